@@ -107,6 +107,7 @@ target_sources (xrpl_core PRIVATE
   src/ripple/protocol/impl/Seed.cpp
   src/ripple/protocol/impl/Serializer.cpp
   src/ripple/protocol/impl/Sign.cpp
+  src/ripple/protocol/impl/SignatureCache.cpp
   src/ripple/protocol/impl/TER.cpp
   src/ripple/protocol/impl/TxFormats.cpp
   src/ripple/protocol/impl/TxMeta.cpp
@@ -240,6 +241,7 @@ install (
     src/ripple/protocol/SeqProxy.h
     src/ripple/protocol/Serializer.h
     src/ripple/protocol/Sign.h
+    src/ripple/protocol/SignatureCache.h
     src/ripple/protocol/SystemParameters.h
     src/ripple/protocol/TER.h
     src/ripple/protocol/TxFlags.h
@@ -366,11 +368,13 @@ target_sources (rippled PRIVATE
   src/ripple/app/ledger/impl/LocalTxs.cpp
   src/ripple/app/ledger/impl/OpenLedger.cpp
   src/ripple/app/ledger/impl/SkipListAcquire.cpp
+  src/ripple/app/ledger/impl/StateExport.cpp
   src/ripple/app/ledger/impl/TimeoutCounter.cpp
   src/ripple/app/ledger/impl/TransactionAcquire.cpp
   src/ripple/app/ledger/impl/TransactionMaster.cpp
   src/ripple/app/main/Application.cpp
   src/ripple/app/main/BasicApp.cpp
+  src/ripple/app/main/CacheGovernor.cpp
   src/ripple/app/main/CollectorManager.cpp
   src/ripple/app/main/GRPCServer.cpp
   src/ripple/app/main/LoadManager.cpp
@@ -458,6 +462,7 @@ target_sources (rippled PRIVATE
   #]===============================]
   src/ripple/basics/impl/Archive.cpp
   src/ripple/basics/impl/BasicConfig.cpp
+  src/ripple/basics/impl/ConcurrentKeyCache.cpp
   src/ripple/basics/impl/ResolverAsio.cpp
   src/ripple/basics/impl/UptimeClock.cpp
   src/ripple/basics/impl/make_SSLContext.cpp
@@ -528,15 +533,20 @@ target_sources (rippled PRIVATE
   src/ripple/nodestore/backend/NuDBFactory.cpp
   src/ripple/nodestore/backend/NullFactory.cpp
   src/ripple/nodestore/backend/RocksDBFactory.cpp
+  src/ripple/nodestore/backend/SegmentFactory.cpp
   src/ripple/nodestore/impl/BatchWriter.cpp
   src/ripple/nodestore/impl/Database.cpp
   src/ripple/nodestore/impl/DatabaseNodeImp.cpp
   src/ripple/nodestore/impl/DatabaseRotatingImp.cpp
   src/ripple/nodestore/impl/DatabaseShardImp.cpp
+  src/ripple/nodestore/impl/DatabaseTieredImp.cpp
   src/ripple/nodestore/impl/DeterministicShard.cpp
   src/ripple/nodestore/impl/DecodedBlob.cpp
+  src/ripple/nodestore/impl/Dictionaries.cpp
   src/ripple/nodestore/impl/DummyScheduler.cpp
+  src/ripple/nodestore/impl/FilteredBackend.cpp
   src/ripple/nodestore/impl/ManagerImp.cpp
+  src/ripple/nodestore/impl/NegativeFilter.cpp
   src/ripple/nodestore/impl/NodeObject.cpp
   src/ripple/nodestore/impl/Shard.cpp
   src/ripple/nodestore/impl/ShardInfo.cpp
@@ -545,6 +555,7 @@ target_sources (rippled PRIVATE
      main sources:
        subdir: overlay
   #]===============================]
+  src/ripple/overlay/impl/BatchVerifier.cpp
   src/ripple/overlay/impl/Cluster.cpp
   src/ripple/overlay/impl/ConnectAttempt.cpp
   src/ripple/overlay/impl/Handshake.cpp
@@ -604,6 +615,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/LedgerCurrent.cpp
   src/ripple/rpc/handlers/LedgerData.cpp
   src/ripple/rpc/handlers/LedgerDiff.cpp
+  src/ripple/rpc/handlers/LedgerExport.cpp
   src/ripple/rpc/handlers/LedgerEntry.cpp
   src/ripple/rpc/handlers/LedgerHandler.cpp
   src/ripple/rpc/handlers/LedgerHeader.cpp
@@ -631,6 +643,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/Submit.cpp
   src/ripple/rpc/handlers/SubmitMultiSigned.cpp
   src/ripple/rpc/handlers/Subscribe.cpp
+  src/ripple/rpc/handlers/Trace.cpp
   src/ripple/rpc/handlers/TransactionEntry.cpp
   src/ripple/rpc/handlers/Tx.cpp
   src/ripple/rpc/handlers/TxHistory.cpp
@@ -661,6 +674,7 @@ target_sources (rippled PRIVATE
        subdir: perflog
   #]===============================]
   src/ripple/perflog/impl/PerfLogImp.cpp
+  src/ripple/perflog/impl/Tracer.cpp
 
   #[===============================[
      main sources:
@@ -691,6 +705,8 @@ if (tests)
     src/test/app/AccountDelete_test.cpp
     src/test/app/AccountTxPaging_test.cpp
     src/test/app/AmendmentTable_test.cpp
+    src/test/app/CacheGovernor_test.cpp
+    src/test/app/CanonicalTXSet_test.cpp
     src/test/app/Check_test.cpp
     src/test/app/CrossingLimits_test.cpp
     src/test/app/DeliverMin_test.cpp
@@ -702,6 +718,7 @@ if (tests)
     src/test/app/Flow_test.cpp
     src/test/app/Freeze_test.cpp
     src/test/app/HashRouter_test.cpp
+    src/test/app/InboundLedger_test.cpp
     src/test/app/LedgerHistory_test.cpp
     src/test/app/LedgerLoad_test.cpp
     src/test/app/LedgerReplay_test.cpp
@@ -722,6 +739,7 @@ if (tests)
     src/test/app/RCLCensorshipDetector_test.cpp
     src/test/app/RCLValidations_test.cpp
     src/test/app/Regression_test.cpp
+    src/test/app/RequestWindow_test.cpp
     src/test/app/SHAMapStore_test.cpp
     src/test/app/SetAuth_test.cpp
     src/test/app/SetRegularKey_test.cpp
@@ -741,6 +759,7 @@ if (tests)
          subdir: basics
     #]===============================]
     src/test/basics/Buffer_test.cpp
+    src/test/basics/ConcurrentKeyCache_test.cpp
     src/test/basics/DetectCrash_test.cpp
     src/test/basics/Expected_test.cpp
     src/test/basics/FileUtilities_test.cpp
@@ -753,6 +772,7 @@ if (tests)
     src/test/basics/Slice_test.cpp
     src/test/basics/StringUtilities_test.cpp
     src/test/basics/TaggedCache_test.cpp
+    src/test/basics/Tracer_test.cpp
     src/test/basics/XRPAmount_test.cpp
     src/test/basics/base64_test.cpp
     src/test/basics/base_uint_test.cpp
@@ -773,6 +793,7 @@ if (tests)
     src/test/beast/beast_CurrentThreadName_test.cpp
     src/test/beast/beast_Journal_test.cpp
     src/test/beast/beast_PropertyStream_test.cpp
+    src/test/beast/beast_StatsDCollector_test.cpp
     src/test/beast/beast_Zero_test.cpp
     src/test/beast/beast_abstract_clock_test.cpp
     src/test/beast/beast_basic_seconds_clock_test.cpp
@@ -789,6 +810,7 @@ if (tests)
     #]===============================]
     src/test/consensus/ByzantineFailureSim_test.cpp
     src/test/consensus/Consensus_test.cpp
+    src/test/consensus/ConsensusBenchmark_test.cpp
     src/test/consensus/DistributedValidatorsSim_test.cpp
     src/test/consensus/LedgerTiming_test.cpp
     src/test/consensus/LedgerTrie_test.cpp
@@ -805,6 +827,7 @@ if (tests)
     src/test/core/CryptoPRNG_test.cpp
     src/test/core/JobQueue_test.cpp
     src/test/core/SociDB_test.cpp
+    src/test/core/Task_test.cpp
     src/test/core/Workers_test.cpp
     #[===============================[
        test sources:
@@ -889,8 +912,12 @@ if (tests)
     #]===============================]
     src/test/nodestore/Backend_test.cpp
     src/test/nodestore/Basics_test.cpp
+    src/test/nodestore/BatchWriter_test.cpp
     src/test/nodestore/DatabaseShard_test.cpp
     src/test/nodestore/Database_test.cpp
+    src/test/nodestore/Dictionaries_test.cpp
+    src/test/nodestore/NegativeFilter_test.cpp
+    src/test/nodestore/Segment_test.cpp
     src/test/nodestore/Timing_test.cpp
     src/test/nodestore/import_test.cpp
     src/test/nodestore/varint_test.cpp
@@ -898,6 +925,7 @@ if (tests)
        test sources:
          subdir: overlay
     #]===============================]
+    src/test/overlay/BatchVerifier_test.cpp
     src/test/overlay/ProtocolVersion_test.cpp
     src/test/overlay/cluster_test.cpp
     src/test/overlay/short_read_test.cpp
@@ -909,6 +937,7 @@ if (tests)
        test sources:
          subdir: peerfinder
     #]===============================]
+    src/test/peerfinder/Handouts_test.cpp
     src/test/peerfinder/Livecache_test.cpp
     src/test/peerfinder/PeerFinder_test.cpp
     #[===============================[
@@ -922,6 +951,7 @@ if (tests)
     src/test/protocol/Memo_test.cpp
     src/test/protocol/PublicKey_test.cpp
     src/test/protocol/Quality_test.cpp
+    src/test/protocol/SField_test.cpp
     src/test/protocol/STAccount_test.cpp
     src/test/protocol/STAmount_test.cpp
     src/test/protocol/STObject_test.cpp
@@ -930,6 +960,7 @@ if (tests)
     src/test/protocol/SecretKey_test.cpp
     src/test/protocol/Seed_test.cpp
     src/test/protocol/SeqProxy_test.cpp
+    src/test/protocol/SignatureCache_test.cpp
     src/test/protocol/TER_test.cpp
     src/test/protocol/types_test.cpp
     #[===============================[
@@ -959,6 +990,7 @@ if (tests)
     src/test/rpc/KeyGeneration_test.cpp
     src/test/rpc/LedgerClosed_test.cpp
     src/test/rpc/LedgerData_test.cpp
+    src/test/rpc/LedgerExport_test.cpp
     src/test/rpc/LedgerRPC_test.cpp
     src/test/rpc/LedgerRequestRPC_test.cpp
     src/test/rpc/ManifestRPC_test.cpp
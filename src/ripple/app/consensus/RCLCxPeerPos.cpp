@@ -71,7 +71,7 @@ proposalUniqueId(
     Slice const& publicKey,
     Slice const& signature)
 {
-    Serializer s(512);
+    SHA512HalfSerializer s;
     s.addBitString(proposeHash);
     s.addBitString(previousLedger);
     s.add32(proposeSeq);
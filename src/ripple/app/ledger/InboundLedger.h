@@ -21,10 +21,12 @@
 #define RIPPLE_APP_LEDGER_INBOUNDLEDGER_H_INCLUDED
 
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/impl/RequestWindow.h>
 #include <ripple/app/ledger/impl/TimeoutCounter.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/basics/CountedObject.h>
 #include <ripple/overlay/PeerSet.h>
+#include <map>
 #include <mutex>
 #include <set>
 #include <utility>
@@ -125,6 +127,17 @@ private:
     void
     filterNodes(
         std::vector<std::pair<SHAMapNodeID, uint256>>& nodes,
+        TriggerReason reason,
+        std::size_t requests);
+
+    std::size_t
+    requestSlots(std::shared_ptr<Peer> const& peer, TriggerReason reason);
+
+    void
+    sendNodeRequests(
+        protocol::TMGetLedger& tmGL,
+        std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+        std::shared_ptr<Peer> const& peer,
         TriggerReason reason);
 
     void
@@ -186,6 +199,9 @@ private:
 
     std::set<uint256> mRecentNodes;
 
+    // Requests for tree nodes in flight to each peer
+    std::map<Peer::id_t, RequestWindow> mWindows;
+
     SHAMapAddNode mStats;
 
     // Data we have received from peers
@@ -205,6 +221,23 @@ deserializeHeader(Slice data, bool hasHash = false);
 LedgerInfo
 deserializePrefixedHeader(Slice data, bool hasHash = false);
 
+/** Add the nodes of a ledger data reply to a map being acquired.
+
+    The nodes below each branch of the root are in disjoint subtrees. When
+    a reply holds enough of them, the branches are added concurrently.
+
+    @param jobQueue Where to add jobs that help, or `nullptr` to add every
+                    node on the calling thread.
+*/
+SHAMapAddNode
+addLedgerNodes(
+    SHAMap& map,
+    SHAMapHash const& rootHash,
+    protocol::TMLedgerData const& packet,
+    SHAMapSyncFilter* filter,
+    JobQueue* jobQueue,
+    beast::Journal journal);
+
 }  // namespace ripple
 
 #endif
@@ -471,7 +471,8 @@ Ledger::read(Keylet const& k) const
 auto
 Ledger::slesBegin() const -> std::unique_ptr<sles_type::iter_base>
 {
-    return std::make_unique<sles_iter_impl>(stateMap_.begin());
+    return std::make_unique<sles_iter_impl>(
+        stateMap_.begin(SHAMap::defaultReadAhead));
 }
 
 auto
@@ -484,7 +485,8 @@ auto
 Ledger::slesUpperBound(uint256 const& key) const
     -> std::unique_ptr<sles_type::iter_base>
 {
-    return std::make_unique<sles_iter_impl>(stateMap_.upper_bound(key));
+    return std::make_unique<sles_iter_impl>(
+        stateMap_.upper_bound(key, SHAMap::defaultReadAhead));
 }
 
 auto
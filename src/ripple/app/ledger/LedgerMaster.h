@@ -309,6 +309,14 @@ private:
 
     std::size_t
     getNeededValidations();
+
+    // Start replaying the ledgers between a recent local ledger and the
+    // ledger with the given hash, rather than acquiring its state, if it
+    // is more than a few ledgers ahead. Returns true if the ledger is being
+    // caught up to.
+    bool
+    catchUp(uint256 const& hash, std::uint32_t seq);
+
     void
     fetchForHistory(
         std::uint32_t missing,
@@ -50,6 +50,9 @@ public:
         InboundLedger::Reason reason_;
         uint256 finishHash_;
         std::uint32_t totalLedgers_;  // including the start and the finish
+        // sequence number of the local ledger a catch-up starts from,
+        // 0 if the task is not part of a catch-up
+        std::uint32_t catchUpStartSeq_ = 0;
 
         // to be updated
         std::uint32_t finishSeq_ = 0;
@@ -129,6 +132,19 @@ public:
     bool
     finished() const;
 
+    /**
+     * Set the task that replays the ledgers before the start ledger of
+     * this task. This task waits for it rather than acquiring the start
+     * ledger, unless it fails.
+     * @param predecessor  the task
+     */
+    void
+    setPredecessor(std::shared_ptr<LedgerReplayTask> const& predecessor);
+
+    /** return the last ledger built if the task is completed */
+    std::shared_ptr<Ledger const>
+    builtLedger() const;
+
 private:
     void
     onTimer(bool progress, ScopedLockType& sl) override;
@@ -175,6 +191,7 @@ private:
     uint32_t maxTimeouts_;
     std::shared_ptr<SkipListAcquire> skipListAcquirer_;
     std::shared_ptr<Ledger const> parent_ = {};
+    std::shared_ptr<LedgerReplayTask> predecessor_ = {};
     uint32_t deltaToBuild_ = 0;  // should not build until have parent
     std::vector<std::shared_ptr<LedgerDeltaAcquire>> deltas_;
 
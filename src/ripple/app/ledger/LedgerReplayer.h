@@ -64,6 +64,20 @@ std::uint32_t constexpr MAX_TASK_SIZE = 256;
 
 // to limit the number of LedgerReplay related jobs in JobQueue
 std::uint32_t constexpr MAX_QUEUED_TASKS = 100;
+
+// for LedgerReplayer to limit the number of tasks one catch-up is split
+// into. Consecutive tasks share a ledger, so a catch-up can replay
+// MAX_CATCH_UP_TASKS * (MAX_TASK_SIZE - 1) ledgers, a little over two
+// hours of ledgers.
+std::uint32_t constexpr MAX_CATCH_UP_TASKS = 8;
+std::uint32_t constexpr MAX_CATCH_UP_LEDGERS =
+    MAX_CATCH_UP_TASKS * (MAX_TASK_SIZE - 1);
+
+// for LedgerMaster to acquire a validated ledger that is at most this many
+// ledgers ahead of the local one, rather than catch up to it. Consensus or
+// an ordinary acquisition, which shares most of the state the node already
+// has, gets there as quickly.
+std::uint32_t constexpr MIN_CATCH_UP_LEDGERS = 8;
 }  // namespace LedgerReplayParameters
 
 /**
@@ -92,10 +106,49 @@ public:
         uint256 const& finishLedgerHash,
         std::uint32_t totalNumLedgers);
 
+    /**
+     * Catch up from a ledger the local node has to a later ledger by
+     * replaying the transactions of every ledger in between, rather than
+     * acquiring the state of the later ledger.
+     *
+     * The range is split into tasks of at most MAX_TASK_SIZE ledgers. The
+     * task for the last ledgers is created first; when its skip list
+     * arrives, it creates the task for the ledgers before its start
+     * ledger, and so on back to the local ledger. The deltas of all the
+     * tasks are acquired at the same time, while the ledgers are built in
+     * order, each task starting from the last ledger of the one before.
+     *
+     * @param start  a ledger the local node has
+     * @param finishLedgerHash  hash of the ledger to catch up to
+     * @param finishSeq  sequence number of the ledger to catch up to
+     * @return true if a catch-up to the ledger is in progress
+     * @note false is returned if the range is longer than
+     *       MAX_CATCH_UP_LEDGERS, or if no task can be created
+     */
+    bool
+    catchUp(
+        std::shared_ptr<Ledger const> const& start,
+        uint256 const& finishLedgerHash,
+        std::uint32_t finishSeq);
+
+    /** Returns true if a catch-up to the ledger or a later one is running
+     * @param seq  sequence number of the ledger, 0 for any catch-up
+     */
+    bool
+    catchingUp(std::uint32_t seq = 0) const;
+
     /** Create LedgerDeltaAcquire subtasks for the LedgerReplayTask task */
     void
     createDeltas(std::shared_ptr<LedgerReplayTask> task);
 
+    /**
+     * Create the task replaying the ledgers before the start ledger of a
+     * catch-up task, unless the task starts from the local ledger
+     * @param task  the catch-up task, with its skip list
+     */
+    void
+    extendCatchUp(std::shared_ptr<LedgerReplayTask> const& task);
+
     /**
      * Process a skip list (extracted from a TMProofPathResponse message)
      * @param info  ledger info
@@ -126,6 +179,23 @@ public:
     stop();
 
 private:
+    /**
+     * Create a task, or find an existing task it can be merged into
+     * @param parameter  parameter of the task
+     * @param predecessor  the task replaying the ledgers before this one
+     * @return the task, or nullptr if no task can be created
+     */
+    std::shared_ptr<LedgerReplayTask>
+    addTask(
+        LedgerReplayTask::TaskParameter&& parameter,
+        std::shared_ptr<LedgerReplayTask> const& predecessor = {});
+
+    // serializes catchUp() calls
+    mutable std::mutex catchUpMtx_;
+    // the task replaying the last ledgers of the newest catch-up
+    std::weak_ptr<LedgerReplayTask> catchUpTask_;
+    std::uint32_t catchUpFinishSeq_ = 0;
+
     mutable std::mutex mtx_;
     std::vector<std::shared_ptr<LedgerReplayTask>> tasks_;
     hash_map<uint256, std::weak_ptr<LedgerDeltaAcquire>> deltas_;
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_STATEEXPORT_H_INCLUDED
+#define RIPPLE_APP_LEDGER_STATEEXPORT_H_INCLUDED
+
+#include <boost/filesystem/path.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ripple {
+
+class JobQueue;
+class Ledger;
+
+/** What exportState wrote */
+struct StateExport
+{
+    std::uint64_t entries = 0;
+    std::uint64_t bytes = 0;
+    std::vector<boost::filesystem::path> files;
+};
+
+/** Write the state of a ledger to files, walking parts of it in parallel
+
+    The key space is split into 16 or 256 partitions by the first four
+    or eight bits of the key, which select the branches of the top one
+    or two levels of the state map. Each partition is written to its own
+    file, named for the ledger and the partition, such as
+    "state-75000000-0a.bin", so the partitions can be walked at once and
+    the files read in any order.
+
+    A file begins with a header:
+
+        magic           8 bytes, "XRPLSTAT"
+        version         32 bits, 1
+        ledger_index    32 bits
+        ledger_hash     256 bits
+        account_hash    256 bits
+        partition       16 bits
+        partitions      16 bits
+
+    which is followed by the entries of the partition in key order:
+
+        key             256 bits
+        data            the serialized entry, with the length prefix
+                        used for variable length fields
+
+    Integers are big endian.
+
+    @param ledger The ledger to export. It must be closed.
+    @param directory Where to write the files. It is created if needed.
+    @param partitions 16 or 256.
+    @param jobQueue Where to add the jobs that walk partitions alongside
+                    the calling thread. At most a few are added, and the
+                    job type limits how many run at once.
+
+    @throws std::runtime_error if a file can't be written, and
+            SHAMapMissingNode if the ledger's state is not all present.
+*/
+StateExport
+exportState(
+    Ledger const& ledger,
+    boost::filesystem::path const& directory,
+    std::size_t partitions,
+    JobQueue& jobQueue);
+
+}  // namespace ripple
+
+#endif
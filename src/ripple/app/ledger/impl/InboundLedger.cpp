@@ -26,16 +26,19 @@
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
 #include <ripple/core/JobQueue.h>
+#include <ripple/core/ParallelFor.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/resource/Fees.h>
+#include <ripple/shamap/SHAMapInnerNode.h>
 #include <ripple/shamap/SHAMapNodeID.h>
 
 #include <boost/iterator/function_output_iterator.hpp>
 
 #include <algorithm>
+#include <array>
 #include <random>
 
 namespace ripple {
@@ -69,6 +72,14 @@ enum {
     // Number of nodes to request blindly
     ,
     reqNodes = 12
+
+    // Number of nodes in a reply before they are added concurrently
+    ,
+    parallelNodesMin = 64
+
+    // Number of jobs helping to add the nodes of a reply
+    ,
+    parallelNodesJobs = 3
 };
 
 // millisecond for each ledger timeout
@@ -433,6 +444,18 @@ InboundLedger::onTimer(bool wasProgress, ScopedLockType&)
 {
     mRecentNodes.clear();
 
+    // Peers ignore requests they can't serve. Assume that any request
+    // outstanding for a whole timer interval was lost.
+    auto const sentBefore = m_clock.now() - ledgerAcquireTimeout;
+    for (auto& [id, window] : mWindows)
+    {
+        if (auto const lost = window.expire(sentBefore))
+        {
+            JLOG(journal_.debug()) << lost << " requests to peer " << id
+                                   << " timed out, window " << window.window();
+        }
+    }
+
     if (isDone())
     {
         JLOG(journal_.info()) << "Already done " << hash_;
@@ -708,10 +731,14 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
             AccountStateSF filter(
                 mLedger->stateMap().family().db(), app_.getLedgerMaster());
 
+            // Find enough nodes to fill every free slot of the peer's window
+            auto const slots = requestSlots(peer, reason);
+            auto const find = std::max<std::size_t>(
+                missingNodesFind, slots * reqNodesReply);
+
             // Release the lock while we process the large state map
             sl.unlock();
-            auto nodes =
-                mLedger->stateMap().getMissingNodes(missingNodesFind, &filter);
+            auto nodes = mLedger->stateMap().getMissingNodes(find, &filter);
             sl.lock();
 
             // Make sure nothing happened while we released the lock
@@ -731,21 +758,16 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
                 }
                 else
                 {
-                    filterNodes(nodes, reason);
+                    filterNodes(nodes, reason, slots);
 
                     if (!nodes.empty())
                     {
                         tmGL.set_itype(protocol::liAS_NODE);
-                        for (auto const& id : nodes)
-                        {
-                            *(tmGL.add_nodeids()) = id.first.getRawString();
-                        }
-
                         JLOG(journal_.trace())
                             << "Sending AS node request (" << nodes.size()
                             << ") to "
                             << (peer ? "selected peer" : "all peers");
-                        mPeerSet->sendRequest(tmGL, peer);
+                        sendNodeRequests(tmGL, nodes, peer, reason);
                         return;
                     }
                     else
@@ -780,8 +802,10 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
             TransactionStateSF filter(
                 mLedger->txMap().family().db(), app_.getLedgerMaster());
 
-            auto nodes =
-                mLedger->txMap().getMissingNodes(missingNodesFind, &filter);
+            auto const slots = requestSlots(peer, reason);
+            auto nodes = mLedger->txMap().getMissingNodes(
+                std::max<std::size_t>(missingNodesFind, slots * reqNodesReply),
+                &filter);
 
             if (nodes.empty())
             {
@@ -797,19 +821,15 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
             }
             else
             {
-                filterNodes(nodes, reason);
+                filterNodes(nodes, reason, slots);
 
                 if (!nodes.empty())
                 {
                     tmGL.set_itype(protocol::liTX_NODE);
-                    for (auto const& n : nodes)
-                    {
-                        *(tmGL.add_nodeids()) = n.first.getRawString();
-                    }
                     JLOG(journal_.trace())
                         << "Sending TX node request (" << nodes.size()
                         << ") to " << (peer ? "selected peer" : "all peers");
-                    mPeerSet->sendRequest(tmGL, peer);
+                    sendNodeRequests(tmGL, nodes, peer, reason);
                     return;
                 }
                 else
@@ -833,7 +853,8 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
 void
 InboundLedger::filterNodes(
     std::vector<std::pair<SHAMapNodeID, uint256>>& nodes,
-    TriggerReason reason)
+    TriggerReason reason,
+    std::size_t requests)
 {
     // Sort nodes so that the ones we haven't recently
     // requested come before the ones we have.
@@ -862,8 +883,8 @@ InboundLedger::filterNodes(
         nodes.erase(dup, nodes.end());
     }
 
-    std::size_t const limit =
-        (reason == TriggerReason::reply) ? reqNodesReply : reqNodes;
+    std::size_t const limit = requests *
+        ((reason == TriggerReason::reply) ? reqNodesReply : reqNodes);
 
     if (nodes.size() > limit)
         nodes.resize(limit);
@@ -872,6 +893,51 @@ InboundLedger::filterNodes(
         mRecentNodes.insert(n.second);
 }
 
+/** The number of node requests to send to a peer at once
+
+    A peer that replied may be sent enough requests to fill its window.
+    Other requests are sent one at a time.
+*/
+std::size_t
+InboundLedger::requestSlots(
+    std::shared_ptr<Peer> const& peer,
+    TriggerReason reason)
+{
+    if (!peer || reason != TriggerReason::reply)
+        return 1;
+
+    return std::max<std::size_t>(mWindows[peer->id()].available(), 1);
+}
+
+/** Send requests for tree nodes, split to fit the peer's window
+    Call with a lock
+*/
+void
+InboundLedger::sendNodeRequests(
+    protocol::TMGetLedger& tmGL,
+    std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+    std::shared_ptr<Peer> const& peer,
+    TriggerReason reason)
+{
+    std::size_t const perRequest =
+        (reason == TriggerReason::reply) ? reqNodesReply : reqNodes;
+
+    for (std::size_t i = 0; i < nodes.size(); i += perRequest)
+    {
+        tmGL.clear_nodeids();
+        for (std::size_t j = i; j < std::min(i + perRequest, nodes.size());
+             ++j)
+        {
+            *(tmGL.add_nodeids()) = nodes[j].first.getRawString();
+        }
+
+        mPeerSet->sendRequest(tmGL, peer);
+
+        if (peer)
+            mWindows[peer->id()].onSend(m_clock.now());
+    }
+}
+
 /** Take ledger header data
     Call with a lock
 */
@@ -921,6 +987,120 @@ InboundLedger::takeHeader(std::string const& data)
     return true;
 }
 
+SHAMapAddNode
+addLedgerNodes(
+    SHAMap& map,
+    SHAMapHash const& rootHash,
+    protocol::TMLedgerData const& packet,
+    SHAMapSyncFilter* filter,
+    JobQueue* jobQueue,
+    beast::Journal journal)
+{
+    SHAMapAddNode san;
+
+    // The nodes below each branch of the root are in disjoint subtrees,
+    // so the nodes of each branch can be added concurrently.
+    std::array<
+        std::vector<std::pair<SHAMapNodeID, Slice>>,
+        SHAMapInnerNode::branchFactor>
+        branches;
+
+    try
+    {
+        for (auto const& node : packet.nodes())
+        {
+            auto const nodeID = deserializeSHAMapNodeID(node.nodeid());
+
+            if (!nodeID)
+                throw std::runtime_error("data does not properly deserialize");
+
+            if (nodeID->isRoot())
+            {
+                san += map.addRootNode(
+                    rootHash, makeSlice(node.nodedata()), filter);
+
+                if (!san.isGood())
+                {
+                    JLOG(journal.warn()) << "Received bad node data";
+                    return san;
+                }
+            }
+            else
+            {
+                branches[selectBranch(SHAMapNodeID(), nodeID->getNodeID())]
+                    .emplace_back(*nodeID, makeSlice(node.nodedata()));
+            }
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(journal.error()) << "Received bad node data: " << e.what();
+        san.incInvalid();
+        return san;
+    }
+
+    std::vector<std::size_t> used;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < branches.size(); ++i)
+    {
+        if (!branches[i].empty())
+        {
+            // A node can only be hooked once its parent is in the map
+            std::stable_sort(
+                branches[i].begin(),
+                branches[i].end(),
+                [](auto const& a, auto const& b) {
+                    return a.first.getDepth() < b.first.getDepth();
+                });
+            used.push_back(i);
+            count += branches[i].size();
+        }
+    }
+
+    std::vector<SHAMapAddNode> results(used.size());
+    auto addBranch = [&](std::size_t i) {
+        auto& result = results[i];
+        try
+        {
+            for (auto const& [nodeID, data] : branches[used[i]])
+            {
+                result += map.addKnownNode(nodeID, data, filter);
+                if (!result.isGood())
+                    return;
+            }
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(journal.error()) << "Received bad node data: " << e.what();
+            result.incInvalid();
+        }
+    };
+
+    if (jobQueue && used.size() > 1 && count >= parallelNodesMin)
+    {
+        parallelFor(
+            *jobQueue,
+            jtLEDGER_NODES,
+            "InboundLedger::addNodes",
+            used.size(),
+            parallelNodesJobs,
+            addBranch);
+    }
+    else
+    {
+        for (std::size_t i = 0; i < used.size(); ++i)
+            addBranch(i);
+    }
+
+    for (auto const& result : results)
+        san += result;
+
+    if (!san.isGood())
+        JLOG(journal.warn()) << "Received bad node data";
+
+    return san;
+}
+
 /** Process node data received from a peer
     Call with a lock
 */
@@ -962,39 +1142,11 @@ InboundLedger::receiveNode(protocol::TMLedgerData& packet, SHAMapAddNode& san)
                 mLedger->stateMap().family().db(), app_.getLedgerMaster())};
     }();
 
-    try
-    {
-        auto const f = filter.get();
-
-        for (auto const& node : packet.nodes())
-        {
-            auto const nodeID = deserializeSHAMapNodeID(node.nodeid());
-
-            if (!nodeID)
-                throw std::runtime_error("data does not properly deserialize");
-
-            if (nodeID->isRoot())
-            {
-                san += map.addRootNode(rootHash, makeSlice(node.nodedata()), f);
-            }
-            else
-            {
-                san += map.addKnownNode(*nodeID, makeSlice(node.nodedata()), f);
-            }
+    san += addLedgerNodes(
+        map, rootHash, packet, filter.get(), &app_.getJobQueue(), journal_);
 
-            if (!san.isGood())
-            {
-                JLOG(journal_.warn()) << "Received bad node data";
-                return;
-            }
-        }
-    }
-    catch (std::exception const& e)
-    {
-        JLOG(journal_.error()) << "Received bad node data: " << e.what();
-        san.incInvalid();
+    if (!san.isGood())
         return;
-    }
 
     if (!map.isSynching())
     {
@@ -1216,10 +1368,14 @@ InboundLedger::processData(
         SHAMapAddNode san;
         receiveNode(packet, san);
 
+        auto& window = mWindows[peer->id()];
+        window.onReply(m_clock.now(), san.isUseful());
+
         JLOG(journal_.debug())
             << "Ledger "
             << ((packet.type() == protocol::liTX_NODE) ? "TX" : "AS")
-            << " node stats: " << san.get();
+            << " node stats: " << san.get() << " window: " << window.window()
+            << " rtt: " << window.rtt().count() << "ms";
 
         if (san.isUseful())
             progress_ = true;
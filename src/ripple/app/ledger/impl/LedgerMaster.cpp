@@ -1017,6 +1017,11 @@ LedgerMaster::checkAccept(uint256 const& hash, std::uint32_t seq)
                 app_.overlay().checkTracking(seq);
         }
 
+        // Only a ledger the network has validated is caught up to
+        if ((seq != 0) && (valCount >= app_.validators().quorum()) &&
+            catchUp(hash, seq))
+            return;
+
         // FIXME: We may not want to fetch a ledger with just one
         // trusted validation
         ledger = app_.getInboundLedgers().acquire(
@@ -1027,6 +1032,46 @@ LedgerMaster::checkAccept(uint256 const& hash, std::uint32_t seq)
         checkAccept(ledger);
 }
 
+bool
+LedgerMaster::catchUp(uint256 const& hash, std::uint32_t seq)
+{
+    if (!app_.config().LEDGER_REPLAY || app_.config().reporting())
+        return false;
+
+    auto& replayer = app_.getLedgerReplayer();
+    if (replayer.catchingUp(seq))
+        return true;
+
+    // A ledger only a few ahead of the local one is acquired instead
+    auto const farAhead = [seq](std::uint32_t local) {
+        return local < seq &&
+            seq - local > LedgerReplayParameters::MIN_CATCH_UP_LEDGERS;
+    };
+
+    // Start from the validated ledger or, after a restart, from the last
+    // ledger saved before the node stopped.
+    auto start = mValidLedger.get();
+    if (start && !farAhead(start->info().seq))
+        return false;
+    if (!start)
+    {
+        auto const info = app_.getRelationalDatabase().getNewestLedgerInfo();
+        if (!info || !farAhead(info->seq) ||
+            seq - info->seq > LedgerReplayParameters::MAX_CATCH_UP_LEDGERS)
+            return false;
+
+        // Do not acquire it if its state is not here
+        start = loadByHash(info->hash, app_, false);
+    }
+
+    if (!start || !replayer.catchUp(start, hash, seq))
+        return false;
+
+    JLOG(m_journal.info()) << "Catching up from " << start->info().seq
+                           << " to " << seq << " by replaying ledgers";
+    return true;
+}
+
 /**
  * Determines how many validations are needed to fully validate a ledger
  *
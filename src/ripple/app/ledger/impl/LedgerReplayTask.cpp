@@ -152,6 +152,23 @@ LedgerReplayTask::trigger(ScopedLockType& sl)
     if (!parent_)
     {
         parent_ = app_.getLedgerMaster().getLedgerByHash(parameter_.startHash_);
+        if (!parent_ && predecessor_)
+        {
+            // The start ledger is the last ledger of the predecessor
+            if (auto const l = predecessor_->builtLedger();
+                l && l->info().hash == parameter_.startHash_)
+            {
+                parent_ = l;
+            }
+            else if (!predecessor_->finished())
+            {
+                // Waiting for it is not a timeout of this task
+                JLOG(journal_.trace()) << "Task " << hash_
+                                       << " waiting for the start ledger";
+                progress_ = true;
+                return;
+            }
+        }
         if (!parent_)
         {
             parent_ = inboundLedgers_.acquire(
@@ -164,6 +181,7 @@ LedgerReplayTask::trigger(ScopedLockType& sl)
             JLOG(journal_.trace())
                 << "Got start ledger " << parameter_.startHash_ << " for task "
                 << hash_;
+            predecessor_.reset();
         }
     }
 
@@ -215,6 +233,18 @@ LedgerReplayTask::tryAdvance(ScopedLockType& sl)
 
         complete_ = true;
         JLOG(journal_.info()) << "Completed " << hash_;
+
+        if (parameter_.catchUpStartSeq_ != 0)
+        {
+            // Let the ledger become the validated ledger, so the ledgers
+            // after it are caught up from it.
+            app_.getJobQueue().addJob(
+                jtREPLAY_TASK,
+                "catchUpDone",
+                [&app = app_, ledger = parent_]() {
+                    app.getLedgerMaster().checkAccept(ledger);
+                });
+        }
     }
     catch (std::runtime_error const&)
     {
@@ -241,6 +271,7 @@ LedgerReplayTask::updateSkipList(
     }
 
     replayer_.createDeltas(shared_from_this());
+    replayer_.extendCatchUp(shared_from_this());
     ScopedLockType sl(mtx_);
     if (!isDone())
         trigger(sl);
@@ -303,4 +334,22 @@ LedgerReplayTask::finished() const
     return isDone();
 }
 
+void
+LedgerReplayTask::setPredecessor(
+    std::shared_ptr<LedgerReplayTask> const& predecessor)
+{
+    ScopedLockType sl(mtx_);
+    if (!isDone() && !parent_)
+        predecessor_ = predecessor;
+}
+
+std::shared_ptr<Ledger const>
+LedgerReplayTask::builtLedger() const
+{
+    ScopedLockType sl(mtx_);
+    if (complete_)
+        return parent_;
+    return {};
+}
+
 }  // namespace ripple
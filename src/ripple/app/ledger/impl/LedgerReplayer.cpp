@@ -51,21 +51,27 @@ LedgerReplayer::replay(
         finishLedgerHash.isNonZero() && totalNumLedgers > 0 &&
         totalNumLedgers <= LedgerReplayParameters::MAX_TASK_SIZE);
 
-    LedgerReplayTask::TaskParameter parameter(
-        r, finishLedgerHash, totalNumLedgers);
+    addTask(LedgerReplayTask::TaskParameter(
+        r, finishLedgerHash, totalNumLedgers));
+}
 
+std::shared_ptr<LedgerReplayTask>
+LedgerReplayer::addTask(
+    LedgerReplayTask::TaskParameter&& parameter,
+    std::shared_ptr<LedgerReplayTask> const& predecessor)
+{
     std::shared_ptr<LedgerReplayTask> task;
     std::shared_ptr<SkipListAcquire> skipList;
     bool newSkipList = false;
     {
         std::lock_guard<std::mutex> lock(mtx_);
         if (app_.isStopping())
-            return;
+            return {};
         if (tasks_.size() >= LedgerReplayParameters::MAX_TASKS)
         {
             JLOG(j_.info()) << "Too many replay tasks, dropping new task "
                             << parameter.finishHash_;
-            return;
+            return {};
         }
 
         for (auto const& t : tasks_)
@@ -73,12 +79,12 @@ LedgerReplayer::replay(
             if (parameter.canMergeInto(t->getTaskParameter()))
             {
                 JLOG(j_.info()) << "Task " << parameter.finishHash_ << " with "
-                                << totalNumLedgers
+                                << parameter.totalLedgers_
                                 << " ledgers merged into an existing task.";
-                return;
+                return t;
             }
         }
-        JLOG(j_.info()) << "Replay " << totalNumLedgers
+        JLOG(j_.info()) << "Replay " << parameter.totalLedgers_
                         << " ledgers. Finish ledger hash "
                         << parameter.finishHash_;
 
@@ -102,10 +108,94 @@ LedgerReplayer::replay(
         tasks_.push_back(task);
     }
 
+    if (predecessor)
+        task->setPredecessor(predecessor);
     if (newSkipList)
         skipList->init(1);
     // task init after skipList init, could save a timeout
     task->init();
+    return task;
+}
+
+bool
+LedgerReplayer::catchUp(
+    std::shared_ptr<Ledger const> const& start,
+    uint256 const& finishLedgerHash,
+    std::uint32_t finishSeq)
+{
+    assert(finishLedgerHash.isNonZero());
+    std::lock_guard<std::mutex> lock(catchUpMtx_);
+
+    // Carry on from a catch-up that is still running if it is not too far
+    // behind, so that the ledgers it replays are not replayed twice.
+    std::shared_ptr<LedgerReplayTask> predecessor;
+    std::uint32_t startSeq = start ? start->seq() : 0;
+    if (auto const last = catchUpTask_.lock(); last && !last->finished())
+    {
+        if (finishSeq <= catchUpFinishSeq_)
+            return true;
+        if (finishSeq - catchUpFinishSeq_ <
+            LedgerReplayParameters::MAX_TASK_SIZE)
+        {
+            predecessor = last;
+            startSeq = catchUpFinishSeq_;
+        }
+    }
+
+    if (!predecessor && !start)
+        return false;
+    if (finishSeq <= startSeq ||
+        finishSeq - startSeq > LedgerReplayParameters::MAX_CATCH_UP_LEDGERS)
+        return false;
+
+    LedgerReplayTask::TaskParameter parameter(
+        InboundLedger::Reason::GENERIC,
+        finishLedgerHash,
+        std::min(
+            finishSeq - startSeq + 1, LedgerReplayParameters::MAX_TASK_SIZE));
+    parameter.catchUpStartSeq_ = startSeq;
+
+    JLOG(j_.info()) << "Catch up " << finishSeq - startSeq
+                    << " ledgers from seq=" << startSeq
+                    << " to seq=" << finishSeq << ", " << finishLedgerHash;
+    auto const task = addTask(std::move(parameter), predecessor);
+    if (!task)
+        return false;
+
+    catchUpTask_ = task;
+    catchUpFinishSeq_ = finishSeq;
+    return true;
+}
+
+bool
+LedgerReplayer::catchingUp(std::uint32_t seq) const
+{
+    std::lock_guard<std::mutex> lock(catchUpMtx_);
+    auto const last = catchUpTask_.lock();
+    return last && !last->finished() && seq <= catchUpFinishSeq_;
+}
+
+void
+LedgerReplayer::extendCatchUp(std::shared_ptr<LedgerReplayTask> const& task)
+{
+    auto const& parameter = task->getTaskParameter();
+    if (!parameter.full_ || parameter.catchUpStartSeq_ == 0 ||
+        parameter.startSeq_ <= parameter.catchUpStartSeq_)
+        return;
+
+    LedgerReplayTask::TaskParameter previous(
+        parameter.reason_,
+        parameter.startHash_,
+        std::min(
+            parameter.startSeq_ - parameter.catchUpStartSeq_ + 1,
+            LedgerReplayParameters::MAX_TASK_SIZE));
+    previous.catchUpStartSeq_ = parameter.catchUpStartSeq_;
+
+    JLOG(j_.debug()) << "Extend catch-up " << parameter.finishHash_
+                     << " with " << previous.totalLedgers_
+                     << " ledgers before seq=" << parameter.startSeq_;
+    if (auto const t = addTask(std::move(previous)); t && t != task)
+        task->setPredecessor(t);
 }
 
 void
@@ -0,0 +1,163 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_REQUESTWINDOW_H_INCLUDED
+#define RIPPLE_APP_LEDGER_REQUESTWINDOW_H_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+
+namespace ripple {
+
+/** Limits the number of requests outstanding to one peer.
+
+    While acquiring a ledger, several requests for tree nodes may be in
+    flight to the same peer, so that the peer is never idle waiting for
+    the next request. The size of the window adapts to the round trip
+    time observed for the peer:
+
+    - A useful reply that arrives close to the fastest round trip seen
+      from the peer opens the window by one request.
+    - A reply that arrives much later than that suggests the peer (or the
+      path to it) is congested, and closes the window by one request.
+    - A useless reply, or a request that times out, halves the window.
+
+    Replies are matched with requests in the order the requests were
+    sent.
+
+    @note This class is not thread-safe.
+*/
+class RequestWindow
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+    using duration = std::chrono::milliseconds;
+
+    static constexpr std::size_t minimumWindow = 1;
+    static constexpr std::size_t initialWindow = 2;
+    static constexpr std::size_t maximumWindow = 8;
+
+    /** The number of requests that may be sent now. */
+    std::size_t
+    available() const
+    {
+        return window_ > sent_.size() ? window_ - sent_.size() : 0;
+    }
+
+    /** The number of requests the peer may have in flight. */
+    std::size_t
+    window() const
+    {
+        return window_;
+    }
+
+    /** The number of requests waiting for a reply. */
+    std::size_t
+    outstanding() const
+    {
+        return sent_.size();
+    }
+
+    /** The smoothed round trip time, zero until a reply was seen. */
+    duration
+    rtt() const
+    {
+        return srtt_;
+    }
+
+    /** Record that a request was sent. */
+    void
+    onSend(clock_type::time_point now)
+    {
+        sent_.push_back(now);
+    }
+
+    /** Record a reply to the oldest outstanding request.
+
+        @param useful `true` if the reply had data we needed.
+    */
+    void
+    onReply(clock_type::time_point now, bool useful)
+    {
+        // A reply to a request sent to every peer
+        if (sent_.empty())
+            return;
+
+        auto const sample = std::max(
+            duration{1},
+            std::chrono::duration_cast<duration>(now - sent_.front()));
+        sent_.pop_front();
+
+        if (srtt_ == duration::zero())
+        {
+            srtt_ = sample;
+            minRtt_ = sample;
+        }
+        else
+        {
+            srtt_ += (sample - srtt_) / 8;
+            minRtt_ = std::min(minRtt_, sample);
+        }
+
+        if (!useful)
+            shrink();
+        else if (srtt_ * 2 <= minRtt_ * 3)
+            window_ = std::min(window_ + 1, maximumWindow);
+        else if (srtt_ >= minRtt_ * 2)
+            window_ = std::max(window_ - 1, minimumWindow);
+    }
+
+    /** Forget requests sent before a point in time.
+
+        @return The number of requests forgotten.
+    */
+    std::size_t
+    expire(clock_type::time_point sentBefore)
+    {
+        std::size_t count = 0;
+        while (!sent_.empty() && sent_.front() < sentBefore)
+        {
+            sent_.pop_front();
+            ++count;
+        }
+
+        if (count != 0)
+            shrink();
+
+        return count;
+    }
+
+private:
+    void
+    shrink()
+    {
+        window_ = std::max(window_ / 2, minimumWindow);
+    }
+
+    std::deque<clock_type::time_point> sent_;
+    std::size_t window_ = initialWindow;
+    duration srtt_{0};
+    duration minRtt_{0};
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,206 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/StateExport.h>
+#include <ripple/basics/contract.h>
+#include <ripple/core/ParallelFor.h>
+#include <ripple/protocol/Serializer.h>
+#include <boost/filesystem/operations.hpp>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <mutex>
+
+namespace ripple {
+
+namespace {
+
+constexpr char magic[] = "XRPLSTAT";
+constexpr std::uint32_t version = 1;
+
+// Write a file's buffer out when it holds this much
+constexpr std::size_t flushSize = 1024 * 1024;
+
+// The most jobs that help the calling thread walk the partitions
+constexpr std::size_t exportHelpers = 3;
+
+boost::filesystem::path
+partitionFile(
+    boost::filesystem::path const& directory,
+    LedgerIndex seq,
+    std::size_t partition)
+{
+    char name[32];
+    std::snprintf(
+        name,
+        sizeof(name),
+        "state-%u-%02x.bin",
+        static_cast<unsigned>(seq),
+        static_cast<unsigned>(partition));
+    return directory / name;
+}
+
+// Write the entries with keys from first to last, inclusive
+void
+exportPartition(
+    Ledger const& ledger,
+    boost::filesystem::path const& file,
+    std::size_t partition,
+    std::size_t partitions,
+    uint256 const& first,
+    uint256 const& last,
+    std::atomic<std::uint64_t>& entries,
+    std::atomic<std::uint64_t>& bytes)
+{
+    std::ofstream out(file.string(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        Throw<std::runtime_error>("Unable to open " + file.string());
+
+    Serializer s(flushSize + 4096);
+    auto flush = [&] {
+        out.write(reinterpret_cast<char const*>(s.data()), s.size());
+        if (!out)
+            Throw<std::runtime_error>("Unable to write " + file.string());
+        bytes += s.size();
+        s.erase();
+    };
+
+    auto const& info = ledger.info();
+    s.addRaw(magic, sizeof(magic) - 1);
+    s.add32(version);
+    s.add32(info.seq);
+    s.addBitString(info.hash);
+    s.addBitString(info.accountHash);
+    s.add16(static_cast<std::uint16_t>(partition));
+    s.add16(static_cast<std::uint16_t>(partitions));
+
+    auto const& map = ledger.stateMap();
+
+    // upper_bound finds the first key after the one it's given, so
+    // only the first partition can't be found that way. Nothing past the
+    // partition is read ahead.
+    auto it = [&] {
+        if (first.isZero())
+            return map.begin(SHAMap::defaultReadAhead, last);
+        auto before = first;
+        return map.upper_bound(--before, SHAMap::defaultReadAhead, last);
+    }();
+
+    std::uint64_t count = 0;
+    for (auto const end = map.end(); it != end && it->key() <= last; ++it)
+    {
+        s.addBitString(it->key());
+        s.addVL(it->slice());
+        ++count;
+
+        if (s.size() >= flushSize)
+            flush();
+    }
+
+    flush();
+    out.close();
+    if (!out)
+        Throw<std::runtime_error>("Unable to write " + file.string());
+
+    entries += count;
+}
+
+}  // namespace
+
+StateExport
+exportState(
+    Ledger const& ledger,
+    boost::filesystem::path const& directory,
+    std::size_t partitions,
+    JobQueue& jobQueue)
+{
+    if (partitions != 16 && partitions != 256)
+        Throw<std::invalid_argument>("State must be split 16 or 256 ways");
+
+    boost::filesystem::create_directories(directory);
+
+    StateExport result;
+    for (std::size_t partition = 0; partition < partitions; ++partition)
+        result.files.push_back(
+            partitionFile(directory, ledger.info().seq, partition));
+
+    // A partition is the keys whose leading bits are its index
+    int const shift = partitions == 16 ? 4 : 0;
+    auto bounds = [shift](std::size_t partition) {
+        uint256 first;
+        uint256 last = ~first;
+        first.data()[0] = static_cast<std::uint8_t>(partition << shift);
+        last.data()[0] = first.data()[0] | ((1 << shift) - 1);
+        return std::make_pair(first, last);
+    };
+
+    std::atomic<std::uint64_t> entries{0};
+    std::atomic<std::uint64_t> bytes{0};
+
+    std::atomic<bool> failed{false};
+    std::mutex m;
+    std::exception_ptr error;
+
+    auto work = [&](std::size_t partition) {
+        // Skip the partitions not yet started once one fails
+        if (failed)
+            return;
+
+        try
+        {
+            auto const [first, last] = bounds(partition);
+            exportPartition(
+                ledger,
+                result.files[partition],
+                partition,
+                partitions,
+                first,
+                last,
+                entries,
+                bytes);
+        }
+        catch (...)
+        {
+            failed = true;
+
+            std::lock_guard lock(m);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    parallelFor(
+        jobQueue,
+        jtLEDGER_EXPORT,
+        "exportState",
+        partitions,
+        exportHelpers,
+        work);
+
+    if (error)
+        std::rethrow_exception(error);
+
+    result.entries = entries;
+    result.bytes = bytes;
+    return result;
+}
+
+}  // namespace ripple
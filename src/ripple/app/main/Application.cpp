@@ -30,6 +30,7 @@
 #include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/main/BasicApp.h>
+#include <ripple/app/main/CacheGovernor.h>
 #include <ripple/app/main/DBInit.h>
 #include <ripple/app/main/GRPCServer.h>
 #include <ripple/app/main/LoadManager.h>
@@ -204,6 +205,7 @@ public:
     std::unique_ptr<InboundTransactions> m_inboundTransactions;
     std::unique_ptr<LedgerReplayer> m_ledgerReplayer;
     TaggedCache<uint256, AcceptedLedger> m_acceptedLedgerCache;
+    std::unique_ptr<CacheGovernor> cacheGovernor_;
     std::unique_ptr<NetworkOPs> m_networkOPs;
     std::unique_ptr<Cluster> cluster_;
     std::unique_ptr<PeerReservationTable> peerReservations_;
@@ -495,6 +497,26 @@ public:
 
         add(m_resourceManager.get());
 
+        if (config_->MEMORY_BUDGET)
+        {
+            cacheGovernor_ = std::make_unique<CacheGovernor>(
+                *config_->MEMORY_BUDGET * 1024 * 1024,
+                logs_->journal("CacheGovernor"));
+
+            if (!CacheGovernor::residentMemory())
+                JLOG(m_journal.warn())
+                    << "Resident memory can not be measured on this "
+                       "platform: [" SECTION_MEMORY_BUDGET "] is ignored";
+
+            // The memory held by each entry is a rough estimate, used to
+            // weigh the caches against each other.
+            cacheGovernor_->add(
+                "tree nodes", *nodeFamily_.getTreeNodeCache(0), 256);
+            cacheGovernor_->add(
+                "full below", *nodeFamily_.getFullBelowCache(0), 64);
+            cacheGovernor_->add("state entries", cachedSLEs_, 512);
+        }
+
         //
         // VFALCO - READ THIS!
         //
@@ -1054,6 +1076,10 @@ public:
             signalStop();
         }
 
+        // Resize the caches before they are swept to their new targets
+        if (cacheGovernor_)
+            cacheGovernor_->update();
+
         // VFALCO NOTE Does the order of calls matter?
         // VFALCO TODO fix the dependency inversion using an observer,
         //         have listeners register for "onSweep ()" notification.
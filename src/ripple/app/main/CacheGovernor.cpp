@@ -0,0 +1,237 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/CacheGovernor.h>
+#include <ripple/basics/Log.h>
+
+#if defined(__linux__)
+#include <fstream>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+namespace ripple {
+
+namespace {
+
+constexpr std::uint64_t megabyte = 1024 * 1024;
+
+// Hits earned since the last update for each byte held
+double
+usefulness(std::uint64_t hits, std::uint64_t bytes)
+{
+    return bytes == 0 ? 0.0 : static_cast<double>(hits) / bytes;
+}
+
+}  // namespace
+
+CacheGovernor::CacheGovernor(
+    std::uint64_t budget,
+    beast::Journal journal,
+    ResidentMemory residentMemory)
+    : budget_(budget), j_(journal), residentMemory_(std::move(residentMemory))
+{
+}
+
+void
+CacheGovernor::update()
+{
+    auto const resident = residentMemory_();
+    if (!resident)
+        return;
+
+    std::lock_guard lock(mutex_);
+
+    std::vector<Sample> samples;
+    samples.reserve(entries_.size());
+    for (auto& e : entries_)
+    {
+        auto const [hits, misses] = e.hitsAndMisses();
+
+        // The counters start over when a cache is reset
+        samples.push_back(
+            {&e,
+             e.size() * e.entryBytes,
+             hits >= e.hits ? hits - e.hits : hits,
+             misses >= e.misses ? misses - e.misses : misses});
+        e.hits = hits;
+        e.misses = misses;
+    }
+
+    // Between the low water mark and the budget, leave the caches alone
+    auto const low = budget_ - budget_ / 5;
+
+    if (*resident > budget_)
+    {
+        // What the caches already gave up may not have been returned to the
+        // system yet
+        auto const excess = *resident - budget_;
+        if (excess <= reclaimed_)
+            return;
+
+        JLOG(j_.info()) << "Resident memory of " << *resident / megabyte
+                        << "MB is over the budget of " << budget_ / megabyte
+                        << "MB";
+        reclaimed_ += shrink(samples, excess - reclaimed_);
+    }
+    else if (*resident < low)
+    {
+        reclaimed_ = 0;
+        grow(samples, low - *resident);
+    }
+}
+
+std::uint64_t
+CacheGovernor::shrink(std::vector<Sample>& samples, std::uint64_t excess)
+{
+    std::uint64_t reclaimed = 0;
+
+    std::sort(
+        samples.begin(), samples.end(), [](Sample const& a, Sample const& b) {
+            return usefulness(a.hits, a.bytes) < usefulness(b.hits, b.bytes);
+        });
+
+    for (auto const& s : samples)
+    {
+        if (excess == 0)
+            break;
+        if (s.bytes == 0)
+            continue;
+
+        auto& e = *s.entry;
+        if (e.targetSize <= e.baseSize / 4 && e.targetAge <= e.baseAge / 4)
+            continue;
+
+        // Take at most half of a cache in one update, so that a cache that
+        // was idle for one sweep is not emptied.
+        auto const reclaim = std::min(s.bytes / 2, excess);
+        double const keep = 1.0 - static_cast<double>(reclaim) / s.bytes;
+        double const entries = static_cast<double>(s.bytes / e.entryBytes);
+
+        retarget(
+            e,
+            std::min<double>(e.targetSize, entries) * keep,
+            std::chrono::duration_cast<duration>(e.targetAge * keep));
+        excess -= reclaim;
+        reclaimed += reclaim;
+    }
+
+    return reclaimed;
+}
+
+void
+CacheGovernor::grow(std::vector<Sample>& samples, std::uint64_t room)
+{
+    std::sort(
+        samples.begin(), samples.end(), [](Sample const& a, Sample const& b) {
+            return usefulness(a.hits, a.bytes) > usefulness(b.hits, b.bytes);
+        });
+
+    for (auto const& s : samples)
+    {
+        if (room == 0)
+            break;
+
+        // A cache that is not hit would not earn more for being larger, and
+        // one that does not miss already holds everything that is asked of
+        // it.
+        if (s.bytes == 0 || s.hits == 0 || s.misses == 0)
+            continue;
+
+        auto& e = *s.entry;
+        if (e.targetSize >= e.baseSize * 4 && e.targetAge >= e.baseAge * 4)
+            continue;
+
+        // A cache that has not filled its target would not use the room
+        if (e.targetSize > 0 &&
+            s.bytes / e.entryBytes <
+                static_cast<std::uint64_t>(e.targetSize) * 9 / 10)
+            continue;
+
+        auto const extra = std::min(s.bytes / 4, room);
+        double const factor = 1.0 + static_cast<double>(extra) / s.bytes;
+
+        retarget(
+            e,
+            e.targetSize * factor,
+            std::chrono::duration_cast<duration>(e.targetAge * factor));
+        room -= extra;
+    }
+}
+
+void
+CacheGovernor::retarget(Entry& e, double size, duration age)
+{
+    if (e.baseSize > 0)
+    {
+        e.targetSize = static_cast<int>(std::clamp(
+            size,
+            std::max(e.baseSize / 4.0, 1.0),
+            e.baseSize * 4.0));
+    }
+    e.targetAge = std::clamp(age, e.baseAge / 4, e.baseAge * 4);
+    e.setTarget(e.targetSize, e.targetAge);
+
+    JLOG(j_.debug())
+        << e.name << " target size " << e.targetSize << ", age "
+        << std::chrono::duration_cast<std::chrono::seconds>(e.targetAge)
+               .count()
+        << "s";
+}
+
+std::optional<std::pair<int, CacheGovernor::duration>>
+CacheGovernor::target(std::string const& name) const
+{
+    std::lock_guard lock(mutex_);
+    for (auto const& e : entries_)
+    {
+        if (e.name == name)
+            return std::make_pair(e.targetSize, e.targetAge);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::uint64_t>
+CacheGovernor::residentMemory()
+{
+#if defined(__linux__)
+    // The second field is the resident set, in pages
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t total = 0;
+    std::uint64_t resident = 0;
+    if (!(statm >> total >> resident))
+        return std::nullopt;
+    return resident * static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(
+            mach_task_self(),
+            MACH_TASK_BASIC_INFO,
+            reinterpret_cast<task_info_t>(&info),
+            &count) != KERN_SUCCESS)
+        return std::nullopt;
+    return info.resident_size;
+#else
+    return std::nullopt;
+#endif
+}
+
+}  // namespace ripple
@@ -0,0 +1,187 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MAIN_CACHEGOVERNOR_H_INCLUDED
+#define RIPPLE_APP_MAIN_CACHEGOVERNOR_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** Resizes caches to keep the server within a memory budget.
+
+    Caches are normally sized from the node size alone, so a server either
+    has memory to spare or thrashes its caches when load rises. Once per
+    sweep the governor compares the resident memory of the process with the
+    budget:
+
+    - Over budget, it shrinks the target size and age of the caches, taking
+      first and most from those that earned the fewest hits, since the last
+      update, for the memory they hold.
+    - Below the low water mark, it lets the caches that are full and still
+      missing grow, the most useful first, into the room that is left.
+
+    Between the low water mark and the budget the caches are left alone, so
+    that they do not shrink and grow on alternate sweeps.
+
+    Memory a cache frees is not always returned to the system, so resident
+    memory can stay over budget after the caches shrink. The governor
+    counts the bytes, by its estimate of what each entry holds, that it
+    took from the caches since the server went over budget, and only
+    shrinks them further for the part of the excess that those bytes do
+    not cover.
+
+    A cache stays between a quarter and four times the size and age it had
+    when it was added. A cache with no target size is governed by age alone.
+
+    @note This class is thread-safe.
+*/
+class CacheGovernor
+{
+public:
+    using duration = std::chrono::steady_clock::duration;
+
+    /** Returns the resident memory of the process in bytes, if known. */
+    using ResidentMemory = std::function<std::optional<std::uint64_t>()>;
+
+    /** Create a governor.
+
+        @param budget The resident memory, in bytes, to stay within.
+        @param journal Where to report changes to the caches.
+        @param residentMemory How to measure the resident memory.
+    */
+    CacheGovernor(
+        std::uint64_t budget,
+        beast::Journal journal,
+        ResidentMemory residentMemory = &CacheGovernor::residentMemory);
+
+    CacheGovernor(CacheGovernor const&) = delete;
+    CacheGovernor&
+    operator=(CacheGovernor const&) = delete;
+
+    /** Govern a cache.
+
+        The cache must outlive the governor.
+
+        @param name A label for diagnostics.
+        @param cache A TaggedCache, or a cache with the same interface.
+        @param entryBytes An estimate of the memory one entry holds.
+    */
+    template <class Cache>
+    void
+    add(std::string name, Cache& cache, std::size_t entryBytes)
+    {
+        Entry e;
+        e.name = std::move(name);
+        e.entryBytes = std::max<std::size_t>(entryBytes, 1);
+        e.size = [&cache]() -> std::size_t { return cache.size(); };
+        e.hitsAndMisses = [&cache]() { return cache.getHitsAndMisses(); };
+        e.setTarget = [&cache](int size, duration age) {
+            if (size > 0)
+                cache.setTargetSize(size);
+            cache.setTargetAge(age);
+        };
+        e.baseSize = e.targetSize = cache.getTargetSize();
+        e.baseAge = e.targetAge = cache.getTargetAge();
+        std::tie(e.hits, e.misses) = cache.getHitsAndMisses();
+
+        std::lock_guard lock(mutex_);
+        entries_.push_back(std::move(e));
+    }
+
+    /** Measure the resident memory and resize the caches.
+
+        Call once per sweep, before the caches are swept.
+    */
+    void
+    update();
+
+    /** Returns the target size and age last set for a cache. */
+    std::optional<std::pair<int, duration>>
+    target(std::string const& name) const;
+
+    /** Returns the resident memory of this process, where it can be
+        measured.
+    */
+    static std::optional<std::uint64_t>
+    residentMemory();
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::size_t entryBytes;
+        std::function<std::size_t()> size;
+        std::function<std::pair<std::uint64_t, std::uint64_t>()>
+            hitsAndMisses;
+        std::function<void(int, duration)> setTarget;
+
+        int baseSize;
+        duration baseAge;
+        int targetSize;
+        duration targetAge;
+
+        // The counters when last sampled
+        std::uint64_t hits;
+        std::uint64_t misses;
+    };
+
+    struct Sample
+    {
+        Entry* entry;
+        std::uint64_t bytes;
+        std::uint64_t hits;
+        std::uint64_t misses;
+    };
+
+    // Returns the bytes taken from the caches
+    std::uint64_t
+    shrink(std::vector<Sample>& samples, std::uint64_t excess);
+
+    void
+    grow(std::vector<Sample>& samples, std::uint64_t room);
+
+    void
+    retarget(Entry& e, double size, duration age);
+
+    std::uint64_t const budget_;
+    beast::Journal const j_;
+    ResidentMemory const residentMemory_;
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+
+    // The bytes taken from the caches since resident memory was last below
+    // the low water mark
+    std::uint64_t reclaimed_ = 0;
+};
+
+}  // namespace ripple
+
+#endif
@@ -27,21 +27,29 @@ class CollectorManagerImp : public CollectorManager
 public:
     beast::Journal m_journal;
     beast::insight::Collector::ptr m_collector;
+    std::shared_ptr<beast::insight::StatsDCollector> m_statsd;
     std::unique_ptr<beast::insight::Groups> m_groups;
 
     CollectorManagerImp(Section const& params, beast::Journal journal)
         : m_journal(journal)
     {
         std::string const& server = get(params, "server");
+        bool prometheus = server == "prometheus";
+        get_if_exists(params, "prometheus", prometheus);
 
-        if (server == "statsd")
+        if (server == "statsd" || prometheus)
         {
-            beast::IP::Endpoint const address(
-                beast::IP::Endpoint::from_string(get(params, "address")));
+            beast::IP::Endpoint address;
+            if (server == "statsd")
+                address =
+                    beast::IP::Endpoint::from_string(get(params, "address"));
             std::string const& prefix(get(params, "prefix"));
 
-            m_collector =
+            auto statsd =
                 beast::insight::StatsDCollector::New(address, prefix, journal);
+            if (prometheus)
+                m_statsd = statsd;
+            m_collector = std::move(statsd);
         }
         else
         {
@@ -64,6 +72,14 @@ public:
     {
         return m_groups->get(name);
     }
+
+    std::optional<std::string>
+    prometheus() override
+    {
+        if (!m_statsd)
+            return std::nullopt;
+        return m_statsd->prometheus();
+    }
 };
 
 //------------------------------------------------------------------------------
@@ -23,6 +23,9 @@
 #include <ripple/basics/BasicConfig.h>
 #include <ripple/beast/insight/Insight.h>
 
+#include <optional>
+#include <string>
+
 namespace ripple {
 
 /** Provides the beast::insight::Collector service. */
@@ -36,6 +39,12 @@ public:
 
     virtual beast::insight::Group::ptr const&
     group(std::string const& name) = 0;
+
+    /** Returns the metrics in the Prometheus text format, if they are
+        exported that way.
+    */
+    virtual std::optional<std::string>
+    prometheus() = 0;
 };
 
 std::unique_ptr<CollectorManager>
@@ -156,6 +156,7 @@ printHelp(const po::options_description& desc)
            "     ledger_cleaner\n"
            "     ledger_closed\n"
            "     ledger_current\n"
+           "     ledger_export <path> [<ledger>] [<partitions>]\n"
            "     ledger_request <ledger>\n"
            "     log_level [[<partition>] <severity>]\n"
            "     logrotate\n"
@@ -177,6 +178,7 @@ printHelp(const po::options_description& desc)
            "     stop\n"
            "     submit <tx_blob>|[<private_key> <tx_json>]\n"
            "     submit_multisigned <tx_json>\n"
+           "     trace [on|off]\n"
            "     tx <id>\n"
            "     validation_create [<seed>|<pass_phrase>|<key>]\n"
            "     validator_info\n"
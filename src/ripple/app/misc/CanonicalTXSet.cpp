@@ -19,6 +19,8 @@
 
 #include <ripple/app/misc/CanonicalTXSet.h>
 
+#include <algorithm>
+
 namespace ripple {
 
 bool
@@ -51,11 +53,70 @@ CanonicalTXSet::accountKey(AccountID const& account)
 void
 CanonicalTXSet::insert(std::shared_ptr<STTx const> const& txn)
 {
-    map_.insert(std::make_pair(
+    // Of several copies of a transaction, the one inserted first is kept
+    if (!ids_.insert(txn->getTransactionID()).second)
+        return;
+
+    items_.emplace_back(
         Key(accountKey(txn->getAccountID(sfAccount)),
             txn->getSeqProxy(),
             txn->getTransactionID()),
-        txn));
+        txn);
+}
+
+void
+CanonicalTXSet::order() const
+{
+    if (sorted_ == items_.size())
+        return;
+
+    auto const less = [](value_type const& lhs, value_type const& rhs) {
+        return lhs.first < rhs.first;
+    };
+
+    // Keys are unique, since insert drops copies of a transaction
+    auto const middle = items_.begin() + sorted_;
+    std::sort(middle, items_.end(), less);
+    std::inplace_merge(items_.begin(), middle, items_.end(), less);
+
+    // Iterators are invalidated already, so this is the time to drop
+    // the tombstones every pass over the set would otherwise walk.
+    if (dead_ != 0)
+        compact();
+    sorted_ = items_.size();
+}
+
+void
+CanonicalTXSet::compact() const
+{
+    items_.erase(
+        std::remove_if(
+            items_.begin(),
+            items_.end(),
+            [](value_type const& item) { return !item.second; }),
+        items_.end());
+    sorted_ = items_.size();
+    dead_ = 0;
+}
+
+CanonicalTXSet::const_iterator
+CanonicalTXSet::begin() const
+{
+    order();
+    return const_iterator(IsLive{}, items_.cbegin(), items_.cend());
+}
+
+CanonicalTXSet::const_iterator
+CanonicalTXSet::erase(const_iterator const& it)
+{
+    auto const base = it.base();
+    assert(base != items_.cend() && base->second);
+
+    ids_.erase(base->first.getTXID());
+    items_[std::distance(items_.cbegin(), base)].second.reset();
+    ++dead_;
+
+    return const_iterator(IsLive{}, std::next(base), items_.cend());
 }
 
 std::shared_ptr<STTx const>
@@ -74,13 +135,26 @@ CanonicalTXSet::popAcctTransaction(std::shared_ptr<STTx const> const& tx)
     std::shared_ptr<STTx const> result;
     uint256 const effectiveAccount{accountKey(tx->getAccountID(sfAccount))};
 
+    order();
+
     Key const after(effectiveAccount, tx->getSeqProxy(), beast::zero);
-    auto const itrNext{map_.lower_bound(after)};
-    if (itrNext != map_.end() &&
+    auto itrNext = std::lower_bound(
+        items_.begin(),
+        items_.end(),
+        after,
+        [](value_type const& item, Key const& key) { return item.first < key; });
+
+    // Skip the tombstones of transactions already erased
+    while (itrNext != items_.end() && !itrNext->second &&
+           itrNext->first.getAccount() == effectiveAccount)
+        ++itrNext;
+
+    if (itrNext != items_.end() &&
         itrNext->first.getAccount() == effectiveAccount)
     {
+        ids_.erase(itrNext->first.getTXID());
         result = std::move(itrNext->second);
-        map_.erase(itrNext);
+        ++dead_;
     }
 
     return result;
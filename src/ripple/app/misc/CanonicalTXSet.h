@@ -21,10 +21,15 @@
 #define RIPPLE_APP_MISC_CANONICALTXSET_H_INCLUDED
 
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/protocol/RippleLedgerHash.h>
 #include <ripple/protocol/STTx.h>
 #include <ripple/protocol/SeqProxy.h>
 
+#include <boost/iterator/filter_iterator.hpp>
+
+#include <vector>
+
 namespace ripple {
 
 /** Holds transactions which were deferred to the next pass of consensus.
@@ -33,6 +38,15 @@ namespace ripple {
 
     - Puts transactions from the same account in SeqProxy order
 
+    Transactions are kept in a flat vector. Insertions are appended and
+    put in order, in bulk, the next time the set is iterated. Erasing
+    leaves a tombstone in place, which is skipped by iteration and dropped
+    when the next insertions are put in order.
+
+    @note Iterators are invalidated by insert and reset. Erasing or popping
+          a transaction invalidates only iterators to it.
+
+    @note This class is not thread-safe, even for const members.
 */
 // VFALCO TODO rename to SortedTxSet
 class CanonicalTXSet : public CountedObject<CanonicalTXSet>
@@ -104,9 +118,25 @@ private:
     uint256
     accountKey(AccountID const& account);
 
+public:
+    using value_type = std::pair<Key, std::shared_ptr<STTx const>>;
+
+private:
+    using Items = std::vector<value_type>;
+
+    // Erased transactions leave a tombstone: an item with no transaction
+    struct IsLive
+    {
+        bool
+        operator()(value_type const& item) const
+        {
+            return item.second != nullptr;
+        }
+    };
+
 public:
     using const_iterator =
-        std::map<Key, std::shared_ptr<STTx const>>::const_iterator;
+        boost::filter_iterator<IsLive, Items::const_iterator>;
 
 public:
     explicit CanonicalTXSet(LedgerHash const& saltHash) : salt_(saltHash)
@@ -130,36 +160,34 @@ public:
     reset(LedgerHash const& salt)
     {
         salt_ = salt;
-        map_.clear();
+        items_.clear();
+        ids_.clear();
+        sorted_ = 0;
+        dead_ = 0;
     }
 
     const_iterator
-    erase(const_iterator const& it)
-    {
-        return map_.erase(it);
-    }
+    erase(const_iterator const& it);
 
     const_iterator
-    begin() const
-    {
-        return map_.begin();
-    }
+    begin() const;
 
     const_iterator
     end() const
     {
-        return map_.end();
+        return const_iterator(IsLive{}, items_.cend(), items_.cend());
     }
 
     size_t
     size() const
     {
-        return map_.size();
+        return ids_.size();
     }
+
     bool
     empty() const
     {
-        return map_.empty();
+        return ids_.empty();
     }
 
     uint256 const&
@@ -169,7 +197,26 @@ public:
     }
 
 private:
-    std::map<Key, std::shared_ptr<STTx const>> map_;
+    // Put the items inserted since the last call in order, and drop
+    // tombstones.
+    void
+    order() const;
+
+    // Drop tombstones
+    void
+    compact() const;
+
+    // Sorted items, followed by the items inserted since
+    mutable Items items_;
+
+    // The number of items in order at the front of items_
+    mutable std::size_t sorted_ = 0;
+
+    // The number of tombstones in items_
+    mutable std::size_t dead_ = 0;
+
+    // The IDs of the transactions in the set
+    hardened_hash_set<uint256> ids_;
 
     // Used to salt the accounts so people can't mine for low account numbers
     uint256 salt_;
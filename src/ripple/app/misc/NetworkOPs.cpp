@@ -22,6 +22,7 @@
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/LedgerReplayer.h>
 #include <ripple/app/ledger/LedgerToJson.h>
 #include <ripple/app/ledger/LocalTxs.h>
 #include <ripple/app/ledger/OpenLedger.h>
@@ -1708,8 +1709,20 @@ NetworkOPsImp::checkLastClosedLedger(
     auto consensus = m_ledgerMaster.getLedgerByHash(closedLedger);
 
     if (!consensus)
-        consensus = app_.getInboundLedgers().acquire(
-            closedLedger, 0, InboundLedger::Reason::CONSENSUS);
+    {
+        // A catch-up that reaches the ledger replays it, so it is only
+        // acquired if its sequence, known from the trusted validations, is
+        // past the catch-up
+        std::uint32_t seq = 0;
+        if (auto const preferred = validations.getPreferred(
+                RCLValidatedLedger{ourClosed, validations.adaptor().journal()});
+            preferred && preferred->second == closedLedger)
+            seq = preferred->first;
+
+        if (seq == 0 || !app_.getLedgerReplayer().catchingUp(seq))
+            consensus = app_.getInboundLedgers().acquire(
+                closedLedger, seq, InboundLedger::Reason::CONSENSUS);
+    }
 
     if (consensus &&
         (!m_ledgerMaster.canBeCurrent(consensus) ||
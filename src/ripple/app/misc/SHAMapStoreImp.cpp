@@ -28,6 +28,7 @@
 #include <ripple/core/Pg.h>
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/nodestore/impl/DatabaseRotatingImp.h>
+#include <ripple/nodestore/impl/DatabaseTieredImp.h>
 #include <ripple/shamap/SHAMapMissingNode.h>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -127,6 +128,14 @@ SHAMapStoreImp::SHAMapStoreImp(
                 "online_delete info from config");
         }
 
+        if (!config.section(ConfigSection::nodeDatabaseHot()).empty())
+        {
+            Throw<std::runtime_error>(
+                "online_delete is not supported with a [" +
+                ConfigSection::nodeDatabaseHot() +
+                "] tier. Remove one of them from config");
+        }
+
         // Configuration that affects the behavior of online delete
         get_if_exists(section, "delete_batch", deleteBatch_);
         std::uint32_t temp;
@@ -217,6 +226,32 @@ SHAMapStoreImp::makeNodeStore(int readThreads)
         dbRotating_ = dbr.get();
         db.reset(dynamic_cast<NodeStore::Database*>(dbr.release()));
     }
+    else if (auto const& hotcfg =
+                 app_.config().section(ConfigSection::nodeDatabaseHot());
+             !hotcfg.empty())
+    {
+        auto const burstSize = megabytes(
+            app_.config().getValueFor(SizedItem::burstSize, std::nullopt));
+
+        auto coldBackend = NodeStore::Manager::instance().make_Backend(
+            nscfg,
+            burstSize,
+            scheduler_,
+            app_.logs().journal(nodeStoreName_));
+        coldBackend->open();
+
+        // Create NodeStore with a hot tier in front of the configured
+        // backend
+        db = std::make_unique<NodeStore::DatabaseTieredImp>(
+            scheduler_,
+            readThreads,
+            std::move(coldBackend),
+            hotcfg,
+            burstSize,
+            nscfg,
+            app_.logs().journal(nodeStoreName_));
+        fdRequired_ += db->fdRequired();
+    }
     else
     {
         db = NodeStore::Manager::instance().make_Database(
@@ -372,7 +407,8 @@ SHAMapStoreImp::run()
                         &SHAMapStoreImp::copyNode,
                         this,
                         std::ref(nodeCount),
-                        std::placeholders::_1));
+                        std::placeholders::_1),
+                    SHAMap::defaultReadAhead);
             }
             catch (SHAMapMissingNode const& e)
             {
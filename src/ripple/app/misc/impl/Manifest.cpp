@@ -28,6 +28,7 @@
 #include <ripple/json/json_reader.h>
 #include <ripple/protocol/PublicKey.h>
 #include <ripple/protocol/Sign.h>
+#include <ripple/protocol/SignatureCache.h>
 
 #include <boost/algorithm/string/trim.hpp>
 
@@ -188,6 +189,14 @@ logMftAct(
 bool
 Manifest::verify() const
 {
+    // The serialized manifest holds both signatures, so its hash and the
+    // master key identify them.
+    auto& cache = SignatureCache::instance();
+    auto const key = SignatureCache::makeKey(
+        sha512Half(makeSlice(serialized)), masterKey.slice(), Slice{}, false);
+    if (cache.contains(key))
+        return true;
+
     STObject st(sfGeneric);
     SerialIter sit(serialized.data(), serialized.size());
     st.set(sit);
@@ -197,8 +206,11 @@ Manifest::verify() const
     if (!revoked() && !ripple::verify(st, HashPrefix::manifest, signingKey))
         return false;
 
-    return ripple::verify(
-        st, HashPrefix::manifest, masterKey, sfMasterSignature);
+    if (!ripple::verify(st, HashPrefix::manifest, masterKey, sfMasterSignature))
+        return false;
+
+    cache.insert(key);
+    return true;
 }
 
 uint256
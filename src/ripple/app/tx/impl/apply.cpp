@@ -22,6 +22,7 @@
 #include <ripple/app/tx/applySteps.h>
 #include <ripple/basics/Log.h>
 #include <ripple/protocol/Feature.h>
+#include <ripple/protocol/SignatureCache.h>
 
 namespace ripple {
 
@@ -54,11 +55,35 @@ checkValidity(
             ? STTx::RequireFullyCanonicalSig::yes
             : STTx::RequireFullyCanonicalSig::no;
 
-        auto const sigVerify = tx.checkSign(requireCanonicalSig, rules);
-        if (!sigVerify)
+        // The transaction ID covers every signature, so along with the
+        // signing key it identifies single and multi-signed transactions
+        // alike. Whether a multi-signed transaction is valid also depends
+        // on how many signers the rules allow. The cache outlives the
+        // HashRouter entry, which may expire while the transaction is
+        // still relayed or held for consensus.
+        auto const signingPubKey = tx.getSigningPubKey();
+        auto const hash = signingPubKey.empty()
+            ? sha512Half(
+                  id,
+                  static_cast<std::uint32_t>(STTx::maxMultiSigners(&rules)))
+            : id;
+
+        auto& cache = SignatureCache::instance();
+        auto const key = SignatureCache::makeKey(
+            hash,
+            makeSlice(signingPubKey),
+            Slice{},
+            requireCanonicalSig == STTx::RequireFullyCanonicalSig::yes);
+
+        if (!cache.contains(key))
         {
-            router.setFlags(id, SF_SIGBAD);
-            return {Validity::SigBad, sigVerify.error()};
+            auto const sigVerify = tx.checkSign(requireCanonicalSig, rules);
+            if (!sigVerify)
+            {
+                router.setFlags(id, SF_SIGBAD);
+                return {Validity::SigBad, sigVerify.error()};
+            }
+            cache.insert(key);
         }
         router.setFlags(id, SF_SIGGOOD);
     }
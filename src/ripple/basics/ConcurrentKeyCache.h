@@ -0,0 +1,304 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_CONCURRENTKEYCACHE_H_INCLUDED
+#define RIPPLE_BASICS_CONCURRENTKEYCACHE_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/beast/clock/abstract_clock.h>
+#include <ripple/beast/insight/Insight.h>
+#include <ripple/beast/utility/Journal.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace ripple {
+
+/** A cache of keys that many threads can use without locking.
+
+    This does the job of a KeyCache, but a lookup or an insert never takes
+    a lock. Keys live in a table of slots. A key may only live in one
+    set of eight slots, chosen by its hash, so a lookup reads at most eight
+    slots. Each slot holds a key, the time the key was last used and a
+    version that readers use to detect a key being replaced while they read
+    it.
+
+    When a key is inserted into a set with no free slot, the key in that set
+    that was used least recently is evicted. A sweep evicts keys that were
+    not used within the target age, and ages keys faster while the cache
+    holds more than its target size.
+
+    Two threads that insert the same key at the same time may both succeed.
+    The copies are harmless: lookups find either, and the unused one ages
+    out.
+
+    The table starts small, so that a cache that is barely used holds little
+    memory. Once it is half full and a key had to be evicted to make room,
+    it doubles, up to the room the target size calls for. A sweep shrinks it
+    when the target size was lowered, and lets it grow again when the target
+    was raised. Keys are copied into the new table; a key that another
+    thread inserts during the copy may be lost, which only costs a miss. The
+    old table is freed once no thread is still using it.
+
+    @note This class is thread-safe.
+*/
+class ConcurrentKeyCache
+{
+public:
+    using key_type = uint256;
+    using clock_type = beast::abstract_clock<std::chrono::steady_clock>;
+
+    /** The number of slots a key may live in. */
+    static constexpr std::size_t ways = 8;
+
+    /** The most keys the cache makes room for with no target size. */
+    static constexpr std::size_t defaultCapacity = 65536;
+
+    /** The most keys the cache makes room for when it is created. */
+    static constexpr std::size_t initialCapacity = 4096;
+
+    /** Construct the cache.
+
+        @param name A label for diagnostics and stats reporting.
+        @param size The target size, or 0 to expire keys by age alone.
+        @param expiration How long a key is kept unless used.
+        @param clock The clock to measure age with.
+        @param journal Where to report sweeps.
+        @param collector The collector to use for reporting stats.
+    */
+    ConcurrentKeyCache(
+        std::string const& name,
+        int size,
+        clock_type::duration expiration,
+        clock_type& clock,
+        beast::Journal journal,
+        beast::insight::Collector::ptr const& collector =
+            beast::insight::NullCollector::New());
+
+    ConcurrentKeyCache(ConcurrentKeyCache const&) = delete;
+    ConcurrentKeyCache&
+    operator=(ConcurrentKeyCache const&) = delete;
+
+    /** Return the clock associated with the cache. */
+    clock_type&
+    clock()
+    {
+        return clock_;
+    }
+
+    /** Returns the number of keys the cache has room for now. */
+    std::size_t
+    capacity() const;
+
+    /** Returns the number of keys in the cache. */
+    std::size_t
+    size() const;
+
+    int
+    getTargetSize() const;
+
+    void
+    setTargetSize(int size);
+
+    clock_type::duration
+    getTargetAge() const;
+
+    void
+    setTargetAge(clock_type::duration age);
+
+    /** Returns the number of lookups that found and missed their key. */
+    std::pair<std::uint64_t, std::uint64_t>
+    getHitsAndMisses() const;
+
+    /** Refresh the last access time on a key if present.
+        @return `true` If the key was found.
+    */
+    bool
+    touch_if_exists(key_type const& key);
+
+    /** Insert a key into the cache.
+        If the key already exists, its last access time is refreshed.
+        @return `true` If the key was inserted.
+    */
+    bool
+    insert(key_type const& key);
+
+    /** Evict the keys that were not used recently enough. */
+    void
+    sweep();
+
+    /** Evict every key. */
+    void
+    clear();
+
+private:
+    // The layout of a slot's state word:
+    //   bit 0      a writer is replacing the key
+    //   bit 1      the slot holds a key
+    //   bits 2-31  the version of the key, bumped whenever it changes
+    //   bits 32-63 the time the key was last used, in seconds
+    static constexpr std::uint64_t busy = 1;
+    static constexpr std::uint64_t occupied = 2;
+    static constexpr std::uint64_t versionMask = 0xFFFFFFFC;
+    static constexpr std::uint64_t versionOne = 4;
+    static constexpr int timeShift = 32;
+
+    struct Slot
+    {
+        std::atomic<std::uint64_t> state{0};
+        std::array<std::atomic<std::uint64_t>, 4> key{};
+    };
+
+    // Counters are spread over cache lines, so that threads looking up
+    // different keys do not contend on them.
+    struct alignas(64) Counters
+    {
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+    };
+
+    // What a table counts for each stripe of its sets
+    struct alignas(64) Usage
+    {
+        std::atomic<std::int64_t> size{0};
+    };
+
+    // The threads using a table, which must leave it before a resize frees
+    // it. They are counted in the cache rather than the table, so that a
+    // thread can count itself before it knows which table it will use. A
+    // resize moves new users to the other count of each pair, and waits
+    // for the count the users of the old table are on to drain.
+    struct alignas(64) Users
+    {
+        std::array<std::atomic<std::uint32_t>, 2> count{};
+    };
+
+    static constexpr std::size_t stripes = 16;
+
+    struct Table
+    {
+        explicit Table(std::size_t count)
+            : sets(count), slots(std::make_unique<Slot[]>(count * ways))
+        {
+        }
+
+        std::size_t const sets;
+        std::unique_ptr<Slot[]> const slots;
+        std::array<Usage, stripes> usage;
+    };
+
+    // Keeps the current table from being freed while a thread uses it
+    class Pin;
+
+    static std::uint32_t
+    lastUsed(std::uint64_t state)
+    {
+        return static_cast<std::uint32_t>(state >> timeShift);
+    }
+
+    static std::uint64_t
+    withLastUsed(std::uint64_t state, std::uint32_t when)
+    {
+        return (state & 0xFFFFFFFF) |
+            (static_cast<std::uint64_t>(when) << timeShift);
+    }
+
+    // The version a slot gets once its key is replaced or evicted
+    static std::uint64_t
+    nextVersion(std::uint64_t state)
+    {
+        return (state + versionOne) & versionMask;
+    }
+
+    // Seconds since the epoch of the clock
+    std::uint32_t
+    now() const;
+
+    // Read the key in a slot. Returns false if the slot is empty, or its
+    // key changed while it was read.
+    static bool
+    read(
+        Slot const& slot,
+        std::array<std::uint64_t, 4>& key,
+        std::uint64_t& state);
+
+    // If the slot holds the key, refresh it and return true
+    static bool
+    touch(
+        Slot& slot,
+        std::array<std::uint64_t, 4> const& key,
+        std::uint32_t when);
+
+    // Evict the key in the slot, if it has not been used since `before`
+    static bool
+    evict(Slot& slot, std::uint32_t before, Usage& usage);
+
+    static std::size_t
+    sizeOf(Table const& table);
+
+    // The number of sets the table should have for the target size and the
+    // keys it holds
+    static std::size_t
+    wantedSets(Table const& table, int targetSize);
+
+    // Resize the table, if it is full enough, without waiting for a thread
+    // that is already resizing or sweeping it
+    void
+    grow();
+
+    // Move the keys to a table with this many sets. Requires the mutex.
+    void
+    resize(std::size_t sets);
+
+    void
+    collect_metrics();
+
+    std::string const name_;
+    clock_type& clock_;
+    beast::Journal const journal_;
+    digest_hash const hash_;
+
+    std::array<Counters, stripes> counters_;
+
+    mutable std::mutex mutex_;
+    int targetSize_;
+    clock_type::duration targetAge_;
+
+    // The table, which only a thread holding the mutex replaces
+    std::unique_ptr<Table> owned_;
+    std::atomic<Table*> table_;
+
+    // Bumped by each resize, to pick the count of each pair new users go on
+    std::atomic<std::uint32_t> epoch_{0};
+    mutable std::array<Users, stripes> users_;
+
+    beast::insight::Hook hook_;
+    beast::insight::Gauge sizeGauge_;
+    beast::insight::Gauge hitRateGauge_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -20,8 +20,12 @@
 #ifndef RIPPLE_BASICS_DECAYINGSAMPLE_H_INCLUDED
 #define RIPPLE_BASICS_DECAYINGSAMPLE_H_INCLUDED
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 
 namespace ripple {
 
@@ -105,6 +109,129 @@ private:
 
 //------------------------------------------------------------------------------
 
+/** A DecayingSample which can be updated concurrently without a lock.
+
+    The time of the last update, in whole seconds since construction, and
+    the value are packed into one atomic word, so that adding a sample is a
+    single compare-and-swap. The value is aged the same way as in
+    DecayingSample. It is kept between zero and 2^32 - 1 exponential units.
+
+    @tparam The number of seconds in the decay window.
+*/
+template <int Window, typename Clock>
+class AtomicDecayingSample
+{
+public:
+    using value_type = typename Clock::duration::rep;
+    using time_point = typename Clock::time_point;
+
+    AtomicDecayingSample() = delete;
+
+    /**
+        @param now Start time of AtomicDecayingSample.
+    */
+    explicit AtomicDecayingSample(time_point now) : m_epoch(now), m_word(0)
+    {
+    }
+
+    AtomicDecayingSample(AtomicDecayingSample const&) = delete;
+    AtomicDecayingSample&
+    operator=(AtomicDecayingSample const&) = delete;
+
+    /** Add a new sample.
+        The value is first aged according to the specified time.
+    */
+    value_type
+    add(value_type value, time_point now)
+    {
+        auto const when = seconds(now);
+        auto word = m_word.load(std::memory_order_relaxed);
+        std::uint64_t next;
+        do
+        {
+            next = pack(word, when, decay(word, when) + value);
+        } while (!m_word.compare_exchange_weak(
+            word, next, std::memory_order_relaxed));
+
+        return static_cast<value_type>(next & valueMask) / Window;
+    }
+
+    /** Retrieve the current value in normalized units.
+        The samples are aged according to the specified time.
+    */
+    value_type
+    value(time_point now) const
+    {
+        return decay(m_word.load(std::memory_order_relaxed), seconds(now)) /
+            Window;
+    }
+
+    /** Discard all the samples. */
+    void
+    clear()
+    {
+        m_word.fetch_and(~valueMask, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::uint64_t valueMask =
+        std::numeric_limits<std::uint32_t>::max();
+
+    // Whole seconds from construction to the specified time.
+    std::uint32_t
+    seconds(time_point now) const
+    {
+        if (now <= m_epoch)
+            return 0;
+
+        return static_cast<std::uint32_t>(std::min<std::int64_t>(
+            std::chrono::duration_cast<std::chrono::seconds>(now - m_epoch)
+                .count(),
+            std::numeric_limits<std::uint32_t>::max()));
+    }
+
+    // The value of a packed word, aged to the specified time.
+    static value_type
+    decay(std::uint64_t word, std::uint32_t when)
+    {
+        auto value = static_cast<value_type>(word & valueMask);
+        auto const last = static_cast<std::uint32_t>(word >> 32);
+
+        // Another thread may have aged the value to a later time
+        if (value == value_type() || when <= last)
+            return value;
+
+        std::size_t elapsed = when - last;
+        if (elapsed > 4 * Window)
+            return value_type();
+
+        while (elapsed--)
+            value -= (value + Window - 1) / Window;
+
+        return value;
+    }
+
+    static std::uint64_t
+    pack(std::uint64_t word, std::uint32_t when, value_type value)
+    {
+        auto const last = static_cast<std::uint32_t>(word >> 32);
+        auto const clamped = std::clamp<value_type>(
+            value, value_type(), static_cast<value_type>(valueMask));
+
+        return (std::uint64_t{std::max(when, last)} << 32) |
+            static_cast<std::uint64_t>(clamped);
+    }
+
+    // The time that seconds are counted from
+    time_point const m_epoch;
+
+    // Last time the aging function was applied, and the value in
+    // exponential units
+    std::atomic<std::uint64_t> m_word;
+};
+
+//------------------------------------------------------------------------------
+
 /** Sampling function using exponential decay to provide a continuous value.
     @tparam HalfLife The half life of a sample, in seconds.
 */
@@ -25,7 +25,7 @@
 
 namespace ripple {
 
-using KeyCache = TaggedCache<uint256, int, true>;
+using KeyCache = TaggedCache<uint256, int, true, digest_hash>;
 
 }  // namespace ripple
 
@@ -64,6 +64,8 @@ public:
         boost::filesystem::path perfLog;
         // log_interval is in milliseconds to support faster testing.
         milliseconds logInterval{seconds(1)};
+        // Whether to record spans with the Tracer from startup.
+        bool trace = false;
     };
 
     virtual ~PerfLog() = default;
@@ -30,6 +30,7 @@
 #include <mutex>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace ripple {
@@ -82,6 +83,8 @@ public:
         , m_cache_count(0)
         , m_hits(0)
         , m_misses(0)
+        , m_touch_hits(0)
+        , m_touch_misses(0)
     {
     }
 
@@ -121,6 +124,13 @@ public:
         JLOG(m_journal.debug()) << m_name << " target size set to " << s;
     }
 
+    int
+    getTargetSize() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_target_size;
+    }
+
     clock_type::duration
     getTargetAge() const
     {
@@ -159,6 +169,17 @@ public:
         return m_hits * (100.0f / std::max(1.0f, total));
     }
 
+    /** Returns the number of hits and misses since the last reset.
+
+        Unlike the hit rate, this counts lookups made with touch_if_exists.
+    */
+    std::pair<std::uint64_t, std::uint64_t>
+    getHitsAndMisses() const
+    {
+        std::lock_guard lock(m_mutex);
+        return {m_hits + m_touch_hits, m_misses + m_touch_misses};
+    }
+
     void
     clear()
     {
@@ -175,6 +196,8 @@ public:
         m_cache_count = 0;
         m_hits = 0;
         m_misses = 0;
+        m_touch_hits = 0;
+        m_touch_misses = 0;
     }
 
     /** Refresh the last access time on a key if present.
@@ -189,10 +212,12 @@ public:
         if (iter == m_cache.end())
         {
             ++m_stats.misses;
+            ++m_touch_misses;
             return false;
         }
         iter->second.touch(m_clock.now());
         ++m_stats.hits;
+        ++m_touch_hits;
         return true;
     }
 
@@ -791,6 +816,10 @@ private:
     cache_type m_cache;  // Hold strong reference to recent objects
     std::uint64_t m_hits;
     std::uint64_t m_misses;
+
+    // Lookups made with touch_if_exists, which the hit rate leaves out
+    std::uint64_t m_touch_hits;
+    std::uint64_t m_touch_misses;
 };
 
 }  // namespace ripple
@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_TRACER_H_INCLUDED
+#define RIPPLE_BASICS_TRACER_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace perf {
+
+/** Records how long sections of code take, on every thread.
+
+    Each thread records the spans it completes in a ring buffer of its
+    own, so recording never takes a lock and never waits on another
+    thread. Only the most recent spans of each thread are kept. Times
+    are taken from the processor's time stamp counter where there is
+    one, which is much cheaper to read than a clock.
+
+    Tracing is off unless enabled, and then costs only the check of
+    whether it is enabled.
+
+    The spans can be exported in the Chrome trace event format, which
+    chrome://tracing and Perfetto can display.
+
+    @note This class is thread-safe.
+*/
+class Tracer
+{
+public:
+    using tick_type = std::uint64_t;
+
+    /** The number of spans kept for each thread. */
+    static constexpr std::size_t bufferSize = 16384;
+
+    Tracer(Tracer const&) = delete;
+    Tracer&
+    operator=(Tracer const&) = delete;
+
+    /** The tracer shared by the whole process. */
+    static Tracer&
+    instance();
+
+    /** Returns the current time in ticks. */
+    static tick_type
+    now() noexcept;
+
+    bool
+    enabled() const noexcept
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void
+    enable(bool enabled);
+
+    /** Record a span on the calling thread.
+
+        @param name What the span measures. This must be a string that
+                    lives as long as the process, such as a literal.
+        @param start The time the span started, from now().
+        @param end The time the span ended, from now().
+    */
+    void
+    record(char const* name, tick_type start, tick_type end) noexcept;
+
+    /** Returns the spans recorded in the Chrome trace event format. */
+    Json::Value
+    getJson() const;
+
+    /** Forget every span recorded so far. */
+    void
+    clear();
+
+private:
+    Tracer();
+
+    struct Event
+    {
+        std::atomic<char const*> name{nullptr};
+        std::atomic<tick_type> start{0};
+        std::atomic<tick_type> end{0};
+    };
+
+    struct Buffer
+    {
+        std::uint32_t tid;
+        std::string threadName;
+
+        // Whether a running thread records into this buffer. A buffer
+        // left by a thread that exited is given to the next new thread.
+        bool inUse = true;
+
+        // The number of spans ever recorded. Only the owning thread
+        // writes it.
+        std::atomic<std::uint64_t> head{0};
+
+        // The value of head when the spans were last cleared
+        std::uint64_t cleared = 0;
+        std::vector<Event> events{bufferSize};
+    };
+
+    class Owner;
+
+    Buffer*
+    buffer();
+
+    std::atomic<bool> enabled_{false};
+
+    // Used to convert ticks to microseconds
+    tick_type const startTicks_;
+    std::chrono::steady_clock::time_point const startTime_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+/** Records the time from construction to destruction as a span.
+
+    @param name What the span measures. This must be a string that lives
+                as long as the process, such as a literal.
+*/
+class Span
+{
+public:
+    explicit Span(char const* name) noexcept
+        : name_(Tracer::instance().enabled() ? name : nullptr)
+        , start_(name_ ? Tracer::now() : 0)
+    {
+    }
+
+    ~Span()
+    {
+        if (name_)
+            Tracer::instance().record(name_, start_, Tracer::now());
+    }
+
+    Span(Span const&) = delete;
+    Span&
+    operator=(Span const&) = delete;
+
+private:
+    char const* const name_;
+    Tracer::tick_type const start_;
+};
+
+}  // namespace perf
+}  // namespace ripple
+
+#endif
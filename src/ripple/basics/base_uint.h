@@ -35,14 +35,74 @@
 #include <boost/functional/hash.hpp>
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cstring>
 #include <functional>
 #include <type_traits>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace ripple {
 
 namespace detail {
 
+/** Compare two buffers of the same size as std::memcmp would.
+
+    Whole blocks are compared at once and only the first differing byte is
+    looked at, which for a 256 bit value is a single AVX2 or two SSE2
+    comparisons.
+*/
+inline int
+compareBytes(
+    std::uint8_t const* a,
+    std::uint8_t const* b,
+    std::size_t size) noexcept
+{
+    std::size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 32 <= size; i += 32)
+    {
+        auto const equal =
+            static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i)),
+                _mm256_loadu_si256(
+                    reinterpret_cast<__m256i const*>(b + i)))));
+        if (equal != 0xFFFFFFFFu)
+        {
+            auto const j = i + std::countr_one(equal);
+            return a[j] < b[j] ? -1 : 1;
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    for (; i + 16 <= size; i += 16)
+    {
+        auto const equal =
+            static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i)),
+                _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i)))));
+        if (equal != 0xFFFFu)
+        {
+            auto const j = i + std::countr_one(equal);
+            return a[j] < b[j] ? -1 : 1;
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
 template <class Container, class = std::void_t<>>
 struct is_contiguous_container : std::false_type
 {
@@ -230,6 +290,16 @@ private:
         if (sv.size() != size() * 2)
             return Unexpected(ParseResult::badLength);
 
+        if (!std::is_constant_evaluated())
+        {
+            if (!detail::hexDecode(
+                    reinterpret_cast<std::uint8_t*>(ret.data()),
+                    sv.data(),
+                    bytes))
+                return Unexpected(ParseResult::badChar);
+            return ret;
+        }
+
         std::size_t i = 0u;
         auto in = sv.begin();
         while (in != sv.end())
@@ -561,6 +631,9 @@ operator<=>(base_uint<Bits, Tag> const& lhs, base_uint<Bits, Tag> const& rhs)
     // FIXME: use std::lexicographical_compare_three_way once support is
     //        added to MacOS.
 
+    if (!std::is_constant_evaluated())
+        return detail::compareBytes(lhs.data(), rhs.data(), lhs.size()) <=> 0;
+
     auto const ret = std::mismatch(lhs.cbegin(), lhs.cend(), rhs.cbegin());
 
     // a == b
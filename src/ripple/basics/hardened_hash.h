@@ -24,6 +24,7 @@
 #include <ripple/beast/hash/xxhasher.h>
 
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <mutex>
 #include <random>
@@ -115,6 +116,49 @@ public:
     }
 };
 
+/** A fast seeded hash for keys that are already cryptographic digests.
+
+    Ledger, transaction and tree node IDs are uniformly distributed, so
+    hashing every byte of them again is wasted work. This mixes the first
+    and last eight bytes of the key with a seed chosen for each instance,
+    so that which keys share a bucket cannot be predicted.
+
+    Only use this for keys nobody can choose freely, such as the output of
+    SHA-512 Half.
+*/
+class digest_hash
+{
+private:
+    std::uint64_t m_seed;
+
+public:
+    using result_type = std::size_t;
+
+    digest_hash() : m_seed(detail::make_seed_pair<>().first)
+    {
+    }
+
+    template <class T>
+    result_type
+    operator()(T const& t) const noexcept
+    {
+        static_assert(sizeof(T) >= sizeof(std::uint64_t));
+        std::uint64_t first;
+        std::uint64_t last;
+        std::memcpy(&first, t.data(), sizeof(first));
+        std::memcpy(&last, t.data() + sizeof(T) - sizeof(last), sizeof(last));
+
+        // The finalizer of MurmurHash3
+        std::uint64_t x = first ^ (last * 0x9e3779b97f4a7c15ULL) ^ m_seed;
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return static_cast<result_type>(x);
+    }
+};
+
 }  // namespace ripple
 
 #endif
@@ -0,0 +1,520 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/ConcurrentKeyCache.h>
+#include <ripple/basics/Log.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace ripple {
+
+namespace {
+
+std::size_t
+setsFor(std::size_t keys)
+{
+    std::size_t sets = 1;
+    while (sets * ConcurrentKeyCache::ways < keys)
+        sets <<= 1;
+    return sets;
+}
+
+// The most sets a table may have for a target size
+std::size_t
+mostSets(int size)
+{
+    return setsFor(
+        size > 0 ? static_cast<std::size_t>(size)
+                 : ConcurrentKeyCache::defaultCapacity);
+}
+
+using Words = std::array<std::uint64_t, 4>;
+
+Words
+toWords(uint256 const& key)
+{
+    static_assert(sizeof(Words) == uint256::size());
+    Words words;
+    std::memcpy(words.data(), key.data(), sizeof(words));
+    return words;
+}
+
+uint256
+fromWords(Words const& words)
+{
+    uint256 key;
+    std::memcpy(key.data(), words.data(), sizeof(words));
+    return key;
+}
+
+}  // namespace
+
+class ConcurrentKeyCache::Pin
+{
+public:
+    Pin(ConcurrentKeyCache const& cache, std::size_t stripe)
+    {
+        // A resize publishes the new table before it moves users to the
+        // other count, and waits for the count it moved them from. So a
+        // user that still sees the epoch it counted itself on is either
+        // waited for, or sees the new table.
+        for (;;)
+        {
+            auto const epoch = cache.epoch_.load();
+            users_ = &cache.users_[stripe].count[epoch & 1];
+            users_->fetch_add(1);
+            if (cache.epoch_.load() == epoch)
+                break;
+            users_->fetch_sub(1, std::memory_order_release);
+        }
+        table_ = cache.table_.load();
+    }
+
+    Pin(Pin const&) = delete;
+    Pin&
+    operator=(Pin const&) = delete;
+
+    ~Pin()
+    {
+        users_->fetch_sub(1, std::memory_order_release);
+    }
+
+    Table&
+    operator*() const
+    {
+        return *table_;
+    }
+
+    Table*
+    operator->() const
+    {
+        return table_;
+    }
+
+private:
+    Table* table_;
+    std::atomic<std::uint32_t>* users_;
+};
+
+ConcurrentKeyCache::ConcurrentKeyCache(
+    std::string const& name,
+    int size,
+    clock_type::duration expiration,
+    clock_type& clock,
+    beast::Journal journal,
+    beast::insight::Collector::ptr const& collector)
+    : name_(name)
+    , clock_(clock)
+    , journal_(journal)
+    , targetSize_(size)
+    , targetAge_(expiration)
+    , owned_(std::make_unique<Table>(
+          std::min(mostSets(size), setsFor(initialCapacity))))
+    , table_(owned_.get())
+    , hook_(collector->make_hook(
+          std::bind(&ConcurrentKeyCache::collect_metrics, this)))
+    , sizeGauge_(collector->make_gauge(name, "size"))
+    , hitRateGauge_(collector->make_gauge(name, "hit_rate"))
+{
+}
+
+std::size_t
+ConcurrentKeyCache::capacity() const
+{
+    Pin const table(*this, 0);
+    return table->sets * ways;
+}
+
+std::size_t
+ConcurrentKeyCache::size() const
+{
+    Pin const table(*this, 0);
+    return sizeOf(*table);
+}
+
+std::size_t
+ConcurrentKeyCache::sizeOf(Table const& table)
+{
+    std::int64_t result = 0;
+    for (auto const& u : table.usage)
+        result += u.size.load(std::memory_order_relaxed);
+    return result > 0 ? static_cast<std::size_t>(result) : 0;
+}
+
+int
+ConcurrentKeyCache::getTargetSize() const
+{
+    std::lock_guard lock(mutex_);
+    return targetSize_;
+}
+
+void
+ConcurrentKeyCache::setTargetSize(int size)
+{
+    std::lock_guard lock(mutex_);
+    targetSize_ = size;
+    JLOG(journal_.debug()) << name_ << " target size set to " << size;
+}
+
+ConcurrentKeyCache::clock_type::duration
+ConcurrentKeyCache::getTargetAge() const
+{
+    std::lock_guard lock(mutex_);
+    return targetAge_;
+}
+
+void
+ConcurrentKeyCache::setTargetAge(clock_type::duration age)
+{
+    std::lock_guard lock(mutex_);
+    targetAge_ = age;
+    JLOG(journal_.debug()) << name_ << " target age set to " << age.count();
+}
+
+std::pair<std::uint64_t, std::uint64_t>
+ConcurrentKeyCache::getHitsAndMisses() const
+{
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    for (auto const& c : counters_)
+    {
+        hits += c.hits.load(std::memory_order_relaxed);
+        misses += c.misses.load(std::memory_order_relaxed);
+    }
+    return {hits, misses};
+}
+
+std::uint32_t
+ConcurrentKeyCache::now() const
+{
+    using namespace std::chrono;
+    return static_cast<std::uint32_t>(
+        duration_cast<seconds>(clock_.now().time_since_epoch()).count());
+}
+
+bool
+ConcurrentKeyCache::read(Slot const& slot, Words& key, std::uint64_t& state)
+{
+    constexpr std::uint64_t identity = busy | occupied | versionMask;
+
+    auto const before = slot.state.load(std::memory_order_acquire);
+    if ((before & (busy | occupied)) != occupied)
+        return false;
+
+    for (std::size_t i = 0; i < key.size(); ++i)
+        key[i] = slot.key[i].load(std::memory_order_relaxed);
+
+    // If the version changed while the key was read, the key may be torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    state = slot.state.load(std::memory_order_relaxed);
+    return (state & identity) == (before & identity);
+}
+
+bool
+ConcurrentKeyCache::touch(Slot& slot, Words const& key, std::uint32_t when)
+{
+    constexpr std::uint64_t identity = busy | occupied | versionMask;
+
+    Words words;
+    std::uint64_t state;
+    if (!read(slot, words, state) || words != key)
+        return false;
+
+    // Only write when the time moves on, so that threads using the same
+    // key do not take the cache line from each other on every lookup.
+    auto after = state;
+    while (lastUsed(after) < when &&
+           !slot.state.compare_exchange_weak(
+               after,
+               withLastUsed(after, when),
+               std::memory_order_relaxed))
+    {
+        if ((after & identity) != (state & identity))
+            break;
+    }
+    return true;
+}
+
+bool
+ConcurrentKeyCache::evict(Slot& slot, std::uint32_t before, Usage& usage)
+{
+    auto state = slot.state.load(std::memory_order_relaxed);
+    while ((state & (busy | occupied)) == occupied && lastUsed(state) <= before)
+    {
+        // Readers see the new version and treat the slot as empty
+        if (slot.state.compare_exchange_weak(
+                state, nextVersion(state), std::memory_order_relaxed))
+        {
+            usage.size.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+ConcurrentKeyCache::touch_if_exists(key_type const& key)
+{
+    auto const hash = hash_(key);
+    auto const words = toWords(key);
+    auto& counters = counters_[hash % stripes];
+    auto const when = now();
+
+    Pin const table(*this, hash % stripes);
+    Slot* const first = &table->slots[(hash & (table->sets - 1)) * ways];
+    for (std::size_t i = 0; i < ways; ++i)
+    {
+        if (touch(first[i], words, when))
+        {
+            counters.hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    counters.misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool
+ConcurrentKeyCache::insert(key_type const& key)
+{
+    auto const hash = hash_(key);
+    auto const words = toWords(key);
+    auto const when = now();
+
+    // A free slot is the best victim, then the one used least recently
+    auto const rank = [](std::uint64_t state) -> std::uint64_t {
+        return (state & occupied) ? 1 + std::uint64_t{lastUsed(state)} : 0;
+    };
+
+    bool evicted = false;
+    {
+        Pin const table(*this, hash % stripes);
+        auto const set = hash & (table->sets - 1);
+        Slot* const first = &table->slots[set * ways];
+        for (;;)
+        {
+            Slot* victim = nullptr;
+            std::uint64_t victimState = 0;
+            for (std::size_t i = 0; i < ways; ++i)
+            {
+                if (touch(first[i], words, when))
+                    return false;
+
+                auto const state =
+                    first[i].state.load(std::memory_order_relaxed);
+                if ((state & busy) == 0 &&
+                    (!victim || rank(state) < rank(victimState)))
+                {
+                    victim = &first[i];
+                    victimState = state;
+                }
+            }
+
+            // Every slot is being written, or another thread took the victim
+            // first: look again.
+            if (!victim ||
+                !victim->state.compare_exchange_strong(
+                    victimState,
+                    victimState | busy,
+                    std::memory_order_acquire))
+                continue;
+
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i < words.size(); ++i)
+                victim->key[i].store(words[i], std::memory_order_relaxed);
+            victim->state.store(
+                withLastUsed(nextVersion(victimState) | occupied, when),
+                std::memory_order_release);
+
+            evicted = (victimState & occupied) != 0;
+            if (!evicted)
+            {
+                table->usage[set % stripes].size.fetch_add(
+                    1, std::memory_order_relaxed);
+            }
+            break;
+        }
+    }
+
+    // The set was full: the table may need to grow
+    if (evicted)
+        grow();
+    return true;
+}
+
+std::size_t
+ConcurrentKeyCache::wantedSets(Table const& table, int targetSize)
+{
+    auto const most = mostSets(targetSize);
+    if (table.sets > most)
+        return most;
+    if (table.sets < most && sizeOf(table) >= table.sets * ways / 2)
+        return table.sets * 2;
+    return table.sets;
+}
+
+void
+ConcurrentKeyCache::grow()
+{
+    std::unique_lock lock(mutex_, std::try_to_lock);
+    if (!lock)
+        return;
+
+    auto const sets = wantedSets(*owned_, targetSize_);
+    if (sets > owned_->sets)
+        resize(sets);
+}
+
+void
+ConcurrentKeyCache::resize(std::size_t sets)
+{
+    Table& from = *owned_;
+    auto to = std::make_unique<Table>(sets);
+
+    // No other thread uses the new table yet, so keys are placed without
+    // marking slots busy. Where a set overflows, the most recent keys stay.
+    for (std::size_t i = 0; i < from.sets * ways; ++i)
+    {
+        Words words;
+        std::uint64_t state;
+        if (!read(from.slots[i], words, state))
+            continue;
+
+        auto const set = hash_(fromWords(words)) & (sets - 1);
+        Slot* const first = &to->slots[set * ways];
+        Slot* victim = nullptr;
+        for (std::size_t j = 0; j < ways; ++j)
+        {
+            auto const s = first[j].state.load(std::memory_order_relaxed);
+            if ((s & occupied) == 0)
+            {
+                victim = &first[j];
+                break;
+            }
+            if (!victim ||
+                lastUsed(s) <
+                    lastUsed(victim->state.load(std::memory_order_relaxed)))
+                victim = &first[j];
+        }
+
+        auto const victimState = victim->state.load(std::memory_order_relaxed);
+        if (victimState & occupied)
+        {
+            if (lastUsed(victimState) >= lastUsed(state))
+                continue;
+        }
+        else
+        {
+            to->usage[set % stripes].size.fetch_add(
+                1, std::memory_order_relaxed);
+        }
+
+        for (std::size_t j = 0; j < words.size(); ++j)
+            victim->key[j].store(words[j], std::memory_order_relaxed);
+        victim->state.store(
+            withLastUsed(versionOne | occupied, lastUsed(state)),
+            std::memory_order_relaxed);
+    }
+
+    table_.store(to.get());
+
+    // Wait for the threads still using the old table before freeing it
+    auto const epoch = epoch_.fetch_add(1);
+    for (auto const& users : users_)
+    {
+        while (users.count[epoch & 1].load() != 0)
+            std::this_thread::yield();
+    }
+
+    JLOG(journal_.debug()) << name_ << " resized from " << from.sets * ways
+                           << " to " << sets * ways << " slots, keeping "
+                           << sizeOf(*to) << " keys";
+    owned_ = std::move(to);
+}
+
+void
+ConcurrentKeyCache::sweep()
+{
+    std::lock_guard lock(mutex_);
+
+    // Follow a target size that changed since the last sweep
+    if (auto const sets = wantedSets(*owned_, targetSize_);
+        sets != owned_->sets)
+        resize(sets);
+
+    Table& table = *owned_;
+    auto targetAge = targetAge_;
+
+    // Age keys faster while the cache holds more than its target size
+    auto const count = sizeOf(table);
+    if (targetSize_ > 0 && count > static_cast<std::size_t>(targetSize_))
+        targetAge = targetAge * targetSize_ / count;
+
+    auto const age = static_cast<std::uint32_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(targetAge).count());
+    auto const when = now();
+    if (when < age)
+        return;
+
+    std::size_t evicted = 0;
+    for (std::size_t set = 0; set < table.sets; ++set)
+    {
+        auto& usage = table.usage[set % stripes];
+        for (std::size_t i = 0; i < ways; ++i)
+            evicted += evict(table.slots[set * ways + i], when - age, usage);
+    }
+
+    JLOG(journal_.debug()) << name_ << " swept " << evicted << " of " << count
+                           << " keys";
+}
+
+void
+ConcurrentKeyCache::clear()
+{
+    std::lock_guard lock(mutex_);
+
+    Table& table = *owned_;
+    for (std::size_t set = 0; set < table.sets; ++set)
+    {
+        auto& usage = table.usage[set % stripes];
+        for (std::size_t i = 0; i < ways; ++i)
+        {
+            evict(
+                table.slots[set * ways + i],
+                std::numeric_limits<std::uint32_t>::max(),
+                usage);
+        }
+    }
+}
+
+void
+ConcurrentKeyCache::collect_metrics()
+{
+    sizeGauge_.set(size());
+
+    auto const [hits, misses] = getHitsAndMisses();
+    auto const total = hits + misses;
+    hitRateGauge_.set(total == 0 ? 0 : (hits * 100) / total);
+}
+
+}  // namespace ripple
@@ -23,8 +23,144 @@
 #include <boost/algorithm/hex.hpp>
 #include <boost/endian/conversion.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace ripple {
 
+namespace detail {
+
+/** Write the upper case hex digits of a buffer.
+
+    @param out Where to write `2 * size` characters.
+    @param in The bytes to convert.
+    @param size The number of bytes to convert.
+*/
+inline void
+hexEncode(char* out, std::uint8_t const* in, std::size_t size) noexcept
+{
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    // Split 16 bytes into 32 nibbles, then turn every nibble into a digit
+    // by adding '0', and the distance from '9' to 'A' for those above 9.
+    __m128i const mask = _mm_set1_epi8(0x0F);
+    __m128i const nine = _mm_set1_epi8(9);
+    __m128i const zero = _mm_set1_epi8('0');
+    __m128i const letter = _mm_set1_epi8('A' - '0' - 10);
+    auto const toDigits = [&](__m128i nibbles) {
+        __m128i const letters =
+            _mm_and_si128(_mm_cmpgt_epi8(nibbles, nine), letter);
+        return _mm_add_epi8(_mm_add_epi8(nibbles, zero), letters);
+    };
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i const v =
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+        __m128i const hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        __m128i const lo = _mm_and_si128(v, mask);
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + 2 * i),
+            toDigits(_mm_unpacklo_epi8(hi, lo)));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + 2 * i + 16),
+            toDigits(_mm_unpackhi_epi8(hi, lo)));
+    }
+#endif
+
+    static constexpr char digits[] = "0123456789ABCDEF";
+    for (; i < size; ++i)
+    {
+        out[2 * i] = digits[in[i] >> 4];
+        out[2 * i + 1] = digits[in[i] & 0x0F];
+    }
+}
+
+/** Read a buffer from hex digits of either case.
+
+    @param out Where to write `size` bytes.
+    @param in The `2 * size` characters to convert.
+    @param size The number of bytes to write.
+    @return `false` if any character is not a hex digit, in which case
+            `out` holds an unspecified value.
+*/
+inline bool
+hexDecode(std::uint8_t* out, char const* in, std::size_t size) noexcept
+{
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    // Convert 16 characters to nibbles, and mark which were hex digits.
+    // Signed comparisons reject characters above 0x7F along with the rest.
+    auto const nibbles = [](__m128i c, __m128i& valid) {
+        __m128i const isDigit = _mm_and_si128(
+            _mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+            _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+        __m128i const lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+        __m128i const isLetter = _mm_and_si128(
+            _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+            _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+        valid = _mm_or_si128(isDigit, isLetter);
+        return _mm_or_si128(
+            _mm_and_si128(isDigit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+            _mm_and_si128(
+                isLetter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+    };
+
+    // Each pair of nibbles is a 16 bit lane with the high nibble first
+    auto const combine = [](__m128i pairs) {
+        __m128i const hi =
+            _mm_slli_epi16(_mm_and_si128(pairs, _mm_set1_epi16(0x00FF)), 4);
+        return _mm_or_si128(hi, _mm_srli_epi16(pairs, 8));
+    };
+
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i validA, validB;
+        __m128i const a = nibbles(
+            _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + 2 * i)),
+            validA);
+        __m128i const b = nibbles(
+            _mm_loadu_si128(
+                reinterpret_cast<__m128i const*>(in + 2 * i + 16)),
+            validB);
+        if (_mm_movemask_epi8(_mm_and_si128(validA, validB)) != 0xFFFF)
+            return false;
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + i),
+            _mm_packus_epi16(combine(a), combine(b)));
+    }
+#endif
+
+    auto const nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    };
+    for (; i < size; ++i)
+    {
+        int const hi = nibble(in[2 * i]);
+        int const lo = nibble(in[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        out[i] = static_cast<std::uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+}  // namespace detail
+
 template <class FwdIt>
 std::string
 strHex(FwdIt begin, FwdIt end)
@@ -35,8 +171,22 @@ strHex(FwdIt begin, FwdIt end)
             std::forward_iterator_tag>::value,
         "FwdIt must be a forward iterator");
     std::string result;
-    result.reserve(2 * std::distance(begin, end));
-    boost::algorithm::hex(begin, end, std::back_inserter(result));
+    if constexpr (
+        std::contiguous_iterator<FwdIt> &&
+        sizeof(typename std::iterator_traits<FwdIt>::value_type) == 1)
+    {
+        auto const size = static_cast<std::size_t>(end - begin);
+        result.resize(2 * size);
+        detail::hexEncode(
+            result.data(),
+            reinterpret_cast<std::uint8_t const*>(std::to_address(begin)),
+            size);
+    }
+    else
+    {
+        result.reserve(2 * std::distance(begin, end));
+        boost::algorithm::hex(begin, end, std::back_inserter(result));
+    }
     return result;
 }
 
@@ -25,10 +25,17 @@
 #include <ripple/beast/net/IPEndpoint.h>
 #include <ripple/beast/utility/Journal.h>
 
+#include <string>
+
 namespace beast {
 namespace insight {
 
 /** A Collector that reports metrics to a StatsD server.
+
+    Counters, meters and events are added up where they change, and the
+    totals are sent once a second, many metrics to each UDP packet.
+    Events are counted in fixed buckets by duration.
+
     Reference:
         https://github.com/b/statsd_spec
 */
@@ -38,7 +45,9 @@ public:
     explicit StatsDCollector() = default;
 
     /** Create a StatsD collector.
-        @param address The IP address and port of the StatsD server.
+        @param address The IP address and port of the StatsD server. If
+                       the port is zero, nothing is sent and the metrics
+                       are only available from prometheus().
         @param prefix A string pre-pended before each metric name.
         @param journal Destination for logging output.
     */
@@ -46,6 +55,17 @@ public:
     New(IP::Endpoint const& address,
         std::string const& prefix,
         Journal journal);
+
+    /** Returns the metrics in the Prometheus text format.
+
+        Counters and meters are totals since the collector was created,
+        and events are histograms. The values are those last sent.
+
+        Reference:
+            https://prometheus.io/docs/instrumenting/exposition_formats/
+    */
+    virtual std::string
+    prometheus() const = 0;
 };
 
 }  // namespace insight
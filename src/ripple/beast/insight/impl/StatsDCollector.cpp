@@ -26,15 +26,20 @@
 #include <ripple/beast/insight/StatsDCollector.h>
 #include <ripple/beast/net/IPAddressConversion.h>
 #include <boost/asio/ip/tcp.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <charconv>
 #include <climits>
-#include <deque>
+#include <cstdio>
 #include <functional>
+#include <limits>
+#include <map>
 #include <mutex>
 #include <optional>
-#include <set>
-#include <sstream>
 #include <thread>
+#include <vector>
 
 #ifndef BEAST_STATSDCOLLECTOR_TRACING_ENABLED
 #define BEAST_STATSDCOLLECTOR_TRACING_ENABLED 0
@@ -49,6 +54,71 @@ class StatsDCollectorImp;
 
 //------------------------------------------------------------------------------
 
+// Metrics that change often are added up where they change, and only the
+// totals are sent. Each thread adds to one of several slots, each on its
+// own cache line, so threads updating the same metric do not contend and
+// never wait on the collector.
+static constexpr std::size_t stripeCount = 8;
+
+static std::size_t
+thisStripe()
+{
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t const stripe =
+        next.fetch_add(1, std::memory_order_relaxed) % stripeCount;
+    return stripe;
+}
+
+template <class T>
+class StripedSum
+{
+public:
+    void
+    add(T amount)
+    {
+        stripes_[thisStripe()].value.fetch_add(
+            amount, std::memory_order_relaxed);
+        if (!dirty_.load(std::memory_order_relaxed))
+            dirty_.store(true, std::memory_order_relaxed);
+    }
+
+    // Returns the sum since the last call, if anything was added
+    std::optional<T>
+    take()
+    {
+        if (!dirty_.exchange(false, std::memory_order_relaxed))
+            return std::nullopt;
+        T sum = 0;
+        for (auto& stripe : stripes_)
+            sum += stripe.value.exchange(0, std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    struct alignas(64) Stripe
+    {
+        std::atomic<T> value{0};
+    };
+
+    std::array<Stripe, stripeCount> stripes_;
+    std::atomic<bool> dirty_{false};
+};
+
+// The upper bounds, in milliseconds, of the buckets events are counted in.
+// Longer events are counted in one more bucket.
+static constexpr std::array<std::int64_t, 15> eventBounds{
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 60000};
+
+static constexpr std::size_t eventBuckets = eventBounds.size() + 1;
+
+struct EventBuckets
+{
+    std::array<std::uint64_t, eventBuckets> counts{};
+    std::array<std::uint64_t, eventBuckets> sums{};
+};
+
+//------------------------------------------------------------------------------
+
 class StatsDMetricBase : public List<StatsDMetricBase>::Node
 {
 public:
@@ -100,8 +170,6 @@ public:
     void
     flush();
     void
-    do_increment(CounterImpl::value_type amount);
-    void
     do_process() override;
 
 private:
@@ -110,35 +178,42 @@ private:
 
     std::shared_ptr<StatsDCollectorImp> m_impl;
     std::string m_name;
-    CounterImpl::value_type m_value;
-    bool m_dirty;
+    StripedSum<CounterImpl::value_type> m_value;
 };
 
 //------------------------------------------------------------------------------
 
-class StatsDEventImpl : public EventImpl
+class StatsDEventImpl : public EventImpl, public StatsDMetricBase
 {
 public:
     StatsDEventImpl(
         std::string const& name,
         std::shared_ptr<StatsDCollectorImp> const& impl);
 
-    ~StatsDEventImpl() = default;
+    ~StatsDEventImpl() override;
 
     void
     notify(EventImpl::value_type const& value) override;
 
     void
-    do_notify(EventImpl::value_type const& value);
+    flush();
     void
-    do_process();
+    do_process() override;
 
 private:
     StatsDEventImpl&
     operator=(StatsDEventImpl const&);
 
+    struct alignas(64) Stripe
+    {
+        std::array<std::atomic<std::uint64_t>, eventBuckets> counts;
+        std::array<std::atomic<std::uint64_t>, eventBuckets> sums;
+    };
+
     std::shared_ptr<StatsDCollectorImp> m_impl;
     std::string m_name;
+    std::array<Stripe, stripeCount> m_stripes;
+    std::atomic<bool> m_dirty;
 };
 
 //------------------------------------------------------------------------------
@@ -160,10 +235,6 @@ public:
     void
     flush();
     void
-    do_set(GaugeImpl::value_type value);
-    void
-    do_increment(GaugeImpl::difference_type amount);
-    void
     do_process() override;
 
 private:
@@ -173,8 +244,7 @@ private:
     std::shared_ptr<StatsDCollectorImp> m_impl;
     std::string m_name;
     GaugeImpl::value_type m_last_value;
-    GaugeImpl::value_type m_value;
-    bool m_dirty;
+    std::atomic<GaugeImpl::value_type> m_value;
 };
 
 //------------------------------------------------------------------------------
@@ -194,8 +264,6 @@ public:
     void
     flush();
     void
-    do_increment(MeterImpl::value_type amount);
-    void
     do_process() override;
 
 private:
@@ -204,8 +272,7 @@ private:
 
     std::shared_ptr<StatsDCollectorImp> m_impl;
     std::string m_name;
-    MeterImpl::value_type m_value;
-    bool m_dirty;
+    StripedSum<MeterImpl::value_type> m_value;
 };
 
 //------------------------------------------------------------------------------
@@ -220,18 +287,33 @@ private:
         max_packet_size = 1472
     };
 
+    // What was last reported for a metric, kept for prometheus()
+    struct Exposed
+    {
+        char const* type = nullptr;
+        double value = 0;
+        bool histogram = false;
+        EventBuckets buckets;
+    };
+
     Journal m_journal;
     IP::Endpoint m_address;
     std::string m_prefix;
     boost::asio::io_service m_io_service;
     std::optional<boost::asio::io_service::work> m_work;
-    boost::asio::io_service::strand m_strand;
     boost::asio::basic_waitable_timer<std::chrono::steady_clock> m_timer;
     boost::asio::ip::udp::socket m_socket;
-    std::deque<std::string> m_data;
     std::recursive_mutex metricsLock_;
     List<StatsDMetricBase> metrics_;
 
+    // The packets being filled in by the metrics. Only used on the
+    // io_service thread.
+    std::vector<std::string> m_packets;
+    std::string m_line;
+
+    mutable std::mutex exposedLock_;
+    std::map<std::string, Exposed> exposed_;
+
     // Must come last for order of init
     std::thread m_thread;
 
@@ -241,6 +323,41 @@ private:
         return boost::asio::ip::udp::endpoint(ep.address(), ep.port());
     }
 
+    template <class Integer>
+    static void
+    append(std::string& s, Integer value)
+    {
+        char buf[24];
+        auto const result = std::to_chars(buf, buf + sizeof(buf), value);
+        s.append(buf, result.ptr);
+    }
+
+    static void
+    append(std::string& s, double value)
+    {
+        char buf[32];
+        auto const n = std::snprintf(buf, sizeof(buf), "%.17g", value);
+        s.append(buf, n);
+    }
+
+    // Metric names may only contain letters, digits, underscores and
+    // colons, and may not start with a digit.
+    static std::string
+    prometheus_name(std::string const& name)
+    {
+        std::string result;
+        result.reserve(name.size() + 1);
+        if (name.empty() || (name[0] >= '0' && name[0] <= '9'))
+            result += '_';
+        for (char c : name)
+        {
+            bool const valid = (c >= 'a' && c <= 'z') ||
+                (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == ':';
+            result += valid ? c : '_';
+        }
+        return result;
+    }
+
 public:
     StatsDCollectorImp(
         IP::Endpoint const& address,
@@ -250,7 +367,6 @@ public:
         , m_address(address)
         , m_prefix(prefix)
         , m_work(std::ref(m_io_service))
-        , m_strand(m_io_service)
         , m_timer(m_io_service)
         , m_socket(m_io_service)
         , m_thread(&StatsDCollectorImp::run, this)
@@ -301,6 +417,56 @@ public:
             name, shared_from_this()));
     }
 
+    std::string
+    prometheus() const override
+    {
+        std::string s;
+        std::lock_guard _(exposedLock_);
+        for (auto const& [name, e] : exposed_)
+        {
+            s += "# TYPE ";
+            s += name;
+            s += ' ';
+            s += e.type;
+            s += '\n';
+
+            if (!e.histogram)
+            {
+                s += name;
+                s += ' ';
+                append(s, e.value);
+                s += '\n';
+                continue;
+            }
+
+            std::uint64_t count = 0;
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < eventBuckets; ++i)
+            {
+                count += e.buckets.counts[i];
+                sum += e.buckets.sums[i];
+                s += name;
+                s += "_bucket{le=\"";
+                if (i < eventBounds.size())
+                    append(s, eventBounds[i]);
+                else
+                    s += "+Inf";
+                s += "\"} ";
+                append(s, count);
+                s += '\n';
+            }
+            s += name;
+            s += "_sum ";
+            append(s, sum);
+            s += '\n';
+            s += name;
+            s += "_count ";
+            append(s, count);
+            s += '\n';
+        }
+        return s;
+    }
+
     //--------------------------------------------------------------------------
 
     void
@@ -319,36 +485,116 @@ public:
 
     //--------------------------------------------------------------------------
 
-    boost::asio::io_service&
-    get_io_service()
+    // Called by the metrics while they are processed, on the io_service
+    // thread, to report what changed during the last interval.
+
+    void
+    write_counter(
+        std::string const& name,
+        std::int64_t amount,
+        char const* statsdType,
+        char const* type)
     {
-        return m_io_service;
+        start_line(name);
+        append(m_line, amount);
+        end_line(statsdType);
+
+        auto& e = exposed(name, type);
+        e.value += amount;
     }
 
-    std::string const&
-    prefix() const
+    void
+    write_gauge(std::string const& name, std::uint64_t value)
     {
-        return m_prefix;
+        start_line(name);
+        append(m_line, value);
+        end_line("g");
+
+        auto& e = exposed(name, "gauge");
+        e.value = value;
+    }
+
+    // Each bucket is sent as one timing with the mean duration of the
+    // events in it, sampled at a rate that tells the server how many
+    // events it stands for.
+    void
+    write_event(std::string const& name, EventBuckets const& buckets)
+    {
+        for (std::size_t i = 0; i < eventBuckets; ++i)
+        {
+            auto const count = buckets.counts[i];
+            if (count == 0)
+                continue;
+
+            start_line(name);
+            append(m_line, (buckets.sums[i] + count / 2) / count);
+            m_line += "|ms";
+            if (count > 1)
+            {
+                char buf[32];
+                auto const n =
+                    std::snprintf(buf, sizeof(buf), "|@%.9g", 1.0 / count);
+                m_line.append(buf, n);
+            }
+            end_line(nullptr);
+        }
+
+        auto& e = exposed(name, "histogram");
+        e.histogram = true;
+        for (std::size_t i = 0; i < eventBuckets; ++i)
+        {
+            e.buckets.counts[i] += buckets.counts[i];
+            e.buckets.sums[i] += buckets.sums[i];
+        }
     }
 
+    //--------------------------------------------------------------------------
+
+private:
     void
-    do_post_buffer(std::string const& buffer)
+    start_line(std::string const& name)
     {
-        m_data.emplace_back(buffer);
+        m_line.clear();
+        m_line += m_prefix;
+        m_line += '.';
+        m_line += name;
+        m_line += ':';
     }
 
+    // Adds the line to the last packet, or starts a new packet if the
+    // line would not fit.
     void
-    post_buffer(std::string&& buffer)
+    end_line(char const* statsdType)
+    {
+        if (statsdType)
+        {
+            m_line += '|';
+            m_line += statsdType;
+        }
+        m_line += '\n';
+
+        if (m_packets.empty() ||
+            m_packets.back().size() + m_line.size() > max_packet_size)
+        {
+            m_packets.emplace_back();
+            m_packets.back().reserve(max_packet_size);
+        }
+        m_packets.back() += m_line;
+    }
+
+    Exposed&
+    exposed(std::string const& name, char const* type)
     {
-        m_io_service.dispatch(m_strand.wrap(std::bind(
-            &StatsDCollectorImp::do_post_buffer, this, std::move(buffer))));
+        auto& e = exposed_[prometheus_name(m_prefix + "_" + name)];
+        e.type = type;
+        return e;
     }
 
     // The keepAlive parameter makes sure the buffers sent to
     // boost::asio::async_send do not go away until the call is finished
     void
     on_send(
-        std::shared_ptr<std::deque<std::string>> /*keepAlive*/,
+        std::shared_ptr<std::vector<std::string>> /*keepAlive*/,
         boost::system::error_code ec,
         std::size_t)
     {
@@ -364,67 +610,34 @@ public:
     }
 
     void
-    log(std::vector<boost::asio::const_buffer> const& buffers)
+    log(std::string const& packet)
     {
-        (void)buffers;
+        (void)packet;
 #if BEAST_STATSDCOLLECTOR_TRACING_ENABLED
-        for (auto const& buffer : buffers)
-        {
-            std::string const s(
-                boost::asio::buffer_cast<char const*>(buffer),
-                boost::asio::buffer_size(buffer));
-            std::cerr << s;
-        }
-        std::cerr << '\n';
+        std::cerr << packet << '\n';
 #endif
     }
 
-    // Send what we have
+    // Send what we have, one UDP packet per block of metrics
     void
     send_buffers()
     {
-        if (m_data.empty())
+        if (m_packets.empty())
             return;
 
-        // Break up the array of strings into blocks
-        // that each fit into one UDP packet.
-        //
-        std::vector<boost::asio::const_buffer> buffers;
-        buffers.reserve(m_data.size());
-        std::size_t size(0);
-
         auto keepAlive =
-            std::make_shared<std::deque<std::string>>(std::move(m_data));
-        m_data.clear();
-
-        for (auto const& s : *keepAlive)
-        {
-            std::size_t const length(s.size());
-            assert(!s.empty());
-            if (!buffers.empty() && (size + length) > max_packet_size)
-            {
-                log(buffers);
-                m_socket.async_send(
-                    buffers,
-                    std::bind(
-                        &StatsDCollectorImp::on_send,
-                        this,
-                        keepAlive,
-                        std::placeholders::_1,
-                        std::placeholders::_2));
-                buffers.clear();
-                size = 0;
-            }
+            std::make_shared<std::vector<std::string>>(std::move(m_packets));
+        m_packets.clear();
 
-            buffers.emplace_back(&s[0], length);
-            size += length;
-        }
+        if (!m_socket.is_open())
+            return;
 
-        if (!buffers.empty())
+        for (auto const& packet : *keepAlive)
         {
-            log(buffers);
+            assert(!packet.empty());
+            log(packet);
             m_socket.async_send(
-                buffers,
+                boost::asio::buffer(packet),
                 std::bind(
                     &StatsDCollectorImp::on_send,
                     this,
@@ -456,10 +669,13 @@ public:
             return;
         }
 
-        std::lock_guard _(metricsLock_);
+        {
+            std::lock_guard _(metricsLock_);
+            std::lock_guard exposedLock(exposedLock_);
 
-        for (auto& m : metrics_)
-            m.do_process();
+            for (auto& m : metrics_)
+                m.do_process();
+        }
 
         send_buffers();
 
@@ -471,7 +687,9 @@ public:
     {
         boost::system::error_code ec;
 
-        if (m_socket.connect(to_endpoint(m_address), ec))
+        // Without a port the metrics are only kept for prometheus()
+        if (m_address.port() != 0 &&
+            m_socket.connect(to_endpoint(m_address), ec))
         {
             if (auto stream = m_journal.error())
                 stream << "Connect failed: " << ec.message();
@@ -482,9 +700,11 @@ public:
 
         m_io_service.run();
 
-        m_socket.shutdown(boost::asio::ip::udp::socket::shutdown_send, ec);
-
-        m_socket.close();
+        if (m_socket.is_open())
+        {
+            m_socket.shutdown(boost::asio::ip::udp::socket::shutdown_send, ec);
+            m_socket.close();
+        }
 
         m_io_service.poll();
     }
@@ -516,7 +736,7 @@ StatsDHookImpl::do_process()
 StatsDCounterImpl::StatsDCounterImpl(
     std::string const& name,
     std::shared_ptr<StatsDCollectorImp> const& impl)
-    : m_impl(impl), m_name(name), m_value(0), m_dirty(false)
+    : m_impl(impl), m_name(name)
 {
     m_impl->add(*this);
 }
@@ -529,31 +749,14 @@ StatsDCounterImpl::~StatsDCounterImpl()
 void
 StatsDCounterImpl::increment(CounterImpl::value_type amount)
 {
-    m_impl->get_io_service().dispatch(std::bind(
-        &StatsDCounterImpl::do_increment,
-        std::static_pointer_cast<StatsDCounterImpl>(shared_from_this()),
-        amount));
+    m_value.add(amount);
 }
 
 void
 StatsDCounterImpl::flush()
 {
-    if (m_dirty)
-    {
-        m_dirty = false;
-        std::stringstream ss;
-        ss << m_impl->prefix() << "." << m_name << ":" << m_value << "|c"
-           << "\n";
-        m_value = 0;
-        m_impl->post_buffer(ss.str());
-    }
-}
-
-void
-StatsDCounterImpl::do_increment(CounterImpl::value_type amount)
-{
-    m_value += amount;
-    m_dirty = true;
+    if (auto const value = m_value.take())
+        m_impl->write_counter(m_name, *value, "c", "counter");
 }
 
 void
@@ -567,26 +770,55 @@ StatsDCounterImpl::do_process()
 StatsDEventImpl::StatsDEventImpl(
     std::string const& name,
     std::shared_ptr<StatsDCollectorImp> const& impl)
-    : m_impl(impl), m_name(name)
+    : m_impl(impl), m_name(name), m_dirty(false)
+{
+    m_impl->add(*this);
+}
+
+StatsDEventImpl::~StatsDEventImpl()
 {
+    m_impl->remove(*this);
 }
 
 void
 StatsDEventImpl::notify(EventImpl::value_type const& value)
 {
-    m_impl->get_io_service().dispatch(std::bind(
-        &StatsDEventImpl::do_notify,
-        std::static_pointer_cast<StatsDEventImpl>(shared_from_this()),
-        value));
+    auto const ms = std::max<std::int64_t>(value.count(), 0);
+    auto const bucket =
+        std::lower_bound(eventBounds.begin(), eventBounds.end(), ms) -
+        eventBounds.begin();
+
+    auto& stripe = m_stripes[thisStripe()];
+    stripe.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    stripe.sums[bucket].fetch_add(ms, std::memory_order_relaxed);
+    if (!m_dirty.load(std::memory_order_relaxed))
+        m_dirty.store(true, std::memory_order_relaxed);
 }
 
 void
-StatsDEventImpl::do_notify(EventImpl::value_type const& value)
+StatsDEventImpl::flush()
 {
-    std::stringstream ss;
-    ss << m_impl->prefix() << "." << m_name << ":" << value.count() << "|ms"
-       << "\n";
-    m_impl->post_buffer(ss.str());
+    if (!m_dirty.exchange(false, std::memory_order_relaxed))
+        return;
+
+    EventBuckets buckets;
+    for (auto& stripe : m_stripes)
+    {
+        for (std::size_t i = 0; i < eventBuckets; ++i)
+        {
+            buckets.counts[i] +=
+                stripe.counts[i].exchange(0, std::memory_order_relaxed);
+            buckets.sums[i] +=
+                stripe.sums[i].exchange(0, std::memory_order_relaxed);
+        }
+    }
+    m_impl->write_event(m_name, buckets);
+}
+
+void
+StatsDEventImpl::do_process()
+{
+    flush();
 }
 
 //------------------------------------------------------------------------------
@@ -594,7 +826,7 @@ StatsDEventImpl::do_notify(EventImpl::value_type const& value)
 StatsDGaugeImpl::StatsDGaugeImpl(
     std::string const& name,
     std::shared_ptr<StatsDCollectorImp> const& impl)
-    : m_impl(impl), m_name(name), m_last_value(0), m_value(0), m_dirty(false)
+    : m_impl(impl), m_name(name), m_last_value(0), m_value(0)
 {
     m_impl->add(*this);
 }
@@ -607,68 +839,45 @@ StatsDGaugeImpl::~StatsDGaugeImpl()
 void
 StatsDGaugeImpl::set(GaugeImpl::value_type value)
 {
-    m_impl->get_io_service().dispatch(std::bind(
-        &StatsDGaugeImpl::do_set,
-        std::static_pointer_cast<StatsDGaugeImpl>(shared_from_this()),
-        value));
+    m_value.store(value, std::memory_order_relaxed);
 }
 
 void
 StatsDGaugeImpl::increment(GaugeImpl::difference_type amount)
 {
-    m_impl->get_io_service().dispatch(std::bind(
-        &StatsDGaugeImpl::do_increment,
-        std::static_pointer_cast<StatsDGaugeImpl>(shared_from_this()),
-        amount));
-}
-
-void
-StatsDGaugeImpl::flush()
-{
-    if (m_dirty)
+    auto value = m_value.load(std::memory_order_relaxed);
+    GaugeImpl::value_type next;
+    do
     {
-        m_dirty = false;
-        std::stringstream ss;
-        ss << m_impl->prefix() << "." << m_name << ":" << m_value << "|g"
-           << "\n";
-        m_impl->post_buffer(ss.str());
-    }
-}
-
-void
-StatsDGaugeImpl::do_set(GaugeImpl::value_type value)
-{
-    m_value = value;
-
-    if (m_value != m_last_value)
-    {
-        m_last_value = m_value;
-        m_dirty = true;
-    }
+        next = value;
+        if (amount > 0)
+        {
+            GaugeImpl::value_type const d(
+                static_cast<GaugeImpl::value_type>(amount));
+            next +=
+                (d >= std::numeric_limits<GaugeImpl::value_type>::max() - value)
+                ? std::numeric_limits<GaugeImpl::value_type>::max() - value
+                : d;
+        }
+        else if (amount < 0)
+        {
+            GaugeImpl::value_type const d(
+                static_cast<GaugeImpl::value_type>(-amount));
+            next = (d >= value) ? 0 : value - d;
+        }
+    } while (!m_value.compare_exchange_weak(
+        value, next, std::memory_order_relaxed));
 }
 
 void
-StatsDGaugeImpl::do_increment(GaugeImpl::difference_type amount)
+StatsDGaugeImpl::flush()
 {
-    GaugeImpl::value_type value(m_value);
-
-    if (amount > 0)
+    auto const value = m_value.load(std::memory_order_relaxed);
+    if (value != m_last_value)
     {
-        GaugeImpl::value_type const d(
-            static_cast<GaugeImpl::value_type>(amount));
-        value +=
-            (d >= std::numeric_limits<GaugeImpl::value_type>::max() - m_value)
-            ? std::numeric_limits<GaugeImpl::value_type>::max() - m_value
-            : d;
+        m_last_value = value;
+        m_impl->write_gauge(m_name, value);
     }
-    else if (amount < 0)
-    {
-        GaugeImpl::value_type const d(
-            static_cast<GaugeImpl::value_type>(-amount));
-        value = (d >= value) ? 0 : value - d;
-    }
-
-    do_set(value);
 }
 
 void
@@ -682,7 +891,7 @@ StatsDGaugeImpl::do_process()
 StatsDMeterImpl::StatsDMeterImpl(
     std::string const& name,
     std::shared_ptr<StatsDCollectorImp> const& impl)
-    : m_impl(impl), m_name(name), m_value(0), m_dirty(false)
+    : m_impl(impl), m_name(name)
 {
     m_impl->add(*this);
 }
@@ -695,31 +904,14 @@ StatsDMeterImpl::~StatsDMeterImpl()
 void
 StatsDMeterImpl::increment(MeterImpl::value_type amount)
 {
-    m_impl->get_io_service().dispatch(std::bind(
-        &StatsDMeterImpl::do_increment,
-        std::static_pointer_cast<StatsDMeterImpl>(shared_from_this()),
-        amount));
+    m_value.add(amount);
 }
 
 void
 StatsDMeterImpl::flush()
 {
-    if (m_dirty)
-    {
-        m_dirty = false;
-        std::stringstream ss;
-        ss << m_impl->prefix() << "." << m_name << ":" << m_value << "|m"
-           << "\n";
-        m_value = 0;
-        m_impl->post_buffer(ss.str());
-    }
-}
-
-void
-StatsDMeterImpl::do_increment(MeterImpl::value_type amount)
-{
-    m_value += amount;
-    m_dirty = true;
+    if (auto const value = m_value.take())
+        m_impl->write_counter(m_name, *value, "m", "counter");
 }
 
 void
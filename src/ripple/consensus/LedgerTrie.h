@@ -23,6 +23,7 @@
 #include <ripple/basics/ToString.h>
 #include <ripple/json/json_value.h>
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <optional>
 #include <sstream>
@@ -211,17 +212,26 @@ struct Node
     std::uint32_t tipSupport = 0;
     std::uint32_t branchSupport = 0;
 
+    // Ordered by decreasing branch support, breaking ties with the larger
+    // starting ID first, so the preferred child is always at the front.
     std::vector<std::unique_ptr<Node>> children;
     Node* parent = nullptr;
 
-    /** Remove the given node from this Node's children
+    /** Whether `a` belongs in front of `b` among the children of a node
+     */
+    static bool
+    before(Node const& a, Node const& b)
+    {
+        return std::make_tuple(a.branchSupport, a.span.startID()) >
+            std::make_tuple(b.branchSupport, b.span.startID());
+    }
 
-        @param child The address of the child node to remove
-        @note The child must be a member of the vector. The passed pointer
-              will be dangling as a result of this call
+    /** Return the position of the given node among this Node's children
+
+        @note The child must be a member of the vector.
     */
-    void
-    erase(Node const* child)
+    typename std::vector<std::unique_ptr<Node>>::iterator
+    position(Node const* child)
     {
         auto it = std::find_if(
             children.begin(),
@@ -230,8 +240,41 @@ struct Node
                 return curr.get() == child;
             });
         assert(it != children.end());
-        std::swap(*it, children.back());
-        children.pop_back();
+        return it;
+    }
+
+    /** Restore the order of this Node's children after the branch support
+        of one of them changed.
+
+        @param child The address of the child node whose support changed
+    */
+    void
+    reorder(Node const* child)
+    {
+        auto it = position(child);
+        while (it != children.begin() && before(**it, **std::prev(it)))
+        {
+            std::iter_swap(it, std::prev(it));
+            --it;
+        }
+        while (std::next(it) != children.end() &&
+               before(**std::next(it), **it))
+        {
+            std::iter_swap(it, std::next(it));
+            ++it;
+        }
+    }
+
+    /** Remove the given node from this Node's children
+
+        @param child The address of the child node to remove
+        @note The child must be a member of the vector. The passed pointer
+              will be dangling as a result of this call
+    */
+    void
+    erase(Node const* child)
+    {
+        children.erase(position(child));
     }
 
     friend std::ostream&
@@ -358,6 +401,9 @@ class LedgerTrie
     // Count of the tip support for each sequence number
     std::map<Seq, std::uint32_t> seqSupport;
 
+    // The node whose span ends with each ledger ID
+    std::map<ID, Node*> tips;
+
     /** Find the node in the trie that represents the longest common ancestry
         with the given ledger.
 
@@ -399,23 +445,44 @@ class LedgerTrie
     /** Find the node in the trie with an exact match to the given ledger ID
 
         @return the found node or nullptr if an exact match was not found.
-
-        @note O(n) since this searches all nodes until a match is found
     */
     Node*
-    findByLedgerID(Ledger const& ledger, Node* parent = nullptr) const
+    findByLedgerID(Ledger const& ledger) const
+    {
+        auto const it = tips.find(ledger.id());
+        if (it == tips.end())
+            return nullptr;
+        return it->second;
+    }
+
+    /** Add to the branch support of a node and all its ancestors, keeping
+        the children of each ancestor in order.
+    */
+    void
+    addBranchSupport(Node* node, std::uint32_t count)
+    {
+        while (node)
+        {
+            node->branchSupport += count;
+            if (node->parent)
+                node->parent->reorder(node);
+            node = node->parent;
+        }
+    }
+
+    /** Remove from the branch support of a node and all its ancestors,
+        keeping the children of each ancestor in order.
+    */
+    void
+    removeBranchSupport(Node* node, std::uint32_t count)
     {
-        if (!parent)
-            parent = root.get();
-        if (ledger.id() == parent->span.tip().id)
-            return parent;
-        for (auto const& child : parent->children)
+        while (node)
         {
-            auto cl = findByLedgerID(ledger, child.get());
-            if (cl)
-                return cl;
+            node->branchSupport -= count;
+            if (node->parent)
+                node->parent->reorder(node);
+            node = node->parent;
         }
-        return nullptr;
     }
 
     void
@@ -438,6 +505,7 @@ class LedgerTrie
 public:
     LedgerTrie() : root{std::make_unique<Node>()}
     {
+        tips[root->span.tip().id] = root.get();
     }
 
     /** Insert and/or increment the support for the given ledger.
@@ -493,6 +561,8 @@ public:
             // Loc truncates to prefix and newNode is its child
             assert(prefix);
             loc->span = *prefix;
+            tips[loc->span.tip().id] = loc;
+            tips[newNode->span.tip().id] = newNode.get();
             newNode->parent = loc;
             loc->children.emplace_back(std::move(newNode));
             loc->tipSupport = 0;
@@ -509,17 +579,14 @@ public:
 
             auto newNode = std::make_unique<Node>(*newSuffix);
             newNode->parent = loc;
+            tips[newNode->span.tip().id] = newNode.get();
             // increment support starting from the new node
             incNode = newNode.get();
             loc->children.push_back(std::move(newNode));
         }
 
         incNode->tipSupport += count;
-        while (incNode)
-        {
-            incNode->branchSupport += count;
-            incNode = incNode->parent;
-        }
+        addBranchSupport(incNode, count);
 
         seqSupport[ledger.seq()] += count;
     }
@@ -549,12 +616,7 @@ public:
         if (it->second == 0)
             seqSupport.erase(it->first);
 
-        Node* decNode = loc;
-        while (decNode)
-        {
-            decNode->branchSupport -= count;
-            decNode = decNode->parent;
-        }
+        removeBranchSupport(loc, count);
 
         while (loc->tipSupport == 0 && loc != root.get())
         {
@@ -562,16 +624,18 @@ public:
             if (loc->children.empty())
             {
                 // this node can be erased
+                tips.erase(loc->span.tip().id);
                 parent->erase(loc);
             }
             else if (loc->children.size() == 1)
             {
-                // This node can be combined with its child
+                // This node can be combined with its child, which has the
+                // same branch support and starting ID so takes its place
+                tips.erase(loc->span.tip().id);
                 std::unique_ptr<Node> child = std::move(loc->children.front());
                 child->span = merge(loc->span, child->span);
                 child->parent = parent;
-                parent->children.emplace_back(std::move(child));
-                parent->erase(loc);
+                *parent->position(loc) = std::move(child);
             }
             else
                 break;
@@ -734,20 +798,8 @@ public:
             }
             else if (!curr->children.empty())
             {
-                // Sort placing children with largest branch support in the
+                // Children are kept with the largest branch support in the
                 // front, breaking ties with the span's starting ID
-                std::partial_sort(
-                    curr->children.begin(),
-                    curr->children.begin() + 2,
-                    curr->children.end(),
-                    [](std::unique_ptr<Node> const& a,
-                       std::unique_ptr<Node> const& b) {
-                        return std::make_tuple(
-                                   a->branchSupport, a->span.startID()) >
-                            std::make_tuple(
-                                   b->branchSupport, b->span.startID());
-                    });
-
                 best = curr->children[0].get();
                 margin = curr->children[0]->branchSupport -
                     curr->children[1]->branchSupport;
@@ -804,6 +856,7 @@ public:
     checkInvariants() const
     {
         std::map<Seq, std::uint32_t> expectedSeqSupport;
+        std::size_t count = 0;
 
         std::stack<Node const*> nodes;
         nodes.push(root.get());
@@ -813,6 +866,22 @@ public:
             nodes.pop();
             if (!curr)
                 continue;
+            ++count;
+
+            // Every node can be found by the ID of its tip
+            auto const tip = tips.find(curr->span.tip().id);
+            if (tip == tips.end() || tip->second != curr)
+                return false;
+
+            // Children are ordered by branch support and starting ID
+            if (!std::is_sorted(
+                    curr->children.begin(),
+                    curr->children.end(),
+                    [](std::unique_ptr<Node> const& a,
+                       std::unique_ptr<Node> const& b) {
+                        return Node::before(*a, *b);
+                    }))
+                return false;
 
             // Node with 0 tip support must have multiple children
             // unless it is the root node
@@ -837,7 +906,7 @@ public:
             if (support != curr->branchSupport)
                 return false;
         }
-        return expectedSeqSupport == seqSupport;
+        return count == tips.size() && expectedSeqSupport == seqSupport;
     }
 };
 
@@ -30,6 +30,7 @@
 
 #include <mutex>
 #include <optional>
+#include <set>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -304,6 +305,12 @@ class Validations
     // Validations from currently listed and trusted nodes (partial and full)
     hash_map<NodeID, Validation> current_;
 
+    // The entries of current_ in the order they become stale
+    std::set<std::pair<NetClock::time_point, NodeID>> bySignTime_;
+
+    // The latest time at which every entry of current_ was known current
+    NetClock::time_point currentAsOf_;
+
     // Used to enforce the largest validation invariant for the local node
     SeqEnforcer<Seq> localSeqEnforcer_;
 
@@ -465,6 +472,53 @@ private:
         }
     }
 
+    /** Flush the current validations which have become stale.
+
+        While the clock moves forward validations go stale in the order they
+        were signed, so only those signed earliest are looked at. If the
+        clock has gone backwards, validations signed or seen too far in the
+        future are no longer current either, so all of them are checked.
+
+        @param lock Existing lock of mutex_
+    */
+    void
+    flushStale(std::lock_guard<Mutex> const& lock)
+    {
+        NetClock::time_point const t = adaptor_.now();
+        if (t < currentAsOf_)
+        {
+            for (auto it = current_.begin(); it != current_.end();)
+            {
+                if (isCurrent(
+                        parms_,
+                        t,
+                        it->second.signTime(),
+                        it->second.seenTime()))
+                {
+                    ++it;
+                    continue;
+                }
+                removeTrie(lock, it->first, it->second);
+                bySignTime_.erase({it->second.signTime(), it->first});
+                it = current_.erase(it);
+            }
+        }
+        currentAsOf_ = t;
+
+        while (!bySignTime_.empty())
+        {
+            auto const& nodeID = bySignTime_.begin()->second;
+            auto const it = current_.find(nodeID);
+            assert(it != current_.end());
+            if (isCurrent(
+                    parms_, t, it->second.signTime(), it->second.seenTime()))
+                break;
+            removeTrie(lock, it->first, it->second);
+            current_.erase(it);
+            bySignTime_.erase(bySignTime_.begin());
+        }
+    }
+
     /** Use the trie for a calculation
 
         Accessing the trie through this helper ensures acquiring validations
@@ -481,9 +535,7 @@ private:
     auto
     withTrie(std::lock_guard<Mutex> const& lock, F&& f)
     {
-        // Call current to flush any stale validations
-        current(
-            lock, [](auto) {}, [](auto, auto) {});
+        flushStale(lock);
         checkAcquired(lock);
         return f(trie_);
     }
@@ -518,6 +570,7 @@ private:
                     parms_, t, it->second.signTime(), it->second.seenTime()))
             {
                 removeTrie(lock, it->first, it->second);
+                bySignTime_.erase({it->second.signTime(), it->first});
                 it = current_.erase(it);
             }
             else
@@ -621,11 +674,13 @@ public:
     ValStatus
     add(NodeID const& nodeID, Validation const& val)
     {
-        if (!isCurrent(parms_, adaptor_.now(), val.signTime(), val.seenTime()))
+        NetClock::time_point const t = adaptor_.now();
+        if (!isCurrent(parms_, t, val.signTime(), val.seenTime()))
             return ValStatus::stale;
 
         {
             std::lock_guard lock{mutex_};
+            currentAsOf_ = std::max(currentAsOf_, t);
 
             // Check that validation sequence is greater than any non-expired
             // validations sequence from that validator; if it's not, perform
@@ -688,6 +743,8 @@ public:
                 if (val.signTime() > oldVal.signTime())
                 {
                     std::pair<Seq, ID> old(oldVal.seq(), oldVal.ledgerID());
+                    bySignTime_.erase({oldVal.signTime(), nodeID});
+                    bySignTime_.emplace(val.signTime(), nodeID);
                     it->second = val;
                     if (val.trusted())
                         updateTrie(lock, nodeID, val, old);
@@ -695,9 +752,11 @@ public:
                 else
                     return ValStatus::stale;
             }
-            else if (val.trusted())
+            else
             {
-                updateTrie(lock, nodeID, val, std::nullopt);
+                bySignTime_.emplace(val.signTime(), nodeID);
+                if (val.trusted())
+                    updateTrie(lock, nodeID, val, std::nullopt);
             }
         }
 
@@ -1104,6 +1163,7 @@ public:
     {
         std::lock_guard lock{mutex_};
         current_.clear();
+        bySignTime_.clear();
     }
 
     /** Return quantity of lagging proposers, and remove online proposers
@@ -247,6 +247,11 @@ public:
     // size, but we allow admins to explicitly set it in the config.
     std::optional<int> SWEEP_INTERVAL;
 
+    // The resident memory, in megabytes, that the server tries to stay
+    // within by resizing its caches. Unset, caches keep the sizes that
+    // follow from the node size.
+    std::optional<std::uint64_t> MEMORY_BUDGET;
+
     // Reduce-relay - these parameters are experimental.
     // Enable reduce-relay features
     // Validation/proposal reduce-relay feature
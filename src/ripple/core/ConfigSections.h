@@ -35,6 +35,11 @@ struct ConfigSection
         return "node_db";
     }
     static std::string
+    nodeDatabaseHot()
+    {
+        return "node_db_hot";
+    }
+    static std::string
     shardDatabase()
     {
         return "shard_db";
@@ -59,8 +64,10 @@ struct ConfigSection
 #define SECTION_INSIGHT "insight"
 #define SECTION_IPS "ips"
 #define SECTION_IPS_FIXED "ips_fixed"
+#define SECTION_LEDGER_EXPORT "ledger_export"
 #define SECTION_LEDGER_HISTORY "ledger_history"
 #define SECTION_MAX_TRANSACTIONS "max_transactions"
+#define SECTION_MEMORY_BUDGET "memory_budget"
 #define SECTION_NETWORK_QUORUM "network_quorum"
 #define SECTION_NODE_SEED "node_seed"
 #define SECTION_NODE_SIZE "node_size"
@@ -41,6 +41,7 @@ enum JobType {
     // insert a job at a specific priority, simply add it at the right location.
 
     jtPACK,               // Make a fetch pack for a peer
+    jtLEDGER_EXPORT,      // Write the state of a ledger to files
     jtPUBOLDLEDGER,       // An old ledger has been accepted
     jtCLIENT,             // A placeholder for the priority of all jtCLIENT jobs
     jtCLIENT_SUBSCRIBE,   // A websocket subscription by a client
@@ -65,6 +66,7 @@ enum JobType {
     jtREQUESTED_TXN,      // Reply with requested transactions
     jtBATCH,              // Apply batched transactions
     jtLEDGER_DATA,        // Received data for a ledger we're acquiring
+    jtLEDGER_NODES,       // Add received nodes of a ledger we're acquiring
     jtADVANCE,            // Advance validated/acquired ledgers
     jtPUBLEDGER,          // Publish a fully-accepted ledger
     jtTXN_DATA,           // Fetch a proposed set
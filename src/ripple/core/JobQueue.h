@@ -24,6 +24,7 @@
 #include <ripple/core/ClosureCounter.h>
 #include <ripple/core/JobTypeData.h>
 #include <ripple/core/JobTypes.h>
+#include <ripple/core/Task.h>
 #include <ripple/core/impl/Workers.h>
 #include <ripple/json/json_value.h>
 #include <boost/coroutine/all.hpp>
@@ -36,6 +37,11 @@ namespace perf {
 class PerfLog;
 }
 
+namespace detail {
+template <class F>
+class SuspendAwaiter;
+}
+
 class Logs;
 struct Coro_create_t
 {
@@ -186,6 +192,57 @@ public:
     std::shared_ptr<Coro>
     postCoro(JobType t, std::string const& name, F&& f);
 
+    /** Adds a job to the queue which will start a Task.
+
+        The Task runs in the job until it first suspends. The awaitables
+        returned by schedule(), suspend() and awaitCoro() continue it in
+        later jobs.
+
+        @param t The type of job.
+        @param name Name of the job.
+        @param task The Task to run.
+
+        @return true if the Task was posted. Otherwise it is destroyed
+                without running.
+    */
+    bool
+    postTask(JobType t, std::string const& name, Task<> task);
+
+    /** Returns an awaitable which continues the awaiting Task in a new job.
+
+        `co_await` evaluates to false if the JobQueue is stopping, in which
+        case the Task continues on the same thread.
+    */
+    auto
+    schedule(JobType t, std::string const& name);
+
+    /** Returns an awaitable which suspends the awaiting Task.
+
+        This is the counterpart of Coro::yield() and Coro::post(), for a
+        Task which waits on some event such as I/O.
+
+        @param f Called once the Task is suspended, with a function object
+                 which continues the Task in a new job. That must be called
+                 exactly once, from any thread.
+    */
+    template <class F>
+    auto
+    suspend(JobType t, std::string const& name, F&& f);
+
+    /** Returns an awaitable which calls a function on a new Coro.
+
+        This lets a Task call code which suspends with Coro::yield(). The
+        awaiting Task continues in a new job once the function returns.
+
+        @param f Has a signature of void(std::shared_ptr<Coro> const&).
+
+        `co_await` evaluates to false if the Coro could not be posted, in
+        which case f is not called.
+    */
+    template <class F>
+    auto
+    awaitCoro(JobType t, std::string const& name, F&& f);
+
     /** Jobs waiting at this priority.
      */
     int
@@ -240,6 +297,9 @@ public:
 private:
     friend class Coro;
 
+    template <class F>
+    friend class detail::SuspendAwaiter;
+
     using JobDataMap = std::map<JobType, JobTypeData>;
 
     beast::Journal m_journal;
@@ -346,9 +406,11 @@ private:
 /*
     An RPC command is received and is handled via ServerHandler(HTTP) or
     Handler(websocket), depending on the connection type. The handler then calls
-    the JobQueue::postCoro() method to create a coroutine and run it at a later
-    point. This frees up the handler thread and allows it to continue handling
-    other requests while the RPC command completes its work asynchronously.
+    the JobQueue::postTask() method to run it as a Task at a later point. This
+    frees up the handler thread and allows it to continue handling other
+    requests while the RPC command completes its work asynchronously. The few
+    commands which suspend in the middle, such as ripple_path_find, are given
+    a Coro with awaitCoro().
 
     postCoro() creates a Coro object. When the Coro ctor is called, and its
     coro_ member is initialized (a boost::coroutines::pull_type), execution
@@ -403,6 +465,7 @@ private:
 }  // namespace ripple
 
 #include <ripple/core/Coro.ipp>
+#include <ripple/core/Task.ipp>
 
 namespace ripple {
 
@@ -70,6 +70,7 @@ private:
         //                                                           avg     peak
         //  JobType               name                    limit    latency  latency
         add(jtPACK,              "makeFetchPack",               1,     0ms,     0ms);
+        add(jtLEDGER_EXPORT,     "ledgerExport",                3,     0ms,     0ms);
         add(jtPUBOLDLEDGER,      "publishAcqLedger",            2, 10000ms, 15000ms);
         add(jtVALIDATION_ut,     "untrustedValidation",  maxLimit,  2000ms,  5000ms);
         add(jtMANIFEST,          "manifest",             maxLimit,  2000ms,  5000ms);
@@ -79,6 +80,7 @@ private:
         add(jtPROPOSAL_ut,       "untrustedProposal",    maxLimit,   500ms,  1250ms);
         add(jtREPLAY_TASK,       "ledgerReplayTask",     maxLimit,     0ms,     0ms);
         add(jtLEDGER_DATA,       "ledgerData",                  3,     0ms,     0ms);
+        add(jtLEDGER_NODES,      "ledgerNodes",          maxLimit,     0ms,     0ms);
         add(jtCLIENT,            "clientCommand",        maxLimit,  2000ms,  5000ms);
         add(jtCLIENT_SUBSCRIBE,  "clientSubscribe",      maxLimit,  2000ms,  5000ms);
         add(jtCLIENT_FEE_CHANGE, "clientFeeChange",      maxLimit,  2000ms,  5000ms);
@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_PARALLELFOR_H_INCLUDED
+#define RIPPLE_CORE_PARALLELFOR_H_INCLUDED
+
+#include <ripple/core/JobQueue.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ripple {
+
+/** Call `f(i)` for every `i` in [0, n), possibly concurrently.
+
+    Up to `helpers` jobs of the given type are added to the job queue to
+    help the calling thread. The calling thread works too, so every call
+    is made even if the job queue never runs the helpers. Returns when
+    every call has returned.
+
+    @note `f` must not throw.
+*/
+template <class F>
+void
+parallelFor(
+    JobQueue& jobQueue,
+    JobType type,
+    std::string const& name,
+    std::size_t n,
+    std::size_t helpers,
+    F& f)
+{
+    struct State
+    {
+        std::size_t const n;
+        std::function<void(std::size_t)> const f;
+        std::atomic<std::size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t finished = 0;
+
+        State(std::size_t n_, std::function<void(std::size_t)> f_)
+            : n(n_), f(std::move(f_))
+        {
+        }
+
+        void
+        run()
+        {
+            std::size_t calls = 0;
+            for (std::size_t i = next++; i < n; i = next++)
+            {
+                f(i);
+                ++calls;
+            }
+
+            if (calls != 0)
+            {
+                std::lock_guard lock(mutex);
+                finished += calls;
+                if (finished == n)
+                    cv.notify_all();
+            }
+        }
+    };
+
+    if (n == 0)
+        return;
+
+    // Helpers that start after every index was claimed return at once, so
+    // `f` is never called once this function has returned.
+    auto state = std::make_shared<State>(n, [&f](std::size_t i) { f(i); });
+
+    for (std::size_t i = 0; i < std::min(helpers, n - 1); ++i)
+        jobQueue.addJob(type, name, [state]() { state->run(); });
+
+    state->run();
+
+    std::unique_lock lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->finished == n; });
+}
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,250 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_TASK_H_INCLUDED
+#define RIPPLE_CORE_TASK_H_INCLUDED
+
+#include <ripple/basics/LocalValue.h>
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace ripple {
+
+template <class T = void>
+class Task;
+
+namespace detail {
+
+// Runs a coroutine on the calling thread with its own LocalValues, the way
+// JobQueue::Coro::resume does.
+inline void
+resumeWith(LocalValues* lvs, std::coroutine_handle<> h)
+{
+    auto saved = getLocalValues().release();
+    getLocalValues().reset(lvs);
+    h.resume();
+    getLocalValues().release();
+    getLocalValues().reset(saved);
+}
+
+class TaskPromiseBase
+{
+    struct FinalAwaiter
+    {
+        bool
+        await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template <class Promise>
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<Promise> h) noexcept
+        {
+            return h.promise().continuation_;
+        }
+
+        void
+        await_resume() const noexcept
+        {
+        }
+    };
+
+    template <class>
+    friend class ripple::Task;
+
+    std::coroutine_handle<> continuation_ = std::noop_coroutine();
+    LocalValues* lvs_ = nullptr;
+
+protected:
+    std::exception_ptr exception_;
+
+public:
+    std::suspend_always
+    initial_suspend() const noexcept
+    {
+        return {};
+    }
+
+    FinalAwaiter
+    final_suspend() const noexcept
+    {
+        return {};
+    }
+
+    void
+    unhandled_exception() noexcept
+    {
+        exception_ = std::current_exception();
+    }
+
+    /** The LocalValues of the job this task is part of. */
+    LocalValues*
+    localValues() const noexcept
+    {
+        return lvs_;
+    }
+};
+
+template <class T>
+class TaskPromise : public TaskPromiseBase
+{
+    std::optional<T> value_;
+
+public:
+    template <class U>
+    void
+    return_value(U&& value)
+    {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T
+    result()
+    {
+        if (exception_)
+            std::rethrow_exception(exception_);
+        assert(value_);
+        return std::move(*value_);
+    }
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase
+{
+public:
+    void
+    return_void() const noexcept
+    {
+    }
+
+    void
+    result()
+    {
+        if (exception_)
+            std::rethrow_exception(exception_);
+    }
+};
+
+}  // namespace detail
+
+/** A stackless coroutine.
+
+    A function returning a Task is a C++20 coroutine. Calling it creates the
+    coroutine without running it; it starts when the Task is awaited with
+    `co_await`, and the awaiting coroutine continues with its result when it
+    returns. Exceptions are rethrown in the awaiting coroutine.
+
+    Unlike a JobQueue::Coro, which reserves a stack for every coroutine, a
+    Task only keeps the local variables that live across a `co_await`. It
+    can only suspend itself, though, not the functions it calls.
+
+    A Task that nothing awaits is started in a job by JobQueue::postTask.
+    All the Tasks started from it share the LocalValues of that job, and
+    the awaitables returned by the JobQueue restore them when a Task is
+    resumed on another thread.
+
+    @note Since a Task may run after the call that created it returns,
+          the parameters of a coroutine that outlives the expression that
+          calls it should be taken by value.
+*/
+template <class T>
+class Task
+{
+public:
+    class promise_type : public detail::TaskPromise<T>
+    {
+    public:
+        Task
+        get_return_object() noexcept
+        {
+            return Task{handle_type::from_promise(*this)};
+        }
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    Task(Task&& other) noexcept : h_(std::exchange(other.h_, {}))
+    {
+    }
+
+    Task&
+    operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (h_)
+                h_.destroy();
+            h_ = std::exchange(other.h_, {});
+        }
+        return *this;
+    }
+
+    ~Task()
+    {
+        if (h_)
+            h_.destroy();
+    }
+
+    auto operator co_await() && noexcept
+    {
+        assert(h_);
+        return Awaiter{h_};
+    }
+
+private:
+    struct Awaiter
+    {
+        handle_type h;
+
+        bool
+        await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template <class Promise>
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<Promise> awaiting) noexcept
+        {
+            h.promise().continuation_ = awaiting;
+            h.promise().lvs_ = awaiting.promise().localValues();
+            return h;
+        }
+
+        T
+        await_resume()
+        {
+            return h.promise().result();
+        }
+    };
+
+    explicit Task(handle_type h) noexcept : h_(h)
+    {
+    }
+
+    handle_type h_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,277 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_TASKINL_H_INCLUDED
+#define RIPPLE_CORE_TASKINL_H_INCLUDED
+
+#include <mutex>
+
+namespace ripple {
+
+namespace detail {
+
+// The coroutine which runs a Task posted to the JobQueue. It owns the
+// LocalValues of the job, and destroys itself when the Task returns.
+class PostedTask
+{
+public:
+    class promise_type
+    {
+        LocalValues lvs_;
+
+    public:
+        PostedTask
+        get_return_object() noexcept
+        {
+            return PostedTask{
+                std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always
+        initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never
+        final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void
+        return_void() const noexcept
+        {
+        }
+
+        // Like an exception thrown in a Coro, it escapes the job.
+        void
+        unhandled_exception() const
+        {
+            throw;
+        }
+
+        LocalValues*
+        localValues() noexcept
+        {
+            return &lvs_;
+        }
+    };
+
+    std::coroutine_handle<promise_type> h;
+};
+
+inline PostedTask
+postedTask(Task<> task)
+{
+    co_await std::move(task);
+}
+
+class JobAwaiter
+{
+    JobQueue& jq_;
+    JobType type_;
+    std::string name_;
+    bool posted_ = false;
+
+public:
+    JobAwaiter(JobQueue& jq, JobType type, std::string const& name)
+        : jq_(jq), type_(type), name_(name)
+    {
+    }
+
+    bool
+    await_ready() const noexcept
+    {
+        return false;
+    }
+
+    template <class Promise>
+    bool
+    await_suspend(std::coroutine_handle<Promise> h)
+    {
+        // Once the job is added it may resume the Task, and destroy this
+        // awaiter, before addJob returns.
+        posted_ = true;
+        auto const lvs = h.promise().localValues();
+        if (jq_.addJob(type_, name_, [h, lvs]() { resumeWith(lvs, h); }))
+            return true;
+
+        // The job will not run.  Continue on this thread.
+        posted_ = false;
+        return false;
+    }
+
+    bool
+    await_resume() const noexcept
+    {
+        return posted_;
+    }
+};
+
+template <class F>
+class SuspendAwaiter
+{
+    JobQueue& jq_;
+    JobType type_;
+    std::string name_;
+    F f_;
+
+public:
+    template <class G>
+    SuspendAwaiter(JobQueue& jq, JobType type, std::string const& name, G&& f)
+        : jq_(jq), type_(type), name_(name), f_(std::forward<G>(f))
+    {
+    }
+
+    bool
+    await_ready() const noexcept
+    {
+        return false;
+    }
+
+    template <class Promise>
+    void
+    await_suspend(std::coroutine_handle<Promise> h)
+    {
+        {
+            std::lock_guard lock(jq_.m_mutex);
+            ++jq_.nSuspend_;
+        }
+
+        // The Task may be resumed, and this awaiter destroyed, before f
+        // returns. So f is moved out of it, and resume holds copies of
+        // everything else it needs.
+        auto f = std::move(f_);
+        f([&jq = jq_,
+           type = type_,
+           name = name_,
+           h,
+           lvs = h.promise().localValues()]() {
+            {
+                std::lock_guard lock(jq.m_mutex);
+                --jq.nSuspend_;
+            }
+            if (!jq.addJob(type, name, [h, lvs]() { resumeWith(lvs, h); }))
+            {
+                // The job will not run.  Continue on this thread so the
+                // Task can finish.  Otherwise the JobQueue would not stop.
+                resumeWith(lvs, h);
+            }
+        });
+    }
+
+    void
+    await_resume() const noexcept
+    {
+    }
+};
+
+template <class F>
+class CoroAwaiter
+{
+    JobQueue& jq_;
+    JobType type_;
+    std::string name_;
+    F f_;
+    bool ran_ = false;
+
+public:
+    template <class G>
+    CoroAwaiter(JobQueue& jq, JobType type, std::string const& name, G&& f)
+        : jq_(jq), type_(type), name_(name), f_(std::forward<G>(f))
+    {
+    }
+
+    bool
+    await_ready() const noexcept
+    {
+        return false;
+    }
+
+    template <class Promise>
+    bool
+    await_suspend(std::coroutine_handle<Promise> h)
+    {
+        auto const lvs = h.promise().localValues();
+        auto const coro = jq_.postCoro(
+            type_,
+            name_,
+            [this, h, lvs](std::shared_ptr<JobQueue::Coro> const& coro) {
+                f_(coro);
+                ran_ = true;
+
+                // Continue the Task in a job of its own rather than on the
+                // stack of the Coro, unless the JobQueue is stopping.
+                if (!jq_.addJob(type_, name_, [h, lvs]() {
+                        resumeWith(lvs, h);
+                    }))
+                    resumeWith(lvs, h);
+            });
+        return coro != nullptr;
+    }
+
+    bool
+    await_resume() const noexcept
+    {
+        return ran_;
+    }
+};
+
+}  // namespace detail
+
+inline bool
+JobQueue::postTask(JobType t, std::string const& name, Task<> task)
+{
+    auto const h = detail::postedTask(std::move(task)).h;
+    if (addJob(t, name, [h]() {
+            detail::resumeWith(h.promise().localValues(), h);
+        }))
+        return true;
+
+    // The job will not run.  Destroying the coroutine destroys the Task.
+    h.destroy();
+    return false;
+}
+
+inline auto
+JobQueue::schedule(JobType t, std::string const& name)
+{
+    return detail::JobAwaiter(*this, t, name);
+}
+
+template <class F>
+auto
+JobQueue::suspend(JobType t, std::string const& name, F&& f)
+{
+    return detail::SuspendAwaiter<std::decay_t<F>>(
+        *this, t, name, std::forward<F>(f));
+}
+
+template <class F>
+auto
+JobQueue::awaitCoro(JobType t, std::string const& name, F&& f)
+{
+    return detail::CoroAwaiter<std::decay_t<F>>(
+        *this, t, name, std::forward<F>(f));
+}
+
+}  // namespace ripple
+
+#endif
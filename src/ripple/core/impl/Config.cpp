@@ -675,6 +675,15 @@ Config::loadFromString(std::string const& fileContents)
                                       ": must be between 10 and 600 inclusive");
     }
 
+    if (getSingleSection(secConfig, SECTION_MEMORY_BUDGET, strTemp, j_))
+    {
+        MEMORY_BUDGET = beast::lexicalCastThrow<std::uint64_t>(strTemp);
+
+        if (*MEMORY_BUDGET < 256)
+            Throw<std::runtime_error>(
+                "Invalid " SECTION_MEMORY_BUDGET ": must be at least 256");
+    }
+
     if (getSingleSection(secConfig, SECTION_WORKERS, strTemp, j_))
     {
         WORKERS = beast::lexicalCastThrow<int>(strTemp);
@@ -38,10 +38,8 @@ private:
     DigestAwareReadView const& base_;
     CachedSLEs& cache_;
     std::mutex mutable mutex_;
-    std::unordered_map<
-        key_type,
-        std::shared_ptr<SLE const>,
-        hardened_hash<>> mutable map_;
+    std::unordered_map<key_type, std::shared_ptr<SLE const>, digest_hash>
+        mutable map_;
 
 public:
     CachedViewImpl() = delete;
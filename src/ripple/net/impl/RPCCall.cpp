@@ -732,6 +732,28 @@ private:
         return jvRequest;
     }
 
+    // ledger_export <path> [<ledger>] [<partitions>]
+    Json::Value
+    parseLedgerExport(Json::Value const& jvParams)
+    {
+        Json::Value jvRequest{Json::objectValue};
+        jvRequest[jss::path] = jvParams[0u].asString();
+
+        if (jvParams.size() > 1)
+            jvParseLedger(jvRequest, jvParams[1u].asString());
+
+        if (jvParams.size() > 2)
+        {
+            std::uint32_t partitions;
+            if (!beast::lexicalCastChecked(
+                    partitions, jvParams[2u].asString()))
+                return rpcError(rpcINVALID_PARAMS);
+            jvRequest[jss::partitions] = partitions;
+        }
+
+        return jvRequest;
+    }
+
     // ledger_header <id>|<index>
     Json::Value
     parseLedgerId(Json::Value const& jvParams)
@@ -1051,6 +1073,26 @@ private:
         return rpcError(rpcINVALID_PARAMS);
     }
 
+    // trace [on|off]
+    Json::Value
+    parseTrace(Json::Value const& jvParams)
+    {
+        Json::Value jvRequest{Json::objectValue};
+
+        if (jvParams.size() == 1)
+        {
+            auto const param = jvParams[0u].asString();
+            if (param == "on")
+                jvRequest[jss::enabled] = true;
+            else if (param == "off")
+                jvRequest[jss::enabled] = false;
+            else
+                return rpcError(rpcINVALID_PARAMS);
+        }
+
+        return jvRequest;
+    }
+
     // transaction_entry <tx_hash> <ledger_hash/ledger_index>
     Json::Value
     parseTransactionEntry(Json::Value const& jvParams)
@@ -1258,6 +1300,7 @@ public:
             {"ledger_current", &RPCParser::parseAsIs, 0, 0},
             //      {   "ledger_entry",         &RPCParser::parseLedgerEntry,
             //      -1, -1   },
+            {"ledger_export", &RPCParser::parseLedgerExport, 1, 3},
             {"ledger_header", &RPCParser::parseLedgerId, 1, 1},
             {"ledger_request", &RPCParser::parseLedgerId, 1, 1},
             {"log_level", &RPCParser::parseLogLevel, 0, 2},
@@ -1289,6 +1332,7 @@ public:
             {"server_state", &RPCParser::parseServerInfo, 0, 1},
             {"crawl_shards", &RPCParser::parseAsIs, 0, 2},
             {"stop", &RPCParser::parseAsIs, 0, 0},
+            {"trace", &RPCParser::parseTrace, 0, 1},
             {"transaction_entry", &RPCParser::parseTransactionEntry, 2, 2},
             {"tx", &RPCParser::parseTx, 1, 4},
             {"tx_account", &RPCParser::parseTxAccount, 1, 7},
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_NODESTORE_BACKEND_H_INCLUDED
 #define RIPPLE_NODESTORE_BACKEND_H_INCLUDED
 
+#include <ripple/json/json_forwards.h>
 #include <ripple/nodestore/Types.h>
 #include <atomic>
 #include <cstdint>
@@ -185,6 +186,15 @@ public:
     {
         return std::nullopt;
     }
+
+    /** Add backend specific statistics to a get_counts report.
+
+        @param obj Json object reference into which to place counters.
+    */
+    virtual void
+    getCountsJson(Json::Value& obj) const
+    {
+    }
 };
 
 }  // namespace NodeStore
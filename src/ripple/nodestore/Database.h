@@ -403,6 +403,15 @@ private:
         return std::nullopt;
     }
 
+    /** Add implementation specific statistics to a get_counts report.
+
+        @param obj Json object reference into which to place counters.
+    */
+    virtual void
+    getCountsJsonImpl(Json::Value& obj) const
+    {
+    }
+
     void
     threadEntry();
 };
@@ -34,8 +34,8 @@ enum {
     batchWritePreallocationSize = 256,
 
     // This sets a limit on the maximum number of writes
-    // in a batch. Actual usage can be twice this since
-    // we have a new batch growing as we write the old.
+    // in a batch, and by default on the number of writes
+    // waiting for a batch.
     //
     batchWriteLimitSize = 65536
 };
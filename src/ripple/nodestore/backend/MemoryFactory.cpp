@@ -84,6 +84,7 @@ private:
     std::string name_;
     beast::Journal const journal_;
     MemoryDB* db_{nullptr};
+    bool deletePath_{false};
 
 public:
     MemoryBackend(
@@ -123,6 +124,11 @@ public:
     void
     close() override
     {
+        if (db_ && deletePath_)
+        {
+            std::lock_guard _(db_->mutex);
+            db_->table.clear();
+        }
         db_ = nullptr;
     }
 
@@ -201,6 +207,7 @@ public:
     void
     setDeletePath() override
     {
+        deletePath_ = true;
     }
 
     int
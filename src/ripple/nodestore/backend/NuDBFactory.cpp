@@ -20,22 +20,31 @@
 #include <ripple/basics/contract.h>
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/Task.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/Dictionaries.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
 #include <ripple/nodestore/impl/codec.h>
 #include <boost/filesystem.hpp>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <exception>
 #include <memory>
+#include <mutex>
 #include <nudb/nudb.hpp>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace ripple {
 namespace NodeStore {
 
-class NuDBBackend : public Backend
+class NuDBBackend : public Backend, private Task
 {
 public:
     static constexpr std::uint64_t currentType = 1;
@@ -52,6 +61,20 @@ public:
     std::atomic<bool> deletePath_;
     Scheduler& scheduler_;
 
+    // Compression dictionaries. Every set ever used is kept alive, since
+    // a reader may still be using an older one.
+    bool const trainDictionaries_;
+    std::atomic<Dictionaries const*> dictionaries_{nullptr};
+    std::atomic<bool> training_{false};
+    std::mutex trainMutex_;
+    std::condition_variable trainCondition_;
+    std::optional<DictionaryTrainer> trainer_;
+    std::vector<std::unique_ptr<Dictionaries const>> generations_;
+
+    // Samples waiting for the scheduler to train a dictionary on them
+    std::vector<std::pair<NodeObjectType, std::vector<Blob>>> untrained_;
+    bool trainScheduled_ = false;
+
     NuDBBackend(
         size_t keyBytes,
         Section const& keyValues,
@@ -64,6 +87,9 @@ public:
         , name_(get(keyValues, "path"))
         , deletePath_(false)
         , scheduler_(scheduler)
+        , trainDictionaries_(
+              keyValues.exists("compression_dictionaries") &&
+              get<bool>(keyValues, "compression_dictionaries"))
     {
         if (name_.empty())
             Throw<std::runtime_error>(
@@ -84,6 +110,9 @@ public:
         , db_(context)
         , deletePath_(false)
         , scheduler_(scheduler)
+        , trainDictionaries_(
+              keyValues.exists("compression_dictionaries") &&
+              get<bool>(keyValues, "compression_dictionaries"))
     {
         if (name_.empty())
             Throw<std::runtime_error>(
@@ -161,6 +190,7 @@ public:
             (db_.appnum() & deterministicMask) != deterministicType)
             Throw<std::runtime_error>("nodestore: unknown appnum");
         db_.set_burst(burstSize_);
+        loadDictionaries();
     }
 
     bool
@@ -178,6 +208,7 @@ public:
     void
     close() override
     {
+        waitForTraining();
         if (db_.is_open())
         {
             nudb::error_code ec;
@@ -209,9 +240,15 @@ public:
         nudb::error_code ec;
         db_.fetch(
             key,
-            [key, pno, &status](void const* data, std::size_t size) {
+            [this, key, pno, &status](void const* data, std::size_t size) {
+                // The object may have been stored with a dictionary that
+                // was published after the fetch began
                 nudb::detail::buffer bf;
-                auto const result = nodeobject_decompress(data, size, bf);
+                auto const result = nodeobject_decompress(
+                    data,
+                    size,
+                    bf,
+                    dictionaries_.load(std::memory_order_acquire));
                 DecodedBlob decoded(key, result.first, result.second);
                 if (!decoded.wasOk())
                 {
@@ -253,10 +290,169 @@ public:
         EncodedBlob e(no);
         nudb::error_code ec;
         nudb::detail::buffer bf;
-        auto const result = nodeobject_compress(e.getData(), e.getSize(), bf);
+        auto const result = nodeobject_compress(
+            e.getData(),
+            e.getSize(),
+            bf,
+            dictionaries_.load(std::memory_order_acquire));
         db_.insert(e.getKey(), result.first, result.second, ec);
         if (ec && ec != nudb::error::key_exists)
             Throw<nudb::system_error>(ec);
+
+        if (training_.load(std::memory_order_relaxed))
+            train(e);
+    }
+
+    // Make a set of dictionaries the one used from now on
+    void
+    publish(std::unique_ptr<Dictionaries const> dictionaries)
+    {
+        dictionaries_.store(dictionaries.get(), std::memory_order_release);
+        generations_.push_back(std::move(dictionaries));
+    }
+
+    // Read the dictionaries stored in the database
+    void
+    loadDictionaries()
+    {
+        std::lock_guard lock(trainMutex_);
+        auto dictionaries = std::make_unique<Dictionaries const>();
+        for (;;)
+        {
+            auto const id = dictionaries->nextId();
+            auto const key = Dictionary::key(id);
+            std::shared_ptr<Dictionary const> dictionary;
+            nudb::error_code ec;
+            db_.fetch(
+                key.data(),
+                [&key, &dictionary](void const* data, std::size_t size) {
+                    nudb::detail::buffer bf;
+                    auto const result = nodeobject_decompress(data, size, bf);
+                    DecodedBlob decoded(
+                        key.data(), result.first, result.second);
+                    if (!decoded.wasOk())
+                        return;
+                    dictionary = Dictionary::parse(
+                        makeSlice(decoded.createObject()->getData()));
+                },
+                ec);
+            if (ec == nudb::error::key_not_found)
+                break;
+            if (ec)
+                Throw<nudb::system_error>(ec);
+            if (!dictionary || dictionary->id() != id)
+                Throw<std::runtime_error>(
+                    "nodestore: corrupt dictionary " + std::to_string(id));
+            dictionaries = std::make_unique<Dictionaries const>(
+                dictionaries->add(std::move(dictionary)));
+        }
+
+        if (dictionaries->size() != 0)
+            JLOG(j_.info()) << name_ << ": loaded " << dictionaries->size()
+                            << " compression dictionaries";
+
+        // Deterministic shards must not contain anything but the ledgers
+        trainer_.reset();
+        if (trainDictionaries_ && db_.appnum() == currentType)
+        {
+            trainer_.emplace();
+            for (std::uint32_t id = 1; id <= dictionaries->size(); ++id)
+                trainer_->skip(dictionaries->find(id)->type());
+        }
+        training_ = trainer_ && !trainer_->done();
+
+        publish(std::move(dictionaries));
+    }
+
+    // Sample an object, and have the scheduler train a dictionary once
+    // there are enough samples. Objects stored while another thread is
+    // sampling are not sampled.
+    void
+    train(EncodedBlob const& e)
+    {
+        {
+            std::unique_lock lock(trainMutex_, std::try_to_lock);
+            if (!lock.owns_lock() || !trainer_)
+                return;
+
+            auto samples = trainer_->sample(e.getData(), e.getSize());
+            if (trainer_->done())
+                training_ = false;
+            if (!samples)
+                return;
+
+            untrained_.push_back(std::move(*samples));
+            if (trainScheduled_)
+                return;
+            trainScheduled_ = true;
+        }
+        scheduler_.scheduleTask(*this);
+    }
+
+    // Train dictionaries on the samples collected, and store them
+    void
+    performScheduledTask() override
+    {
+        std::unique_lock lock(trainMutex_);
+        while (!untrained_.empty())
+        {
+            auto [type, samples] = std::move(untrained_.back());
+            untrained_.pop_back();
+
+            lock.unlock();
+            auto data = trainer_->train(samples);
+            lock.lock();
+
+            if (data.empty())
+            {
+                JLOG(j_.warn()) << name_ << ": can't train a compression "
+                                << "dictionary for type " << type;
+                continue;
+            }
+
+            auto const current =
+                dictionaries_.load(std::memory_order_relaxed);
+            auto dictionary = std::make_shared<Dictionary const>(
+                current->nextId(), type, std::move(data));
+
+            // NuDB writes inserts in order, so the dictionary is in the
+            // database before any object compressed with it.
+            auto const object = NodeObject::createObject(
+                hotUNKNOWN,
+                dictionary->serialize(),
+                Dictionary::key(dictionary->id()));
+            EncodedBlob encoded(object);
+            nudb::detail::buffer bf;
+            auto const result =
+                nodeobject_compress(encoded.getData(), encoded.getSize(), bf);
+            nudb::error_code ec;
+            db_.insert(encoded.getKey(), result.first, result.second, ec);
+            if (ec)
+            {
+                // The objects are still compressed without a dictionary
+                JLOG(j_.error()) << name_ << ": can't store compression "
+                                 << "dictionary: " << ec.message();
+                continue;
+            }
+
+            JLOG(j_.info()) << name_ << ": trained compression dictionary "
+                            << dictionary->id() << " for type "
+                            << dictionary->type() << ", "
+                            << dictionary->data().size() << " bytes";
+
+            publish(std::make_unique<Dictionaries const>(
+                current->add(std::move(dictionary))));
+        }
+        trainScheduled_ = false;
+        trainCondition_.notify_all();
+    }
+
+    // Wait until the dictionaries scheduled to be trained are stored
+    void
+    waitForTraining()
+    {
+        std::unique_lock lock(trainMutex_);
+        trainCondition_.wait(lock, [this] { return !trainScheduled_; });
     }
 
     void
@@ -296,6 +492,12 @@ public:
         auto const kp = db_.key_path();
         auto const lp = db_.log_path();
         // auto const appnum = db_.appnum();
+        waitForTraining();
+        auto const dictionaries =
+            dictionaries_.load(std::memory_order_acquire);
+        std::vector<uint256> dictionaryKeys;
+        for (std::uint32_t id = 1; id <= dictionaries->size(); ++id)
+            dictionaryKeys.push_back(Dictionary::key(id));
         nudb::error_code ec;
         db_.close(ec);
         if (ec)
@@ -307,8 +509,15 @@ public:
                 void const* data,
                 std::size_t size,
                 nudb::error_code&) {
+                // The dictionaries belong to this database only
+                for (auto const& k : dictionaryKeys)
+                {
+                    if (std::memcmp(key, k.data(), k.size()) == 0)
+                        return;
+                }
                 nudb::detail::buffer bf;
-                auto const result = nodeobject_decompress(data, size, bf);
+                auto const result =
+                    nodeobject_decompress(data, size, bf, dictionaries);
                 DecodedBlob decoded(key, result.first, result.second);
                 if (!decoded.wasOk())
                 {
@@ -344,6 +553,7 @@ public:
         auto const dp = db_.dat_path();
         auto const kp = db_.key_path();
         auto const lp = db_.log_path();
+        waitForTraining();
         nudb::error_code ec;
         db_.close(ec);
         if (ec)
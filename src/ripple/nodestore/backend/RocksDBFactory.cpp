@@ -420,6 +420,12 @@ public:
         return m_batch.getWriteLoad();
     }
 
+    void
+    getCountsJson(Json::Value& obj) const override
+    {
+        m_batch.getCountsJson(obj);
+    }
+
     void
     setDeletePath() override
     {
@@ -0,0 +1,1380 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/Factory.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/Task.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <boost/endian/conversion.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ripple {
+namespace NodeStore {
+
+/*  A segment is an immutable file of node objects, read through a memory
+    mapping. Its layout is:
+
+        header          64 bytes
+        displacements   one 32-bit value per bucket
+        filter          blocks of 64 bytes, aligned to 64 bytes
+        index           one 64-bit record offset per object
+        records         in key order: the key, the 32-bit size of the
+                        value, and the value in the EncodedBlob format
+
+    Integers are little-endian. The index is a minimal perfect hash built
+    with "hash and displace": a key hashes to a bucket, and the bucket's
+    displacement chooses which hash of the key picks its slot in the
+    index. Every slot holds exactly one object, so the index has no empty
+    slots and costs eight bytes an object. A key that is not in the
+    segment still lands on some slot, and the key of the record there
+    tells the two apart.
+
+    The filter is a blocked Bloom filter of the keys, like NegativeFilter,
+    so that a fetch only reads the index and records of the segments that
+    may hold its key.
+
+    Objects that are not in a segment yet are appended to a log, made of
+    a magic number and records in the same format, so that they survive a
+    crash.
+*/
+namespace segment {
+
+constexpr std::array<char, 8> magic = {'X', 'R', 'P', 'L', 'S', 'E', 'G', '2'};
+constexpr std::array<char, 8> logMagic =
+    {'X', 'R', 'P', 'L', 'L', 'O', 'G', '1'};
+constexpr std::size_t headerBytes = 64;
+constexpr std::size_t keyBytes = 32;
+constexpr std::size_t recordHeaderBytes = keyBytes + 4;
+
+// The average number of keys in a bucket. More keys in a bucket make the
+// displacements smaller, but each harder to find.
+constexpr std::uint64_t bucketKeys = 4;
+
+// How many displacements to try for a bucket before choosing a new seed
+constexpr std::uint32_t maxDisplacement = 1 << 24;
+
+// About ten filter bits and seven hashes a key let through one key in a
+// hundred that is not in the segment.
+constexpr std::uint64_t filterBlockBytes = 64;
+constexpr std::uint64_t filterBlockBits = filterBlockBytes * 8;
+constexpr std::uint64_t filterBitsPerKey = 10;
+constexpr std::uint32_t filterHashes = 7;
+
+// The finalizer of MurmurHash3
+inline std::uint64_t
+mix(std::uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline std::uint64_t
+load64(std::uint8_t const* p)
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return boost::endian::little_to_native(v);
+}
+
+inline std::uint32_t
+load32(std::uint8_t const* p)
+{
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return boost::endian::little_to_native(v);
+}
+
+template <class T>
+void
+put(std::vector<std::uint8_t>& out, T v)
+{
+    v = boost::endian::native_to_little(v);
+    auto const p = reinterpret_cast<std::uint8_t const*>(&v);
+    out.insert(out.end(), p, p + sizeof(v));
+}
+
+// Keys are digests, so their words are already well mixed
+inline std::uint64_t
+bucketOf(std::uint8_t const* key, std::uint64_t seed, std::uint64_t buckets)
+{
+    return mix(load64(key) ^ seed) % buckets;
+}
+
+inline std::uint64_t
+slotOf(
+    std::uint8_t const* key,
+    std::uint64_t seed,
+    std::uint32_t displacement,
+    std::uint64_t slots)
+{
+    return mix(
+               load64(key + 8) ^
+               mix(load64(key + 16) ^ seed ^
+                   (displacement * 0x9e3779b97f4a7c15ULL))) %
+        slots;
+}
+
+// The filter bits of a key: its block, then a start and an odd step that
+// visit distinct bits of the block.
+struct FilterBits
+{
+    std::uint64_t block;
+    std::uint64_t h1;
+    std::uint64_t h2;
+};
+
+inline FilterBits
+filterBitsOf(std::uint8_t const* key, std::uint64_t seed, std::uint64_t blocks)
+{
+    auto const h = mix(load64(key + 24) ^ seed);
+    return {h % blocks, mix(h), mix(h ^ seed) | 1};
+}
+
+// Returns false if the key is definitely not in the filter
+inline bool
+filterMayContain(
+    std::uint8_t const* filter,
+    std::uint64_t blocks,
+    std::uint64_t seed,
+    std::uint8_t const* key)
+{
+    auto const [block, h1, h2] = filterBitsOf(key, seed, blocks);
+    auto const bits = filter + block * filterBlockBytes;
+    for (std::uint32_t i = 0; i < filterHashes; ++i)
+    {
+        auto const bit = (h1 + i * h2) % filterBlockBits;
+        if ((bits[bit / 8] & (1 << (bit % 8))) == 0)
+            return false;
+    }
+    return true;
+}
+
+inline void
+filterInsert(
+    std::vector<std::uint8_t>& filter,
+    std::uint64_t seed,
+    std::uint8_t const* key)
+{
+    auto const blocks = filter.size() / filterBlockBytes;
+    auto const [block, h1, h2] = filterBitsOf(key, seed, blocks);
+    auto const bits = filter.data() + block * filterBlockBytes;
+    for (std::uint32_t i = 0; i < filterHashes; ++i)
+    {
+        auto const bit = (h1 + i * h2) % filterBlockBits;
+        bits[bit / 8] |= 1 << (bit % 8);
+    }
+}
+
+// Flush a file to the disk
+inline bool
+syncFile(std::FILE* f)
+{
+    if (std::fflush(f) != 0)
+        return false;
+#ifdef _MSC_VER
+    return _commit(_fileno(f)) == 0;
+#else
+    return ::fsync(::fileno(f)) == 0;
+#endif
+}
+
+// Find a displacement for every bucket that gives every key its own slot,
+// or nothing if the seed does not allow one.
+std::optional<std::vector<std::uint32_t>>
+displace(
+    std::vector<std::uint8_t const*> const& keys,
+    std::uint64_t seed,
+    std::uint64_t buckets)
+{
+    auto const count = keys.size();
+
+    // Group the keys by bucket
+    std::vector<std::uint64_t> bucket(count);
+    std::vector<std::uint32_t> start(buckets + 1, 0);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        bucket[i] = bucketOf(keys[i], seed, buckets);
+        ++start[bucket[i] + 1];
+    }
+    for (std::uint64_t b = 0; b < buckets; ++b)
+        start[b + 1] += start[b];
+    std::vector<std::uint32_t> members(count);
+    {
+        auto next = start;
+        for (std::size_t i = 0; i < count; ++i)
+            members[next[bucket[i]]++] = i;
+    }
+
+    // Place the largest buckets first, while most slots are free
+    std::vector<std::uint32_t> order(buckets);
+    for (std::uint64_t b = 0; b < buckets; ++b)
+        order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) {
+        return start[a + 1] - start[a] > start[b + 1] - start[b];
+    });
+
+    std::vector<std::uint32_t> displacements(buckets, 0);
+    std::vector<bool> taken(count, false);
+    std::vector<std::uint64_t> slots;
+    for (auto const b : order)
+    {
+        if (start[b + 1] == start[b])
+            break;
+
+        bool placed = false;
+        for (std::uint32_t d = 0; d < maxDisplacement && !placed; ++d)
+        {
+            slots.clear();
+            placed = true;
+            for (auto i = start[b]; i < start[b + 1]; ++i)
+            {
+                auto const s = slotOf(keys[members[i]], seed, d, count);
+                if (taken[s] ||
+                    std::find(slots.begin(), slots.end(), s) != slots.end())
+                {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(s);
+            }
+            if (placed)
+            {
+                for (auto const s : slots)
+                    taken[s] = true;
+                displacements[b] = d;
+            }
+        }
+        if (!placed)
+            return std::nullopt;
+    }
+    return displacements;
+}
+
+// Call a function with each record in a buffer, in order. Returns the
+// number of bytes in complete records.
+template <class Function>
+std::uint64_t
+for_each_record(std::uint8_t const* data, std::uint64_t size, Function&& f)
+{
+    std::uint64_t offset = 0;
+    while (size - offset >= recordHeaderBytes)
+    {
+        auto const value = load32(data + offset + keyBytes);
+        if (value > size - offset - recordHeaderBytes)
+            break;
+        f(data + offset, data + offset + recordHeaderBytes, value);
+        offset += recordHeaderBytes + value;
+    }
+    return offset;
+}
+
+// A segment file, mapped into memory
+class Segment
+{
+public:
+    explicit Segment(boost::filesystem::path const& path) : path_(path)
+    {
+        using namespace boost::interprocess;
+
+        // The mapping outlives the file handle
+        file_mapping file(path.string().c_str(), read_only);
+        region_ = mapped_region(file, read_only);
+        base_ = static_cast<std::uint8_t const*>(region_.get_address());
+        size_ = region_.get_size();
+
+        if (size_ < headerBytes ||
+            !std::equal(magic.begin(), magic.end(), base_))
+            Throw<std::runtime_error>(
+                "nodestore: not a segment: " + path.string());
+
+        count_ = load64(base_ + 8);
+        buckets_ = load64(base_ + 16);
+        seed_ = load64(base_ + 24);
+        auto const filterOffset = load64(base_ + 32);
+        auto const indexOffset = load64(base_ + 40);
+        records_ = load64(base_ + 48);
+
+        if (load64(base_ + 56) != size_ || buckets_ == 0 ||
+            buckets_ > size_ / 4 || count_ > size_ / 8 ||
+            filterOffset < headerBytes + buckets_ * 4 ||
+            filterOffset % filterBlockBytes != 0 ||
+            indexOffset <= filterOffset ||
+            (indexOffset - filterOffset) % filterBlockBytes != 0 ||
+            indexOffset > size_ || records_ != indexOffset + count_ * 8 ||
+            records_ > size_)
+            Throw<std::runtime_error>(
+                "nodestore: corrupt segment: " + path.string());
+
+        displacements_ = base_ + headerBytes;
+        filter_ = base_ + filterOffset;
+        filterBlocks_ = (indexOffset - filterOffset) / filterBlockBytes;
+        index_ = base_ + indexOffset;
+
+        // Tell the kernel that reads will be scattered
+        region_.advise(mapped_region::advice_random);
+    }
+
+    Segment(Segment const&) = delete;
+    Segment&
+    operator=(Segment const&) = delete;
+
+    ~Segment()
+    {
+        if (!retired_)
+            return;
+
+        // Unmap the file before removing it, which Windows requires
+        boost::interprocess::mapped_region().swap(region_);
+        boost::system::error_code ec;
+        boost::filesystem::remove(path_, ec);
+    }
+
+    boost::filesystem::path const&
+    path() const
+    {
+        return path_;
+    }
+
+    std::uint64_t
+    count() const
+    {
+        return count_;
+    }
+
+    /** Remove the file once the last user lets go of the segment. */
+    void
+    retire() const
+    {
+        retired_ = true;
+    }
+
+    /** Returns the value stored for a key, if any. */
+    std::optional<std::pair<std::uint8_t const*, std::uint32_t>>
+    find(std::uint8_t const* key) const
+    {
+        if (count_ == 0 ||
+            !filterMayContain(filter_, filterBlocks_, seed_, key))
+            return std::nullopt;
+
+        auto const bucket = bucketOf(key, seed_, buckets_);
+        auto const displacement = load32(displacements_ + bucket * 4);
+        auto const slot = slotOf(key, seed_, displacement, count_);
+        auto const offset = load64(index_ + slot * 8);
+
+        auto const record = record_at(offset);
+        if (!record || std::memcmp(key, record->first, keyBytes) != 0)
+            return std::nullopt;
+        return std::make_pair(
+            record->first + recordHeaderBytes, record->second);
+    }
+
+    /** Call a function with each key and value, in key order. */
+    template <class Function>
+    void
+    for_each(Function&& f) const
+    {
+        auto const size = size_ - records_;
+        if (for_each_record(base_ + records_, size, f) != size)
+            Throw<std::runtime_error>(
+                "nodestore: corrupt segment: " + path_.string());
+    }
+
+private:
+    // The key and value size of the record at an offset
+    std::optional<std::pair<std::uint8_t const*, std::uint32_t>>
+    record_at(std::uint64_t offset) const
+    {
+        if (offset < records_ || offset > size_ - recordHeaderBytes)
+            return std::nullopt;
+        auto const size = load32(base_ + offset + keyBytes);
+        if (size > size_ - offset - recordHeaderBytes)
+            return std::nullopt;
+        return std::make_pair(base_ + offset, size);
+    }
+
+    boost::filesystem::path const path_;
+    boost::interprocess::mapped_region region_;
+    std::uint8_t const* base_;
+    std::uint64_t size_;
+    std::uint64_t count_;
+    std::uint64_t buckets_;
+    std::uint64_t seed_;
+    std::uint64_t records_;
+    std::uint8_t const* displacements_;
+    std::uint8_t const* filter_;
+    std::uint64_t filterBlocks_;
+    std::uint8_t const* index_;
+    mutable std::atomic<bool> retired_{false};
+};
+
+using Objects = std::map<uint256, std::shared_ptr<NodeObject>>;
+
+// A record to write: a key, and its value in the EncodedBlob format
+struct Record
+{
+    std::uint8_t const* key;
+    std::uint8_t const* value;
+    std::uint32_t size;
+};
+
+// Write records, in key order and with no key twice, to a new segment file,
+// which appears under its name only once it is complete and durable.
+void
+write(boost::filesystem::path const& path, std::vector<Record> const& records)
+{
+    std::vector<std::uint8_t const*> keys;
+    keys.reserve(records.size());
+    for (auto const& r : records)
+        keys.push_back(r.key);
+
+    auto const count = static_cast<std::uint64_t>(keys.size());
+    auto const buckets = std::max<std::uint64_t>(
+        1, (count + bucketKeys - 1) / bucketKeys);
+
+    std::uint64_t seed = 0;
+    std::optional<std::vector<std::uint32_t>> displacements;
+    for (std::uint64_t attempt = 1; !displacements; ++attempt)
+    {
+        if (attempt > 16)
+            Throw<std::runtime_error>(
+                "nodestore: no perfect hash for segment " + path.string());
+        seed = mix(attempt * 0x9e3779b97f4a7c15ULL);
+        displacements = displace(keys, seed, buckets);
+    }
+
+    auto const filterBlocks = std::max<std::uint64_t>(
+        1,
+        (count * filterBitsPerKey + filterBlockBits - 1) / filterBlockBits);
+    auto const filterOffset = (headerBytes + buckets * 4 + filterBlockBytes -
+                               1) /
+        filterBlockBytes * filterBlockBytes;
+    auto const indexOffset = filterOffset + filterBlocks * filterBlockBytes;
+    auto const recordsOffset = indexOffset + count * 8;
+
+    // Records are laid out in key order
+    std::vector<std::uint64_t> index(count);
+    std::vector<std::uint8_t> filter(filterBlocks * filterBlockBytes, 0);
+    auto size = recordsOffset;
+    for (auto const& r : records)
+    {
+        auto const b = bucketOf(r.key, seed, buckets);
+        index[slotOf(r.key, seed, (*displacements)[b], count)] = size;
+        filterInsert(filter, seed, r.key);
+        size += recordHeaderBytes + r.size;
+    }
+
+    std::vector<std::uint8_t> head;
+    head.reserve(recordsOffset);
+    head.insert(head.end(), magic.begin(), magic.end());
+    put(head, count);
+    put(head, buckets);
+    put(head, seed);
+    put(head, static_cast<std::uint64_t>(filterOffset));
+    put(head, static_cast<std::uint64_t>(indexOffset));
+    put(head, static_cast<std::uint64_t>(recordsOffset));
+    put(head, static_cast<std::uint64_t>(size));
+    for (auto const d : *displacements)
+        put(head, d);
+    head.resize(filterOffset, 0);
+    head.insert(head.end(), filter.begin(), filter.end());
+    for (auto const offset : index)
+        put(head, offset);
+
+    // The records are copied straight from where they are held, which may
+    // be other segments, rather than gathered in memory first.
+    auto const temp = boost::filesystem::path(path).replace_extension(".tmp");
+    std::FILE* f = std::fopen(temp.string().c_str(), "wb");
+    if (!f)
+        Throw<std::runtime_error>(
+            "nodestore: unable to create " + temp.string());
+    bool ok = std::fwrite(head.data(), 1, head.size(), f) == head.size();
+    for (auto it = records.begin(); ok && it != records.end(); ++it)
+    {
+        std::vector<std::uint8_t> length;
+        put(length, it->size);
+        ok = std::fwrite(it->key, 1, keyBytes, f) == keyBytes &&
+            std::fwrite(length.data(), 1, length.size(), f) ==
+                length.size() &&
+            std::fwrite(it->value, 1, it->size, f) == it->size;
+    }
+    ok = syncFile(f) && ok;
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok)
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove(temp, ec);
+        Throw<std::runtime_error>(
+            "nodestore: unable to write " + temp.string());
+    }
+
+    boost::filesystem::rename(temp, path);
+}
+
+// An append-only log of the objects that are not in a segment yet
+class Log
+{
+public:
+    explicit Log(boost::filesystem::path const& path)
+        : path_(path), file_(std::fopen(path.string().c_str(), "wb"))
+    {
+        if (!file_)
+            Throw<std::runtime_error>(
+                "nodestore: unable to create " + path.string());
+        if (std::fwrite(logMagic.data(), 1, logMagic.size(), file_) !=
+            logMagic.size())
+        {
+            std::fclose(file_);
+            Throw<std::runtime_error>(
+                "nodestore: unable to write " + path.string());
+        }
+    }
+
+    Log(Log const&) = delete;
+    Log&
+    operator=(Log const&) = delete;
+
+    ~Log()
+    {
+        std::fclose(file_);
+    }
+
+    boost::filesystem::path const&
+    path() const
+    {
+        return path_;
+    }
+
+    void
+    append(std::shared_ptr<NodeObject> const& object)
+    {
+        EncodedBlob const e(object);
+        std::vector<std::uint8_t> size;
+        put(size, static_cast<std::uint32_t>(e.getSize()));
+        if (std::fwrite(e.getKey(), 1, keyBytes, file_) != keyBytes ||
+            std::fwrite(size.data(), 1, size.size(), file_) != size.size() ||
+            std::fwrite(e.getData(), 1, e.getSize(), file_) != e.getSize())
+            Throw<std::runtime_error>(
+                "nodestore: unable to write " + path_.string());
+    }
+
+    /** Hand what was appended to the operating system. */
+    void
+    flush()
+    {
+        if (std::fflush(file_) != 0)
+            Throw<std::runtime_error>(
+                "nodestore: unable to write " + path_.string());
+    }
+
+    /** Make what was appended durable. */
+    void
+    sync()
+    {
+        if (!syncFile(file_))
+            Throw<std::runtime_error>(
+                "nodestore: unable to sync " + path_.string());
+    }
+
+    /** Call a function with each record in a log.
+
+        A record that was being appended when the server stopped is
+        ignored.
+
+        @return The number of records.
+    */
+    template <class Function>
+    static std::uint64_t
+    replay(boost::filesystem::path const& path, Function&& f)
+    {
+        auto const size = boost::filesystem::file_size(path);
+        std::vector<std::uint8_t> data(size);
+        std::FILE* file = std::fopen(path.string().c_str(), "rb");
+        if (!file)
+            Throw<std::runtime_error>(
+                "nodestore: unable to open " + path.string());
+        auto const read = std::fread(data.data(), 1, data.size(), file);
+        std::fclose(file);
+        if (read != data.size())
+            Throw<std::runtime_error>(
+                "nodestore: unable to read " + path.string());
+
+        // The log was being created
+        if (size < logMagic.size())
+            return 0;
+        if (!std::equal(logMagic.begin(), logMagic.end(), data.begin()))
+            Throw<std::runtime_error>(
+                "nodestore: not a segment log: " + path.string());
+
+        std::uint64_t records = 0;
+        for_each_record(
+            data.data() + logMagic.size(),
+            size - logMagic.size(),
+            [&](std::uint8_t const* key,
+                std::uint8_t const* value,
+                std::uint32_t bytes) {
+                f(key, value, bytes);
+                ++records;
+            });
+        return records;
+    }
+
+private:
+    boost::filesystem::path const path_;
+    std::FILE* const file_;
+};
+
+}  // namespace segment
+
+//------------------------------------------------------------------------------
+
+/*  A backend made of immutable, memory-mapped segment files.
+
+    Objects that are stored are appended to a log and kept in memory until
+    there are enough of them, and are then sealed into a new segment on
+    the scheduler's thread. Segments are never changed once written, but
+    are merged: once there are enough segments of about the same size,
+    they are replaced by one holding all their objects, so that there are
+    few segments to look through. A fetch checks the filter of each
+    segment, and reads the mapped index and record of only those that may
+    hold the key, without a system call or decompression. This suits
+    history that is read rarely and at random, such as a full-history
+    archive filled with an import.
+*/
+class SegmentBackend : public Backend, private Task
+{
+    using Segments = std::vector<std::shared_ptr<segment::Segment const>>;
+
+    // How many segments of about the same size are merged into one
+    static constexpr std::size_t mergeSegments = 8;
+
+    // The most objects a merged segment may have. Building its index takes
+    // about 50 bytes of memory an object.
+    static constexpr std::uint64_t maxMergeObjects = 1 << 24;
+
+    beast::Journal const j_;
+    std::string const name_;
+    std::size_t const segmentObjects_;
+    Scheduler& scheduler_;
+    std::atomic<bool> deletePath_{false};
+    bool open_ = false;
+
+    // Objects that are not in a segment yet, and the segments
+    std::mutex mutex_;
+    segment::Objects pending_;
+    std::shared_ptr<segment::Objects const> sealing_;
+    std::shared_ptr<Segments const> segments_;
+
+    std::condition_variable sealCondition_;
+    bool sealScheduled_ = false;
+
+    // The logs that hold the objects not in a segment yet. Held while
+    // objects are logged and then added, so that a seal takes objects
+    // along with the logs they are in. Taken before mutex_, and never
+    // needed to fetch, so fetches don't wait on the log's I/O.
+    std::mutex logMutex_;
+    std::unique_ptr<segment::Log> log_;
+    std::vector<boost::filesystem::path> logs_;
+    std::uint64_t nextLogId_ = 1;
+
+    // Serializes writing segments
+    std::mutex sealMutex_;
+    std::uint64_t nextId_ = 1;
+
+public:
+    SegmentBackend(
+        Section const& keyValues,
+        Scheduler& scheduler,
+        beast::Journal journal)
+        : j_(journal)
+        , name_(get(keyValues, "path"))
+        , segmentObjects_(std::max<std::size_t>(
+              get<std::size_t>(keyValues, "segment_objects", 250000),
+              1))
+        , scheduler_(scheduler)
+        , segments_(std::make_shared<Segments const>())
+    {
+        if (name_.empty())
+            Throw<std::runtime_error>(
+                "nodestore: Missing path in Segment backend");
+    }
+
+    ~SegmentBackend() override
+    {
+        try
+        {
+            close();
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.error()) << name_ << ": " << e.what();
+        }
+    }
+
+    std::string
+    getName() override
+    {
+        return name_;
+    }
+
+    void
+    open(bool createIfMissing) override
+    {
+        using namespace boost::filesystem;
+
+        if (open_)
+        {
+            assert(false);
+            JLOG(j_.error()) << "database is already open";
+            return;
+        }
+
+        path const folder(name_);
+        if (createIfMissing)
+            create_directories(folder);
+        else if (!is_directory(folder))
+            Throw<std::runtime_error>(
+                "nodestore: missing Segment directory " + name_);
+
+        std::vector<path> files;
+        std::vector<path> logs;
+        for (auto const& entry : directory_iterator(folder))
+        {
+            auto const& p = entry.path();
+            if (p.extension() == ".seg")
+                files.push_back(p);
+            else if (p.extension() == ".log")
+                logs.push_back(p);
+            else if (p.extension() == ".tmp")
+            {
+                // A segment that was being written when the server stopped
+                remove(p);
+            }
+        }
+        std::sort(files.begin(), files.end());
+        std::sort(logs.begin(), logs.end());
+
+        auto segments = std::make_shared<Segments>();
+        std::uint64_t objects = 0;
+        for (auto const& file : files)
+        {
+            segments->push_back(
+                std::make_shared<segment::Segment const>(file));
+            objects += segments->back()->count();
+        }
+
+        // Objects logged before the server stopped, which may also be in a
+        // segment if it stopped just after sealing them
+        segment::Objects pending;
+        std::vector<path> replayed;
+        std::uint64_t logged = 0;
+        for (auto const& log : logs)
+        {
+            auto const records = segment::Log::replay(
+                log,
+                [&](std::uint8_t const* key,
+                    std::uint8_t const* value,
+                    std::uint32_t size) {
+                    DecodedBlob decoded(key, value, size);
+                    if (!decoded.wasOk())
+                        Throw<std::runtime_error>(
+                            "nodestore: corrupt segment log " + log.string());
+                    auto object = decoded.createObject();
+                    pending.emplace(object->getHash(), std::move(object));
+                });
+            logged += records;
+
+            if (records == 0)
+                remove(log);
+            else
+                replayed.push_back(log);
+        }
+
+        {
+            std::lock_guard logLock(logMutex_);
+            logs_ = std::move(replayed);
+            nextLogId_ = logs.empty() ? 1 : idOf(logs.back()) + 1;
+
+            std::lock_guard lock(mutex_);
+            segments_ = std::move(segments);
+            pending_ = std::move(pending);
+        }
+        {
+            std::lock_guard lock(sealMutex_);
+            nextId_ = files.empty() ? 1 : idOf(files.back()) + 1;
+        }
+        open_ = true;
+
+        JLOG(j_.info()) << name_ << ": opened " << files.size()
+                        << " segments with " << objects << " objects, and "
+                        << logged << " logged objects";
+
+        schedule();
+    }
+
+    bool
+    isOpen() override
+    {
+        return open_;
+    }
+
+    void
+    close() override
+    {
+        if (!open_)
+            return;
+
+        waitForSealing();
+        seal();
+
+        {
+            std::lock_guard lock(mutex_);
+            segments_ = std::make_shared<Segments const>();
+        }
+        open_ = false;
+
+        if (deletePath_)
+            boost::filesystem::remove_all(name_);
+    }
+
+    Status
+    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override
+    {
+        pObject->reset();
+
+        std::shared_ptr<Segments const> segments;
+        {
+            uint256 const hash(uint256::fromVoid(key));
+            std::lock_guard lock(mutex_);
+            if (auto const it = pending_.find(hash); it != pending_.end())
+            {
+                *pObject = it->second;
+                return ok;
+            }
+            if (sealing_)
+            {
+                if (auto const it = sealing_->find(hash); it != sealing_->end())
+                {
+                    *pObject = it->second;
+                    return ok;
+                }
+            }
+            segments = segments_;
+        }
+
+        // Segments are in the order their objects were stored, and recent
+        // objects are the ones fetched most
+        auto const k = static_cast<std::uint8_t const*>(key);
+        for (auto it = segments->rbegin(); it != segments->rend(); ++it)
+        {
+            if (auto const value = (*it)->find(k))
+            {
+                DecodedBlob decoded(key, value->first, value->second);
+                if (!decoded.wasOk())
+                    return dataCorrupt;
+                *pObject = decoded.createObject();
+                return ok;
+            }
+        }
+        return notFound;
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
+    fetchBatch(std::vector<uint256 const*> const& hashes) override
+    {
+        std::vector<std::shared_ptr<NodeObject>> results;
+        results.reserve(hashes.size());
+        for (auto const& h : hashes)
+        {
+            std::shared_ptr<NodeObject> nObj;
+            Status status = fetch(h->begin(), &nObj);
+            if (status != ok)
+                results.push_back({});
+            else
+                results.push_back(nObj);
+        }
+
+        return {results, ok};
+    }
+
+    void
+    store(std::shared_ptr<NodeObject> const& object) override
+    {
+        if (add(Batch{object}))
+            schedule();
+    }
+
+    void
+    storeBatch(Batch const& batch) override
+    {
+        if (add(batch))
+            schedule();
+    }
+
+    void
+    sync() override
+    {
+        std::lock_guard lock(logMutex_);
+        if (log_)
+            log_->sync();
+    }
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
+    {
+        waitForSealing();
+        seal();
+
+        std::shared_ptr<Segments const> segments;
+        {
+            std::lock_guard lock(mutex_);
+            segments = segments_;
+        }
+        for (auto const& s : *segments)
+        {
+            s->for_each([&f](
+                            std::uint8_t const* key,
+                            std::uint8_t const* value,
+                            std::uint32_t size) {
+                DecodedBlob decoded(key, value, size);
+                if (!decoded.wasOk())
+                    Throw<std::runtime_error>("nodestore: corrupt segment");
+                f(decoded.createObject());
+            });
+        }
+    }
+
+    int
+    getWriteLoad() override
+    {
+        // Objects beyond a segment's worth wait for sealing to catch up
+        std::lock_guard lock(mutex_);
+        if (pending_.size() <= segmentObjects_)
+            return 0;
+        return static_cast<int>(std::min<std::size_t>(
+            pending_.size() - segmentObjects_,
+            std::numeric_limits<int>::max()));
+    }
+
+    void
+    setDeletePath() override
+    {
+        deletePath_ = true;
+    }
+
+    int
+    fdRequired() const override
+    {
+        // Mapped segments hold no descriptor. The log is open, and so is a
+        // segment while it is written.
+        return 2;
+    }
+
+private:
+    static std::uint64_t
+    idOf(boost::filesystem::path const& file)
+    {
+        return std::stoull(file.stem().string());
+    }
+
+    boost::filesystem::path
+    pathOf(std::uint64_t id, char const* extension) const
+    {
+        std::ostringstream file;
+        file << std::setw(12) << std::setfill('0') << id << extension;
+        return boost::filesystem::path(name_) / file.str();
+    }
+
+    // Log and hold objects until they are sealed. Returns true once enough
+    // are waiting to fill a segment.
+    bool
+    add(Batch const& batch)
+    {
+        std::lock_guard logLock(logMutex_);
+
+        Batch fresh;
+        {
+            std::lock_guard lock(mutex_);
+            for (auto const& object : batch)
+            {
+                if (!pending_.count(object->getHash()))
+                    fresh.push_back(object);
+            }
+        }
+        if (fresh.empty())
+            return false;
+
+        if (!log_)
+        {
+            auto path = pathOf(nextLogId_++, ".log");
+            log_ = std::make_unique<segment::Log>(path);
+            logs_.push_back(std::move(path));
+        }
+        for (auto const& object : fresh)
+            log_->append(object);
+        log_->flush();
+
+        std::lock_guard lock(mutex_);
+        for (auto& object : fresh)
+            pending_.emplace(object->getHash(), std::move(object));
+        return pending_.size() >= segmentObjects_;
+    }
+
+    // Seal the objects waiting on the scheduler's thread
+    void
+    schedule()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            if (sealScheduled_ || pending_.size() < segmentObjects_)
+                return;
+            sealScheduled_ = true;
+        }
+        scheduler_.scheduleTask(*this);
+    }
+
+    void
+    performScheduledTask() override
+    {
+        for (;;)
+        {
+            bool failed = false;
+            try
+            {
+                seal();
+                compact();
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(j_.error()) << name_ << ": " << e.what();
+                failed = true;
+            }
+
+            // Objects may have filled another segment in the meantime
+            std::lock_guard lock(mutex_);
+            if (failed || pending_.size() < segmentObjects_)
+            {
+                sealScheduled_ = false;
+                sealCondition_.notify_all();
+                return;
+            }
+        }
+    }
+
+    // Wait until the objects scheduled to be sealed are in a segment
+    void
+    waitForSealing()
+    {
+        std::unique_lock lock(mutex_);
+        sealCondition_.wait(lock, [this] { return !sealScheduled_; });
+    }
+
+    // Write the objects waiting into a new segment. If that fails, they are
+    // waiting again, and still in their logs.
+    void
+    seal()
+    {
+        std::lock_guard seal(sealMutex_);
+
+        std::shared_ptr<segment::Objects const> objects;
+        std::vector<boost::filesystem::path> logs;
+        {
+            std::lock_guard logLock(logMutex_);
+            {
+                std::lock_guard lock(mutex_);
+                if (pending_.empty())
+                    return;
+            }
+
+            // Objects stored from now on go to a new log
+            if (log_)
+            {
+                log_->sync();
+                log_.reset();
+            }
+            logs = std::exchange(logs_, {});
+
+            std::lock_guard lock(mutex_);
+            objects = std::make_shared<segment::Objects const>(
+                std::exchange(pending_, {}));
+            sealing_ = objects;
+        }
+
+        auto const path = pathOf(nextId_, ".seg");
+        auto const start = std::chrono::steady_clock::now();
+        std::shared_ptr<segment::Segment const> sealed;
+        try
+        {
+            std::vector<Blob> values;
+            std::vector<segment::Record> records;
+            values.reserve(objects->size());
+            records.reserve(objects->size());
+            for (auto const& [key, object] : *objects)
+            {
+                EncodedBlob const e(object);
+                auto const data = static_cast<std::uint8_t const*>(e.getData());
+                values.emplace_back(data, data + e.getSize());
+                records.push_back(
+                    {key.data(),
+                     values.back().data(),
+                     static_cast<std::uint32_t>(values.back().size())});
+            }
+
+            segment::write(path, records);
+            sealed = std::make_shared<segment::Segment const>(path);
+        }
+        catch (...)
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove(path, ec);
+
+            std::lock_guard logLock(logMutex_);
+            logs_.insert(logs_.begin(), logs.begin(), logs.end());
+
+            std::lock_guard lock(mutex_);
+            pending_.insert(objects->begin(), objects->end());
+            sealing_.reset();
+            Rethrow();
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            auto segments = std::make_shared<Segments>(*segments_);
+            segments->push_back(std::move(sealed));
+            segments_ = std::move(segments);
+            sealing_.reset();
+        }
+        ++nextId_;
+
+        // The objects are durable in the segment
+        for (auto const& log : logs)
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove(log, ec);
+            if (ec)
+                JLOG(j_.warn()) << name_ << ": can't remove " << log.string()
+                                << ": " << ec.message();
+        }
+
+        BatchWriteReport report;
+        report.writeCount = objects->size();
+        report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        scheduler_.onBatchWrite(report);
+
+        JLOG(j_.debug()) << name_ << ": sealed " << objects->size()
+                         << " objects into " << path.filename().string();
+    }
+
+    // Segments of one size tier hold from segmentObjects_ * mergeSegments^t
+    // objects up to mergeSegments times that many
+    int
+    tierOf(std::uint64_t count) const
+    {
+        int tier = 0;
+        for (std::uint64_t limit = segmentObjects_ * mergeSegments;
+             count >= limit;
+             limit *= mergeSegments)
+            ++tier;
+        return tier;
+    }
+
+    // Merge segments of the same tier while there are enough of them
+    void
+    compact()
+    {
+        std::lock_guard seal(sealMutex_);
+
+        for (;;)
+        {
+            std::shared_ptr<Segments const> current;
+            {
+                std::lock_guard lock(mutex_);
+                current = segments_;
+            }
+
+            std::map<int, std::vector<std::size_t>> tiers;
+            for (std::size_t i = 0; i < current->size(); ++i)
+                tiers[tierOf((*current)[i]->count())].push_back(i);
+
+            std::vector<std::size_t> chosen;
+            std::uint64_t objects = 0;
+            for (auto& [tier, members] : tiers)
+            {
+                if (members.size() < mergeSegments)
+                    continue;
+                members.resize(mergeSegments);
+                objects = 0;
+                for (auto const i : members)
+                    objects += (*current)[i]->count();
+                if (objects > maxMergeObjects)
+                    break;
+                chosen = std::move(members);
+                break;
+            }
+            if (chosen.empty())
+                return;
+
+            std::vector<segment::Record> records;
+            records.reserve(objects);
+            for (auto const i : chosen)
+            {
+                (*current)[i]->for_each([&records](
+                                            std::uint8_t const* key,
+                                            std::uint8_t const* value,
+                                            std::uint32_t size) {
+                    records.push_back({key, value, size});
+                });
+            }
+
+            // An object stored twice may be in more than one segment
+            auto const less = [](auto const& a, auto const& b) {
+                return std::memcmp(a.key, b.key, segment::keyBytes) < 0;
+            };
+            std::sort(records.begin(), records.end(), less);
+            records.erase(
+                std::unique(
+                    records.begin(),
+                    records.end(),
+                    [](auto const& a, auto const& b) {
+                        return std::memcmp(
+                                   a.key, b.key, segment::keyBytes) == 0;
+                    }),
+                records.end());
+
+            auto const path = pathOf(nextId_, ".seg");
+            auto const start = std::chrono::steady_clock::now();
+            std::shared_ptr<segment::Segment const> merged;
+            try
+            {
+                segment::write(path, records);
+                merged = std::make_shared<segment::Segment const>(path);
+            }
+            catch (...)
+            {
+                boost::system::error_code ec;
+                boost::filesystem::remove(path, ec);
+                Rethrow();
+            }
+            ++nextId_;
+
+            // The merged segment takes the place of the oldest one. Fetches
+            // that already hold the others keep reading them, and their
+            // files are removed once they are done.
+            {
+                std::lock_guard lock(mutex_);
+                auto segments = std::make_shared<Segments>();
+                for (std::size_t i = 0; i < current->size(); ++i)
+                {
+                    if (i == chosen.front())
+                        segments->push_back(merged);
+                    else if (
+                        std::find(chosen.begin(), chosen.end(), i) ==
+                        chosen.end())
+                        segments->push_back((*current)[i]);
+                }
+                segments_ = std::move(segments);
+            }
+            for (auto const i : chosen)
+                (*current)[i]->retire();
+
+            JLOG(j_.debug())
+                << name_ << ": merged " << chosen.size() << " segments with "
+                << records.size() << " objects into "
+                << path.filename().string() << " in "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count()
+                << "ms";
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class SegmentFactory : public Factory
+{
+public:
+    SegmentFactory()
+    {
+        Manager::instance().insert(*this);
+    }
+
+    ~SegmentFactory() override
+    {
+        Manager::instance().erase(*this);
+    }
+
+    std::string
+    getName() const override
+    {
+        return "Segment";
+    }
+
+    std::unique_ptr<Backend>
+    createInstance(
+        size_t keyBytes,
+        Section const& keyValues,
+        std::size_t,
+        Scheduler& scheduler,
+        beast::Journal journal) override
+    {
+        if (keyBytes != segment::keyBytes)
+            Throw<std::runtime_error>(
+                "nodestore: Segment backend needs 32 byte keys");
+        return std::make_unique<SegmentBackend>(keyValues, scheduler, journal);
+    }
+};
+
+static SegmentFactory segmentFactory;
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -18,17 +18,59 @@
 //==============================================================================
 
 #include <ripple/nodestore/impl/BatchWriter.h>
+#include <ripple/protocol/jss.h>
+#include <algorithm>
+#include <bit>
+#include <cassert>
 
 namespace ripple {
 namespace NodeStore {
 
+void
+BatchWriter::Histogram::add(std::uint64_t value) noexcept
+{
+    auto const bucket = std::min<std::size_t>(
+        std::bit_width(value), counts_.size() - 1);
+    ++counts_[bucket];
+}
+
+Json::Value
+BatchWriter::Histogram::getJson() const
+{
+    Json::Value result(Json::objectValue);
+    for (std::size_t i = 0; i < counts_.size(); ++i)
+    {
+        if (counts_[i] != 0)
+        {
+            auto const smallest = i == 0 ? 0 : std::uint64_t{1} << (i - 1);
+            result[std::to_string(smallest)] = std::to_string(counts_[i]);
+        }
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
 BatchWriter::BatchWriter(Callback& callback, Scheduler& scheduler)
+    : BatchWriter(callback, scheduler, Setup{})
+{
+}
+
+BatchWriter::BatchWriter(
+    Callback& callback,
+    Scheduler& scheduler,
+    Setup const& setup)
     : m_callback(callback)
     , m_scheduler(scheduler)
-    , mWriteLoad(0)
-    , mWritePending(false)
+    , setup_(setup)
+    , batchLimit_(std::clamp<std::size_t>(
+          batchWriteLimitSize / 16,
+          batchWritePreallocationSize,
+          batchWriteLimitSize))
 {
-    mWriteSet.reserve(batchWritePreallocationSize);
+    assert(setup_.maxInFlight > 0);
+    assert(setup_.queueLimit > 0);
+    pending_.reserve(batchWritePreallocationSize);
 }
 
 BatchWriter::~BatchWriter()
@@ -39,19 +81,28 @@ BatchWriter::~BatchWriter()
 void
 BatchWriter::store(std::shared_ptr<NodeObject> const& object)
 {
-    std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
+    std::unique_lock sl(mutex_);
 
-    // If the batch has reached its limit, we wait
-    // until the batch writer is finished
-    while (mWriteSet.size() >= batchWriteLimitSize)
-        mWriteCondition.wait(sl);
+    // If too much is waiting to be written, we wait until the
+    // writers have caught up
+    if (throttled_)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        writeCondition_.wait(sl, [this] { return !throttled_; });
+        ++stalls_;
+        stallDuration_ +=
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+    }
 
-    mWriteSet.push_back(object);
+    pending_.push_back(object);
+    if (pending_.size() >= setup_.queueLimit)
+        throttled_ = true;
 
-    if (!mWritePending)
+    if (wantsWriter())
     {
-        mWritePending = true;
-
+        ++inFlight_;
+        sl.unlock();
         m_scheduler.scheduleTask(*this);
     }
 }
@@ -59,9 +110,24 @@ BatchWriter::store(std::shared_ptr<NodeObject> const& object)
 int
 BatchWriter::getWriteLoad()
 {
-    std::lock_guard sl(mWriteMutex);
+    std::lock_guard sl(mutex_);
+
+    return static_cast<int>(pending_.size() + writing_);
+}
 
-    return std::max(mWriteLoad, static_cast<int>(mWriteSet.size()));
+void
+BatchWriter::getCountsJson(Json::Value& obj) const
+{
+    std::lock_guard sl(mutex_);
+
+    obj[jss::node_write_queue] = static_cast<Json::UInt>(pending_.size());
+    obj[jss::node_write_in_flight] = inFlight_;
+    obj[jss::node_write_batch_limit] = static_cast<Json::UInt>(batchLimit_);
+    obj[jss::node_write_stalls] = std::to_string(stalls_);
+    obj[jss::node_write_stall_duration_us] =
+        std::to_string(stallDuration_.count());
+    obj[jss::node_write_queue_depth] = queueDepth_.getJson();
+    obj[jss::node_write_latency_us] = latency_.getJson();
 }
 
 void
@@ -70,40 +136,100 @@ BatchWriter::performScheduledTask()
     writeBatch();
 }
 
+bool
+BatchWriter::wantsWriter() const
+{
+    // One writer whenever anything is pending, and more while there is
+    // at least a full batch waiting for each
+    if (pending_.empty() || inFlight_ >= setup_.maxInFlight)
+        return false;
+    return inFlight_ == 0 || pending_.size() >= batchLimit_ * inFlight_;
+}
+
+void
+BatchWriter::adapt(std::size_t written, std::chrono::microseconds elapsed)
+{
+    // Shrink quickly when the backend falls behind, and grow slowly, and
+    // only when the limit was what kept the batch small.
+    if (elapsed > setup_.targetLatency)
+        batchLimit_ = std::max<std::size_t>(
+            batchLimit_ / 2, batchWritePreallocationSize);
+    else if (elapsed < setup_.targetLatency / 2 && written >= batchLimit_)
+        batchLimit_ = std::min<std::size_t>(
+            batchLimit_ + batchLimit_ / 4, batchWriteLimitSize);
+}
+
 void
 BatchWriter::writeBatch()
 {
     for (;;)
     {
-        std::vector<std::shared_ptr<NodeObject>> set;
-
-        set.reserve(batchWritePreallocationSize);
+        Batch set;
+        bool helper = false;
 
         {
-            std::lock_guard sl(mWriteMutex);
+            std::lock_guard sl(mutex_);
+
+            if (pending_.empty())
+            {
+                --inFlight_;
+                writeCondition_.notify_all();
+                return;
+            }
 
-            mWriteSet.swap(set);
-            assert(mWriteSet.empty());
-            mWriteLoad = set.size();
+            queueDepth_.add(pending_.size());
 
-            if (set.empty())
+            // Objects are written in no particular order, so the batch is
+            // taken from the end
+            if (pending_.size() <= batchLimit_)
             {
-                mWritePending = false;
-                mWriteCondition.notify_all();
+                set.reserve(batchWritePreallocationSize);
+                pending_.swap(set);
+            }
+            else
+            {
+                auto const first = pending_.end() - batchLimit_;
+                set.assign(
+                    std::make_move_iterator(first),
+                    std::make_move_iterator(pending_.end()));
+                pending_.erase(first, pending_.end());
+            }
+            writing_ += set.size();
 
-                // VFALCO NOTE Fix this function to not return from the middle
-                return;
+            if (throttled_ && pending_.size() <= setup_.queueLimit / 2)
+            {
+                throttled_ = false;
+                writeCondition_.notify_all();
+            }
+
+            if (wantsWriter())
+            {
+                ++inFlight_;
+                helper = true;
             }
         }
 
+        if (helper)
+            m_scheduler.scheduleTask(*this);
+
         BatchWriteReport report;
         report.writeCount = set.size();
         auto const before = std::chrono::steady_clock::now();
 
         m_callback.writeBatch(set);
 
-        report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - before);
+        auto const elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - before);
+        report.elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+
+        {
+            std::lock_guard sl(mutex_);
+            writing_ -= set.size();
+            latency_.add(elapsed.count());
+            adapt(set.size(), elapsed);
+        }
 
         m_scheduler.onBatchWrite(report);
     }
@@ -112,10 +238,9 @@ BatchWriter::writeBatch()
 void
 BatchWriter::waitForWriting()
 {
-    std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
+    std::unique_lock sl(mutex_);
 
-    while (mWritePending)
-        mWriteCondition.wait(sl);
+    writeCondition_.wait(sl, [this] { return inFlight_ == 0; });
 }
 
 }  // namespace NodeStore
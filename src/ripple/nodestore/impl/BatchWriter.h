@@ -20,10 +20,14 @@
 #ifndef RIPPLE_NODESTORE_BATCHWRITER_H_INCLUDED
 #define RIPPLE_NODESTORE_BATCHWRITER_H_INCLUDED
 
+#include <ripple/json/json_value.h>
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/nodestore/Task.h>
 #include <ripple/nodestore/Types.h>
+#include <array>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 
 namespace ripple {
@@ -31,10 +35,17 @@ namespace NodeStore {
 
 /** Batch-writing assist logic.
 
-    The batch writes are performed with a scheduled task. Use of the
+    The batch writes are performed with scheduled tasks. Use of the
     class it not required. A backend can implement its own write batching,
     or skip write batching if doing so yields a performance benefit.
 
+    Several batches may be written at the same time, so the callback must
+    be safe to call concurrently. The size of a batch adapts to how long
+    the backend takes to write one: it shrinks when writes are slower than
+    the target latency, and grows while they are faster. When too many
+    objects are waiting to be written, producers block until the writers
+    have caught up with half of them.
+
     @see Scheduler
 */
 class BatchWriter : private Task
@@ -53,9 +64,25 @@ public:
         writeBatch(Batch const& batch) = 0;
     };
 
+    /** Tuning for a batch writer. */
+    struct Setup
+    {
+        /** The most batches written at the same time. */
+        int maxInFlight = 4;
+
+        /** The most objects waiting to be written before producers block. */
+        std::size_t queueLimit = batchWriteLimitSize;
+
+        /** How long writing one batch should take. */
+        std::chrono::microseconds targetLatency =
+            std::chrono::milliseconds{100};
+    };
+
     /** Create a batch writer. */
     BatchWriter(Callback& callback, Scheduler& scheduler);
 
+    BatchWriter(Callback& callback, Scheduler& scheduler, Setup const& setup);
+
     /** Destroy a batch writer.
 
         Anything pending in the batch is written out before this returns.
@@ -65,7 +92,8 @@ public:
     /** Store the object.
 
         This will add to the batch and initiate a scheduled task to
-        write the batch out.
+        write the batch out. If too many objects are waiting to be
+        written, this blocks until the writers catch up.
     */
     void
     store(std::shared_ptr<NodeObject> const& object);
@@ -74,7 +102,26 @@ public:
     int
     getWriteLoad();
 
+    /** Add the writer's queue, latency and backpressure statistics. */
+    void
+    getCountsJson(Json::Value& obj) const;
+
 private:
+    // Counts of values in power-of-two buckets
+    class Histogram
+    {
+    public:
+        void
+        add(std::uint64_t value) noexcept;
+
+        // An object keyed by the smallest value in each non-empty bucket
+        Json::Value
+        getJson() const;
+
+    private:
+        std::array<std::uint64_t, 40> counts_{};
+    };
+
     void
     performScheduledTask() override;
     void
@@ -82,17 +129,31 @@ private:
     void
     waitForWriting();
 
-private:
-    using LockType = std::recursive_mutex;
-    using CondvarType = std::condition_variable_any;
+    // Returns `true` if another task should be scheduled
+    bool
+    wantsWriter() const;
+
+    // Adjust the batch size after a batch was written
+    void
+    adapt(std::size_t written, std::chrono::microseconds elapsed);
 
+private:
     Callback& m_callback;
     Scheduler& m_scheduler;
-    LockType mWriteMutex;
-    CondvarType mWriteCondition;
-    int mWriteLoad;
-    bool mWritePending;
-    Batch mWriteSet;
+    Setup const setup_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable writeCondition_;
+    Batch pending_;
+    std::size_t writing_ = 0;
+    int inFlight_ = 0;
+    std::size_t batchLimit_;
+    bool throttled_ = false;
+
+    std::uint64_t stalls_ = 0;
+    std::chrono::microseconds stallDuration_{0};
+    Histogram queueDepth_;
+    Histogram latency_;
 };
 
 }  // namespace NodeStore
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/json/json_value.h>
@@ -255,6 +256,8 @@ Database::fetchNodeObject(
     FetchType fetchType,
     bool duplicate)
 {
+    perf::Span const span("NodeStore::fetch");
+
     FetchReport fetchReport(fetchType);
 
     using namespace std::chrono;
@@ -403,6 +406,8 @@ Database::getCountsJson(Json::Value& obj)
         obj[jss::node_writes_delayed] = std::to_string(c->writesDelayed);
         obj[jss::node_writes_duration_us] = std::to_string(c->writeDurationUs);
     }
+
+    getCountsJsonImpl(obj);
 }
 
 }  // namespace NodeStore
@@ -162,6 +162,12 @@ private:
     {
         return backend_->counters();
     }
+
+    void
+    getCountsJsonImpl(Json::Value& obj) const override
+    {
+        backend_->getCountsJson(obj);
+    }
 };
 
 }  // namespace NodeStore
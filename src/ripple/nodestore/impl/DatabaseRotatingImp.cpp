@@ -207,5 +207,16 @@ DatabaseRotatingImp::for_each(
     archive->for_each(f);
 }
 
+void
+DatabaseRotatingImp::getCountsJsonImpl(Json::Value& obj) const
+{
+    auto const backend = [&] {
+        std::lock_guard lock(mutex_);
+        return writableBackend_;
+    }();
+
+    backend->getCountsJson(obj);
+}
+
 }  // namespace NodeStore
 }  // namespace ripple
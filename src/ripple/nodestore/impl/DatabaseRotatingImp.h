@@ -93,6 +93,9 @@ private:
 
     void
     for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override;
+
+    void
+    getCountsJsonImpl(Json::Value& obj) const override;
 };
 
 }  // namespace NodeStore
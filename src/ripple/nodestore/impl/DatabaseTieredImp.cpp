@@ -0,0 +1,317 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/json/json_value.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DatabaseTieredImp.h>
+#include <ripple/protocol/jss.h>
+
+#include <boost/filesystem.hpp>
+
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+DatabaseTieredImp::DatabaseTieredImp(
+    Scheduler& scheduler,
+    int readThreads,
+    std::shared_ptr<Backend> coldBackend,
+    Section const& hotConfig,
+    std::size_t burstSize,
+    Section const& config,
+    beast::Journal j)
+    : Database(scheduler, readThreads, config, j)
+    , hotConfig_(hotConfig)
+    , burstSize_(burstSize)
+    , hotLedgers_(get<std::uint32_t>(hotConfig, "hot_ledgers", 8192))
+    , promote_(get<bool>(hotConfig, "promote", true))
+    , coldBackend_(std::move(coldBackend))
+{
+    assert(coldBackend_);
+
+    if (hotLedgers_ < 256)
+        Throw<std::runtime_error>("hot_ledgers must be at least 256");
+
+    if (get(hotConfig_, "path").empty())
+    {
+        Throw<std::runtime_error>(
+            "Missing path in [" + ConfigSection::nodeDatabaseHot() + "]");
+    }
+
+    removeStaleHotBackends();
+    hotWritable_ = makeHotBackend();
+    hotArchive_ = makeHotBackend();
+
+    fdRequired_ += coldBackend_->fdRequired();
+    fdRequired_ += 2 * hotWritable_->fdRequired();
+}
+
+void
+DatabaseTieredImp::removeStaleHotBackends()
+{
+    // Hot backends are removed when they are closed. Any that are left
+    // were open when the server stopped uncleanly, and only hold copies.
+    namespace fs = boost::filesystem;
+
+    fs::path const dir = get(hotConfig_, "path");
+    if (!fs::is_directory(dir))
+        return;
+
+    std::vector<fs::path> stale;
+    for (auto const& entry : fs::directory_iterator(dir))
+    {
+        if (fs::is_directory(entry.path()) &&
+            entry.path().filename().string().rfind("hot.", 0) == 0)
+            stale.push_back(entry.path());
+    }
+
+    for (auto const& p : stale)
+    {
+        JLOG(j_.warn()) << "Removing stale hot tier " << p.string();
+        fs::remove_all(p);
+    }
+}
+
+std::unique_ptr<Backend>
+DatabaseTieredImp::makeHotBackend()
+{
+    Section section{hotConfig_};
+
+    boost::filesystem::path p = get(section, "path");
+    p /= "hot.%%%%";
+    section.set("path", boost::filesystem::unique_path(p).string());
+
+    auto backend{Manager::instance().make_Backend(
+        section, burstSize_, scheduler_, j_)};
+    backend->open();
+
+    // The hot tier only holds copies of objects in the cold tier
+    backend->setDeletePath();
+    return backend;
+}
+
+std::int32_t
+DatabaseTieredImp::getWriteLoad() const
+{
+    auto const hot = [&] {
+        std::lock_guard lock(mutex_);
+        return hotWritable_;
+    }();
+
+    return std::max(coldBackend_->getWriteLoad(), hot->getWriteLoad());
+}
+
+void
+DatabaseTieredImp::store(
+    NodeObjectType type,
+    Blob&& data,
+    uint256 const& hash,
+    std::uint32_t ledgerSeq)
+{
+    auto nObj = NodeObject::createObject(type, std::move(data), hash);
+
+    auto const hot = [&] {
+        std::lock_guard lock(mutex_);
+        return hotWritable_;
+    }();
+
+    hot->store(nObj);
+    coldBackend_->store(nObj);
+    storeStats(1, nObj->getData().size());
+
+    auto last = lastSeq_.load(std::memory_order_relaxed);
+    while (ledgerSeq > last &&
+           !lastSeq_.compare_exchange_weak(
+               last, ledgerSeq, std::memory_order_relaxed))
+        ;
+}
+
+void
+DatabaseTieredImp::sync()
+{
+    auto const hot = [&] {
+        std::lock_guard lock(mutex_);
+        return hotWritable_;
+    }();
+
+    hot->sync();
+    coldBackend_->sync();
+}
+
+void
+DatabaseTieredImp::sweep()
+{
+    auto const last = lastSeq_.load(std::memory_order_relaxed);
+    if (last == 0)
+        return;
+
+    {
+        std::lock_guard lock(mutex_);
+        if (hotFirstSeq_ == 0)
+        {
+            hotFirstSeq_ = last;
+            return;
+        }
+
+        if (last - hotFirstSeq_ < hotLedgers_)
+            return;
+    }
+
+    // Opening a backend may be slow, do it without holding the lock
+    std::shared_ptr<Backend> newBackend = makeHotBackend();
+    std::shared_ptr<Backend> expired;
+
+    {
+        std::lock_guard lock(mutex_);
+        expired = std::move(hotArchive_);
+        hotArchive_ = std::move(hotWritable_);
+        hotWritable_ = std::move(newBackend);
+        hotFirstSeq_ = last;
+    }
+
+    ++rotations_;
+    JLOG(j_.info()) << "Rotated hot tier at ledger " << last << ", discarded "
+                    << expired->getName();
+
+    // The expired backend is removed from disk once the last fetch that
+    // may still be using it releases it.
+}
+
+std::shared_ptr<NodeObject>
+DatabaseTieredImp::fetchFrom(
+    Backend& backend,
+    uint256 const& hash,
+    char const* tier)
+{
+    Status status;
+    std::shared_ptr<NodeObject> nodeObject;
+    try
+    {
+        status = backend.fetch(hash.data(), &nodeObject);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.fatal()) << "Exception fetching " << hash << " from " << tier
+                         << " tier: " << e.what();
+        Rethrow();
+    }
+
+    switch (status)
+    {
+        case ok:
+        case notFound:
+            break;
+        case dataCorrupt:
+            JLOG(j_.fatal()) << "Corrupt NodeObject #" << hash << " in "
+                             << tier << " tier";
+            break;
+        default:
+            JLOG(j_.warn()) << "Unknown status=" << status << " from " << tier
+                            << " tier";
+            break;
+    }
+
+    return nodeObject;
+}
+
+std::shared_ptr<NodeObject>
+DatabaseTieredImp::fetchNodeObject(
+    uint256 const& hash,
+    std::uint32_t,
+    FetchReport& fetchReport,
+    bool)
+{
+    using namespace std::chrono;
+
+    auto [writable, archive] = [&] {
+        std::lock_guard lock(mutex_);
+        return std::make_pair(hotWritable_, hotArchive_);
+    }();
+
+    auto begin = steady_clock::now();
+    auto elapsed = [&begin] {
+        auto const now = steady_clock::now();
+        auto const us = duration_cast<microseconds>(now - begin).count();
+        begin = now;
+        return us;
+    };
+
+    // Try the hot tier, newest generation first
+    ++hotCounters_.fetches;
+    auto nodeObject = fetchFrom(*writable, hash, "hot");
+    bool const fromArchive = !nodeObject;
+    if (fromArchive)
+        nodeObject = fetchFrom(*archive, hash, "hot");
+    hotCounters_.durationUs += elapsed();
+
+    // Keep objects that are still in use from expiring with their
+    // generation
+    if (nodeObject && fromArchive && promote_)
+        writable->store(nodeObject);
+
+    if (nodeObject)
+    {
+        ++hotCounters_.hits;
+    }
+    else
+    {
+        // Fall back to the cold tier
+        ++coldCounters_.fetches;
+        nodeObject = fetchFrom(*coldBackend_, hash, "cold");
+        coldCounters_.durationUs += elapsed();
+
+        if (nodeObject)
+        {
+            ++coldCounters_.hits;
+            if (promote_)
+            {
+                writable->store(nodeObject);
+                ++promotions_;
+            }
+        }
+    }
+
+    if (nodeObject)
+        fetchReport.wasFound = true;
+
+    return nodeObject;
+}
+
+void
+DatabaseTieredImp::getCountsJsonImpl(Json::Value& obj) const
+{
+    coldBackend_->getCountsJson(obj);
+
+    obj[jss::node_hot_reads_total] = std::to_string(hotCounters_.fetches);
+    obj[jss::node_hot_reads_hit] = std::to_string(hotCounters_.hits);
+    obj[jss::node_hot_reads_duration_us] =
+        std::to_string(hotCounters_.durationUs);
+    obj[jss::node_cold_reads_total] = std::to_string(coldCounters_.fetches);
+    obj[jss::node_cold_reads_hit] = std::to_string(coldCounters_.hits);
+    obj[jss::node_cold_reads_duration_us] =
+        std::to_string(coldCounters_.durationUs);
+    obj[jss::node_hot_promotions] = std::to_string(promotions_);
+    obj[jss::node_hot_rotations] = std::to_string(rotations_);
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
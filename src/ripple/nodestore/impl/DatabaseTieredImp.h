@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_DATABASETIEREDIMP_H_INCLUDED
+#define RIPPLE_NODESTORE_DATABASETIEREDIMP_H_INCLUDED
+
+#include <ripple/nodestore/Database.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace ripple {
+namespace NodeStore {
+
+/* A node store made of a small, fast "hot" tier in front of a large "cold"
+ * tier.
+ *
+ * The cold backend is the persistent, authoritative store: every object is
+ * written to it. The hot tier is a cache made of two generations of backends,
+ * typically Memory, NuDB or RocksDB on fast storage. New objects are written
+ * to the current hot generation and objects found only in the cold backend
+ * are promoted into it on read. Once the hot tier has seen `hot_ledgers`
+ * ledgers, the generations rotate: the previous one is discarded and a fresh
+ * one takes its place, so objects nobody reads are demoted by age.
+ *
+ * Hot backends are always created with their delete path set. Their contents
+ * do not survive a restart, which is safe because the cold tier holds
+ * everything.
+ */
+class DatabaseTieredImp : public Database
+{
+public:
+    DatabaseTieredImp() = delete;
+    DatabaseTieredImp(DatabaseTieredImp const&) = delete;
+    DatabaseTieredImp&
+    operator=(DatabaseTieredImp const&) = delete;
+
+    /** Construct the tiered node store.
+
+        @param scheduler The scheduler to use for performing asynchronous tasks.
+        @param readThreads The number of asynchronous read threads to create.
+        @param coldBackend The opened, persistent backend.
+        @param hotConfig The configuration of the hot tier backends.
+        @param burstSize Backend burst size in bytes for the hot tier.
+        @param config The configuration settings of the cold tier.
+        @param j Destination for logging output.
+    */
+    DatabaseTieredImp(
+        Scheduler& scheduler,
+        int readThreads,
+        std::shared_ptr<Backend> coldBackend,
+        Section const& hotConfig,
+        std::size_t burstSize,
+        Section const& config,
+        beast::Journal j);
+
+    ~DatabaseTieredImp()
+    {
+        stop();
+    }
+
+    std::string
+    getName() const override
+    {
+        return coldBackend_->getName();
+    }
+
+    std::int32_t
+    getWriteLoad() const override;
+
+    void
+    importDatabase(Database& source) override
+    {
+        importInternal(*coldBackend_, source);
+    }
+
+    void
+    store(
+        NodeObjectType type,
+        Blob&& data,
+        uint256 const& hash,
+        std::uint32_t ledgerSeq) override;
+
+    bool isSameDB(std::uint32_t, std::uint32_t) override
+    {
+        // the tiers act as one logical database
+        return true;
+    }
+
+    void
+    sync() override;
+
+    bool
+    storeLedger(std::shared_ptr<Ledger const> const& srcLedger) override
+    {
+        return Database::storeLedger(*srcLedger, coldBackend_);
+    }
+
+    /** Rotates the hot tier if it has seen `hot_ledgers` ledgers. */
+    void
+    sweep() override;
+
+private:
+    struct TierCounters
+    {
+        std::atomic<std::uint64_t> fetches{0};
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> durationUs{0};
+    };
+
+    Section const hotConfig_;
+    std::size_t const burstSize_;
+
+    // Number of ledgers the current hot generation spans before rotating
+    std::uint32_t const hotLedgers_;
+
+    // Whether objects read from the cold tier are copied to the hot tier
+    bool const promote_;
+
+    std::shared_ptr<Backend> const coldBackend_;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<Backend> hotWritable_;
+    std::shared_ptr<Backend> hotArchive_;
+
+    // The first ledger sequence stored in the current hot generation
+    std::uint32_t hotFirstSeq_{0};
+
+    // The largest ledger sequence stored so far
+    std::atomic<std::uint32_t> lastSeq_{0};
+
+    TierCounters hotCounters_;
+    TierCounters coldCounters_;
+    std::atomic<std::uint64_t> promotions_{0};
+    std::atomic<std::uint64_t> rotations_{0};
+
+    void
+    removeStaleHotBackends();
+
+    std::unique_ptr<Backend>
+    makeHotBackend();
+
+    std::shared_ptr<NodeObject>
+    fetchFrom(Backend& backend, uint256 const& hash, char const* tier);
+
+    std::shared_ptr<NodeObject>
+    fetchNodeObject(
+        uint256 const& hash,
+        std::uint32_t,
+        FetchReport& fetchReport,
+        bool duplicate) override;
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
+    {
+        coldBackend_->for_each(f);
+    }
+
+    std::optional<Backend::Counters<std::uint64_t>>
+    getCounters() const override
+    {
+        return coldBackend_->counters();
+    }
+
+    void
+    getCountsJsonImpl(Json::Value& obj) const override;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/Dictionaries.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/digest.h>
+
+#include <zdict.h>
+
+namespace ripple {
+namespace NodeStore {
+
+// The version of the format dictionaries are stored in
+static constexpr std::uint8_t dictionaryVersion = 1;
+
+Dictionary::Dictionary(std::uint32_t id, NodeObjectType type, Blob data)
+    : id_(id)
+    , type_(type)
+    , data_(std::move(data))
+    , cdict_(ZSTD_createCDict(data_.data(), data_.size(), compressionLevel))
+    , ddict_(ZSTD_createDDict(data_.data(), data_.size()))
+{
+    if (!cdict_ || !ddict_)
+    {
+        ZSTD_freeCDict(cdict_);
+        ZSTD_freeDDict(ddict_);
+        Throw<std::runtime_error>(
+            "nodestore: can't load dictionary " + std::to_string(id_));
+    }
+}
+
+Dictionary::~Dictionary()
+{
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+}
+
+std::shared_ptr<Dictionary const>
+Dictionary::parse(Slice s)
+{
+    SerialIter sit(s);
+    if (sit.empty() || sit.get8() != dictionaryVersion)
+        Throw<std::runtime_error>("nodestore: unknown dictionary version");
+    auto const id = sit.get32();
+    auto const type = static_cast<NodeObjectType>(sit.get32());
+    auto const data = sit.getSlice(sit.getBytesLeft());
+    if (id == 0 || data.empty())
+        Throw<std::runtime_error>("nodestore: invalid dictionary");
+    return std::make_shared<Dictionary const>(
+        id, type, Blob(data.begin(), data.end()));
+}
+
+Blob
+Dictionary::serialize() const
+{
+    Serializer s(data_.size() + 9);
+    s.add8(dictionaryVersion);
+    s.add32(id_);
+    s.add32(type_);
+    s.addRaw(data_);
+    return s.peekData();
+}
+
+uint256
+Dictionary::key(std::uint32_t id)
+{
+    static constexpr char tag[] = "NodeStore compression dictionary";
+    sha512_half_hasher h;
+    h(tag, sizeof(tag) - 1);
+    using beast::hash_append;
+    hash_append(h, id);
+    return static_cast<uint256>(h);
+}
+
+//------------------------------------------------------------------------------
+
+Dictionaries
+Dictionaries::add(std::shared_ptr<Dictionary const> dictionary) const
+{
+    if (dictionary->id() != nextId())
+        Throw<std::logic_error>(
+            "nodestore: dictionary " + std::to_string(dictionary->id()) +
+            " added out of order");
+
+    Dictionaries result(*this);
+    result.newest_[dictionary->type()] = dictionary.get();
+    result.dictionaries_.push_back(std::move(dictionary));
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+Blob
+trainDictionary(std::vector<Blob> const& samples, std::size_t capacity)
+{
+    Blob buffer;
+    std::vector<std::size_t> sizes;
+    sizes.reserve(samples.size());
+    for (auto const& sample : samples)
+    {
+        buffer.insert(buffer.end(), sample.begin(), sample.end());
+        sizes.push_back(sample.size());
+    }
+
+    Blob result(capacity);
+    auto const size = ZDICT_trainFromBuffer(
+        result.data(),
+        result.size(),
+        buffer.data(),
+        sizes.data(),
+        static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(size))
+        return {};
+    result.resize(size);
+    return result;
+}
+
+DictionaryTrainer::DictionaryTrainer(
+    std::size_t dictionarySize,
+    std::size_t sampleSize)
+    : dictionarySize_(dictionarySize), sampleSize_(sampleSize)
+{
+    samples_[hotACCOUNT_NODE];
+    samples_[hotTRANSACTION_NODE];
+}
+
+void
+DictionaryTrainer::skip(NodeObjectType type)
+{
+    samples_.erase(type);
+}
+
+bool
+DictionaryTrainer::done() const
+{
+    return samples_.empty();
+}
+
+std::optional<std::pair<NodeObjectType, std::vector<Blob>>>
+DictionaryTrainer::sample(void const* data, std::size_t size)
+{
+    // See EncodedBlob for the layout
+    if (size <= 9 || is_inner_node(data, size))
+        return std::nullopt;
+
+    auto const p = static_cast<std::uint8_t const*>(data);
+    auto const type = static_cast<NodeObjectType>(p[8]);
+    auto const it = samples_.find(type);
+    if (it == samples_.end())
+        return std::nullopt;
+
+    auto& samples = it->second;
+    samples.objects.emplace_back(p, p + size);
+    samples.bytes += size;
+    if (samples.bytes < sampleSize_)
+        return std::nullopt;
+
+    auto result = std::make_pair(type, std::move(samples.objects));
+    samples_.erase(it);
+    return result;
+}
+
+Blob
+DictionaryTrainer::train(std::vector<Blob> const& samples) const
+{
+    return trainDictionary(samples, dictionarySize_);
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,253 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_DICTIONARIES_H_INCLUDED
+#define RIPPLE_NODESTORE_DICTIONARIES_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/nodestore/NodeObject.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <zstd.h>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A zstd dictionary for compressing one type of node object.
+
+    Objects of the same type share most of their structure: field codes,
+    prefixes and common values. A dictionary trained on a sample of them
+    lets zstd compress even a single small object well.
+
+    Each dictionary has an id that is written alongside every object it
+    compressed, so the object can be decompressed after newer dictionaries
+    have been added.
+*/
+class Dictionary
+{
+public:
+    /** The zstd compression level used with dictionaries. */
+    static constexpr int compressionLevel = 3;
+
+    Dictionary(std::uint32_t id, NodeObjectType type, Blob data);
+
+    ~Dictionary();
+
+    Dictionary(Dictionary const&) = delete;
+    Dictionary&
+    operator=(Dictionary const&) = delete;
+
+    /** Returns the dictionary stored as `serialize` wrote it. */
+    static std::shared_ptr<Dictionary const>
+    parse(Slice s);
+
+    /** Returns the dictionary in the form it is stored in. */
+    Blob
+    serialize() const;
+
+    /** Returns the key a dictionary is stored under in a backend.
+
+        The keys of node objects are digests of their contents, so these
+        keys never collide with one.
+    */
+    static uint256
+    key(std::uint32_t id);
+
+    std::uint32_t
+    id() const noexcept
+    {
+        return id_;
+    }
+
+    NodeObjectType
+    type() const noexcept
+    {
+        return type_;
+    }
+
+    Blob const&
+    data() const noexcept
+    {
+        return data_;
+    }
+
+    ZSTD_CDict const*
+    compressor() const noexcept
+    {
+        return cdict_;
+    }
+
+    ZSTD_DDict const*
+    decompressor() const noexcept
+    {
+        return ddict_;
+    }
+
+private:
+    std::uint32_t const id_;
+    NodeObjectType const type_;
+    Blob const data_;
+    ZSTD_CDict* cdict_;
+    ZSTD_DDict* ddict_;
+};
+
+//------------------------------------------------------------------------------
+
+/** The dictionaries known to a backend.
+
+    Ids are given out in order starting from 1, and a dictionary is never
+    removed: the newest dictionary for a type is used to compress, and every
+    dictionary remains available to decompress.
+
+    A set is not changed once it is in use. Adding a dictionary makes a new
+    set, which shares the dictionaries of the old one.
+*/
+class Dictionaries
+{
+public:
+    Dictionaries() = default;
+
+    /** Returns the dictionary with an id, or `nullptr`. */
+    Dictionary const*
+    find(std::uint32_t id) const noexcept
+    {
+        if (id == 0 || id > dictionaries_.size())
+            return nullptr;
+        return dictionaries_[id - 1].get();
+    }
+
+    /** Returns the dictionary to compress a type of object with, or
+        `nullptr` if there is none.
+    */
+    Dictionary const*
+    compressor(NodeObjectType type) const noexcept
+    {
+        auto const it = newest_.find(type);
+        return it == newest_.end() ? nullptr : it->second;
+    }
+
+    /** Returns the id the next dictionary must have. */
+    std::uint32_t
+    nextId() const noexcept
+    {
+        return static_cast<std::uint32_t>(dictionaries_.size() + 1);
+    }
+
+    std::size_t
+    size() const noexcept
+    {
+        return dictionaries_.size();
+    }
+
+    /** Returns a copy of this set with another dictionary.
+
+        @param dictionary A dictionary whose id is `nextId()`.
+    */
+    Dictionaries
+    add(std::shared_ptr<Dictionary const> dictionary) const;
+
+private:
+    std::vector<std::shared_ptr<Dictionary const>> dictionaries_;
+    std::map<NodeObjectType, Dictionary const*> newest_;
+};
+
+//------------------------------------------------------------------------------
+
+/** Returns a dictionary trained on samples, or an empty blob if zstd
+    could not train one.
+
+    @param samples The objects to train on.
+    @param capacity The largest dictionary to produce, in bytes.
+*/
+Blob
+trainDictionary(std::vector<Blob> const& samples, std::size_t capacity);
+
+/** Collects samples of the objects written to a backend, and trains a
+    dictionary for each type of object once it has seen enough of them.
+
+    Only account state and transaction leaf nodes are sampled. Inner nodes
+    are compressed by the codec without a dictionary, and ledger headers
+    are too few to be worth one.
+
+    @note This class is not thread-safe.
+*/
+class DictionaryTrainer
+{
+public:
+    /** Create a trainer.
+
+        @param dictionarySize The largest dictionary to train, in bytes.
+        @param sampleSize The number of bytes of objects of one type to
+                          collect before training. zstd suggests about a
+                          hundred times the dictionary size.
+    */
+    explicit DictionaryTrainer(
+        std::size_t dictionarySize = 32 * 1024,
+        std::size_t sampleSize = 100 * 32 * 1024);
+
+    /** Stop sampling a type of object, which already has a dictionary. */
+    void
+    skip(NodeObjectType type);
+
+    /** Returns `true` if no type of object is being sampled any more. */
+    bool
+    done() const;
+
+    /** Offer an object as a sample.
+
+        @param data The object, as encoded for the backend.
+        @param size The size of the object.
+        @return The type of the object and the samples of that type, once
+                there are enough of them to train a dictionary. The type
+                is not sampled any more.
+    */
+    std::optional<std::pair<NodeObjectType, std::vector<Blob>>>
+    sample(void const* data, std::size_t size);
+
+    /** Returns a dictionary trained on samples, or an empty blob if zstd
+        could not train one.
+
+        Training takes much longer than sampling, and may be done while
+        other objects are sampled.
+    */
+    Blob
+    train(std::vector<Blob> const& samples) const;
+
+private:
+    struct Samples
+    {
+        std::vector<Blob> objects;
+        std::size_t bytes = 0;
+    };
+
+    std::size_t const dictionarySize_;
+    std::size_t const sampleSize_;
+    std::map<NodeObjectType, Samples> samples_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,539 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/basics/contract.h>
+#include <ripple/json/json_value.h>
+#include <ripple/nodestore/impl/FilteredBackend.h>
+#include <ripple/nodestore/impl/NegativeFilter.h>
+#include <ripple/protocol/jss.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ripple {
+namespace NodeStore {
+
+namespace detail {
+
+// Flush a file and wait for it to reach the disk
+inline bool
+syncFile(std::FILE* f)
+{
+    if (std::fflush(f) != 0)
+        return false;
+#ifdef _MSC_VER
+    return _commit(_fileno(f)) == 0;
+#else
+    return ::fsync(::fileno(f)) == 0;
+#endif
+}
+
+}  // namespace detail
+
+class FilteredBackend : public Backend
+{
+private:
+    std::unique_ptr<Backend> const backend_;
+    std::string const dir_;
+    beast::Journal const j_;
+    NegativeFilter filter_;
+
+    // Where the filter is saved, empty if the backend has no directory
+    boost::filesystem::path file_;
+    bool open_{false};
+    std::atomic<bool> deletePath_{false};
+
+    // Keys stored since the filter was last saved are appended to a log,
+    // so that after a crash the saved filter can be brought up to date
+    // instead of being rebuilt. While a save is in progress the previous
+    // log is kept as well.
+    //
+    // Keys are gathered in memory and written at the end of a batch, on a
+    // sync, or once enough of them or a second's worth are waiting. Keys
+    // still waiting when the process dies are missing from the filter
+    // after it restarts, so the objects stored with them are fetched from
+    // the network again when they are needed.
+    static constexpr std::size_t logBufferSize = 32 * 1024;
+    static constexpr std::chrono::seconds logBufferAge{1};
+
+    boost::filesystem::path log_;
+    boost::filesystem::path oldLog_;
+    std::mutex logMutex_;
+    std::FILE* logFile_{nullptr};
+    std::vector<std::uint8_t> logBuffer_;
+    std::chrono::steady_clock::time_point logBuffered_;
+    std::uint64_t logKeys_{0};
+    std::uint64_t const logLimit_;
+    std::atomic<bool> saving_{false};
+
+    std::atomic<std::uint64_t> checks_{0};
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> falsePositives_{0};
+
+    // Add the keys read from a log, returns how many there were
+    std::uint64_t
+    replay(boost::filesystem::path const& path)
+    {
+        std::ifstream in(path.string(), std::ios::binary);
+        std::uint64_t count = 0;
+        uint256 key;
+
+        // A key cut short by a crash was never passed to the backend
+        while (in.read(reinterpret_cast<char*>(key.data()), key.size()))
+        {
+            filter_.insert(key);
+            ++count;
+        }
+        return count;
+    }
+
+    // Stop keeping the filter on disk, so that it is rebuilt on the next
+    // start rather than trusted without the keys it is missing.
+    void
+    abandon(std::lock_guard<std::mutex> const&)
+    {
+        JLOG(j_.warn()) << "Unable to save negative filter to "
+                        << file_.string()
+                        << ". It will be rebuilt on the next start.";
+
+        if (logFile_)
+            std::fclose(std::exchange(logFile_, nullptr));
+        logBuffer_.clear();
+
+        boost::system::error_code ec;
+        boost::filesystem::remove(file_, ec);
+        boost::filesystem::remove(log_, ec);
+        boost::filesystem::remove(oldLog_, ec);
+        file_.clear();
+    }
+
+    // Write the keys waiting in memory to the log
+    void
+    writeLog(std::lock_guard<std::mutex> const& lock)
+    {
+        if (!logFile_ || logBuffer_.empty())
+            return;
+
+        auto const size = logBuffer_.size();
+        if (std::fwrite(logBuffer_.data(), size, 1, logFile_) != 1 ||
+            std::fflush(logFile_) != 0)
+            return abandon(lock);
+        logBuffer_.clear();
+    }
+
+    // Start a new log once the saved filter holds every key. Only called
+    // while nothing is being stored.
+    void
+    checkpoint(bool save, bool reopen)
+    {
+        std::lock_guard lock(logMutex_);
+        if (file_.empty())
+            return;
+
+        if (logFile_)
+            std::fclose(std::exchange(logFile_, nullptr));
+        logBuffer_.clear();
+
+        if (save && !filter_.save(file_))
+            return abandon(lock);
+
+        boost::system::error_code ec;
+        boost::filesystem::remove(oldLog_, ec);
+        boost::filesystem::remove(log_, ec);
+        logKeys_ = 0;
+
+        if (reopen)
+        {
+            logFile_ = std::fopen(log_.string().c_str(), "wb");
+            if (!logFile_)
+                abandon(lock);
+        }
+    }
+
+    // Save the filter while objects are being stored, keeping the log of
+    // the keys it is saved with until the save completes.
+    void
+    rotate()
+    {
+        if (saving_.exchange(true))
+            return;
+
+        boost::filesystem::path file;
+        {
+            std::lock_guard lock(logMutex_);
+            writeLog(lock);
+            if (logFile_)
+            {
+                std::fclose(logFile_);
+
+                boost::system::error_code ec;
+                boost::filesystem::rename(log_, oldLog_, ec);
+                logFile_ = std::fopen(log_.string().c_str(), "wb");
+                logKeys_ = 0;
+                if (ec || !logFile_)
+                    abandon(lock);
+            }
+            file = file_;
+        }
+
+        // Every key in the old log is in the filter by now
+        if (!file.empty())
+        {
+            bool const saved = filter_.save(file);
+
+            std::lock_guard lock(logMutex_);
+            boost::system::error_code ec;
+            if (saved)
+                boost::filesystem::remove(oldLog_, ec);
+            else if (!file_.empty())
+                abandon(lock);
+        }
+
+        saving_ = false;
+    }
+
+    // Add keys to the filter and the log before the backend stores them.
+    // A key is in the filter before it is in a log, so a save that starts
+    // after a log is put aside holds every key in it.
+    void
+    insert(
+        std::shared_ptr<NodeObject> const* objects,
+        std::size_t count,
+        bool batch)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            filter_.insert(objects[i]->getHash());
+
+        bool full = false;
+        {
+            std::lock_guard lock(logMutex_);
+            if (!logFile_)
+                return;
+
+            auto const now = std::chrono::steady_clock::now();
+            if (logBuffer_.empty())
+                logBuffered_ = now;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto const& hash = objects[i]->getHash();
+                logBuffer_.insert(logBuffer_.end(), hash.begin(), hash.end());
+            }
+
+            if (batch || logBuffer_.size() >= logBufferSize ||
+                now - logBuffered_ >= logBufferAge)
+                writeLog(lock);
+
+            logKeys_ += count;
+            full = logKeys_ >= logLimit_;
+        }
+
+        if (full)
+            rotate();
+    }
+
+    void
+    prepare()
+    {
+        using namespace std::chrono;
+
+        open_ = true;
+
+        boost::system::error_code ec;
+        if (!dir_.empty() && boost::filesystem::is_directory(dir_, ec))
+        {
+            file_ = boost::filesystem::path(dir_) / "negative.filter";
+            log_ = boost::filesystem::path(dir_) / "negative.filter.log";
+            oldLog_ = boost::filesystem::path(dir_) / "negative.filter.old";
+        }
+
+        if (!file_.empty() && filter_.load(file_))
+        {
+            auto const replayed = replay(oldLog_) + replay(log_);
+
+            JLOG(j_.info()) << "Loaded negative filter for "
+                            << backend_->getName() << " with "
+                            << filter_.inserted() << " keys, " << replayed
+                            << " of them from its log";
+
+            // Fold the logs of an unclean shutdown into the saved filter
+            checkpoint(replayed != 0, true);
+            return;
+        }
+
+        auto const start = steady_clock::now();
+        backend_->for_each([this](std::shared_ptr<NodeObject> object) {
+            filter_.insert(object->getHash());
+        });
+
+        JLOG(j_.info()) << "Rebuilt negative filter for "
+                        << backend_->getName() << " with "
+                        << filter_.inserted() << " keys in "
+                        << duration_cast<milliseconds>(
+                               steady_clock::now() - start)
+                               .count()
+                        << "ms";
+
+        if (filter_.inserted() > filter_.capacity())
+        {
+            JLOG(j_.warn()) << "Negative filter for " << backend_->getName()
+                            << " holds more than negative_filter_keys ("
+                            << filter_.capacity()
+                            << ") keys. Its false positive rate will rise.";
+        }
+
+        // Save the rebuilt filter, so that a crash does not rebuild it again
+        checkpoint(true, true);
+    }
+
+public:
+    FilteredBackend(
+        std::unique_ptr<Backend> backend,
+        std::string dir,
+        std::uint64_t keys,
+        std::uint32_t bitsPerKey,
+        beast::Journal journal)
+        : backend_(std::move(backend))
+        , dir_(std::move(dir))
+        , j_(journal)
+        , filter_(keys, bitsPerKey)
+        , logLimit_(std::max<std::uint64_t>(keys / 16, 65536))
+    {
+    }
+
+    ~FilteredBackend() override
+    {
+        close();
+    }
+
+    std::string
+    getName() override
+    {
+        return backend_->getName();
+    }
+
+    void
+    open(bool createIfMissing) override
+    {
+        backend_->open(createIfMissing);
+        prepare();
+    }
+
+    void
+    open(bool createIfMissing, uint64_t appType, uint64_t uid, uint64_t salt)
+        override
+    {
+        backend_->open(createIfMissing, appType, uid, salt);
+        prepare();
+    }
+
+    bool
+    isOpen() override
+    {
+        return backend_->isOpen();
+    }
+
+    void
+    close() override
+    {
+        if (std::exchange(open_, false) && !deletePath_)
+            checkpoint(true, false);
+
+        if (logFile_)
+            std::fclose(std::exchange(logFile_, nullptr));
+
+        backend_->close();
+    }
+
+    Status
+    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override
+    {
+        ++checks_;
+        if (!filter_.mayContain(uint256::fromVoid(key)))
+        {
+            ++hits_;
+            pObject->reset();
+            return notFound;
+        }
+
+        auto const status = backend_->fetch(key, pObject);
+        if (status == notFound)
+            ++falsePositives_;
+        return status;
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
+    fetchBatch(std::vector<uint256 const*> const& hashes) override
+    {
+        std::vector<std::shared_ptr<NodeObject>> results(hashes.size());
+        std::vector<uint256 const*> maybe;
+        std::vector<std::size_t> index;
+        maybe.reserve(hashes.size());
+        index.reserve(hashes.size());
+
+        checks_ += hashes.size();
+        for (std::size_t i = 0; i < hashes.size(); ++i)
+        {
+            if (filter_.mayContain(*hashes[i]))
+            {
+                maybe.push_back(hashes[i]);
+                index.push_back(i);
+            }
+        }
+        hits_ += hashes.size() - maybe.size();
+
+        if (maybe.empty())
+            return {std::move(results), ok};
+
+        auto [found, status] = backend_->fetchBatch(maybe);
+        for (std::size_t i = 0; i < found.size(); ++i)
+        {
+            if (!found[i])
+                ++falsePositives_;
+            results[index[i]] = std::move(found[i]);
+        }
+
+        return {std::move(results), status};
+    }
+
+    void
+    store(std::shared_ptr<NodeObject> const& object) override
+    {
+        insert(&object, 1, false);
+        backend_->store(object);
+    }
+
+    void
+    storeBatch(Batch const& batch) override
+    {
+        insert(batch.data(), batch.size(), true);
+        backend_->storeBatch(batch);
+    }
+
+    void
+    sync() override
+    {
+        {
+            std::lock_guard lock(logMutex_);
+            writeLog(lock);
+            if (logFile_ && !detail::syncFile(logFile_))
+                abandon(lock);
+        }
+        backend_->sync();
+    }
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
+    {
+        backend_->for_each(std::move(f));
+    }
+
+    int
+    getWriteLoad() override
+    {
+        return backend_->getWriteLoad();
+    }
+
+    void
+    setDeletePath() override
+    {
+        deletePath_ = true;
+        backend_->setDeletePath();
+    }
+
+    void
+    verify() override
+    {
+        backend_->verify();
+    }
+
+    int
+    fdRequired() const override
+    {
+        return backend_->fdRequired();
+    }
+
+    std::optional<Counters<std::uint64_t>>
+    counters() const override
+    {
+        return backend_->counters();
+    }
+
+    void
+    getCountsJson(Json::Value& obj) const override
+    {
+        backend_->getCountsJson(obj);
+
+        auto const checks = checks_.load();
+        auto const hits = hits_.load();
+        auto const falsePositives = falsePositives_.load();
+
+        obj[jss::node_filter_checks] = std::to_string(checks);
+        obj[jss::node_filter_hits] = std::to_string(hits);
+        obj[jss::node_filter_false_positives] = std::to_string(falsePositives);
+        obj[jss::node_filter_keys] = std::to_string(filter_.inserted());
+
+        // The share of fetches answered without I/O, and the share of
+        // absent keys the filter failed to recognize
+        obj[jss::node_filter_hit_rate] =
+            checks ? static_cast<double>(hits) / checks : 0.0;
+        obj[jss::node_filter_false_positive_rate] = (hits + falsePositives)
+            ? static_cast<double>(falsePositives) / (hits + falsePositives)
+            : 0.0;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+std::unique_ptr<Backend>
+makeFilteredBackend(
+    std::unique_ptr<Backend> backend,
+    Section const& config,
+    beast::Journal journal)
+{
+    std::uint64_t keys = 0;
+    if (!get_if_exists(config, "negative_filter_keys", keys) || keys == 0)
+        return backend;
+
+    auto const bitsPerKey =
+        get<std::uint32_t>(config, "negative_filter_bits", 10);
+    if (bitsPerKey < 1 || bitsPerKey > 64)
+    {
+        Throw<std::runtime_error>(
+            "negative_filter_bits must be between 1 and 64");
+    }
+
+    return std::make_unique<FilteredBackend>(
+        std::move(backend), get(config, "path"), keys, bitsPerKey, journal);
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_FILTEREDBACKEND_H_INCLUDED
+#define RIPPLE_NODESTORE_FILTEREDBACKEND_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/nodestore/Backend.h>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Put a negative lookup filter in front of a backend, if configured.
+
+    When the section sets `negative_filter_keys`, the returned backend keeps
+    a NegativeFilter of every key it stores and answers fetches for keys the
+    filter has never seen with `notFound`, without touching the wrapped
+    backend.
+
+    The filter is saved in the backend's directory on close, and loaded on
+    open. Keys stored in between are appended to a log next to it before
+    they reach the backend, and the filter is saved again whenever the log
+    grows large, so after a crash the saved filter is brought up to date
+    from the log. When no saved filter is available, it is rebuilt by
+    visiting every object of the backend.
+
+    @param backend The backend to wrap. It must not be open yet.
+    @param config The backend's configuration section.
+    @param journal Destination for logging output.
+    @return The backend to use, `backend` itself if no filter is configured.
+*/
+std::unique_ptr<Backend>
+makeFilteredBackend(
+    std::unique_ptr<Backend> backend,
+    Section const& config,
+    beast::Journal journal);
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
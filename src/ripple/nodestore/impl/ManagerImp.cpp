@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/nodestore/impl/DatabaseNodeImp.h>
+#include <ripple/nodestore/impl/FilteredBackend.h>
 #include <ripple/nodestore/impl/ManagerImp.h>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -64,8 +65,11 @@ ManagerImp::make_Backend(
         missing_backend();
     }
 
-    return factory->createInstance(
-        NodeObject::keyBytes, parameters, burstSize, scheduler, journal);
+    return makeFilteredBackend(
+        factory->createInstance(
+            NodeObject::keyBytes, parameters, burstSize, scheduler, journal),
+        parameters,
+        journal);
 }
 
 std::unique_ptr<Database>
@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/hash/xxhasher.h>
+#include <ripple/nodestore/impl/NegativeFilter.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace detail {
+
+// Filter file layout, in native byte order:
+//
+//  magic       8 bytes
+//  blocks      8 bytes
+//  hashes      8 bytes
+//  inserted    8 bytes
+//  words       blocks * 64 bytes
+//  checksum    8 bytes, xxhash64 of the words
+//
+std::array<char, 8> constexpr filterMagic{'R', 'P', 'L', 'N', 'F', 'L', 'T', 1};
+
+// Words are copied through a buffer of this size to and from the file
+std::size_t constexpr filterChunkWords = 64 * 1024;
+
+}  // namespace detail
+
+NegativeFilter::NegativeFilter(std::uint64_t keys, std::uint32_t bitsPerKey)
+    : capacity_(keys)
+    , blocks_(std::max<std::uint64_t>(
+          1,
+          (std::max<std::uint64_t>(keys, 1) * bitsPerKey + blockBits - 1) /
+              blockBits))
+    , hashes_(std::clamp<std::uint32_t>(
+          static_cast<std::uint32_t>(std::lround(bitsPerKey * 0.69)),
+          1,
+          16))
+    , words_(std::make_unique<std::atomic<std::uint64_t>[]>(
+          blocks_ * blockWords))
+{
+}
+
+bool
+NegativeFilter::save(boost::filesystem::path const& path) const
+{
+    auto const temp = boost::filesystem::path(path).concat(".tmp");
+
+    {
+        std::ofstream out(temp.string(), std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+
+        std::uint64_t const header[] = {
+            blocks_, hashes_, inserted_.load(std::memory_order_relaxed)};
+
+        out.write(detail::filterMagic.data(), detail::filterMagic.size());
+        out.write(reinterpret_cast<char const*>(header), sizeof(header));
+
+        auto const words = blocks_ * blockWords;
+        std::vector<std::uint64_t> buffer;
+        buffer.reserve(
+            std::min<std::uint64_t>(words, detail::filterChunkWords));
+
+        beast::xxhasher h;
+        for (std::uint64_t i = 0; i < words && out; i += buffer.size())
+        {
+            buffer.clear();
+            for (auto j = i;
+                 j < words && buffer.size() < detail::filterChunkWords;
+                 ++j)
+                buffer.push_back(words_[j].load(std::memory_order_relaxed));
+
+            auto const bytes = buffer.size() * sizeof(std::uint64_t);
+            h(buffer.data(), bytes);
+            out.write(reinterpret_cast<char const*>(buffer.data()), bytes);
+        }
+
+        auto const checksum = static_cast<std::uint64_t>(h);
+        out.write(reinterpret_cast<char const*>(&checksum), sizeof(checksum));
+
+        out.flush();
+        if (!out)
+            return false;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(temp, path, ec);
+    return !ec;
+}
+
+bool
+NegativeFilter::load(boost::filesystem::path const& path)
+{
+    auto const words = blocks_ * blockWords;
+
+    auto clear = [&] {
+        for (std::uint64_t i = 0; i < words; ++i)
+            words_[i].store(0, std::memory_order_relaxed);
+        inserted_.store(0, std::memory_order_relaxed);
+        return false;
+    };
+
+    std::ifstream in(path.string(), std::ios::binary);
+    if (!in)
+        return false;
+
+    std::array<char, 8> magic;
+    std::uint64_t header[3];
+    in.read(magic.data(), magic.size());
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    if (!in || magic != detail::filterMagic || header[0] != blocks_ ||
+        header[1] != hashes_)
+        return false;
+
+    std::vector<std::uint64_t> buffer(
+        std::min<std::uint64_t>(words, detail::filterChunkWords));
+
+    beast::xxhasher h;
+    for (std::uint64_t i = 0; i < words;)
+    {
+        auto const n = std::min<std::uint64_t>(buffer.size(), words - i);
+        in.read(
+            reinterpret_cast<char*>(buffer.data()),
+            n * sizeof(std::uint64_t));
+        if (!in)
+            return clear();
+
+        h(buffer.data(), n * sizeof(std::uint64_t));
+        for (std::uint64_t j = 0; j < n; ++j, ++i)
+            words_[i].store(buffer[j], std::memory_order_relaxed);
+    }
+
+    std::uint64_t checksum;
+    in.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+    if (!in || static_cast<std::uint64_t>(h) != checksum)
+        return clear();
+
+    inserted_.store(header[2], std::memory_order_relaxed);
+    return true;
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
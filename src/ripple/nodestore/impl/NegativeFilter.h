@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_NEGATIVEFILTER_H_INCLUDED
+#define RIPPLE_NODESTORE_NEGATIVEFILTER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A blocked Bloom filter of NodeStore keys.
+
+    The filter answers "definitely absent" for keys that were never inserted,
+    so a lookup for a missing object can skip the backend entirely. Keys that
+    may be present are passed on to the backend.
+
+    All the bits set by one key are in a single 512-bit block, so a query
+    touches one cache line. NodeStore keys are SHA-512Half digests: their
+    bytes are used directly as hash values.
+
+    @note insert and mayContain may be called concurrently.
+*/
+class NegativeFilter
+{
+public:
+    /** Create an empty filter.
+
+        @param keys The number of keys the filter is sized for.
+        @param bitsPerKey The number of filter bits per key.
+    */
+    NegativeFilter(std::uint64_t keys, std::uint32_t bitsPerKey);
+
+    NegativeFilter(NegativeFilter const&) = delete;
+    NegativeFilter&
+    operator=(NegativeFilter const&) = delete;
+
+    void
+    insert(uint256 const& key) noexcept
+    {
+        auto const [block, h1, h2] = locate(key);
+        for (std::uint32_t i = 0; i < hashes_; ++i)
+        {
+            auto const bit = (h1 + i * h2) % blockBits;
+            block[bit / 64].fetch_or(
+                std::uint64_t{1} << (bit % 64), std::memory_order_relaxed);
+        }
+        inserted_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** Returns `false` if the key was definitely never inserted. */
+    bool
+    mayContain(uint256 const& key) const noexcept
+    {
+        auto const [block, h1, h2] = locate(key);
+        for (std::uint32_t i = 0; i < hashes_; ++i)
+        {
+            auto const bit = (h1 + i * h2) % blockBits;
+            if ((block[bit / 64].load(std::memory_order_relaxed) &
+                 (std::uint64_t{1} << (bit % 64))) == 0)
+                return false;
+        }
+        return true;
+    }
+
+    /** The number of insertions, including duplicate keys. */
+    std::uint64_t
+    inserted() const noexcept
+    {
+        return inserted_.load(std::memory_order_relaxed);
+    }
+
+    /** The number of keys the filter is sized for. */
+    std::uint64_t
+    capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+    /** Write the filter to a file.
+
+        The file is written under a temporary name and renamed, so an
+        interrupted save never leaves a partial filter behind.
+
+        @return `true` if the filter was saved.
+    */
+    bool
+    save(boost::filesystem::path const& path) const;
+
+    /** Replace the contents of the filter with those of a file.
+
+        The file must have been saved by a filter with the same geometry.
+
+        @return `true` if the filter was loaded. On failure the filter is
+                left empty.
+    */
+    bool
+    load(boost::filesystem::path const& path);
+
+private:
+    static constexpr std::uint64_t blockBits = 512;
+    static constexpr std::uint64_t blockWords = blockBits / 64;
+
+    std::uint64_t const capacity_;
+    std::uint64_t const blocks_;
+    std::uint32_t const hashes_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+    std::atomic<std::uint64_t> inserted_{0};
+
+    struct Location
+    {
+        std::atomic<std::uint64_t>* block;
+        std::uint64_t h1;
+        std::uint64_t h2;
+    };
+
+    Location
+    locate(uint256 const& key) const noexcept
+    {
+        static_assert(uint256::bytes >= 3 * sizeof(std::uint64_t));
+
+        std::uint64_t w[3];
+        std::memcpy(w, key.data(), sizeof(w));
+
+        // An odd step visits distinct bits for every hash in the block
+        return {&words_[(w[0] % blocks_) * blockWords], w[1], w[2] | 1};
+    }
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
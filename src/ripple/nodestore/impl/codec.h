@@ -26,14 +26,17 @@
 #include <ripple/basics/contract.h>
 #include <ripple/basics/safe_cast.h>
 #include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/impl/Dictionaries.h>
 #include <ripple/nodestore/impl/varint.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <cstddef>
 #include <cstring>
 #include <lz4.h>
+#include <memory>
 #include <nudb/detail/field.hpp>
 #include <string>
 #include <utility>
+#include <zstd.h>
 
 namespace ripple {
 namespace NodeStore {
@@ -92,6 +95,90 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     return result;
 }
 
+// zstd with a dictionary: the id of the dictionary and the size of the
+// object, followed by a zstd frame without a checksum, content size or
+// dictionary id. Objects are small, so those would cost more than they
+// are worth.
+
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+zstd_decompress(
+    void const* in,
+    std::size_t in_size,
+    Dictionaries const* dictionaries,
+    BufferFactory&& bf)
+{
+    using namespace nudb::detail;
+
+    auto const p = reinterpret_cast<std::uint8_t const*>(in);
+    std::size_t id = 0;
+    auto const n1 = read_varint(p, in_size, id);
+    if (n1 == 0)
+        Throw<std::runtime_error>("zstd_decompress: invalid blob");
+    std::size_t outSize = 0;
+    auto const n2 = read_varint(p + n1, in_size - n1, outSize);
+    if (n2 == 0 || n1 + n2 >= in_size || outSize == 0)
+        Throw<std::runtime_error>("zstd_decompress: invalid blob");
+
+    Dictionary const* const dictionary = dictionaries
+        ? dictionaries->find(static_cast<std::uint32_t>(id))
+        : nullptr;
+    if (!dictionary)
+        Throw<std::runtime_error>(
+            "zstd_decompress: unknown dictionary " + std::to_string(id));
+
+    thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx{
+        ZSTD_createDCtx(), &ZSTD_freeDCtx};
+
+    void* const out = bf(outSize);
+    auto const result = ZSTD_decompress_usingDDict(
+        dctx.get(),
+        out,
+        outSize,
+        p + n1 + n2,
+        in_size - n1 - n2,
+        dictionary->decompressor());
+    if (result != outSize)
+        Throw<std::runtime_error>("zstd_decompress: ZSTD_decompress");
+
+    return {out, outSize};
+}
+
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+zstd_compress(
+    void const* in,
+    std::size_t in_size,
+    Dictionary const& dictionary,
+    BufferFactory&& bf)
+{
+    using namespace nudb::detail;
+
+    thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx{
+        [] {
+            auto const cctx = ZSTD_createCCtx();
+            ZSTD_CCtx_setParameter(cctx, ZSTD_c_contentSizeFlag, 0);
+            ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 0);
+            ZSTD_CCtx_setParameter(cctx, ZSTD_c_dictIDFlag, 0);
+            return cctx;
+        }(),
+        &ZSTD_freeCCtx};
+
+    auto const n = size_varint(dictionary.id()) + size_varint(in_size);
+    auto const out_max = ZSTD_compressBound(in_size);
+    auto const out = reinterpret_cast<std::uint8_t*>(bf(n + out_max));
+    ostream os(out, n);
+    write<varint>(os, dictionary.id());
+    write<varint>(os, in_size);
+
+    ZSTD_CCtx_refCDict(cctx.get(), dictionary.compressor());
+    auto const out_size =
+        ZSTD_compress2(cctx.get(), out + n, out_max, in, in_size);
+    if (ZSTD_isError(out_size))
+        Throw<std::runtime_error>("zstd compress");
+    return {out, n + out_size};
+}
+
 //------------------------------------------------------------------------------
 
 /*
@@ -101,11 +188,16 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     1 = lz4 compressed
     2 = inner node compressed
     3 = full inner node
+    4 = zstd compressed with a dictionary
 */
 
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_decompress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    Dictionaries const* dictionaries = nullptr)
 {
     using namespace nudb::detail;
 
@@ -199,6 +291,11 @@ nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
             write(os, is(512), 512);
             break;
         }
+        case 4:  // zstd with a dictionary
+        {
+            result = zstd_decompress(p, in_size, dictionaries, bf);
+            break;
+        }
         default:
             Throw<std::runtime_error>(
                 "nodeobject codec: bad type=" + std::to_string(type));
@@ -214,9 +311,40 @@ zero32()
     return v.data();
 }
 
+// Returns `true` if an encoded object is an inner node
+template <class = void>
+bool
+is_inner_node(void const* in, std::size_t in_size)
+{
+    using namespace nudb::detail;
+
+    if (in_size != 525)
+        return false;
+    istream is(in, in_size);
+    std::uint32_t index;
+    std::uint32_t unused;
+    std::uint8_t kind;
+    std::uint32_t prefix;
+    read<std::uint32_t>(is, index);
+    read<std::uint32_t>(is, unused);
+    read<std::uint8_t>(is, kind);
+    read<std::uint32_t>(is, prefix);
+    return safe_cast<HashPrefix>(prefix) == HashPrefix::innerNode;
+}
+
+/** Compress an encoded object.
+
+    Objects of a type that has a dictionary in `dictionaries` are
+    compressed with it. Decompressing them requires a set that has the
+    same dictionary.
+*/
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_compress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    Dictionaries const* dictionaries = nullptr)
 {
     using std::runtime_error;
     using namespace nudb::detail;
@@ -278,6 +406,26 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
         }
     }
 
+    // See EncodedBlob for the layout
+    if (dictionaries && in_size > 9)
+    {
+        auto const type = static_cast<NodeObjectType>(
+            reinterpret_cast<std::uint8_t const*>(in)[8]);
+        if (auto const dictionary = dictionaries->compressor(type))
+        {
+            auto const vs = size_varint(4U);
+            std::uint8_t* p;
+            auto const zr = NodeStore::zstd_compress(
+                in, in_size, *dictionary, [&p, &vs, &bf](std::size_t n) {
+                    p = reinterpret_cast<std::uint8_t*>(bf(vs + n));
+                    return p + vs;
+                });
+            ostream os(p, vs);
+            write<varint>(os, 4U);
+            return {p, vs + zr.second};
+        }
+    }
+
     std::array<std::uint8_t, varint_traits<std::size_t>::max> vi;
 
     constexpr std::size_t codecType = 1;
@@ -0,0 +1,136 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/core/ParallelFor.h>
+#include <ripple/overlay/impl/BatchVerifier.h>
+
+#include <unordered_map>
+
+namespace ripple {
+
+BatchVerifier::BatchVerifier(JobQueue& jobQueue, beast::Journal journal)
+    : jobQueue_(jobQueue), j_(journal)
+{
+}
+
+void
+BatchVerifier::submit(
+    JobType type,
+    std::string const& name,
+    uint256 const& suppression,
+    Verify verify,
+    Done done)
+{
+    std::lock_guard lock(mutex_);
+
+    auto& batch = batches_[type];
+    batch.items.push_back({suppression, std::move(verify), std::move(done)});
+
+    // Messages arriving while the job waits join its batch
+    if (!batch.scheduled &&
+        jobQueue_.addJob(type, name, [this, type]() { process(type); }))
+        batch.scheduled = true;
+}
+
+std::size_t
+BatchVerifier::size() const
+{
+    std::lock_guard lock(mutex_);
+
+    std::size_t result = 0;
+    for (auto const& [type, batch] : batches_)
+        result += batch.items.size();
+    return result;
+}
+
+void
+BatchVerifier::process(JobType type)
+{
+    std::vector<Item> items;
+    {
+        std::lock_guard lock(mutex_);
+        auto& batch = batches_[type];
+        items.swap(batch.items);
+        batch.scheduled = false;
+    }
+
+    // Group the messages needing a check by suppression hash, keeping the
+    // order they arrived in.
+    std::vector<std::vector<std::size_t>> groups;
+    std::unordered_map<uint256, std::size_t, hardened_hash<>> index;
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        if (!items[i].verify)
+        {
+            groups.push_back({i});
+            continue;
+        }
+
+        auto const [it, inserted] =
+            index.emplace(items[i].suppression, groups.size());
+        if (inserted)
+            groups.emplace_back();
+        groups[it->second].push_back(i);
+    }
+
+    JLOG(j_.trace()) << "Checking " << items.size() << " messages in "
+                     << groups.size() << " groups";
+
+    // A check that throws is a bad signature, so that every message of the
+    // group is still handled and its sender charged
+    auto check = [&](std::size_t g) {
+        auto const& first = items[groups[g].front()];
+        bool good = false;
+        try
+        {
+            good = !first.verify || first.verify();
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.warn()) << "Exception checking signature: " << e.what();
+        }
+
+        for (auto const i : groups[g])
+        {
+            try
+            {
+                items[i].done(good);
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(j_.warn()) << "Exception handling message: " << e.what();
+            }
+        }
+    };
+
+    if (groups.size() > 1)
+        parallelFor(
+            jobQueue_,
+            type,
+            "BatchVerifier::check",
+            groups.size(),
+            maxHelpers,
+            check);
+    else if (!groups.empty())
+        check(0);
+}
+
+}  // namespace ripple
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_BATCHVERIFIER_H_INCLUDED
+#define RIPPLE_OVERLAY_BATCHVERIFIER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/core/JobQueue.h>
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+/** Checks the signatures of proposals and validations received from peers.
+
+    Every proposal and validation used to be checked in a job of its own.
+    Instead, messages of the same job type are collected while a job to
+    check them waits in the job queue, and that job checks them together:
+    messages with the same suppression hash are checked only once, and
+    the checks are spread over several jobs running at the same time.
+
+    Proposals and validations are only ever signed with secp256k1 keys,
+    which cannot be verified in batches, so each signature is still
+    verified on its own.
+
+    @note This class is thread-safe.
+*/
+class BatchVerifier
+{
+public:
+    /** Returns `true` if the signature of a message is good. */
+    using Verify = std::function<bool()>;
+
+    /** Handles a message once its signature was checked. */
+    using Done = std::function<void(bool)>;
+
+    /** The most jobs helping a job to check a batch. */
+    static constexpr std::size_t maxHelpers = 3;
+
+    BatchVerifier(JobQueue& jobQueue, beast::Journal journal);
+
+    BatchVerifier(BatchVerifier const&) = delete;
+    BatchVerifier&
+    operator=(BatchVerifier const&) = delete;
+
+    /** Check the signature of a message.
+
+        @param type The type of the jobs checking the message.
+        @param name The name of the job checking the batch, if one has to
+                    be added.
+        @param suppression Identifies the message.
+        @param verify Checks the signature. It is not called if another
+                      message with the same suppression hash, in the same
+                      batch, is checked. If empty, the message needs no
+                      check, as for proposals from cluster members.
+        @param done Called with the result of the check.
+    */
+    void
+    submit(
+        JobType type,
+        std::string const& name,
+        uint256 const& suppression,
+        Verify verify,
+        Done done);
+
+    /** The number of messages waiting to be checked. */
+    std::size_t
+    size() const;
+
+private:
+    struct Item
+    {
+        uint256 suppression;
+        Verify verify;
+        Done done;
+    };
+
+    struct Batch
+    {
+        std::vector<Item> items;
+        bool scheduled = false;
+    };
+
+    void
+    process(JobType type);
+
+    JobQueue& jobQueue_;
+    beast::Journal const j_;
+
+    mutable std::mutex mutex_;
+    std::map<JobType, Batch> batches_;
+};
+
+}  // namespace ripple
+
+#endif
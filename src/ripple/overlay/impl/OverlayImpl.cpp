@@ -141,6 +141,7 @@ OverlayImpl::OverlayImpl(
     , next_id_(1)
     , timer_count_(0)
     , slots_(app.logs(), *this)
+    , verifier_(app_.getJobQueue(), app_.journal("BatchVerifier"))
     , m_stats(
           std::bind(&OverlayImpl::collect_metrics, this),
           collector,
@@ -28,6 +28,7 @@
 #include <ripple/overlay/Message.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/Slot.h>
+#include <ripple/overlay/impl/BatchVerifier.h>
 #include <ripple/overlay/impl/Handshake.h>
 #include <ripple/overlay/impl/TrafficCount.h>
 #include <ripple/overlay/impl/TxMetrics.h>
@@ -130,6 +131,9 @@ private:
     // Transaction reduce-relay metrics
     metrics::TxMetrics txMetrics_;
 
+    // Checks the signatures of proposals and validations from peers
+    BatchVerifier verifier_;
+
     // A message with the list of manifests we send to peers
     std::shared_ptr<Message> manifestMessage_;
     // Used to track whether we need to update the cached list of manifests
@@ -454,6 +458,12 @@ public:
         txMetrics_.addMetrics(args...);
     }
 
+    BatchVerifier&
+    verifier()
+    {
+        return verifier_;
+    }
+
 private:
     void
     squelch(
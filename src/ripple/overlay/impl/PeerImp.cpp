@@ -1013,6 +1013,8 @@ PeerImp::onMessageBegin(
     std::size_t uncompressed_size,
     bool isCompressed)
 {
+    if (perf::Tracer::instance().enabled())
+        traceStart_ = perf::Tracer::now();
     load_event_ =
         app_.getJobQueue().makeLoadEvent(jtPEER, protocolMessageName(type));
     fee_ = Resource::feeLightPeer;
@@ -1041,11 +1043,18 @@ PeerImp::onMessageBegin(
 
 void
 PeerImp::onMessageEnd(
-    std::uint16_t,
+    std::uint16_t type,
     std::shared_ptr<::google::protobuf::Message> const&)
 {
     load_event_.reset();
     charge(fee_);
+
+    if (traceStart_ != 0)
+    {
+        perf::Tracer::instance().record(
+            protocolMessageName(type), traceStart_, perf::Tracer::now());
+        traceStart_ = 0;
+    }
 }
 
 void
@@ -2004,13 +2013,20 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMProposeSet> const& m)
             app_.timeKeeper().closeTime(),
             calcNodeID(app_.validatorManifests().getMasterKey(publicKey))});
 
+    // Proposals from cluster members are not checked
+    BatchVerifier::Verify verify;
+    if (!cluster())
+        verify = [proposal]() { return proposal.checkSign(); };
+
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue().addJob(
+    overlay_.verifier().submit(
         isTrusted ? jtPROPOSAL_t : jtPROPOSAL_ut,
         "recvPropose->checkPropose",
-        [weak, isTrusted, m, proposal]() {
+        suppression,
+        std::move(verify),
+        [weak, isTrusted, m, proposal](bool goodSignature) {
             if (auto peer = weak.lock())
-                peer->checkPropose(isTrusted, m, proposal);
+                peer->checkPropose(goodSignature, isTrusted, m, proposal);
         });
 }
 
@@ -2608,12 +2624,14 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMValidation> const& m)
             }();
 
             std::weak_ptr<PeerImp> weak = shared_from_this();
-            app_.getJobQueue().addJob(
+            overlay_.verifier().submit(
                 isTrusted ? jtVALIDATION_t : jtVALIDATION_ut,
                 name,
-                [weak, val, m, key]() {
+                key,
+                [val]() { return val->isValid(); },
+                [weak, val, m, key](bool goodSignature) {
                     if (auto peer = weak.lock())
-                        peer->checkValidation(val, key, m);
+                        peer->checkValidation(goodSignature, val, key, m);
                 });
         }
         else
@@ -3123,6 +3141,7 @@ PeerImp::checkTransaction(
 // Called from our JobQueue
 void
 PeerImp::checkPropose(
+    bool goodSignature,
     bool isTrusted,
     std::shared_ptr<protocol::TMProposeSet> const& packet,
     RCLCxPeerPos peerPos)
@@ -3132,7 +3151,7 @@ PeerImp::checkPropose(
 
     assert(packet);
 
-    if (!cluster() && !peerPos.checkSign())
+    if (!goodSignature)
     {
         JLOG(p_journal_.warn()) << "Proposal fails sig check";
         charge(Resource::feeInvalidSignature);
@@ -3165,11 +3184,12 @@ PeerImp::checkPropose(
 
 void
 PeerImp::checkValidation(
+    bool goodSignature,
     std::shared_ptr<STValidation> const& val,
     uint256 const& key,
     std::shared_ptr<protocol::TMValidation> const& packet)
 {
-    if (!val->isValid())
+    if (!goodSignature)
     {
         JLOG(p_journal_.debug()) << "Validation forwarded by peer is invalid";
         charge(Resource::feeInvalidSignature);
@@ -24,6 +24,7 @@
 #include <ripple/app/ledger/impl/LedgerReplayMsgHandler.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/RangeSet.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/beast/utility/WrappedSink.h>
 #include <ripple/nodestore/ShardInfo.h>
@@ -159,6 +160,8 @@ private:
     bool gracefulClose_ = false;
     int large_sendq_ = 0;
     std::unique_ptr<LoadEvent> load_event_;
+    // When handling of the current message started, if it is traced
+    perf::Tracer::tick_type traceStart_ = 0;
     // The highest sequence of each PublisherList that has
     // been sent to or received from this peer.
     hash_map<PublicKey, std::size_t> publisherListSequences_;
@@ -619,12 +622,14 @@ private:
 
     void
     checkPropose(
+        bool goodSignature,
         bool isTrusted,
         std::shared_ptr<protocol::TMProposeSet> const& packet,
         RCLCxPeerPos peerPos);
 
     void
     checkValidation(
+        bool goodSignature,
         std::shared_ptr<STValidation> const& val,
         uint256 const& key,
         std::shared_ptr<protocol::TMValidation> const& packet);
@@ -58,7 +58,7 @@ protocolMessageType(protocol::TMProofPathRequest const&)
 
 /** Returns the name of a protocol message given its type. */
 template <class = void>
-std::string
+char const*
 protocolMessageName(int type)
 {
     switch (type)
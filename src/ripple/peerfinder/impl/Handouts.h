@@ -33,25 +33,20 @@ namespace PeerFinder {
 namespace detail {
 
 /** Try to insert one object in the target.
-    When an item is handed out it is moved to the end of the container.
+    Objects are drawn from the container in a random order, so the cost
+    is proportional to the number the target rejects rather than to the
+    size of the container.
     @return The number of objects inserted
 */
-// VFALCO TODO specialization that handles std::list for SequenceContainer
-//             using splice for optimization over erase/push_back
-//
 template <class Target, class HopContainer>
 std::size_t
 handout_one(Target& t, HopContainer& h)
 {
     assert(!t.full());
-    for (auto it = h.begin(); it != h.end(); ++it)
+    for (std::size_t i = 0; i < h.size(); ++i)
     {
-        auto const& e = *it;
-        if (t.try_insert(e))
-        {
-            h.move_back(it);
+        if (t.try_insert(h.draw(i)))
             return 1;
-        }
     }
     return 0;
 }
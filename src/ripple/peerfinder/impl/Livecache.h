@@ -27,10 +27,11 @@
 #include <ripple/peerfinder/PeerfinderManager.h>
 #include <ripple/peerfinder/impl/Tuning.h>
 #include <ripple/peerfinder/impl/iosformat.h>
-#include <boost/intrusive/list.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
 #include <algorithm>
+#include <cassert>
+#include <vector>
 
 namespace ripple {
 namespace PeerFinder {
@@ -46,17 +47,22 @@ public:
     explicit LivecacheBase() = default;
 
 protected:
-    struct Element : boost::intrusive::list_base_hook<>
+    struct Element
     {
         Element(Endpoint const& endpoint_) : endpoint(endpoint_)
         {
         }
 
         Endpoint endpoint;
+
+        // Position of this element in the list for its hops
+        std::size_t index = 0;
     };
 
-    using list_type = boost::intrusive::
-        make_list<Element, boost::intrusive::constant_time_size<false>>::type;
+    // Elements at the same hops, in no particular order. Each element
+    // knows its own position, so one can be removed, or a random one
+    // chosen, in constant time.
+    using list_type = std::vector<Element*>;
 
 public:
     /** A list of Endpoint at the same hops
@@ -70,15 +76,15 @@ public:
         // Iterator transformation to extract the endpoint from Element
         struct Transform
         {
-            using first_argument = Element;
+            using first_argument = Element const*;
             using result_type = Endpoint;
 
             explicit Transform() = default;
 
             Endpoint const&
-            operator()(Element const& e) const
+            operator()(Element const* e) const
             {
-                return e.endpoint;
+                return e->endpoint;
             }
         };
 
@@ -142,13 +148,38 @@ public:
             return reverse_iterator(m_list.get().crend(), Transform());
         }
 
-        // move the element to the end of the container
-        void
-        move_back(const_iterator pos)
+        std::size_t
+        size() const
+        {
+            return m_list.get().size();
+        }
+
+        bool
+        empty() const
         {
-            auto& e(const_cast<Element&>(*pos.base()));
-            m_list.get().erase(m_list.get().iterator_to(e));
-            m_list.get().push_back(e);
+            return m_list.get().empty();
+        }
+
+        /** Draw a random endpoint from those not yet drawn.
+
+            The endpoints at positions [0, pos) have been drawn already.
+            One of the rest is chosen at random and moved to `pos`, so
+            drawing at 0, 1, 2... visits the endpoints in a random order
+            without shuffling the whole list first.
+        */
+        Endpoint const&
+        draw(std::size_t pos)
+        {
+            auto& list = m_list.get();
+            assert(pos < list.size());
+            if (pos + 1 < list.size())
+            {
+                auto const other = rand_int(pos, list.size() - 1);
+                std::swap(list[pos], list[other]);
+                list[pos]->index = pos;
+                list[other]->index = other;
+            }
+            return list[pos]->endpoint;
         }
 
     private:
@@ -496,13 +527,9 @@ Livecache<Allocator>::hops_t::shuffle()
 {
     for (auto& list : m_lists)
     {
-        std::vector<std::reference_wrapper<Element>> v;
-        v.reserve(list.size());
-        std::copy(list.begin(), list.end(), std::back_inserter(v));
-        std::shuffle(v.begin(), v.end(), default_prng());
-        list.clear();
-        for (auto& e : v)
-            list.push_back(e);
+        std::shuffle(list.begin(), list.end(), default_prng());
+        for (std::size_t i = 0; i < list.size(); ++i)
+            list[i]->index = i;
     }
 }
 
@@ -531,8 +558,11 @@ void
 Livecache<Allocator>::hops_t::insert(Element& e)
 {
     assert(e.endpoint.hops <= Tuning::maxHops + 1);
-    // This has security implications without a shuffle
-    m_lists[e.endpoint.hops].push_front(e);
+    // The order of a list is not random, so endpoints must be handed
+    // out with draw() or after a shuffle.
+    auto& list = m_lists[e.endpoint.hops];
+    e.index = list.size();
+    list.push_back(&e);
     ++m_hist[e.endpoint.hops];
 }
 
@@ -542,10 +572,7 @@ Livecache<Allocator>::hops_t::reinsert(Element& e, std::uint32_t numHops)
 {
     assert(numHops <= Tuning::maxHops + 1);
 
-    auto& list = m_lists[e.endpoint.hops];
-    list.erase(list.iterator_to(e));
-
-    --m_hist[e.endpoint.hops];
+    remove(e);
 
     e.endpoint.hops = numHops;
     insert(e);
@@ -557,8 +584,12 @@ Livecache<Allocator>::hops_t::remove(Element& e)
 {
     --m_hist[e.endpoint.hops];
 
+    // Fill the hole with the last element
     auto& list = m_lists[e.endpoint.hops];
-    list.erase(list.iterator_to(e));
+    assert(e.index < list.size() && list[e.index] == &e);
+    list[e.index] = list.back();
+    list[e.index]->index = e.index;
+    list.pop_back();
 }
 
 }  // namespace PeerFinder
@@ -20,6 +20,7 @@
 #include <ripple/perflog/impl/PerfLogImp.h>
 
 #include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/core/JobTypes.h>
@@ -317,6 +318,8 @@ PerfLogImp::PerfLogImp(
     : setup_(setup), app_(app), j_(journal), signalStop_(std::move(signalStop))
 {
     openLog();
+    if (setup_.trace)
+        Tracer::instance().enable(true);
 }
 
 PerfLogImp::~PerfLogImp()
@@ -494,6 +497,7 @@ setup_PerfLog(Section const& section, boost::filesystem::path const& configDir)
     std::uint64_t logInterval;
     if (get_if_exists(section, "log_interval", logInterval))
         setup.logInterval = std::chrono::seconds(logInterval);
+    get_if_exists(section, "trace", setup.trace);
     return setup;
 }
 
@@ -0,0 +1,216 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Tracer.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/protocol/jss.h>
+
+#include <algorithm>
+#include <tuple>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace ripple {
+namespace perf {
+
+// Gives the thread's buffer back to the tracer when the thread exits
+class Tracer::Owner
+{
+public:
+    Owner(Tracer& tracer, Buffer* buffer) : tracer_(tracer), buffer_(buffer)
+    {
+    }
+
+    ~Owner()
+    {
+        std::lock_guard lock(tracer_.mutex_);
+        buffer_->inUse = false;
+    }
+
+    Buffer*
+    get() const
+    {
+        return buffer_;
+    }
+
+private:
+    Tracer& tracer_;
+    Buffer* buffer_;
+};
+
+Tracer::Tracer()
+    : startTicks_(now()), startTime_(std::chrono::steady_clock::now())
+{
+}
+
+Tracer&
+Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::tick_type
+Tracer::now() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_MSC_VER)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+void
+Tracer::enable(bool enabled)
+{
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+Tracer::Buffer*
+Tracer::buffer()
+{
+    thread_local std::unique_ptr<Owner> owner;
+    if (owner)
+        return owner->get();
+
+    std::lock_guard lock(mutex_);
+
+    Buffer* result = nullptr;
+    for (auto const& b : buffers_)
+    {
+        if (!b->inUse)
+        {
+            // The spans of the thread that exited are kept until they are
+            // overwritten
+            result = b.get();
+            result->inUse = true;
+            break;
+        }
+    }
+
+    if (!result)
+    {
+        buffers_.push_back(std::make_unique<Buffer>());
+        result = buffers_.back().get();
+        result->tid = static_cast<std::uint32_t>(buffers_.size());
+    }
+
+    result->threadName = beast::getCurrentThreadName();
+    owner = std::make_unique<Owner>(*this, result);
+    return result;
+}
+
+void
+Tracer::record(char const* name, tick_type start, tick_type end) noexcept
+{
+    try
+    {
+        auto const b = buffer();
+        auto const head = b->head.load(std::memory_order_relaxed);
+        auto& e = b->events[head % bufferSize];
+        e.name.store(name, std::memory_order_relaxed);
+        e.start.store(start, std::memory_order_relaxed);
+        e.end.store(end, std::memory_order_relaxed);
+        b->head.store(head + 1, std::memory_order_release);
+    }
+    catch (std::exception const&)
+    {
+        // The span is lost if there is no memory for a new buffer
+    }
+}
+
+Json::Value
+Tracer::getJson() const
+{
+    // Work out how fast the ticks go from how many have passed
+    double const ticks = now() - startTicks_;
+    double const us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - startTime_)
+                          .count();
+    double const ticksPerUs = ticks > 0 && us > 0 ? ticks / us : 1;
+    auto toUs = [&](tick_type t) { return (t - startTicks_) / ticksPerUs; };
+
+    Json::Value ret(Json::objectValue);
+    ret[jss::enabled] = enabled();
+    ret[jss::displayTimeUnit] = "ms";
+    auto& events = (ret[jss::traceEvents] = Json::arrayValue);
+
+    std::lock_guard lock(mutex_);
+    for (auto const& b : buffers_)
+    {
+        auto& meta = events.append(Json::objectValue);
+        meta[jss::name] = "thread_name";
+        meta[jss::ph] = "M";
+        meta[jss::pid] = 1;
+        meta[jss::tid] = b->tid;
+        meta[jss::args][jss::name] = b->threadName;
+
+        // Copy the spans, then drop any the thread may have overwritten
+        // while they were copied.
+        auto const head = b->head.load(std::memory_order_acquire);
+        auto const first =
+            std::max(head > bufferSize ? head - bufferSize : 0, b->cleared);
+        std::vector<std::tuple<char const*, tick_type, tick_type>> spans;
+        if (head > first)
+            spans.reserve(head - first);
+        for (auto i = first; i < head; ++i)
+        {
+            auto const& e = b->events[i % bufferSize];
+            spans.emplace_back(
+                e.name.load(std::memory_order_relaxed),
+                e.start.load(std::memory_order_relaxed),
+                e.end.load(std::memory_order_relaxed));
+        }
+        auto const after = b->head.load(std::memory_order_acquire);
+        auto const valid = after >= bufferSize ? after - bufferSize + 1 : 0;
+
+        for (auto i = std::max(first, valid); i < head; ++i)
+        {
+            auto const& [name, start, end] = spans[i - first];
+            if (start < startTicks_ || end < start)
+                continue;
+            auto& event = events.append(Json::objectValue);
+            event[jss::name] = name;
+            event[jss::ph] = "X";
+            event[jss::pid] = 1;
+            event[jss::tid] = b->tid;
+            event[jss::ts] = toUs(start);
+            event[jss::dur] = (end - start) / ticksPerUs;
+        }
+    }
+
+    return ret;
+}
+
+void
+Tracer::clear()
+{
+    std::lock_guard lock(mutex_);
+    for (auto const& b : buffers_)
+        b->cleared = b->head.load(std::memory_order_acquire);
+}
+
+}  // namespace perf
+}  // namespace ripple
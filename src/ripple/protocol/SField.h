@@ -22,6 +22,7 @@
 
 #include <ripple/basics/safe_cast.h>
 #include <ripple/json/json_value.h>
+#include <array>
 #include <cstdint>
 #include <map>
 #include <utility>
@@ -162,13 +163,18 @@ public:
     static const SField&
     getField(int type, int value)
     {
+        if (type >= 0 && type < typeLimit && value >= 0 && value < valueLimit)
+        {
+            if (auto const field = knownFields[type][value])
+                return *field;
+        }
         return getField(field_code(type, value));
     }
 
     static const SField&
     getField(SerializedTypeID type, int value)
     {
-        return getField(field_code(type, value));
+        return getField(safe_cast<int>(type), value);
     }
 
     std::string const&
@@ -264,6 +270,19 @@ public:
 private:
     static int num;
     static std::map<int, SField const*> knownCodeToField;
+
+    // Fields whose type and value are both small, which covers every field
+    // found in serialized objects, are also found by direct lookup in
+    // knownFields. The table is zero-initialized before any SField is
+    // constructed, and is filled in as the fields register themselves.
+    static constexpr int typeLimit = 32;
+    static constexpr int valueLimit = 256;
+
+    static std::array<std::array<SField const*, valueLimit>, typeLimit>
+        knownFields;
+
+    static void
+    registerField(SField const& field);
 };
 
 /** A field with a type known at compile time. */
@@ -31,6 +31,7 @@
 #include <ripple/protocol/STPathSet.h>
 #include <ripple/protocol/STVector256.h>
 #include <ripple/protocol/impl/STVar.h>
+#include <boost/container/small_vector.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 #include <cassert>
 #include <optional>
@@ -409,10 +410,14 @@ private:
     void
     add(Serializer& s, WhichFields whichFields) const;
 
+    // Objects rarely have more fields than this, so sorting them
+    // usually needs no allocation
+    using SortedFields = boost::container::small_vector<STBase const*, 32>;
+
     // Sort the entries in an STObject into the order that they will be
     // serialized.  Note: they are not sorted into pointer value order, they
     // are sorted by SField::fieldCode.
-    static std::vector<STBase const*>
+    static SortedFields
     getSortedFields(STObject const& objToSort, WhichFields whichFields);
 
     // Implementation for getting (most) fields that return by value.
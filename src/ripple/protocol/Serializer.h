@@ -28,26 +28,142 @@
 #include <ripple/basics/safe_cast.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/SField.h>
+#include <ripple/protocol/digest.h>
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <iomanip>
+#include <optional>
 #include <type_traits>
 
 namespace ripple {
 
+namespace detail {
+
+/** Feeds serialized data to a SHA512-Half hash.
+
+    Data is gathered in a small inline buffer, and handed to the hash a
+    block at a time rather than a few bytes at a time. No memory is
+    allocated.
+*/
+class SerializerHashSink
+{
+private:
+    sha512_half_hasher hasher_;
+    std::array<std::uint8_t, 256> buffer_;
+    std::size_t used_ = 0;
+    std::size_t size_ = 0;
+    std::optional<uint256> result_;
+
+public:
+    // Returns the number of bytes added before this call
+    int
+    append(void const* data, std::size_t size)
+    {
+        assert(!result_);
+
+        int const ret = size_;
+        size_ += size;
+
+        if (used_ + size > buffer_.size())
+        {
+            hasher_(buffer_.data(), used_);
+            used_ = 0;
+
+            if (size >= buffer_.size())
+            {
+                hasher_(data, size);
+                return ret;
+            }
+        }
+
+        if (size != 0)
+        {
+            std::memcpy(buffer_.data() + used_, data, size);
+            used_ += size;
+        }
+        return ret;
+    }
+
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    uint256
+    finish()
+    {
+        if (!result_)
+        {
+            hasher_(buffer_.data(), used_);
+            used_ = 0;
+            result_ = static_cast<uint256>(hasher_);
+        }
+        return *result_;
+    }
+};
+
+}  // namespace detail
+
 class Serializer
 {
 private:
     // DEPRECATED
     Blob mData;
 
+    // If set, added data is hashed rather than stored in mData
+    detail::SerializerHashSink* sink_ = nullptr;
+
+    int
+    append(void const* data, std::size_t size)
+    {
+        if (sink_)
+            return sink_->append(data, size);
+
+        int const ret = mData.size();
+        mData.insert(
+            mData.end(),
+            static_cast<std::uint8_t const*>(data),
+            static_cast<std::uint8_t const*>(data) + size);
+        return ret;
+    }
+
+protected:
+    explicit Serializer(detail::SerializerHashSink& sink) : sink_(&sink)
+    {
+    }
+
 public:
     explicit Serializer(int n = 256)
     {
         mData.reserve(n);
     }
 
+    // A copy never shares a hash with the original
+    Serializer(Serializer const& other) : mData(other.mData)
+    {
+    }
+
+    Serializer(Serializer&& other) noexcept : mData(std::move(other.mData))
+    {
+    }
+
+    Serializer&
+    operator=(Serializer const& other)
+    {
+        mData = other.mData;
+        return *this;
+    }
+
+    Serializer&
+    operator=(Serializer&& other) noexcept
+    {
+        mData = std::move(other.mData);
+        return *this;
+    }
+
     Serializer(void const* data, std::size_t size)
     {
         mData.resize(size);
@@ -305,6 +421,37 @@ Serializer::addVL(Iter begin, Iter end, int len)
 
 //------------------------------------------------------------------------------
 
+/** A Serializer that computes the SHA512-Half of what is added to it.
+
+    The data is hashed as it is added, and is never stored, so computing
+    the hash of a serialized object allocates no memory. Only the add
+    functions and getSHA512Half may be used; the accessors for the data
+    behave as if the Serializer were empty.
+*/
+class SHA512HalfSerializer : public Serializer
+{
+private:
+    detail::SerializerHashSink hashSink_;
+
+public:
+    SHA512HalfSerializer() : Serializer(hashSink_)
+    {
+    }
+
+    SHA512HalfSerializer(SHA512HalfSerializer const&) = delete;
+    SHA512HalfSerializer&
+    operator=(SHA512HalfSerializer const&) = delete;
+
+    /** The number of bytes hashed so far. */
+    std::size_t
+    hashed() const
+    {
+        return hashSink_.size();
+    }
+};
+
+//------------------------------------------------------------------------------
+
 // DEPRECATED
 // Transitional adapter to new serialization interfaces
 class SerialIter
@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_SIGNATURECACHE_H_INCLUDED
+#define RIPPLE_PROTOCOL_SIGNATURECACHE_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/basics/hardened_hash.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace ripple {
+
+/** Remembers signatures that were recently verified.
+
+    The same signature is often checked several times: a transaction is
+    checked when it is submitted, again when each peer relays it, and
+    again when it is applied to a ledger. Validations and manifests also
+    arrive from several peers. Verifying a secp256k1 signature is far more
+    expensive than a lookup in this cache.
+
+    Only good signatures are remembered, so a flood of bad signatures
+    cannot push good ones out. An entry is forgotten after a while, or
+    when its shard is full, oldest first.
+
+    Entries are identified by a key derived from everything that decides
+    whether a signature is good: what was signed, the public key, the
+    signature and whether a fully canonical signature was required.
+
+    @note This class is thread-safe.
+*/
+class SignatureCache
+{
+public:
+    using clock_type = Stopwatch;
+
+    static constexpr std::size_t defaultSize = 65536;
+    static constexpr std::chrono::seconds defaultExpiration{600};
+
+    /** Create a cache.
+
+        @param size The number of signatures to remember.
+        @param expiration How long to remember a signature for.
+    */
+    SignatureCache(
+        std::size_t size,
+        std::chrono::seconds expiration,
+        clock_type& clock = stopwatch());
+
+    SignatureCache(SignatureCache const&) = delete;
+    SignatureCache&
+    operator=(SignatureCache const&) = delete;
+
+    /** The cache shared by every signature check in the process. */
+    static SignatureCache&
+    instance();
+
+    /** Returns the key identifying a signature.
+
+        @param hash A digest of what was signed. If the digest covers the
+                    signature as well, as a transaction ID does, the
+                    signature may be empty.
+        @param publicKey The key that made the signature.
+        @param signature The signature.
+        @param fullyCanonical Whether the signature had to be fully
+                              canonical.
+    */
+    static uint256
+    makeKey(
+        uint256 const& hash,
+        Slice const& publicKey,
+        Slice const& signature,
+        bool fullyCanonical);
+
+    /** Returns `true` if the signature was verified recently. */
+    bool
+    contains(uint256 const& key);
+
+    /** Remember that a signature is good. */
+    void
+    insert(uint256 const& key);
+
+    /** Forget every signature. */
+    void
+    clear();
+
+    /** The number of signatures remembered. */
+    std::size_t
+    size() const;
+
+    std::uint64_t
+    hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t
+    misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t shardCount = 16;
+
+    struct Entry
+    {
+        clock_type::time_point inserted;
+        std::uint64_t id;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<uint256, Entry, digest_hash> map;
+
+        // Keys in the order they were inserted, with the id of the entry
+        // they were inserted as. An entry replaced since is not erased
+        // when its older copy reaches the front.
+        std::deque<std::pair<uint256, std::uint64_t>> order;
+        std::uint64_t nextId = 0;
+    };
+
+    Shard&
+    shard(uint256 const& key);
+
+    std::size_t const shardSize_;
+    std::chrono::seconds const expiration_;
+    clock_type& clock_;
+    std::array<Shard, shardCount> shards_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+};
+
+}  // namespace ripple
+
+#endif
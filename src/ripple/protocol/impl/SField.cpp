@@ -29,6 +29,10 @@ namespace ripple {
 SField::IsSigning const SField::notSigning;
 int SField::num = 0;
 std::map<int, SField const*> SField::knownCodeToField;
+std::array<
+    std::array<SField const*, SField::valueLimit>,
+    SField::typeLimit>
+    SField::knownFields{};
 
 // Give only this translation unit permission to construct SFields
 struct SField::private_access_tag_t
@@ -368,7 +372,7 @@ SField::SField(
     , signingField(signing)
     , jsonName(fieldName.c_str())
 {
-    knownCodeToField[fieldCode] = this;
+    registerField(*this);
 }
 
 SField::SField(private_access_tag_t, int fc)
@@ -380,12 +384,37 @@ SField::SField(private_access_tag_t, int fc)
     , signingField(IsSigning::yes)
     , jsonName(fieldName.c_str())
 {
-    knownCodeToField[fieldCode] = this;
+    registerField(*this);
+}
+
+void
+SField::registerField(SField const& field)
+{
+    knownCodeToField[field.fieldCode] = &field;
+
+    if (field.fieldCode < 0)
+        return;
+
+    auto const type = field.fieldCode >> 16;
+    auto const value = field.fieldCode & 0xffff;
+    if (type < typeLimit && value < valueLimit)
+        knownFields[type][value] = &field;
 }
 
 SField const&
 SField::getField(int code)
 {
+    if (code >= 0)
+    {
+        auto const type = code >> 16;
+        auto const value = code & 0xffff;
+        if (type < typeLimit && value < valueLimit)
+        {
+            if (auto const field = knownFields[type][value])
+                return *field;
+        }
+    }
+
     auto it = knownCodeToField.find(code);
 
     if (it != knownCodeToField.end())
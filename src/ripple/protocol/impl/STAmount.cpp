@@ -25,6 +25,7 @@
 #include <ripple/protocol/SystemParameters.h>
 #include <ripple/protocol/UintTypes.h>
 #include <ripple/protocol/jss.h>
+#include <bit>
 #include <boost/algorithm/string.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/regex.hpp>
@@ -61,6 +62,64 @@ static const std::uint64_t tenTo14 = 100000000000000ull;
 static const std::uint64_t tenTo14m1 = tenTo14 - 1;
 static const std::uint64_t tenTo17 = tenTo14 * 1000;
 
+static constexpr std::uint64_t powersOfTen[] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull};
+
+// Returns the number of decimal digits in a non-zero value
+static int
+digits10(std::uint64_t value)
+{
+    assert(value != 0);
+
+    // 1233 / 4096 is a little less than log10(2), so the guess is either
+    // right or one short.
+    int const bits = 64 - std::countl_zero(value);
+    int const guess = (bits * 1233) >> 12;
+    return guess + (value >= powersOfTen[guess]);
+}
+
+// Divide by 10^shift, which truncates like dividing by 10 shift times.
+// Canonicalizing never divides by more than 10^4, and dividing by a
+// constant is a multiplication, much faster than a division.
+static std::uint64_t
+divPow10(std::uint64_t value, int shift)
+{
+    switch (shift)
+    {
+        case 0:
+            return value;
+        case 1:
+            return value / 10;
+        case 2:
+            return value / 100;
+        case 3:
+            return value / 1000;
+        case 4:
+            return value / 10000;
+        default:
+            return value / powersOfTen[shift];
+    }
+}
+
 //------------------------------------------------------------------------------
 static std::int64_t
 getSNValue(STAmount const& amount)
@@ -1115,6 +1174,25 @@ operator-(STAmount const& value)
 //
 //------------------------------------------------------------------------------
 
+#ifdef __SIZEOF_INT128__
+using uint128_t = unsigned __int128;
+#else
+using uint128_t = boost::multiprecision::uint128_t;
+#endif
+
+// The full product of two 64-bit values
+static uint128_t
+multiply128(std::uint64_t multiplier, std::uint64_t multiplicand)
+{
+#ifdef __SIZEOF_INT128__
+    return static_cast<uint128_t>(multiplier) * multiplicand;
+#else
+    uint128_t ret;
+    boost::multiprecision::multiply(ret, multiplier, multiplicand);
+    return ret;
+#endif
+}
+
 // Calculate (a * b) / c when all three values are 64-bit
 // without loss of precision:
 static std::uint64_t
@@ -1123,10 +1201,7 @@ muldiv(
     std::uint64_t multiplicand,
     std::uint64_t divisor)
 {
-    boost::multiprecision::uint128_t ret;
-
-    boost::multiprecision::multiply(ret, multiplier, multiplicand);
-    ret /= divisor;
+    uint128_t const ret = multiply128(multiplier, multiplicand) / divisor;
 
     if (ret > std::numeric_limits<std::uint64_t>::max())
     {
@@ -1145,11 +1220,8 @@ muldiv_round(
     std::uint64_t divisor,
     std::uint64_t rounding)
 {
-    boost::multiprecision::uint128_t ret;
-
-    boost::multiprecision::multiply(ret, multiplier, multiplicand);
-    ret += rounding;
-    ret /= divisor;
+    uint128_t const ret =
+        (multiply128(multiplier, multiplicand) + rounding) / divisor;
 
     if (ret > std::numeric_limits<std::uint64_t>::max())
     {
@@ -1162,6 +1234,82 @@ muldiv_round(
     return static_cast<uint64_t>(ret);
 }
 
+// Bring a non-zero native mantissa into the range of IOU mantissas.
+// Same as multiplying by 10 until it is at least cMinValue.
+static void
+scaleNative(std::uint64_t& value, int& offset)
+{
+    if (value < STAmount::cMinValue)
+    {
+        int const shift = 16 - digits10(value);
+        value *= powersOfTen[shift];
+        offset -= shift;
+    }
+}
+
+// The amount value * 10^offset, the same as
+// STAmount(issue, value, offset, negative).
+//
+// The products and quotients of IOU mantissas have one to four digits
+// too many. Canonicalizing drops them one at a time, rounding them with
+// Number when it is switched on; here they are dropped at once. Amounts
+// that would overflow or underflow take the long way.
+static STAmount
+makeAmount(Issue const& issue, std::uint64_t value, int offset, bool negative)
+{
+    if (value < STAmount::cMinValue ||
+        value > std::numeric_limits<std::int64_t>::max() ||
+        isXRP(issue.currency))
+        return STAmount(issue, value, offset, negative);
+
+    std::uint64_t mantissa = value;
+    int exponent = offset;
+
+    if (mantissa > STAmount::cMaxValue)
+    {
+        int const shift = digits10(mantissa) - 16;
+        mantissa = divPow10(value, shift);
+        exponent += shift;
+
+        if (getSTNumberSwitchover())
+        {
+            // Round the dropped digits the way Number does
+            auto const dropped = value - mantissa * powersOfTen[shift];
+            auto const half = powersOfTen[shift] / 2;
+
+            bool up;
+            switch (Number::getround())
+            {
+                case Number::towards_zero:
+                    up = false;
+                    break;
+                case Number::downward:
+                    up = negative && dropped != 0;
+                    break;
+                case Number::upward:
+                    up = !negative && dropped != 0;
+                    break;
+                default:
+                    up = dropped > half ||
+                        (dropped == half && (mantissa & 1) != 0);
+                    break;
+            }
+
+            if (up && ++mantissa > STAmount::cMaxValue)
+            {
+                mantissa /= 10;
+                ++exponent;
+            }
+        }
+    }
+
+    if (exponent < STAmount::cMinOffset || exponent > STAmount::cMaxOffset)
+        return STAmount(issue, value, offset, negative);
+
+    return STAmount(
+        issue, mantissa, exponent, false, negative, STAmount::unchecked{});
+}
+
 STAmount
 divide(STAmount const& num, STAmount const& den, Issue const& issue)
 {
@@ -1177,30 +1325,17 @@ divide(STAmount const& num, STAmount const& den, Issue const& issue)
     int denOffset = den.exponent();
 
     if (num.native())
-    {
-        while (numVal < STAmount::cMinValue)
-        {
-            // Need to bring into range
-            numVal *= 10;
-            --numOffset;
-        }
-    }
+        scaleNative(numVal, numOffset);
 
     if (den.native())
-    {
-        while (denVal < STAmount::cMinValue)
-        {
-            denVal *= 10;
-            --denOffset;
-        }
-    }
+        scaleNative(denVal, denOffset);
 
     // We divide the two mantissas (each is between 10^15
     // and 10^16). To maintain precision, we multiply the
     // numerator by 10^17 (the product is in the range of
     // 10^32 to 10^33) followed by a division, so the result
     // is in the range of 10^16 to 10^15.
-    return STAmount(
+    return makeAmount(
         issue,
         muldiv(numVal, tenTo17, denVal) + 5,
         numOffset - denOffset - 17,
@@ -1213,7 +1348,7 @@ multiply(STAmount const& v1, STAmount const& v2, Issue const& issue)
     if (v1 == beast::zero || v2 == beast::zero)
         return STAmount(issue);
 
-    if (v1.native() && v2.native() && isXRP(issue))
+    if (v1.native() && v2.native() && isXRP(issue.currency))
     {
         std::uint64_t const minV =
             getSNValue(v1) < getSNValue(v2) ? getSNValue(v1) : getSNValue(v2);
@@ -1238,28 +1373,16 @@ multiply(STAmount const& v1, STAmount const& v2, Issue const& issue)
     int offset2 = v2.exponent();
 
     if (v1.native())
-    {
-        while (value1 < STAmount::cMinValue)
-        {
-            value1 *= 10;
-            --offset1;
-        }
-    }
+        scaleNative(value1, offset1);
 
     if (v2.native())
-    {
-        while (value2 < STAmount::cMinValue)
-        {
-            value2 *= 10;
-            --offset2;
-        }
-    }
+        scaleNative(value2, offset2);
 
     // We multiply the two mantissas (each is between 10^15
     // and 10^16), so their product is in the 10^30 to 10^32
     // range. Dividing their product by 10^14 maintains the
     // precision, by scaling the result to 10^16 to 10^18.
-    return STAmount(
+    return makeAmount(
         issue,
         muldiv(value1, value2, tenTo14) + 7,
         offset1 + offset2 + 14,
@@ -1289,7 +1412,15 @@ canonicalizeRound(bool native, std::uint64_t& value, int& offset)
     }
     else if (value > STAmount::cMaxValue)
     {
-        while (value > (10 * STAmount::cMaxValue))
+        // Divide until there are at most 17 digits, in one step, then
+        // once more if they are still more than 10 * cMaxValue.
+        if (int const shift = digits10(value) - 17; shift > 0)
+        {
+            value = divPow10(value, shift);
+            offset += shift;
+        }
+
+        if (value > (10 * STAmount::cMaxValue))
         {
             value /= 10;
             ++offset;
@@ -1311,7 +1442,7 @@ mulRound(
     if (v1 == beast::zero || v2 == beast::zero)
         return {issue};
 
-    bool const xrp = isXRP(issue);
+    bool const xrp = isXRP(issue.currency);
 
     if (v1.native() && v2.native() && xrp)
     {
@@ -1333,22 +1464,10 @@ mulRound(
     int offset1 = v1.exponent(), offset2 = v2.exponent();
 
     if (v1.native())
-    {
-        while (value1 < STAmount::cMinValue)
-        {
-            value1 *= 10;
-            --offset1;
-        }
-    }
+        scaleNative(value1, offset1);
 
     if (v2.native())
-    {
-        while (value2 < STAmount::cMinValue)
-        {
-            value2 *= 10;
-            --offset2;
-        }
-    }
+        scaleNative(value2, offset2);
 
     bool const resultNegative = v1.negative() != v2.negative();
 
@@ -1366,7 +1485,7 @@ mulRound(
     int offset = offset1 + offset2 + 14;
     if (resultNegative != roundUp)
         canonicalizeRound(xrp, amount, offset);
-    STAmount result(issue, amount, offset, resultNegative);
+    STAmount result = makeAmount(issue, amount, offset, resultNegative);
 
     if (roundUp && !resultNegative && !result)
     {
@@ -1404,23 +1523,12 @@ divRound(
     int numOffset = num.exponent(), denOffset = den.exponent();
 
     if (num.native())
-    {
-        while (numVal < STAmount::cMinValue)
-        {
-            numVal *= 10;
-            --numOffset;
-        }
-    }
+        scaleNative(numVal, numOffset);
 
     if (den.native())
-    {
-        while (denVal < STAmount::cMinValue)
-        {
-            denVal *= 10;
-            --denOffset;
-        }
-    }
+        scaleNative(denVal, denOffset);
 
+    bool const xrp = isXRP(issue.currency);
     bool const resultNegative = (num.negative() != den.negative());
 
     // We divide the two mantissas (each is between 10^15
@@ -1437,12 +1545,12 @@ divRound(
     int offset = numOffset - denOffset - 17;
 
     if (resultNegative != roundUp)
-        canonicalizeRound(isXRP(issue), amount, offset);
+        canonicalizeRound(xrp, amount, offset);
 
-    STAmount result(issue, amount, offset, resultNegative);
+    STAmount result = makeAmount(issue, amount, offset, resultNegative);
     if (roundUp && !resultNegative && !result)
     {
-        if (isXRP(issue))
+        if (xrp)
         {
             // return the smallest value above zero
             amount = 1;
@@ -338,7 +338,7 @@ STObject::isEquivalent(const STBase& t) const
 uint256
 STObject::getHash(HashPrefix prefix) const
 {
-    Serializer s;
+    SHA512HalfSerializer s;
     s.add32(prefix);
     add(s, withAllFields);
     return s.getSHA512Half();
@@ -347,7 +347,7 @@ STObject::getHash(HashPrefix prefix) const
 uint256
 STObject::getSigningHash(HashPrefix prefix) const
 {
-    Serializer s;
+    SHA512HalfSerializer s;
     s.add32(prefix);
     add(s, omitSigningFields);
     return s.getSHA512Half();
@@ -782,8 +782,7 @@ STObject::add(Serializer& s, WhichFields whichFields) const
 {
     // Depending on whichFields, signing fields are either serialized or
     // not.  Then fields are added to the Serializer sorted by fieldCode.
-    std::vector<STBase const*> const fields{
-        getSortedFields(*this, whichFields)};
+    auto const fields = getSortedFields(*this, whichFields);
 
     // insert sorted
     for (STBase const* const field : fields)
@@ -802,10 +801,10 @@ STObject::add(Serializer& s, WhichFields whichFields) const
     }
 }
 
-std::vector<STBase const*>
+STObject::SortedFields
 STObject::getSortedFields(STObject const& objToSort, WhichFields whichFields)
 {
-    std::vector<STBase const*> sf;
+    SortedFields sf;
     sf.reserve(objToSort.getCount());
 
     // Choose the fields that we need to sort.
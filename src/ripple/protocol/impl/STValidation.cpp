@@ -22,6 +22,7 @@
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/STValidation.h>
+#include <ripple/protocol/SignatureCache.h>
 
 namespace ripple {
 
@@ -109,11 +110,33 @@ STValidation::isValid() const noexcept
     {
         assert(publicKeyType(getSignerPublic()) == KeyType::secp256k1);
 
-        valid_ = verifyDigest(
-            getSignerPublic(),
-            getSigningHash(),
-            makeSlice(getFieldVL(sfSignature)),
-            getFlags() & vfFullyCanonicalSig);
+        // The same validation is often received from several peers
+        auto const signingHash = getSigningHash();
+        auto const signature = getFieldVL(sfSignature);
+        bool const fullyCanonical = getFlags() & vfFullyCanonicalSig;
+
+        auto& cache = SignatureCache::instance();
+        auto const key = SignatureCache::makeKey(
+            signingHash,
+            getSignerPublic().slice(),
+            makeSlice(signature),
+            fullyCanonical);
+
+        if (cache.contains(key))
+        {
+            valid_ = true;
+        }
+        else
+        {
+            valid_ = verifyDigest(
+                getSignerPublic(),
+                signingHash,
+                makeSlice(signature),
+                fullyCanonical);
+
+            if (*valid_)
+                cache.insert(key);
+        }
     }
 
     return valid_.value();
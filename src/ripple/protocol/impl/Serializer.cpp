@@ -28,21 +28,21 @@ namespace ripple {
 int
 Serializer::add16(std::uint16_t i)
 {
-    int ret = mData.size();
-    mData.push_back(static_cast<unsigned char>(i >> 8));
-    mData.push_back(static_cast<unsigned char>(i & 0xff));
-    return ret;
+    std::uint8_t const bytes[2] = {
+        static_cast<unsigned char>(i >> 8),
+        static_cast<unsigned char>(i & 0xff)};
+    return append(bytes, sizeof(bytes));
 }
 
 int
 Serializer::add32(std::uint32_t i)
 {
-    int ret = mData.size();
-    mData.push_back(static_cast<unsigned char>(i >> 24));
-    mData.push_back(static_cast<unsigned char>((i >> 16) & 0xff));
-    mData.push_back(static_cast<unsigned char>((i >> 8) & 0xff));
-    mData.push_back(static_cast<unsigned char>(i & 0xff));
-    return ret;
+    std::uint8_t const bytes[4] = {
+        static_cast<unsigned char>(i >> 24),
+        static_cast<unsigned char>((i >> 16) & 0xff),
+        static_cast<unsigned char>((i >> 8) & 0xff),
+        static_cast<unsigned char>(i & 0xff)};
+    return append(bytes, sizeof(bytes));
 }
 
 int
@@ -59,16 +59,16 @@ Serializer::add32(HashPrefix p)
 int
 Serializer::add64(std::uint64_t i)
 {
-    int ret = mData.size();
-    mData.push_back(static_cast<unsigned char>(i >> 56));
-    mData.push_back(static_cast<unsigned char>((i >> 48) & 0xff));
-    mData.push_back(static_cast<unsigned char>((i >> 40) & 0xff));
-    mData.push_back(static_cast<unsigned char>((i >> 32) & 0xff));
-    mData.push_back(static_cast<unsigned char>((i >> 24) & 0xff));
-    mData.push_back(static_cast<unsigned char>((i >> 16) & 0xff));
-    mData.push_back(static_cast<unsigned char>((i >> 8) & 0xff));
-    mData.push_back(static_cast<unsigned char>(i & 0xff));
-    return ret;
+    std::uint8_t const bytes[8] = {
+        static_cast<unsigned char>(i >> 56),
+        static_cast<unsigned char>((i >> 48) & 0xff),
+        static_cast<unsigned char>((i >> 40) & 0xff),
+        static_cast<unsigned char>((i >> 32) & 0xff),
+        static_cast<unsigned char>((i >> 24) & 0xff),
+        static_cast<unsigned char>((i >> 16) & 0xff),
+        static_cast<unsigned char>((i >> 8) & 0xff),
+        static_cast<unsigned char>(i & 0xff)};
+    return append(bytes, sizeof(bytes));
 }
 
 template <>
@@ -99,75 +99,67 @@ Serializer::addInteger(std::uint64_t i)
 int
 Serializer::addRaw(Blob const& vector)
 {
-    int ret = mData.size();
-    mData.insert(mData.end(), vector.begin(), vector.end());
-    return ret;
+    return append(vector.data(), vector.size());
 }
 
 int
 Serializer::addRaw(Slice slice)
 {
-    int ret = mData.size();
-    mData.insert(mData.end(), slice.begin(), slice.end());
-    return ret;
+    return append(slice.data(), slice.size());
 }
 
 int
 Serializer::addRaw(const Serializer& s)
 {
-    int ret = mData.size();
-    mData.insert(mData.end(), s.begin(), s.end());
-    return ret;
+    return append(s.data(), s.size());
 }
 
 int
 Serializer::addRaw(const void* ptr, int len)
 {
-    int ret = mData.size();
-    mData.insert(mData.end(), (const char*)ptr, ((const char*)ptr) + len);
-    return ret;
+    return append(ptr, len);
 }
 
 int
 Serializer::addFieldID(int type, int name)
 {
-    int ret = mData.size();
     assert((type > 0) && (type < 256) && (name > 0) && (name < 256));
 
+    std::uint8_t bytes[3];
+    std::size_t size = 0;
+
     if (type < 16)
     {
         if (name < 16)  // common type, common name
-            mData.push_back(static_cast<unsigned char>((type << 4) | name));
+            bytes[size++] = static_cast<unsigned char>((type << 4) | name);
         else
         {
             // common type, uncommon name
-            mData.push_back(static_cast<unsigned char>(type << 4));
-            mData.push_back(static_cast<unsigned char>(name));
+            bytes[size++] = static_cast<unsigned char>(type << 4);
+            bytes[size++] = static_cast<unsigned char>(name);
         }
     }
     else if (name < 16)
     {
         // uncommon type, common name
-        mData.push_back(static_cast<unsigned char>(name));
-        mData.push_back(static_cast<unsigned char>(type));
+        bytes[size++] = static_cast<unsigned char>(name);
+        bytes[size++] = static_cast<unsigned char>(type);
     }
     else
     {
         // uncommon type, uncommon name
-        mData.push_back(static_cast<unsigned char>(0));
-        mData.push_back(static_cast<unsigned char>(type));
-        mData.push_back(static_cast<unsigned char>(name));
+        bytes[size++] = static_cast<unsigned char>(0);
+        bytes[size++] = static_cast<unsigned char>(type);
+        bytes[size++] = static_cast<unsigned char>(name);
     }
 
-    return ret;
+    return append(bytes, size);
 }
 
 int
 Serializer::add8(unsigned char byte)
 {
-    int ret = mData.size();
-    mData.push_back(byte);
-    return ret;
+    return append(&byte, 1);
 }
 
 bool
@@ -193,6 +185,9 @@ Serializer::chop(int bytes)
 uint256
 Serializer::getSHA512Half() const
 {
+    if (sink_)
+        return sink_->finish();
+
     return sha512Half(makeSlice(mData));
 }
 
@@ -202,8 +197,9 @@ Serializer::addVL(Blob const& vector)
     int ret = addEncoded(vector.size());
     addRaw(vector);
     assert(
+        sink_ ||
         mData.size() ==
-        (ret + vector.size() + encodeLengthLength(vector.size())));
+            (ret + vector.size() + encodeLengthLength(vector.size())));
     return ret;
 }
 
@@ -413,6 +409,18 @@ SerialIter::get64()
 void
 SerialIter::getFieldID(int& type, int& name)
 {
+    // Most fields have a common type and a common name, which both fit in
+    // a single byte.
+    if (remain_ != 0 && (*p_ >> 4) != 0 && (*p_ & 15) != 0)
+    {
+        type = *p_ >> 4;
+        name = *p_ & 15;
+        ++p_;
+        ++used_;
+        --remain_;
+        return;
+    }
+
     type = get8();
     name = type & 15;
     type >>= 4;
@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/protocol/SignatureCache.h>
+#include <ripple/protocol/digest.h>
+
+namespace ripple {
+
+SignatureCache::SignatureCache(
+    std::size_t size,
+    std::chrono::seconds expiration,
+    clock_type& clock)
+    : shardSize_(std::max<std::size_t>(size / shardCount, 1))
+    , expiration_(expiration)
+    , clock_(clock)
+{
+}
+
+SignatureCache&
+SignatureCache::instance()
+{
+    static SignatureCache cache(defaultSize, defaultExpiration);
+    return cache;
+}
+
+uint256
+SignatureCache::makeKey(
+    uint256 const& hash,
+    Slice const& publicKey,
+    Slice const& signature,
+    bool fullyCanonical)
+{
+    // The lengths keep the public key and signature from running together
+    sha512_half_hasher h;
+    using beast::hash_append;
+    hash_append(
+        h,
+        hash,
+        static_cast<std::uint32_t>(publicKey.size()),
+        static_cast<std::uint32_t>(signature.size()),
+        static_cast<std::uint8_t>(fullyCanonical));
+    h(publicKey.data(), publicKey.size());
+    h(signature.data(), signature.size());
+    return static_cast<uint256>(h);
+}
+
+SignatureCache::Shard&
+SignatureCache::shard(uint256 const& key)
+{
+    // Keys are the output of a hash, so any byte is as good as any other
+    return shards_[key.data()[0] % shardCount];
+}
+
+bool
+SignatureCache::contains(uint256 const& key)
+{
+    auto& s = shard(key);
+    {
+        std::lock_guard lock(s.mutex);
+        auto const it = s.map.find(key);
+        if (it != s.map.end())
+        {
+            if (clock_.now() - it->second.inserted < expiration_)
+            {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            // The entry is left in `order`, which skips it later
+            s.map.erase(it);
+        }
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void
+SignatureCache::insert(uint256 const& key)
+{
+    auto& s = shard(key);
+    auto const now = clock_.now();
+
+    std::lock_guard lock(s.mutex);
+
+    auto const id = s.nextId++;
+    s.map[key] = Entry{now, id};
+    s.order.emplace_back(key, id);
+
+    // Forget the oldest signatures while the shard is too large, and any
+    // that have expired.
+    while (!s.order.empty())
+    {
+        auto const& [oldest, oldestId] = s.order.front();
+        auto const it = s.map.find(oldest);
+        bool const live = it != s.map.end() && it->second.id == oldestId;
+
+        if (live && s.map.size() <= shardSize_ &&
+            now - it->second.inserted < expiration_)
+            break;
+
+        if (live)
+            s.map.erase(it);
+        s.order.pop_front();
+    }
+}
+
+void
+SignatureCache::clear()
+{
+    for (auto& s : shards_)
+    {
+        std::lock_guard lock(s.mutex);
+        s.map.clear();
+        s.order.clear();
+    }
+}
+
+std::size_t
+SignatureCache::size() const
+{
+    std::size_t result = 0;
+    for (auto const& s : shards_)
+    {
+        std::lock_guard lock(s.mutex);
+        result += s.map.size();
+    }
+    return result;
+}
+
+}  // namespace ripple
@@ -141,6 +141,7 @@ JSS(amount);                 // out: AccountChannels
 JSS(api_version);            // in: many, out: Version
 JSS(api_version_low);        // out: Version
 JSS(applied);                // out: SubmitTransaction
+JSS(args);                   // out: Tracer
 JSS(asks);                   // out: Subscribe
 JSS(assets);                 // out: GatewayBalances
 JSS(authorized);             // out: AccountLines
@@ -166,6 +167,7 @@ JSS(both_sides);             // in: Subscribe, Unsubscribe
 JSS(broadcast);              // out: SubmitTransaction
 JSS(build_path);             // in: TransactionSign
 JSS(build_version);          // out: NetworkOPs
+JSS(bytes);                  // out: LedgerExport
 JSS(cancel_after);           // out: AccountChannels
 JSS(can_delete);             // out: CanDelete
 JSS(changes);                // out: BookChanges
@@ -233,8 +235,10 @@ JSS(dir_entry);               // out: DirectoryEntryIterator
 JSS(dir_index);               // out: DirectoryEntryIterator
 JSS(dir_root);                // out: DirectoryEntryIterator
 JSS(directory);               // in: LedgerEntry
+JSS(displayTimeUnit);         // out: Tracer
 JSS(domain);                  // out: ValidatorInfo, Manifest
 JSS(drops);                   // out: TxQ
+JSS(dur);                     // out: Tracer
 JSS(duration_us);             // out: NetworkOPs
 JSS(effective);               // out: ValidatorList
                               // in: UNL
@@ -242,6 +246,7 @@ JSS(enabled);                 // out: AmendmentTable
 JSS(engine_result);           // out: NetworkOPs, TransactionSign, Submit
 JSS(engine_result_code);      // out: NetworkOPs, TransactionSign, Submit
 JSS(engine_result_message);   // out: NetworkOPs, TransactionSign, Submit
+JSS(entries);                 // out: LedgerExport
 JSS(ephemeral_key);           // out: ValidatorInfo
                               // in/out: Manifest
 JSS(error);                   // out: error
@@ -267,6 +272,7 @@ JSS(fee_level);             // out: AccountInfo
 JSS(fee_mult_max);          // in: TransactionSign
 JSS(fee_ref);               // out: NetworkOPs
 JSS(fetch_pack);            // out: NetworkOPs
+JSS(files);                 // out: LedgerExport
 JSS(first);                 // out: rpc/Version
 JSS(firstSequence);         // out: NodeToShardStatus
 JSS(firstShardIndex);       // out: NodeToShardStatus
@@ -422,6 +428,20 @@ JSS(no_ripple);                  // out: AccountLines
 JSS(no_ripple_peer);             // out: AccountLines
 JSS(node);                       // out: LedgerEntry
 JSS(node_binary);                // out: LedgerEntry
+JSS(node_cold_reads_hit);        // out: GetCounts
+JSS(node_cold_reads_total);      // out: GetCounts
+JSS(node_cold_reads_duration_us);  // out: GetCounts
+JSS(node_filter_checks);         // out: GetCounts
+JSS(node_filter_false_positive_rate);  // out: GetCounts
+JSS(node_filter_false_positives);  // out: GetCounts
+JSS(node_filter_hit_rate);       // out: GetCounts
+JSS(node_filter_hits);           // out: GetCounts
+JSS(node_filter_keys);           // out: GetCounts
+JSS(node_hot_promotions);        // out: GetCounts
+JSS(node_hot_reads_hit);         // out: GetCounts
+JSS(node_hot_reads_total);       // out: GetCounts
+JSS(node_hot_reads_duration_us); // out: GetCounts
+JSS(node_hot_rotations);         // out: GetCounts
 JSS(node_read_bytes);            // out: GetCounts
 JSS(node_read_errors);           // out: GetCounts
 JSS(node_read_retries);          // out: GetCounts
@@ -433,7 +453,14 @@ JSS(nodestore);                  // out: GetCounts
 JSS(node_writes);                // out: GetCounts
 JSS(node_written_bytes);         // out: GetCounts
 JSS(node_writes_duration_us);    // out: GetCounts
+JSS(node_write_batch_limit);     // out: GetCounts
+JSS(node_write_in_flight);       // out: GetCounts
+JSS(node_write_latency_us);      // out: GetCounts
+JSS(node_write_queue);           // out: GetCounts
+JSS(node_write_queue_depth);     // out: GetCounts
 JSS(node_write_retries);         // out: GetCounts
+JSS(node_write_stall_duration_us);  // out: GetCounts
+JSS(node_write_stalls);          // out: GetCounts
 JSS(node_writes_delayed);        // out::GetCounts
 JSS(obligations);                // out: GatewayBalances
 JSS(offer);                      // in: LedgerEntry
@@ -452,8 +479,10 @@ JSS(params);                      // RPC
 JSS(parent_close_time);           // out: LedgerToJson
 JSS(parent_hash);                 // out: LedgerToJson
 JSS(partition);                   // in: LogLevel
+JSS(partitions);                  // in/out: LedgerExport
 JSS(passphrase);                  // in: WalletPropose
 JSS(password);                    // in: Subscribe
+JSS(path);                        // in/out: LedgerExport
 JSS(paths);                       // in: RipplePathFind
 JSS(paths_canonical);             // out: RipplePathFind
 JSS(paths_computed);              // out: PathRequest, RipplePathFind
@@ -465,6 +494,8 @@ JSS(peers);                       // out: InboundLedger, handlers/Peers, Overlay
 JSS(peer_disconnects);            // Severed peer connection counter.
 JSS(peer_disconnects_resources);  // Severed peer connections because of
                                   // excess resource consumption.
+JSS(ph);                          // out: Tracer
+JSS(pid);                         // out: Tracer
 JSS(port);                        // in: Connect
 JSS(previous);                    // out: Reservations
 JSS(previous_ledger);             // out: LedgerPropose
@@ -576,8 +607,10 @@ JSS(threshold);             // in: Blacklist
 JSS(ticket);                // in: AccountObjects
 JSS(ticket_count);          // out: AccountInfo
 JSS(ticket_seq);            // in: LedgerEntry
+JSS(tid);                   // out: Tracer
 JSS(time);
 JSS(timeouts);                // out: InboundLedger
+JSS(traceEvents);             // out: Tracer
 JSS(track);                   // out: PeerImp
 JSS(traffic);                 // out: Overlay
 JSS(total);                   // out: counters
@@ -597,6 +630,7 @@ JSS(treenode_cache_size);     // out: GetCounts
 JSS(treenode_track_size);     // out: GetCounts
 JSS(trusted);                 // out: UnlList
 JSS(trusted_validator_keys);  // out: ValidatorList
+JSS(ts);                      // out: Tracer
 JSS(tx);                      // out: STTx, AccountTx*
 JSS(tx_blob);                 // in/out: Submit,
                               // in: TransactionSign, AccountTx*
@@ -25,6 +25,7 @@
 #include <ripple/beast/core/List.h>
 #include <ripple/resource/impl/Key.h>
 #include <ripple/resource/impl/Tuning.h>
+#include <atomic>
 #include <cassert>
 
 namespace ripple {
@@ -33,6 +34,11 @@ namespace Resource {
 using clock_type = beast::abstract_clock<std::chrono::steady_clock>;
 
 // An entry in the table
+//
+// The balances and the time of the last warning may be read and updated
+// without a lock. The remaining fields are protected by the lock of the
+// Logic shard which holds the entry.
+//
 // VFALCO DEPRECATED using boost::intrusive list
 struct Entry : public beast::List<Entry>::Node
 {
@@ -69,9 +75,10 @@ struct Entry : public beast::List<Entry>::Node
 
     // Balance including remote contributions
     int
-    balance(clock_type::time_point const now)
+    balance(clock_type::time_point const now) const
     {
-        return local_balance.value(now) + remote_balance;
+        return local_balance.value(now) +
+            remote_balance.load(std::memory_order_relaxed);
     }
 
     // Add a charge and return normalized balance
@@ -79,23 +86,24 @@ struct Entry : public beast::List<Entry>::Node
     int
     add(int charge, clock_type::time_point const now)
     {
-        return local_balance.add(charge, now) + remote_balance;
+        return local_balance.add(charge, now) +
+            remote_balance.load(std::memory_order_relaxed);
     }
 
     // Back pointer to the map key (bit of a hack here)
     Key const* key;
 
     // Number of Consumer references
-    int refcount;
+    std::atomic<int> refcount;
 
     // Exponentially decaying balance of resource consumption
-    DecayingSample<decayWindowSeconds, clock_type> local_balance;
+    AtomicDecayingSample<decayWindowSeconds, clock_type> local_balance;
 
     // Normalized balance contribution from imports
-    int remote_balance;
+    std::atomic<int> remote_balance;
 
     // Time of the last warning
-    clock_type::time_point lastWarningTime;
+    std::atomic<clock_type::time_point> lastWarningTime;
 
     // For inactive entries, time after which this entry will be erased
     clock_type::time_point whenExpires;
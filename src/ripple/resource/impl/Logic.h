@@ -31,6 +31,7 @@
 #include <ripple/resource/Fees.h>
 #include <ripple/resource/Gossip.h>
 #include <ripple/resource/impl/Import.h>
+#include <array>
 #include <cassert>
 #include <mutex>
 
@@ -57,34 +58,94 @@ private:
         beast::insight::Meter drop;
     };
 
-    Stats m_stats;
-    Stopwatch& m_clock;
-    beast::Journal m_journal;
+    // A part of the table, selected by the hash of the key.
+    struct Shard
+    {
+        std::mutex lock;
+
+        // Table of entries
+        Table table;
 
-    std::recursive_mutex lock_;
+        // Because the following are intrusive lists, a given Entry may be
+        // in at most list at a given instant.  The Entry must be removed
+        // from one list before placing it in another.
 
-    // Table of all entries
-    Table table_;
+        // List of all active inbound entries
+        EntryIntrusiveList inbound;
 
-    // Because the following are intrusive lists, a given Entry may be in
-    // at most list at a given instant.  The Entry must be removed from
-    // one list before placing it in another.
+        // List of all active outbound entries
+        EntryIntrusiveList outbound;
 
-    // List of all active inbound entries
-    EntryIntrusiveList inbound_;
+        // List of all active admin entries
+        EntryIntrusiveList admin;
 
-    // List of all active outbound entries
-    EntryIntrusiveList outbound_;
+        // List of all inactve entries
+        EntryIntrusiveList inactive;
 
-    // List of all active admin entries
-    EntryIntrusiveList admin_;
+        EntryIntrusiveList&
+        active(Kind kind)
+        {
+            switch (kind)
+            {
+                case kindInbound:
+                    return inbound;
+                case kindOutbound:
+                    return outbound;
+                case kindUnlimited:
+                    return admin;
+                default:
+                    assert(false);
+                    return inbound;
+            }
+        }
+    };
+
+    Stats m_stats;
+    Stopwatch& m_clock;
+    beast::Journal m_journal;
 
-    // List of all inactve entries
-    EntryIntrusiveList inactive_;
+    // Entries are charged without a lock. Creating, acquiring and releasing
+    // them locks the shard they are in.
+    Key::hasher hasher_;
+    std::array<Shard, tableShards> shards_;
 
     // All imported gossip data
+    std::mutex importLock_;
     Imports importTable_;
 
+    Shard&
+    shard(Key const& key)
+    {
+        return shards_[hasher_(key) % shards_.size()];
+    }
+
+    Consumer
+    newEndpoint(Kind kind, beast::IP::Endpoint const& address)
+    {
+        Key const key(kind, address);
+        Shard& s(shard(key));
+        Entry* entry(nullptr);
+
+        {
+            std::lock_guard _(s.lock);
+            auto [resultIt, resultInserted] = s.table.emplace(
+                std::piecewise_construct,
+                std::make_tuple(key),             // Key
+                std::make_tuple(m_clock.now()));  // Entry
+
+            entry = &resultIt->second;
+            entry->key = &resultIt->first;
+            if (++entry->refcount == 1)
+            {
+                if (!resultInserted)
+                    s.inactive.erase(s.inactive.iterator_to(*entry));
+                s.active(kind).push_back(*entry);
+            }
+        }
+
+        return Consumer(*this, *entry);
+    }
+
     //--------------------------------------------------------------------------
 public:
     Logic(
@@ -103,65 +164,24 @@ public:
         // destroyed before the consumer table.
         //
         importTable_.clear();
-        table_.clear();
+        for (auto& s : shards_)
+            s.table.clear();
     }
 
     Consumer
     newInboundEndpoint(beast::IP::Endpoint const& address)
     {
-        Entry* entry(nullptr);
-
-        {
-            std::lock_guard _(lock_);
-            auto [resultIt, resultInserted] = table_.emplace(
-                std::piecewise_construct,
-                std::make_tuple(kindInbound, address.at_port(0)),  // Key
-                std::make_tuple(m_clock.now()));                   // Entry
-
-            entry = &resultIt->second;
-            entry->key = &resultIt->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (!resultInserted)
-                {
-                    inactive_.erase(inactive_.iterator_to(*entry));
-                }
-                inbound_.push_back(*entry);
-            }
-        }
-
-        JLOG(m_journal.debug()) << "New inbound endpoint " << *entry;
-
-        return Consumer(*this, *entry);
+        auto consumer = newEndpoint(kindInbound, address.at_port(0));
+        JLOG(m_journal.debug()) << "New inbound endpoint " << consumer;
+        return consumer;
     }
 
     Consumer
     newOutboundEndpoint(beast::IP::Endpoint const& address)
     {
-        Entry* entry(nullptr);
-
-        {
-            std::lock_guard _(lock_);
-            auto [resultIt, resultInserted] = table_.emplace(
-                std::piecewise_construct,
-                std::make_tuple(kindOutbound, address),  // Key
-                std::make_tuple(m_clock.now()));         // Entry
-
-            entry = &resultIt->second;
-            entry->key = &resultIt->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (!resultInserted)
-                    inactive_.erase(inactive_.iterator_to(*entry));
-                outbound_.push_back(*entry);
-            }
-        }
-
-        JLOG(m_journal.debug()) << "New outbound endpoint " << *entry;
-
-        return Consumer(*this, *entry);
+        auto consumer = newEndpoint(kindOutbound, address);
+        JLOG(m_journal.debug()) << "New outbound endpoint " << consumer;
+        return consumer;
     }
 
     /**
@@ -172,29 +192,9 @@ public:
     Consumer
     newUnlimitedEndpoint(beast::IP::Endpoint const& address)
     {
-        Entry* entry(nullptr);
-
-        {
-            std::lock_guard _(lock_);
-            auto [resultIt, resultInserted] = table_.emplace(
-                std::piecewise_construct,
-                std::make_tuple(kindUnlimited, address.at_port(1)),  // Key
-                std::make_tuple(m_clock.now()));                     // Entry
-
-            entry = &resultIt->second;
-            entry->key = &resultIt->first;
-            ++entry->refcount;
-            if (entry->refcount == 1)
-            {
-                if (!resultInserted)
-                    inactive_.erase(inactive_.iterator_to(*entry));
-                admin_.push_back(*entry);
-            }
-        }
-
-        JLOG(m_journal.debug()) << "New unlimited endpoint " << *entry;
-
-        return Consumer(*this, *entry);
+        auto consumer = newEndpoint(kindUnlimited, address.at_port(1));
+        JLOG(m_journal.debug()) << "New unlimited endpoint " << consumer;
+        return consumer;
     }
 
     Json::Value
@@ -210,43 +210,29 @@ public:
         clock_type::time_point const now(m_clock.now());
 
         Json::Value ret(Json::objectValue);
-        std::lock_guard _(lock_);
 
-        for (auto& inboundEntry : inbound_)
-        {
-            int localBalance = inboundEntry.local_balance.value(now);
-            if ((localBalance + inboundEntry.remote_balance) >= threshold)
+        auto add = [&](EntryIntrusiveList& list, char const* type) {
+            for (auto& listEntry : list)
             {
-                Json::Value& entry =
-                    (ret[inboundEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = inboundEntry.remote_balance;
-                entry[jss::type] = "inbound";
-            }
-        }
-        for (auto& outboundEntry : outbound_)
-        {
-            int localBalance = outboundEntry.local_balance.value(now);
-            if ((localBalance + outboundEntry.remote_balance) >= threshold)
-            {
-                Json::Value& entry =
-                    (ret[outboundEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = outboundEntry.remote_balance;
-                entry[jss::type] = "outbound";
+                int localBalance = listEntry.local_balance.value(now);
+                int remoteBalance = listEntry.remote_balance;
+                if ((localBalance + remoteBalance) >= threshold)
+                {
+                    Json::Value& entry =
+                        (ret[listEntry.to_string()] = Json::objectValue);
+                    entry[jss::local] = localBalance;
+                    entry[jss::remote] = remoteBalance;
+                    entry[jss::type] = type;
+                }
             }
-        }
-        for (auto& adminEntry : admin_)
+        };
+
+        for (auto& s : shards_)
         {
-            int localBalance = adminEntry.local_balance.value(now);
-            if ((localBalance + adminEntry.remote_balance) >= threshold)
-            {
-                Json::Value& entry =
-                    (ret[adminEntry.to_string()] = Json::objectValue);
-                entry[jss::local] = localBalance;
-                entry[jss::remote] = adminEntry.remote_balance;
-                entry[jss::type] = "admin";
-            }
+            std::lock_guard _(s.lock);
+            add(s.inbound, "inbound");
+            add(s.outbound, "outbound");
+            add(s.admin, "admin");
         }
 
         return ret;
@@ -258,18 +244,20 @@ public:
         clock_type::time_point const now(m_clock.now());
 
         Gossip gossip;
-        std::lock_guard _(lock_);
 
-        gossip.items.reserve(inbound_.size());
-
-        for (auto& inboundEntry : inbound_)
+        for (auto& s : shards_)
         {
-            Gossip::Item item;
-            item.balance = inboundEntry.local_balance.value(now);
-            if (item.balance >= minimumGossipBalance)
+            std::lock_guard _(s.lock);
+
+            for (auto& inboundEntry : s.inbound)
             {
-                item.address = inboundEntry.key->address;
-                gossip.items.push_back(item);
+                Gossip::Item item;
+                item.balance = inboundEntry.local_balance.value(now);
+                if (item.balance >= minimumGossipBalance)
+                {
+                    item.address = inboundEntry.key->address;
+                    gossip.items.push_back(item);
+                }
             }
         }
 
@@ -283,7 +271,7 @@ public:
     {
         auto const elapsed = m_clock.now();
         {
-            std::lock_guard _(lock_);
+            std::lock_guard _(importLock_);
             auto [resultIt, resultInserted] = importTable_.emplace(
                 std::piecewise_construct,
                 std::make_tuple(origin),  // Key
@@ -341,25 +329,30 @@ public:
     void
     periodicActivity()
     {
-        std::lock_guard _(lock_);
-
         auto const elapsed = m_clock.now();
 
-        for (auto iter(inactive_.begin()); iter != inactive_.end();)
+        for (auto& s : shards_)
         {
-            if (iter->whenExpires <= elapsed)
-            {
-                JLOG(m_journal.debug()) << "Expired " << *iter;
-                auto table_iter = table_.find(*iter->key);
-                ++iter;
-                erase(table_iter);
-            }
-            else
+            std::lock_guard _(s.lock);
+
+            for (auto iter(s.inactive.begin()); iter != s.inactive.end();)
             {
-                break;
+                if (iter->whenExpires <= elapsed)
+                {
+                    JLOG(m_journal.debug()) << "Expired " << *iter;
+                    auto table_iter = s.table.find(*iter->key);
+                    ++iter;
+                    erase(s, table_iter);
+                }
+                else
+                {
+                    break;
+                }
             }
         }
 
+        std::lock_guard _(importLock_);
+
         auto iter = importTable_.begin();
         while (iter != importTable_.end())
         {
@@ -396,47 +389,45 @@ public:
         return Disposition::ok;
     }
 
+    // Call with the shard locked
     void
-    erase(Table::iterator iter)
+    erase(Shard& s, Table::iterator iter)
     {
-        std::lock_guard _(lock_);
         Entry& entry(iter->second);
         assert(entry.refcount == 0);
-        inactive_.erase(inactive_.iterator_to(entry));
-        table_.erase(iter);
+        s.inactive.erase(s.inactive.iterator_to(entry));
+        s.table.erase(iter);
     }
 
     void
     acquire(Entry& entry)
     {
-        std::lock_guard _(lock_);
-        ++entry.refcount;
+        // The caller holds a reference, so the entry is already active
+        assert(entry.refcount > 0);
+        entry.refcount.fetch_add(1, std::memory_order_relaxed);
     }
 
     void
     release(Entry& entry)
     {
-        std::lock_guard _(lock_);
+        // Dropping a reference other than the last one needs no lock
+        int count = entry.refcount.load(std::memory_order_relaxed);
+        while (count > 1)
+        {
+            if (entry.refcount.compare_exchange_weak(
+                    count, count - 1, std::memory_order_relaxed))
+                return;
+        }
+
+        Shard& s(shard(*entry.key));
+        std::lock_guard _(s.lock);
         if (--entry.refcount == 0)
         {
             JLOG(m_journal.debug()) << "Inactive " << entry;
 
-            switch (entry.key->kind)
-            {
-                case kindInbound:
-                    inbound_.erase(inbound_.iterator_to(entry));
-                    break;
-                case kindOutbound:
-                    outbound_.erase(outbound_.iterator_to(entry));
-                    break;
-                case kindUnlimited:
-                    admin_.erase(admin_.iterator_to(entry));
-                    break;
-                default:
-                    assert(false);
-                    break;
-            }
-            inactive_.push_back(entry);
+            auto& active = s.active(entry.key->kind);
+            active.erase(active.iterator_to(entry));
+            s.inactive.push_back(entry);
             entry.whenExpires = m_clock.now() + secondsUntilExpiration;
         }
     }
@@ -444,7 +435,6 @@ public:
     Disposition
     charge(Entry& entry, Charge const& fee)
     {
-        std::lock_guard _(lock_);
         clock_type::time_point const now(m_clock.now());
         int const balance(entry.add(fee.cost(), now));
         JLOG(m_journal.trace()) << "Charging " << entry << " for " << fee;
@@ -457,22 +447,20 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard _(lock_);
-        bool notify(false);
         auto const elapsed = m_clock.now();
-        if (entry.balance(m_clock.now()) >= warningThreshold &&
-            elapsed != entry.lastWarningTime)
-        {
-            charge(entry, feeWarning);
-            notify = true;
-            entry.lastWarningTime = elapsed;
-        }
-        if (notify)
-        {
-            JLOG(m_journal.info()) << "Load warning: " << entry;
-            ++m_stats.warn;
-        }
-        return notify;
+        if (entry.balance(elapsed) < warningThreshold)
+            return false;
+
+        // Warn at most once per tick, even if called concurrently
+        auto last = entry.lastWarningTime.load();
+        if (last == elapsed ||
+            !entry.lastWarningTime.compare_exchange_strong(last, elapsed))
+            return false;
+
+        charge(entry, feeWarning);
+        JLOG(m_journal.info()) << "Load warning: " << entry;
+        ++m_stats.warn;
+        return true;
     }
 
     bool
@@ -481,7 +469,6 @@ public:
         if (entry.isUnlimited())
             return false;
 
-        std::lock_guard _(lock_);
         bool drop(false);
         clock_type::time_point const now(m_clock.now());
         int const balance(entry.balance(now));
@@ -504,7 +491,6 @@ public:
     int
     balance(Entry& entry)
     {
-        std::lock_guard _(lock_);
         return entry.balance(m_clock.now());
     }
 
@@ -520,11 +506,11 @@ public:
         {
             beast::PropertyStream::Map item(items);
             if (entry.refcount != 0)
-                item["count"] = entry.refcount;
+                item["count"] = entry.refcount.load();
             item["name"] = entry.to_string();
             item["balance"] = entry.balance(now);
             if (entry.remote_balance != 0)
-                item["remote_balance"] = entry.remote_balance;
+                item["remote_balance"] = entry.remote_balance.load();
         }
     }
 
@@ -533,27 +519,19 @@ public:
     {
         clock_type::time_point const now(m_clock.now());
 
-        std::lock_guard _(lock_);
-
-        {
-            beast::PropertyStream::Set s("inbound", map);
-            writeList(now, s, inbound_);
-        }
-
-        {
-            beast::PropertyStream::Set s("outbound", map);
-            writeList(now, s, outbound_);
-        }
-
-        {
-            beast::PropertyStream::Set s("admin", map);
-            writeList(now, s, admin_);
-        }
+        auto write = [&](char const* name, EntryIntrusiveList Shard::*list) {
+            beast::PropertyStream::Set set(name, map);
+            for (auto& s : shards_)
+            {
+                std::lock_guard _(s.lock);
+                writeList(now, set, s.*list);
+            }
+        };
 
-        {
-            beast::PropertyStream::Set s("inactive", map);
-            writeList(now, s, inactive_);
-        }
+        write("inbound", &Shard::inbound);
+        write("outbound", &Shard::outbound);
+        write("admin", &Shard::admin);
+        write("inactive", &Shard::inactive);
     }
 };
 
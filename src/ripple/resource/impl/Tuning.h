@@ -21,6 +21,7 @@
 #define RIPPLE_RESOURCE_TUNING_H_INCLUDED
 
 #include <chrono>
+#include <cstddef>
 
 namespace ripple {
 namespace Resource {
@@ -47,6 +48,9 @@ enum {
 // The number of seconds until an inactive table item is removed
 std::chrono::seconds constexpr secondsUntilExpiration{300};
 
+// The number of independently locked parts of the consumer table
+std::size_t constexpr tableShards = 16;
+
 // Number of seconds until imported gossip expires
 std::chrono::seconds constexpr gossipExpirationSeconds{30};
 
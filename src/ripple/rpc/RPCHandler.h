@@ -37,6 +37,10 @@ doCommand(RPC::JsonContext&, Json::Value&);
 Role
 roleRequired(unsigned int version, bool betaEnabled, std::string const& method);
 
+/** Returns true if the method must be called with a JobQueue::Coro. */
+bool
+needsCoro(unsigned int version, bool betaEnabled, std::string const& method);
+
 }  // namespace RPC
 }  // namespace ripple
 
@@ -83,6 +83,8 @@ doLedgerData(RPC::JsonContext&);
 Json::Value
 doLedgerEntry(RPC::JsonContext&);
 Json::Value
+doLedgerExport(RPC::JsonContext&);
+Json::Value
 doLedgerHeader(RPC::JsonContext&);
 Json::Value
 doLedgerRequest(RPC::JsonContext&);
@@ -143,6 +145,8 @@ doSubmitMultiSigned(RPC::JsonContext&);
 Json::Value
 doSubscribe(RPC::JsonContext&);
 Json::Value
+doTrace(RPC::JsonContext&);
+Json::Value
 doTransactionEntry(RPC::JsonContext&);
 Json::Value
 doTxJson(RPC::JsonContext&);
@@ -168,10 +168,12 @@ doLedgerDataGrpc(
         return {response, errorStatus};
     }
 
-    auto e = ledger->sles.end();
+    // The scan stops at the first key past the end marker. An iterator
+    // from upper_bound would read ahead of a scan that never comes.
+    std::optional<uint256> endKey;
     if (auto key = uint256::fromVoidChecked(request.end_marker()))
     {
-        e = ledger->sles.upper_bound(*key);
+        endKey = *key;
     }
     else if (request.end_marker().size() != 0)
     {
@@ -182,8 +184,12 @@ doLedgerDataGrpc(
 
     int maxLimit = RPC::Tuning::pageLength(true);
 
+    auto const e = ledger->sles.end();
     for (auto i = ledger->sles.upper_bound(startKey); i != e; ++i)
     {
+        if (endKey && (*i)->key() > *endKey)
+            break;
+
         auto sle = ledger->read(keylet::unchecked((*i)->key()));
         if (maxLimit-- <= 0)
         {
@@ -0,0 +1,125 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/StateExport.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/net/RPCErr.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/RPCHelpers.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
+#include <boost/filesystem/path.hpp>
+#include <algorithm>
+
+namespace ripple {
+
+// {
+//   path: <string>          // directory to write the files to, relative
+//                           // to the [ledger_export] directory
+//   partitions: 16 | 256    // optional, defaults to 16
+//   ledger_hash: <ledger>
+//   ledger_index: <ledger_index>  // optional, defaults to "validated"
+// }
+//
+// Writes every entry of a closed ledger's state to files on the server,
+// one for each partition of the key space, walking the partitions in
+// parallel. See exportState for the format of the files.
+Json::Value
+doLedgerExport(RPC::JsonContext& context)
+{
+    auto const& params = context.params;
+    auto const& config = context.app.config();
+
+    // Files are only written below the configured directory
+    boost::filesystem::path directory = config.legacy(SECTION_LEDGER_EXPORT);
+    if (directory.empty())
+        return rpcError(rpcNOT_ENABLED);
+    if (!directory.is_absolute())
+        directory = config.CONFIG_DIR / directory;
+
+    if (!params.isMember(jss::path))
+        return RPC::missing_field_error(jss::path);
+    if (!params[jss::path].isString() || params[jss::path].asString().empty())
+        return RPC::expected_field_error(jss::path, "string");
+
+    boost::filesystem::path const path = params[jss::path].asString();
+    if (path.has_root_path() ||
+        std::any_of(path.begin(), path.end(), [](auto const& part) {
+            return part == "..";
+        }))
+        return RPC::invalid_field_error(jss::path);
+
+    std::size_t partitions = 16;
+    if (params.isMember(jss::partitions))
+    {
+        auto const& p = params[jss::partitions];
+        if (!p.isConvertibleTo(Json::uintValue) ||
+            (p.asUInt() != 16 && p.asUInt() != 256))
+            return RPC::invalid_field_error(jss::partitions);
+        partitions = p.asUInt();
+    }
+
+    // Without a ledger, export the last validated one rather than the open
+    // ledger, which can't be exported
+    if (!params.isMember(jss::ledger_hash) &&
+        !params.isMember(jss::ledger_index) && !params.isMember(jss::ledger))
+        context.params[jss::ledger_index] = jss::validated;
+
+    std::shared_ptr<ReadView const> view;
+    auto result = RPC::lookupLedger(view, context);
+    if (!view)
+        return result;
+
+    auto const ledger = std::dynamic_pointer_cast<Ledger const>(view);
+    if (!ledger)
+        return RPC::make_error(
+            rpcINVALID_PARAMS, "Only a closed ledger can be exported.");
+
+    StateExport exported;
+    try
+    {
+        exported = exportState(
+            *ledger, directory / path, partitions, context.app.getJobQueue());
+    }
+    catch (SHAMapMissingNode const& e)
+    {
+        return RPC::make_error(rpcLGR_NOT_FOUND, e.what());
+    }
+    catch (std::exception const& e)
+    {
+        return RPC::make_error(rpcINTERNAL, e.what());
+    }
+
+    result[jss::path] = params[jss::path].asString();
+    result[jss::partitions] = static_cast<unsigned>(partitions);
+    result[jss::entries] = std::to_string(exported.entries);
+    result[jss::bytes] = std::to_string(exported.bytes);
+
+    Json::Value& files = result[jss::files] = Json::arrayValue;
+    for (auto const& file : exported.files)
+        files.append(file.filename().string());
+
+    return result;
+}
+
+}  // namespace ripple
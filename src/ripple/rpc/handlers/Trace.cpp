@@ -0,0 +1,57 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Tracer.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+
+namespace ripple {
+
+// {
+//   enabled: <bool>  // optional
+// }
+//
+// Turns tracing on or off if "enabled" is given. Otherwise returns the
+// spans recorded in the Chrome trace event format.
+Json::Value
+doTrace(RPC::JsonContext& context)
+{
+    auto& tracer = perf::Tracer::instance();
+
+    if (context.params.isMember(jss::enabled))
+    {
+        auto const& enabled = context.params[jss::enabled];
+        if (!enabled.isBool())
+            return RPC::expected_field_error(jss::enabled, "bool");
+
+        tracer.enable(enabled.asBool());
+        if (enabled.asBool())
+            tracer.clear();
+
+        Json::Value ret(Json::objectValue);
+        ret[jss::enabled] = tracer.enabled();
+        return ret;
+    }
+
+    return tracer.getJson();
+}
+
+}  // namespace ripple
@@ -108,6 +108,7 @@ Handler const handlerArray[]{
      NEEDS_CURRENT_LEDGER},
     {"ledger_data", byRef(&doLedgerData), Role::USER, NO_CONDITION},
     {"ledger_entry", byRef(&doLedgerEntry), Role::USER, NO_CONDITION},
+    {"ledger_export", byRef(&doLedgerExport), Role::ADMIN, NO_CONDITION},
     {"ledger_header", byRef(&doLedgerHeader), Role::USER, NO_CONDITION},
     {"ledger_request", byRef(&doLedgerRequest), Role::ADMIN, NO_CONDITION},
     {"log_level", byRef(&doLogLevel), Role::ADMIN, NO_CONDITION},
@@ -137,7 +138,11 @@ Handler const handlerArray[]{
      byRef(&doPeerReservationsList),
      Role::ADMIN,
      NO_CONDITION},
-    {"ripple_path_find", byRef(&doRipplePathFind), Role::USER, NO_CONDITION},
+    {"ripple_path_find",
+     byRef(&doRipplePathFind),
+     Role::USER,
+     NO_CONDITION,
+     true},
     {"sign", byRef(&doSign), Role::USER, NO_CONDITION},
     {"sign_for", byRef(&doSignFor), Role::USER, NO_CONDITION},
     {"submit", byRef(&doSubmit), Role::USER, NEEDS_CURRENT_LEDGER},
@@ -149,6 +154,7 @@ Handler const handlerArray[]{
     {"server_state", byRef(&doServerState), Role::USER, NO_CONDITION},
     {"crawl_shards", byRef(&doCrawlShards), Role::ADMIN, NO_CONDITION},
     {"stop", byRef(&doStop), Role::ADMIN, NO_CONDITION},
+    {"trace", byRef(&doTrace), Role::ADMIN, NO_CONDITION},
     {"transaction_entry", byRef(&doTransactionEntry), Role::USER, NO_CONDITION},
     {"tx", byRef(&doTxJson), Role::USER, NEEDS_NETWORK_CONNECTION},
     {"tx_history", byRef(&doTxHistory), Role::USER, NO_CONDITION},
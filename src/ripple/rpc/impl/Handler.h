@@ -52,6 +52,9 @@ struct Handler
     Method<Json::Value> valueMethod_;
     Role role_;
     RPC::Condition condition_;
+
+    // The method suspends the JobQueue::Coro in its context while it waits.
+    bool needsCoro_ = false;
 };
 
 Handler const*
@@ -25,6 +25,7 @@
 #include <ripple/app/reporting/P2pProxy.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/PerfLog.h>
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/contract.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
@@ -265,6 +266,8 @@ doCommand(RPC::JsonContext& context, Json::Value& result)
 
     if (auto method = handler->valueMethod_)
     {
+        perf::Span const span(handler->name_);
+
         if (!context.headers.user.empty() ||
             !context.headers.forwardedFor.empty())
         {
@@ -304,5 +307,12 @@ roleRequired(unsigned int version, bool betaEnabled, std::string const& method)
     return handler->role_;
 }
 
+bool
+needsCoro(unsigned int version, bool betaEnabled, std::string const& method)
+{
+    auto handler = RPC::getHandler(version, betaEnabled, method);
+    return handler && handler->needsCoro_;
+}
+
 }  // namespace RPC
 }  // namespace ripple
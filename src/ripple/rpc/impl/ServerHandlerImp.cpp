@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/app/main/Application.h>
+#include <ripple/app/main/CollectorManager.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/base64.h>
@@ -61,6 +62,14 @@ isStatusRequest(http_request_type const& request)
         request.method() == boost::beast::http::verb::get;
 }
 
+static bool
+isMetricsRequest(http_request_type const& request)
+{
+    return request.version() >= 11 && request.target() == "/metrics" &&
+        request.body().size() == 0 &&
+        request.method() == boost::beast::http::verb::get;
+}
+
 static Handoff
 statusRequestResponse(
     http_request_type const& request,
@@ -229,6 +238,11 @@ ServerHandlerImp::onHandoff(
     if (is_ws && isStatusRequest(request))
         return statusResponse(request);
 
+    if ((p.count("http") > 0 || p.count("https") > 0) &&
+        isMetricsRequest(request))
+        return metricsResponse(
+            request, session.port(), remote_address.address());
+
     // Otherwise pass to legacy onRequest or websocket
     return {};
 }
@@ -292,13 +306,8 @@ ServerHandlerImp::onRequest(Session& session)
     }
 
     std::shared_ptr<Session> detachedSession = session.detach();
-    auto const postResult = m_jobQueue.postCoro(
-        jtCLIENT_RPC,
-        "RPC-Client",
-        [this, detachedSession](std::shared_ptr<JobQueue::Coro> coro) {
-            processSession(detachedSession, coro);
-        });
-    if (postResult == nullptr)
+    if (!m_jobQueue.postTask(
+            jtCLIENT_RPC, "RPC-Client", processSession(detachedSession)))
     {
         // The coroutine was rejected, probably because we're shutting down.
         HTTPReply(
@@ -339,22 +348,10 @@ ServerHandlerImp::onWSMessage(
 
     JLOG(m_journal.trace()) << "Websocket received '" << jv << "'";
 
-    auto const postResult = m_jobQueue.postCoro(
-        jtCLIENT_WEBSOCKET,
-        "WS-Client",
-        [this, session, jv = std::move(jv)](
-            std::shared_ptr<JobQueue::Coro> const& coro) {
-            auto const jr = this->processSession(session, coro, jv);
-            auto const s = to_string(jr);
-            auto const n = s.length();
-            boost::beast::multi_buffer sb(n);
-            sb.commit(boost::asio::buffer_copy(
-                sb.prepare(n), boost::asio::buffer(s.c_str(), n)));
-            session->send(
-                std::make_shared<StreambufWSMsg<decltype(sb)>>(std::move(sb)));
-            session->complete();
-        });
-    if (postResult == nullptr)
+    if (!m_jobQueue.postTask(
+            jtCLIENT_WEBSOCKET,
+            "WS-Client",
+            processMessage(session, std::move(jv))))
     {
         // The coroutine was rejected, probably because we're shutting down.
         session->close({boost::beast::websocket::going_away, "Shutting Down"});
@@ -397,10 +394,26 @@ logDuration(
                 << " microseconds. request = " << request;
 }
 
-Json::Value
+// Run as a coroutine.
+Task<>
+ServerHandlerImp::processMessage(
+    std::shared_ptr<WSSession> session,
+    Json::Value jv)
+{
+    auto const jr = co_await processSession(session, jv);
+    auto const s = to_string(jr);
+    auto const n = s.length();
+    boost::beast::multi_buffer sb(n);
+    sb.commit(boost::asio::buffer_copy(
+        sb.prepare(n), boost::asio::buffer(s.c_str(), n)));
+    session->send(
+        std::make_shared<StreambufWSMsg<decltype(sb)>>(std::move(sb)));
+    session->complete();
+}
+
+Task<Json::Value>
 ServerHandlerImp::processSession(
     std::shared_ptr<WSSession> const& session,
-    std::shared_ptr<JobQueue::Coro> const& coro,
     Json::Value const& jv)
 {
     auto is = std::static_pointer_cast<WSInfoSub>(session->appDefined);
@@ -410,7 +423,7 @@ ServerHandlerImp::processSession(
             {boost::beast::websocket::policy_error, "threshold exceeded"});
         // FIX: This rpcError is not delivered since the session
         // was just closed.
-        return rpcError(rpcSLOW_DOWN);
+        co_return rpcError(rpcSLOW_DOWN);
     }
 
     // Requests without "command" are invalid.
@@ -443,7 +456,7 @@ ServerHandlerImp::processSession(
                 jr[jss::api_version] = jv[jss::api_version];
 
             is->getConsumer().charge(Resource::feeInvalidRPC);
-            return jr;
+            co_return jr;
         }
 
         auto required = RPC::roleRequired(
@@ -472,14 +485,15 @@ ServerHandlerImp::processSession(
                  app_.getLedgerMaster(),
                  is->getConsumer(),
                  role,
-                 coro,
+                 {},
                  is,
                  apiVersion},
                 jv,
                 {is->user(), is->forwarded_for()}};
 
             auto start = std::chrono::system_clock::now();
-            RPC::doCommand(context, jr[jss::result]);
+            co_await doCommand(
+                context, jr[jss::result], jtCLIENT_WEBSOCKET, "WS-Client");
             auto end = std::chrono::system_clock::now();
             logDuration(jv, end - start, m_journal);
         }
@@ -540,21 +554,18 @@ ServerHandlerImp::processSession(
         jr[jss::api_version] = jv[jss::api_version];
 
     jr[jss::type] = jss::response;
-    return jr;
+    co_return jr;
 }
 
 // Run as a coroutine.
-void
-ServerHandlerImp::processSession(
-    std::shared_ptr<Session> const& session,
-    std::shared_ptr<JobQueue::Coro> coro)
+Task<>
+ServerHandlerImp::processSession(std::shared_ptr<Session> session)
 {
-    processRequest(
+    co_await processRequest(
         session->port(),
         buffers_to_string(session->request().body().data()),
         session->remoteAddress().at_port(0),
         makeOutput(*session),
-        coro,
         forwardedFor(session->request()),
         [&] {
             auto const iter = session->request().find("X-User");
@@ -585,13 +596,12 @@ Json::Int constexpr server_overloaded = -32604;
 Json::Int constexpr forbidden = -32605;
 Json::Int constexpr wrong_version = -32606;
 
-void
+Task<>
 ServerHandlerImp::processRequest(
     Port const& port,
     std::string const& request,
     beast::IP::Endpoint const& remoteIPAddress,
     Output&& output,
-    std::shared_ptr<JobQueue::Coro> coro,
     boost::string_view forwardedFor,
     boost::string_view user)
 {
@@ -609,7 +619,7 @@ ServerHandlerImp::processRequest(
                 "Unable to parse request: " + reader.getFormatedErrorMessages(),
                 output,
                 rpcJ);
-            return;
+            co_return;
         }
     }
 
@@ -621,7 +631,7 @@ ServerHandlerImp::processRequest(
         if (!jsonOrig.isMember(jss::params) || !jsonOrig[jss::params].isArray())
         {
             HTTPReply(400, "Malformed batch request", output, rpcJ);
-            return;
+            co_return;
         }
         size = jsonOrig[jss::params].size();
     }
@@ -665,7 +675,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(400, jss::invalid_API_version.c_str(), output, rpcJ);
-                return;
+                co_return;
             }
             Json::Value r(Json::objectValue);
             r[jss::request] = jsonRPC;
@@ -715,7 +725,7 @@ ServerHandlerImp::processRequest(
                 if (!batch)
                 {
                     HTTPReply(503, "Server is overloaded", output, rpcJ);
-                    return;
+                    co_return;
                 }
                 Json::Value r = jsonRPC;
                 r[jss::error] =
@@ -731,7 +741,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(403, "Forbidden", output, rpcJ);
-                return;
+                co_return;
             }
             Json::Value r = jsonRPC;
             r[jss::error] = make_json_error(forbidden, "Forbidden");
@@ -745,7 +755,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(400, "Null method", output, rpcJ);
-                return;
+                co_return;
             }
             Json::Value r = jsonRPC;
             r[jss::error] = make_json_error(method_not_found, "Null method");
@@ -760,7 +770,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(400, "method is not string", output, rpcJ);
-                return;
+                co_return;
             }
             Json::Value r = jsonRPC;
             r[jss::error] =
@@ -776,7 +786,7 @@ ServerHandlerImp::processRequest(
             if (!batch)
             {
                 HTTPReply(400, "method is empty", output, rpcJ);
-                return;
+                co_return;
             }
             Json::Value r = jsonRPC;
             r[jss::error] =
@@ -802,7 +812,7 @@ ServerHandlerImp::processRequest(
             {
                 usage.charge(Resource::feeInvalidRPC);
                 HTTPReply(400, "params unparseable", output, rpcJ);
-                return;
+                co_return;
             }
             else
             {
@@ -811,7 +821,7 @@ ServerHandlerImp::processRequest(
                 {
                     usage.charge(Resource::feeInvalidRPC);
                     HTTPReply(400, "params unparseable", output, rpcJ);
-                    return;
+                    co_return;
                 }
             }
         }
@@ -829,7 +839,7 @@ ServerHandlerImp::processRequest(
                 if (!batch)
                 {
                     HTTPReply(400, "ripplerpc is not a string", output, rpcJ);
-                    return;
+                    co_return;
                 }
 
                 Json::Value r = jsonRPC;
@@ -868,7 +878,7 @@ ServerHandlerImp::processRequest(
              app_.getLedgerMaster(),
              usage,
              role,
-             coro,
+             {},
              InfoSub::pointer(),
              apiVersion},
             params,
@@ -879,7 +889,7 @@ ServerHandlerImp::processRequest(
 
         try
         {
-            RPC::doCommand(context, result);
+            co_await doCommand(context, result, jtCLIENT_RPC, "RPC-Client");
         }
         catch (std::exception const& ex)
         {
@@ -1015,6 +1025,39 @@ ServerHandlerImp::processRequest(
     HTTPReply(httpStatus, response, output, rpcJ);
 }
 
+// Most commands run right in the Task, which has no stack of its own. The
+// few that suspend their JobQueue::Coro while they wait are given one.
+Task<>
+ServerHandlerImp::doCommand(
+    RPC::JsonContext& context,
+    Json::Value& result,
+    JobType type,
+    std::string const& name)
+{
+    auto const& params = context.params;
+    auto const method = params.isMember(jss::command)
+        ? params[jss::command].asString()
+        : params[jss::method].asString();
+    if (!RPC::needsCoro(
+            context.apiVersion, app_.config().BETA_RPC_API, method))
+    {
+        RPC::doCommand(context, result);
+        co_return;
+    }
+
+    bool const ran = co_await m_jobQueue.awaitCoro(
+        type, name, [&](std::shared_ptr<JobQueue::Coro> const& coro) {
+            context.coro = coro;
+            RPC::doCommand(context, result);
+            context.coro.reset();
+        });
+    if (!ran)
+    {
+        // The coroutine was rejected, probably because we're shutting down.
+        result = RPC::make_error(rpcTOO_BUSY);
+    }
+}
+
 //------------------------------------------------------------------------------
 
 /*  This response is used with load balancing.
@@ -1051,6 +1094,45 @@ ServerHandlerImp::statusResponse(http_request_type const& request) const
     return handoff;
 }
 
+// Serves the metrics to a Prometheus server, if they are exported that way
+// and the request comes from an admin address.
+Handoff
+ServerHandlerImp::metricsResponse(
+    http_request_type const& request,
+    Port const& port,
+    boost::asio::ip::address const& remote_address) const
+{
+    using namespace boost::beast::http;
+    Handoff handoff;
+    response<string_body> msg;
+    auto metrics = app_.getCollectorManager().prometheus();
+    if (!metrics)
+    {
+        msg.result(status::not_found);
+        msg.insert("Content-Type", "text/plain");
+        msg.body() = "Metrics are not exported.";
+    }
+    else if (!ipAllowed(
+                 remote_address, port.admin_nets_v4, port.admin_nets_v6))
+    {
+        msg.result(status::forbidden);
+        msg.insert("Content-Type", "text/plain");
+        msg.body() = "Forbidden";
+    }
+    else
+    {
+        msg.result(status::ok);
+        msg.insert("Content-Type", "text/plain; version=0.0.4");
+        msg.body() = std::move(*metrics);
+    }
+    msg.version(request.version());
+    msg.insert("Server", BuildInfo::getFullVersionString());
+    msg.insert("Connection", "close");
+    msg.prepare_payload();
+    handoff.response = std::make_shared<SimpleWriter>(msg);
+    return handoff;
+}
+
 //------------------------------------------------------------------------------
 
 void
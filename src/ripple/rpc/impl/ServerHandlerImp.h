@@ -171,29 +171,41 @@ public:
     onStopped(Server&);
 
 private:
-    Json::Value
+    Task<>
+    processMessage(std::shared_ptr<WSSession> session, Json::Value jv);
+
+    Task<Json::Value>
     processSession(
         std::shared_ptr<WSSession> const& session,
-        std::shared_ptr<JobQueue::Coro> const& coro,
         Json::Value const& jv);
 
-    void
-    processSession(
-        std::shared_ptr<Session> const&,
-        std::shared_ptr<JobQueue::Coro> coro);
+    Task<>
+    processSession(std::shared_ptr<Session> session);
 
-    void
+    Task<>
     processRequest(
         Port const& port,
         std::string const& request,
         beast::IP::Endpoint const& remoteIPAddress,
         Output&&,
-        std::shared_ptr<JobQueue::Coro> coro,
         boost::string_view forwardedFor,
         boost::string_view user);
 
+    Task<>
+    doCommand(
+        RPC::JsonContext& context,
+        Json::Value& result,
+        JobType type,
+        std::string const& name);
+
     Handoff
     statusResponse(http_request_type const& request) const;
+
+    Handoff
+    metricsResponse(
+        http_request_type const& request,
+        Port const& port,
+        boost::asio::ip::address const& remote_address) const;
 };
 
 }  // namespace ripple
@@ -20,8 +20,7 @@
 #ifndef RIPPLE_SHAMAP_FULLBELOWCACHE_H_INCLUDED
 #define RIPPLE_SHAMAP_FULLBELOWCACHE_H_INCLUDED
 
-#include <ripple/basics/KeyCache.h>
-#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/ConcurrentKeyCache.h>
 #include <ripple/basics/base_uint.h>
 #include <ripple/beast/insight/Collector.h>
 #include <ripple/beast/utility/Journal.h>
@@ -38,7 +37,7 @@ namespace detail {
 class BasicFullBelowCache
 {
 private:
-    using CacheType = KeyCache;
+    using CacheType = ConcurrentKeyCache;
 
 public:
     enum { defaultCacheTargetSize = 0 };
@@ -82,6 +81,39 @@ public:
         return m_cache.size();
     }
 
+    /** Return the target number of elements in the cache. */
+    int
+    getTargetSize() const
+    {
+        return m_cache.getTargetSize();
+    }
+
+    void
+    setTargetSize(int size)
+    {
+        m_cache.setTargetSize(size);
+    }
+
+    /** Return how long an element stays in the cache unless touched. */
+    clock_type::duration
+    getTargetAge() const
+    {
+        return m_cache.getTargetAge();
+    }
+
+    void
+    setTargetAge(clock_type::duration age)
+    {
+        m_cache.setTargetAge(age);
+    }
+
+    /** Return the number of lookups that found and missed their key. */
+    std::pair<std::uint64_t, std::uint64_t>
+    getHitsAndMisses() const
+    {
+        return m_cache.getHitsAndMisses();
+    }
+
     /** Remove expired cache items.
         Thread safety:
             Safe to call from any thread.
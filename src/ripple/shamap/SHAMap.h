@@ -31,9 +31,14 @@
 #include <ripple/shamap/SHAMapItem.h>
 #include <ripple/shamap/SHAMapLeafNode.h>
 #include <ripple/shamap/SHAMapMissingNode.h>
+#include <ripple/shamap/SHAMapNodeID.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
 #include <ripple/shamap/TreeNodeCache.h>
+#include <atomic>
 #include <cassert>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <stack>
 #include <vector>
 
@@ -42,6 +47,10 @@ namespace ripple {
 class SHAMapNodeID;
 class SHAMapSyncFilter;
 
+namespace tests {
+class SHAMap_test;
+}
+
 /** Describes the current state of a given SHAMap */
 enum class SHAMapState {
     /** The map is in flux and objects can be added and removed.
@@ -105,11 +114,16 @@ private:
     std::uint32_t ledgerSeq_ = 0;
 
     std::shared_ptr<SHAMapTreeNode> root_;
-    mutable SHAMapState state_;
+
+    // Atomic because nodes in disjoint subtrees may be added concurrently
+    std::atomic<SHAMapState> state_;
     SHAMapType const type_;
     bool backed_ = true;         // Map is backed by the database
     mutable bool full_ = false;  // Map is believed complete in database
 
+    // The read ahead test looks at how far a read ahead gets
+    friend class tests::SHAMap_test;
+
 public:
     /** Number of children each non-leaf node has (the 'radix tree' part of the
      * map) */
@@ -119,6 +133,9 @@ public:
     /** The depth of the hash map: data is only present in the leaves */
     static inline constexpr unsigned int leafDepth = 64;
 
+    /** Number of node reads a full scan keeps in flight */
+    static inline constexpr std::size_t defaultReadAhead = 256;
+
     using DeltaItem = std::pair<
         boost::intrusive_ptr<SHAMapItem const>,
         boost::intrusive_ptr<SHAMapItem const>>;
@@ -164,6 +181,23 @@ public:
     const_iterator
     end() const;
 
+    /** Return an iterator to the first item that reads ahead.
+
+        As the iterator advances, the nodes it will reach next are read
+        from the database asynchronously, keeping up to `readAhead` reads
+        in flight. A scan of a map that is not in memory then waits on
+        many reads at once instead of on one read at a time.
+
+        @param readAhead The number of reads to keep in flight. Zero, or
+                         a map that is not backed, reads nothing ahead.
+        @param last If set, the last key the scan will reach. Nothing
+                    after it is read ahead.
+    */
+    const_iterator
+    begin(
+        std::size_t readAhead,
+        std::optional<uint256> const& last = std::nullopt) const;
+
     //--------------------------------------------------------------------------
 
     // Returns a new map that's a snapshot of this one.
@@ -227,6 +261,16 @@ public:
     const_iterator
     upper_bound(uint256 const& id) const;
 
+    /** Find the first item after the given item, reading ahead.
+
+        @see begin(std::size_t)
+    */
+    const_iterator
+    upper_bound(
+        uint256 const& id,
+        std::size_t readAhead,
+        std::optional<uint256> const& last = std::nullopt) const;
+
     /** Find the object with the greatest object id smaller than the input id.
 
         @param id the identifier of the item.
@@ -240,9 +284,13 @@ public:
 
          @param function called with every node visited.
          If function returns false, visitNodes exits.
+         @param readAhead The number of node reads to keep in flight
+         ahead of the visit.
     */
     void
-    visitNodes(std::function<bool(SHAMapTreeNode&)> const& function) const;
+    visitNodes(
+        std::function<bool(SHAMapTreeNode&)> const& function,
+        std::size_t readAhead = 0) const;
 
     /**  Visit every node in this SHAMap that
          is not present in the specified SHAMap
@@ -258,11 +306,14 @@ public:
     /**  Visit every leaf node in this SHAMap
 
          @param function called with every non inner node visited.
+         @param readAhead The number of node reads to keep in flight
+         ahead of the visit.
     */
     void
     visitLeaves(
-        std::function<
-            void(boost::intrusive_ptr<SHAMapItem const> const&)> const&) const;
+        std::function<void(
+            boost::intrusive_ptr<SHAMapItem const> const&)> const&,
+        std::size_t readAhead = 0) const;
 
     // comparison/sync functions
 
@@ -582,6 +633,88 @@ private:
     finishFetch(
         SHAMapHash const& hash,
         std::shared_ptr<NodeObject> const& object) const;
+
+    // Structure to track the nodes a scan reads ahead of its position
+    struct ReadAhead
+    {
+        ReadAhead() = delete;
+        ReadAhead(const ReadAhead&) = delete;
+        ReadAhead&
+        operator=(const ReadAhead&) = delete;
+
+        // Orders nodes the way a scan reaches them: a node comes
+        // before the nodes below it, and those before its next sibling
+        struct Preorder
+        {
+            bool
+            operator()(SHAMapNodeID const& a, SHAMapNodeID const& b) const
+            {
+                if (a.getNodeID() != b.getNodeID())
+                    return a.getNodeID() < b.getNodeID();
+                return a.getDepth() < b.getDepth();
+            }
+        };
+
+        // Reads completed by the database's read threads. This is the
+        // only state they touch, so a read that completes after the
+        // scan has finished is harmless.
+        struct Completed
+        {
+            std::mutex mutex_;
+            std::vector<std::tuple<
+                SHAMapNodeID,
+                SHAMapHash,
+                std::shared_ptr<NodeObject>>>
+                reads_;
+        };
+
+        // The nodes an advance may visit once the read ahead is started,
+        // so that a scan of a map that is already in memory or cached
+        // isn't preceded by a walk of the rest of the map
+        static constexpr std::size_t stepVisits = 32;
+
+        std::size_t const window_;
+        std::optional<uint256> const last_;
+        std::size_t pending_ = 0;
+
+        // The nodes the next advances may visit, up to the window
+        std::size_t visits_;
+        std::shared_ptr<Completed> const completed_;
+
+        // inner nodes ahead of the scan whose children are not yet read
+        std::map<SHAMapNodeID, std::shared_ptr<SHAMapInnerNode>, Preorder>
+            unexplored_;
+
+        // nodes read ahead of the scan, held until the scan passes them
+        std::map<SHAMapNodeID, std::shared_ptr<SHAMapTreeNode>, Preorder>
+            ahead_;
+
+        ReadAhead(std::size_t window, std::optional<uint256> const& last)
+            : window_(window)
+            , last_(last)
+            , visits_(window)
+            , completed_(std::make_shared<Completed>())
+        {
+        }
+    };
+
+    /** Start reading ahead, if the map is read from the database */
+    std::shared_ptr<ReadAhead>
+    makeReadAhead(
+        std::size_t window,
+        std::optional<uint256> const& last = std::nullopt) const;
+
+    /** Move a read ahead to a scan's new position
+
+        Collects completed reads, drops nodes the scan has passed and
+        issues reads for the nodes that follow, nearest first. Children
+        that are hooked are left to the scan, and each advance visits a
+        bounded number of nodes.
+
+        @param position The key the scan has reached.
+    */
+    void
+    advanceReadAhead(ReadAhead& ra, uint256 const& position) const;
 };
 
 inline void
@@ -648,6 +781,7 @@ private:
     SharedPtrNodeStack stack_;
     SHAMap const* map_ = nullptr;
     pointer item_ = nullptr;
+    std::shared_ptr<ReadAhead> readAhead_;
 
 public:
     const_iterator() = delete;
@@ -718,6 +852,8 @@ SHAMap::const_iterator::operator++()
         item_ = temp->peekItem().get();
     else
         item_ = nullptr;
+    if (readAhead_ && item_)
+        map_->advanceReadAhead(*readAhead_, item_->key());
     return *this;
 }
 
@@ -24,7 +24,8 @@
 
 namespace ripple {
 
-using TreeNodeCache = TaggedCache<uint256, SHAMapTreeNode>;
+using TreeNodeCache =
+    TaggedCache<uint256, SHAMapTreeNode, false, digest_hash>;
 
 }  // namespace ripple
 
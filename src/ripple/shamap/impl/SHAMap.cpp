@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/basics/Tracer.h>
 #include <ripple/basics/contract.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/shamap/SHAMapAccountStateLeafNode.h>
@@ -25,6 +26,8 @@
 #include <ripple/shamap/SHAMapTxLeafNode.h>
 #include <ripple/shamap/SHAMapTxPlusMetaLeafNode.h>
 
+#include <algorithm>
+
 namespace ripple {
 
 [[nodiscard]] std::shared_ptr<SHAMapLeafNode>
@@ -686,6 +689,155 @@ SHAMap::lower_bound(uint256 const& id) const
     return end();
 }
 
+SHAMap::const_iterator
+SHAMap::begin(std::size_t readAhead, std::optional<uint256> const& last) const
+{
+    auto ra = makeReadAhead(readAhead, last);
+    if (ra)
+        advanceReadAhead(*ra, uint256{});
+
+    const_iterator it(this);
+    if (ra && it.item_)
+    {
+        advanceReadAhead(*ra, it.item_->key());
+        it.readAhead_ = std::move(ra);
+    }
+    return it;
+}
+
+SHAMap::const_iterator
+SHAMap::upper_bound(
+    uint256 const& id,
+    std::size_t readAhead,
+    std::optional<uint256> const& last) const
+{
+    auto ra = makeReadAhead(readAhead, last);
+    if (ra)
+        advanceReadAhead(*ra, id);
+
+    auto it = upper_bound(id);
+    if (ra && it.item_)
+    {
+        advanceReadAhead(*ra, it.item_->key());
+        it.readAhead_ = std::move(ra);
+    }
+    return it;
+}
+
+std::shared_ptr<SHAMap::ReadAhead>
+SHAMap::makeReadAhead(
+    std::size_t window,
+    std::optional<uint256> const& last) const
+{
+    if (window == 0 || !backed_ || !root_->isInner())
+        return {};
+
+    auto ra = std::make_shared<ReadAhead>(window, last);
+    ra->unexplored_.emplace(
+        SHAMapNodeID{}, std::static_pointer_cast<SHAMapInnerNode>(root_));
+    return ra;
+}
+
+void
+SHAMap::advanceReadAhead(ReadAhead& ra, uint256 const& position) const
+{
+    // A node is passed if it is before the position and not above it
+    auto const passed = [&position](SHAMapNodeID const& id) {
+        return id.getNodeID() < position &&
+            SHAMapNodeID::createID(id.getDepth(), position) != id;
+    };
+
+    // Only the nodes above the position are before it and not passed
+    auto const prune = [&](auto& nodes) {
+        auto it = nodes.begin();
+        while (it != nodes.end() && it->first.getNodeID() < position)
+        {
+            if (passed(it->first))
+                it = nodes.erase(it);
+            else
+                ++it;
+        }
+    };
+
+    decltype(ra.completed_->reads_) reads;
+    {
+        std::lock_guard lock(ra.completed_->mutex_);
+        reads.swap(ra.completed_->reads_);
+    }
+
+    for (auto const& [id, hash, object] : reads)
+    {
+        --ra.pending_;
+
+        // Canonicalizing puts the node in the tree node cache,
+        // where the scan finds it when it gets there
+        auto node = finishFetch(hash, object);
+        if (!node || passed(id))
+            continue;
+
+        if (node->isInner())
+            ra.unexplored_.emplace(
+                id, std::static_pointer_cast<SHAMapInnerNode>(node));
+        ra.ahead_.emplace(id, std::move(node));
+    }
+
+    prune(ra.unexplored_);
+    prune(ra.ahead_);
+
+    ra.visits_ = std::min(ra.visits_ + ReadAhead::stepVisits, ra.window_);
+
+    // Explore the nearest inner nodes first, and don't get so far ahead
+    // that the nodes held for the scan are a burden
+    while (ra.pending_ < ra.window_ && ra.visits_ != 0 &&
+           !ra.unexplored_.empty() &&
+           ra.unexplored_.size() + ra.ahead_.size() < 4 * ra.window_)
+    {
+        auto const [id, inner] = *ra.unexplored_.begin();
+        ra.unexplored_.erase(ra.unexplored_.begin());
+
+        for (int branch = 0; branch < branchFactor; ++branch)
+        {
+            if (inner->isEmptyBranch(branch))
+                continue;
+
+            // The branches that follow are past the end of the scan too
+            auto const childID = id.getChildNodeID(branch);
+            if (ra.last_ && childID.getNodeID() > *ra.last_)
+                break;
+
+            if (passed(childID))
+                continue;
+
+            if (ra.visits_ != 0)
+                --ra.visits_;
+
+            // The scan reaches a hooked child without reading it
+            if (inner->getChild(branch))
+                continue;
+
+            auto const& hash = inner->getChildHash(branch);
+            if (auto const child = cacheLookup(hash))
+            {
+                if (child->isInner())
+                    ra.unexplored_.emplace(
+                        childID,
+                        std::static_pointer_cast<SHAMapInnerNode>(child));
+                continue;
+            }
+
+            ++ra.pending_;
+            f_.db().asyncFetch(
+                hash.as_uint256(),
+                ledgerSeq_,
+                [completed = ra.completed_, childID, hash](
+                    std::shared_ptr<NodeObject> const& object) {
+                    std::lock_guard lock(completed->mutex_);
+                    completed->reads_.emplace_back(childID, hash, object);
+                });
+        }
+    }
+}
+
 bool
 SHAMap::hasItem(uint256 const& id) const
 {
@@ -991,6 +1143,8 @@ SHAMap::unshare()
 int
 SHAMap::flushDirty(NodeObjectType t)
 {
+    perf::Span const span("SHAMap::flushDirty");
+
     // We only write back if this map is backed.
     return walkSubTree(backed_, t);
 }
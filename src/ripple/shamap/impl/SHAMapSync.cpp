@@ -26,17 +26,22 @@ namespace ripple {
 void
 SHAMap::visitLeaves(
     std::function<void(boost::intrusive_ptr<SHAMapItem const> const&
-                           item)> const& leafFunction) const
+                           item)> const& leafFunction,
+    std::size_t readAhead) const
 {
-    visitNodes([&leafFunction](SHAMapTreeNode& node) {
-        if (!node.isInner())
-            leafFunction(static_cast<SHAMapLeafNode&>(node).peekItem());
-        return true;
-    });
+    visitNodes(
+        [&leafFunction](SHAMapTreeNode& node) {
+            if (!node.isInner())
+                leafFunction(static_cast<SHAMapLeafNode&>(node).peekItem());
+            return true;
+        },
+        readAhead);
 }
 
 void
-SHAMap::visitNodes(std::function<bool(SHAMapTreeNode&)> const& function) const
+SHAMap::visitNodes(
+    std::function<bool(SHAMapTreeNode&)> const& function,
+    std::size_t readAhead) const
 {
     if (!root_)
         return;
@@ -46,18 +51,26 @@ SHAMap::visitNodes(std::function<bool(SHAMapTreeNode&)> const& function) const
     if (!root_->isInner())
         return;
 
-    using StackEntry = std::pair<int, std::shared_ptr<SHAMapInnerNode>>;
+    using StackEntry =
+        std::tuple<int, std::shared_ptr<SHAMapInnerNode>, SHAMapNodeID>;
     std::stack<StackEntry, std::vector<StackEntry>> stack;
 
     auto node = std::static_pointer_cast<SHAMapInnerNode>(root_);
+    SHAMapNodeID nodeID;
     int pos = 0;
 
+    auto const ra = makeReadAhead(readAhead);
+
     while (true)
     {
         while (pos < 16)
         {
             if (!node->isEmptyBranch(pos))
             {
+                auto const childID = nodeID.getChildNodeID(pos);
+                if (ra)
+                    advanceReadAhead(*ra, childID.getNodeID());
+
                 std::shared_ptr<SHAMapTreeNode> child =
                     descendNoStore(node, pos);
                 if (!function(*child))
@@ -74,11 +87,12 @@ SHAMap::visitNodes(std::function<bool(SHAMapTreeNode&)> const& function) const
                     if (pos != 15)
                     {
                         // save next position to resume at
-                        stack.push(std::make_pair(pos + 1, std::move(node)));
+                        stack.emplace(pos + 1, std::move(node), nodeID);
                     }
 
                     // descend to the child's first position
                     node = std::static_pointer_cast<SHAMapInnerNode>(child);
+                    nodeID = childID;
                     pos = 0;
                 }
             }
@@ -91,7 +105,7 @@ SHAMap::visitNodes(std::function<bool(SHAMapTreeNode&)> const& function) const
         if (stack.empty())
             break;
 
-        std::tie(pos, node) = stack.top();
+        std::tie(pos, node, nodeID) = stack.top();
         stack.pop();
     }
 }
@@ -0,0 +1,294 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/CacheGovernor.h>
+#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/Protocol.h>
+#include <test/unit_test/SuiteJournal.h>
+
+namespace ripple {
+
+class CacheGovernor_test : public beast::unit_test::suite
+{
+    using Cache = TaggedCache<LedgerIndex, std::string>;
+    using Counts = std::pair<std::uint64_t, std::uint64_t>;
+
+    static constexpr std::uint64_t budget = 1000000;
+    static constexpr std::size_t entryBytes = 100;
+
+    static void
+    fill(Cache& cache, LedgerIndex count)
+    {
+        for (LedgerIndex i = 0; i < count; ++i)
+            cache.insert(i, "value");
+    }
+
+    // Look up `hits` keys that are in the cache and `misses` that are not
+    static void
+    use(Cache& cache, LedgerIndex hits, LedgerIndex misses)
+    {
+        for (LedgerIndex i = 0; i < hits; ++i)
+            cache.fetch(i);
+        for (LedgerIndex i = 0; i < misses; ++i)
+            cache.fetch(1000000 + i);
+    }
+
+    bool
+    expectTarget(
+        CacheGovernor const& governor,
+        std::string const& name,
+        int size,
+        CacheGovernor::duration age)
+    {
+        auto const target = governor.target(name);
+        return BEAST_EXPECT(target) && BEAST_EXPECT(target->first == size) &&
+            BEAST_EXPECT(target->second == age);
+    }
+
+    void
+    testShrink()
+    {
+        testcase("shrink");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal("CacheGovernor_test", *this);
+        TestStopwatch clock;
+
+        std::uint64_t resident = budget;
+        CacheGovernor governor(
+            budget, journal, [&resident]() { return resident; });
+
+        Cache busy("busy", 1000, 60s, clock, journal);
+        Cache idle("idle", 1000, 60s, clock, journal);
+        fill(busy, 1000);
+        fill(idle, 1000);
+        governor.add("busy", busy, entryBytes);
+        governor.add("idle", idle, entryBytes);
+
+        // Within the budget, nothing changes
+        use(busy, 100, 0);
+        governor.update();
+        expectTarget(governor, "busy", 1000, 60s);
+        expectTarget(governor, "idle", 1000, 60s);
+
+        // The cache that earns nothing for its memory gives it up first
+        use(busy, 100, 0);
+        resident = budget + 50000;
+        governor.update();
+        expectTarget(governor, "busy", 1000, 60s);
+        expectTarget(governor, "idle", 500, 30s);
+        BEAST_EXPECT(idle.getTargetSize() == 500);
+        BEAST_EXPECT(idle.getTargetAge() == 30s);
+
+        // The sweep brings the cache down to its new target
+        clock.advance(45s);
+        idle.sweep();
+        BEAST_EXPECT(idle.size() == 0);
+
+        // No cache shrinks below a quarter of where it started
+        fill(idle, 1000);
+        resident = 100 * budget;
+        for (int i = 0; i < 10; ++i)
+            governor.update();
+        expectTarget(governor, "busy", 250, 15s);
+        expectTarget(governor, "idle", 250, 15s);
+    }
+
+    void
+    testGrow()
+    {
+        testcase("grow");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal("CacheGovernor_test", *this);
+        TestStopwatch clock;
+
+        std::uint64_t resident = 0;
+        CacheGovernor governor(
+            budget, journal, [&resident]() { return resident; });
+
+        Cache full("full", 1000, 60s, clock, journal);
+        Cache sparse("sparse", 1000, 60s, clock, journal);
+        Cache complete("complete", 1000, 60s, clock, journal);
+        Cache aged("aged", 0, 60s, clock, journal);
+        fill(full, 1000);
+        fill(sparse, 100);
+        fill(complete, 1000);
+        fill(aged, 1000);
+        governor.add("full", full, entryBytes);
+        governor.add("sparse", sparse, entryBytes);
+        governor.add("complete", complete, entryBytes);
+        governor.add("aged", aged, entryBytes);
+
+        // Only caches that are full and still missing grow
+        use(full, 100, 100);
+        use(sparse, 100, 100);
+        use(complete, 100, 0);
+        use(aged, 100, 100);
+        governor.update();
+        expectTarget(governor, "full", 1250, 75s);
+        expectTarget(governor, "sparse", 1000, 60s);
+        expectTarget(governor, "complete", 1000, 60s);
+        expectTarget(governor, "aged", 0, 75s);
+        BEAST_EXPECT(full.getTargetSize() == 1250);
+        BEAST_EXPECT(aged.getTargetSize() == 0);
+
+        // A cache that has not filled its new target does not grow again
+        use(full, 100, 100);
+        governor.update();
+        expectTarget(governor, "full", 1250, 75s);
+
+        // Caches grow no further than the room under the low water mark
+        fill(full, 1250);
+        use(full, 100, 100);
+        resident = budget - budget / 5 - 15625;
+        governor.update();
+        expectTarget(governor, "full", 1406, 84375ms);
+
+        // No cache grows beyond four times where it started
+        resident = 0;
+        for (int i = 0; i < 20; ++i)
+        {
+            fill(full, full.getTargetSize());
+            use(full, 100, 100);
+            governor.update();
+        }
+        expectTarget(governor, "full", 4000, 240s);
+    }
+
+    void
+    testHysteresis()
+    {
+        testcase("hysteresis");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal("CacheGovernor_test", *this);
+        TestStopwatch clock;
+
+        std::uint64_t resident = budget;
+        CacheGovernor governor(
+            budget, journal, [&resident]() { return resident; });
+
+        Cache cache("cache", 1000, 60s, clock, journal);
+        fill(cache, 1000);
+        governor.add("cache", cache, entryBytes);
+
+        resident = budget + 50000;
+        governor.update();
+        expectTarget(governor, "cache", 500, 30s);
+
+        // Memory the cache freed was not returned to the system, so resident
+        // memory stays where it was. The cache is not shrunk again.
+        for (int i = 0; i < 10; ++i)
+        {
+            use(cache, 100, 100);
+            governor.update();
+        }
+        expectTarget(governor, "cache", 500, 30s);
+
+        // Only the growth beyond what the cache already gave up is taken
+        resident = budget + 75000;
+        governor.update();
+        expectTarget(governor, "cache", 375, 22500ms);
+
+        // Between the low water mark and the budget, nothing changes
+        resident = budget - budget / 10;
+        use(cache, 100, 100);
+        governor.update();
+        expectTarget(governor, "cache", 375, 22500ms);
+
+        // Below the low water mark the cache grows, and what it gave up is
+        // forgotten: going over budget again shrinks it again.
+        resident = 0;
+        use(cache, 100, 100);
+        governor.update();
+        expectTarget(governor, "cache", 468, 28125ms);
+
+        resident = budget + 10000;
+        use(cache, 100, 0);
+        governor.update();
+        auto const target = governor.target("cache");
+        BEAST_EXPECT(target && target->first < 468);
+    }
+
+    void
+    testCounters()
+    {
+        testcase("counters");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal("CacheGovernor_test", *this);
+        TestStopwatch clock;
+
+        Cache cache("cache", 1000, 60s, clock, journal);
+        fill(cache, 10);
+        use(cache, 3, 1);
+        BEAST_EXPECT(cache.getHitRate() == 75.0f);
+
+        // Touching keys counts for the governor, not for the hit rate
+        BEAST_EXPECT(cache.touch_if_exists(1));
+        BEAST_EXPECT(!cache.touch_if_exists(1000000));
+        BEAST_EXPECT(!cache.touch_if_exists(1000001));
+        BEAST_EXPECT(cache.getHitRate() == 75.0f);
+        BEAST_EXPECT(cache.getHitsAndMisses() == Counts(4, 3));
+
+        cache.reset();
+        BEAST_EXPECT(cache.getHitsAndMisses() == Counts(0, 0));
+    }
+
+    void
+    testUnmeasured()
+    {
+        testcase("unmeasured");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal("CacheGovernor_test", *this);
+        TestStopwatch clock;
+
+        CacheGovernor governor(
+            budget, journal, []() { return std::optional<std::uint64_t>{}; });
+
+        Cache cache("cache", 1000, 60s, clock, journal);
+        fill(cache, 1000);
+        governor.add("cache", cache, entryBytes);
+        governor.update();
+        expectTarget(governor, "cache", 1000, 60s);
+        BEAST_EXPECT(!governor.target("other"));
+
+        if (auto const resident = CacheGovernor::residentMemory())
+            BEAST_EXPECT(*resident > 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testShrink();
+        testGrow();
+        testHysteresis();
+        testCounters();
+        testUnmeasured();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CacheGovernor, app, ripple);
+
+}  // namespace ripple
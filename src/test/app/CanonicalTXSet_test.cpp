@@ -0,0 +1,334 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/BuildLedger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/consensus/LedgerTiming.h>
+#include <test/jtx.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+namespace ripple {
+namespace test {
+
+class CanonicalTXSet_test : public beast::unit_test::suite
+{
+    static std::shared_ptr<STTx const>
+    makeTx(std::uint32_t account, std::uint32_t seq, std::uint32_t ticket = 0)
+    {
+        return std::make_shared<STTx const>(ttACCOUNT_SET, [&](STObject& obj) {
+            obj.setAccountID(sfAccount, AccountID(account));
+            obj.setFieldU32(sfSequence, seq);
+            if (ticket != 0)
+                obj.setFieldU32(sfTicketSequence, ticket);
+        });
+    }
+
+    // The transaction IDs in the order the set iterates them
+    static std::vector<uint256>
+    ids(CanonicalTXSet const& set)
+    {
+        std::vector<uint256> result;
+        for (auto const& item : set)
+            result.push_back(item.second->getTransactionID());
+        return result;
+    }
+
+    void
+    testOrder()
+    {
+        testcase("order");
+
+        std::vector<std::shared_ptr<STTx const>> txs;
+        for (std::uint32_t account = 1; account <= 20; ++account)
+        {
+            for (std::uint32_t seq = 1; seq <= 50; ++seq)
+                txs.push_back(makeTx(account, seq));
+            for (std::uint32_t ticket = 1; ticket <= 5; ++ticket)
+                txs.push_back(makeTx(account, 0, ticket));
+        }
+
+        beast::xor_shift_engine rng(7);
+        std::shuffle(txs.begin(), txs.end(), rng);
+
+        // The order the set had when it was held in a std::map
+        uint256 const salt{42};
+        std::map<std::tuple<uint256, SeqProxy, uint256>, uint256> reference;
+        for (auto const& tx : txs)
+        {
+            uint256 account = beast::zero;
+            auto const id = tx->getAccountID(sfAccount);
+            std::memcpy(account.begin(), id.begin(), id.size());
+            account ^= salt;
+            reference.emplace(
+                std::make_tuple(
+                    account, tx->getSeqProxy(), tx->getTransactionID()),
+                tx->getTransactionID());
+        }
+        std::vector<uint256> expected;
+        for (auto const& item : reference)
+            expected.push_back(item.second);
+
+        CanonicalTXSet set(salt);
+        for (auto const& tx : txs)
+            set.insert(tx);
+        BEAST_EXPECT(set.size() == txs.size());
+        BEAST_EXPECT(ids(set) == expected);
+
+        // Inserting more after reading puts the new ones in order too
+        CanonicalTXSet partial(salt);
+        std::size_t const half = txs.size() / 2;
+        for (std::size_t i = 0; i < half; ++i)
+            partial.insert(txs[i]);
+        BEAST_EXPECT(partial.size() == half);
+        for (std::size_t i = half; i < txs.size(); ++i)
+            partial.insert(txs[i]);
+        BEAST_EXPECT(ids(partial) == expected);
+
+        // Duplicates are ignored
+        for (auto const& tx : txs)
+            partial.insert(tx);
+        BEAST_EXPECT(partial.size() == txs.size());
+        BEAST_EXPECT(ids(partial) == expected);
+
+        // Large batches are put in order too
+        CanonicalTXSet large(uint256{7});
+        for (std::uint32_t account = 1; account <= 100; ++account)
+            for (std::uint32_t seq = 1; seq <= 200; ++seq)
+                large.insert(makeTx(account, seq));
+        BEAST_EXPECT(large.size() == 20000);
+        std::vector<std::pair<uint256, SeqProxy>> keys;
+        for (auto const& item : large)
+            keys.emplace_back(
+                item.first.getAccount(), item.second->getSeqProxy());
+        BEAST_EXPECT(std::is_sorted(keys.begin(), keys.end()));
+        BEAST_EXPECT(
+            std::adjacent_find(keys.begin(), keys.end()) == keys.end());
+    }
+
+    void
+    testErase()
+    {
+        testcase("erase");
+
+        CanonicalTXSet set(uint256{1});
+        for (std::uint32_t account = 1; account <= 10; ++account)
+            for (std::uint32_t seq = 1; seq <= 10; ++seq)
+                set.insert(makeTx(account, seq));
+
+        auto const all = ids(set);
+        BEAST_EXPECT(all.size() == 100);
+
+        // Erase every other transaction
+        std::vector<uint256> kept;
+        bool erase = true;
+        for (auto it = set.begin(); it != set.end(); erase = !erase)
+        {
+            if (erase)
+            {
+                it = set.erase(it);
+            }
+            else
+            {
+                kept.push_back(it->second->getTransactionID());
+                ++it;
+            }
+        }
+        BEAST_EXPECT(set.size() == 50);
+        BEAST_EXPECT(ids(set) == kept);
+
+        // An erased transaction can be inserted again
+        auto const tx = makeTx(1, 1);
+        set.insert(tx);
+        BEAST_EXPECT(set.size() == 51);
+        BEAST_EXPECT(
+            set.begin()->second->getTransactionID() == tx->getTransactionID());
+
+        // Erase everything
+        for (auto it = set.begin(); it != set.end();)
+            it = set.erase(it);
+        BEAST_EXPECT(set.empty());
+        BEAST_EXPECT(set.begin() == set.end());
+
+        set.insert(tx);
+        BEAST_EXPECT(set.size() == 1);
+        set.reset(uint256{2});
+        BEAST_EXPECT(set.empty());
+        BEAST_EXPECT(set.key() == uint256{2});
+    }
+
+    void
+    testPop()
+    {
+        testcase("popAcctTransaction");
+
+        CanonicalTXSet set(uint256{3});
+        auto const seq1 = makeTx(1, 1);
+        auto const seq2 = makeTx(1, 2);
+        auto const seq5 = makeTx(1, 5);
+        auto const ticket3 = makeTx(1, 0, 3);
+        auto const ticket9 = makeTx(1, 0, 9);
+        auto const other = makeTx(2, 1);
+        for (auto const& tx : {ticket9, seq5, other, ticket3, seq2, seq1})
+            set.insert(tx);
+
+        auto pop = [&](std::shared_ptr<STTx const> const& tx) {
+            auto const next = set.popAcctTransaction(tx);
+            return next ? next->getTransactionID() : uint256{};
+        };
+
+        // Sequences come first, whatever the gaps, then tickets in order
+        BEAST_EXPECT(pop(seq1) == seq1->getTransactionID());
+        BEAST_EXPECT(pop(seq1) == seq2->getTransactionID());
+        BEAST_EXPECT(pop(seq2) == seq5->getTransactionID());
+        BEAST_EXPECT(pop(seq5) == ticket3->getTransactionID());
+        BEAST_EXPECT(pop(ticket3) == ticket9->getTransactionID());
+        BEAST_EXPECT(pop(ticket9) == uint256{});
+        BEAST_EXPECT(set.size() == 1);
+        BEAST_EXPECT(
+            set.begin()->second->getTransactionID() ==
+            other->getTransactionID());
+    }
+
+public:
+    void
+    run() override
+    {
+        testOrder();
+        testErase();
+        testPop();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CanonicalTXSet, app, ripple);
+
+//------------------------------------------------------------------------------
+
+// Times how long it takes to build a ledger from a large transaction set,
+// and how much of it is spent putting the set in order.
+class CanonicalTXSet_timing_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    static double
+    ms(clock_type::duration d)
+    {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+        using namespace std::chrono_literals;
+
+        std::size_t const numAccounts = 100;
+        std::size_t const numTxs = 10000;
+
+        Env env(*this, envconfig(), nullptr, beast::severities::kError);
+
+        std::vector<Account> accounts;
+        for (std::size_t i = 0; i < numAccounts; ++i)
+            accounts.emplace_back("acct" + std::to_string(i));
+        for (auto const& account : accounts)
+            env.fund(XRP(100000), account);
+        env.close();
+
+        std::vector<std::uint32_t> seqs;
+        for (auto const& account : accounts)
+            seqs.push_back(env.seq(account));
+
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve(numTxs);
+        for (std::size_t i = 0; i < numTxs; ++i)
+        {
+            auto const from = i % numAccounts;
+            auto const to = (i + 1) % numAccounts;
+            txs.push_back(env.jt(pay(accounts[from], accounts[to], XRP(1)),
+                                 seq(seqs[from]++),
+                                 fee(10))
+                              .stx);
+        }
+
+        beast::xor_shift_engine rng(11);
+        std::shuffle(txs.begin(), txs.end(), rng);
+
+        auto const parent = env.app().getLedgerMaster().getClosedLedger();
+        auto const closeTime = parent->info().closeTime + 10s;
+
+        for (int run = 0; run < 3; ++run)
+        {
+            CanonicalTXSet set(uint256{std::uint64_t(run + 1)});
+
+            auto const start = clock_type::now();
+            for (auto const& tx : txs)
+                set.insert(tx);
+            auto const inserted = clock_type::now();
+
+            BEAST_EXPECT(set.size() == txs.size());
+
+            // The set is put in order when it is first read
+            auto it = set.begin();
+            auto const ordered = clock_type::now();
+
+            std::size_t count = 0;
+            for (; it != set.end(); ++it)
+                count += it->second != nullptr;
+            BEAST_EXPECT(count == txs.size());
+            auto const iterated = clock_type::now();
+
+            std::set<TxID> failed;
+            auto const built = buildLedger(
+                parent,
+                closeTime,
+                true,
+                ledgerDefaultTimeResolution,
+                env.app(),
+                set,
+                failed,
+                env.journal);
+            auto const done = clock_type::now();
+
+            BEAST_EXPECT(built);
+            BEAST_EXPECT(set.empty());
+            BEAST_EXPECT(failed.empty());
+
+            auto const total = ms(done - start);
+            log << "insert " << ms(inserted - start) << "ms, order "
+                << ms(ordered - inserted) << "ms, iterate "
+                << ms(iterated - ordered) << "ms, buildLedger "
+                << ms(done - iterated) << "ms; ordering is "
+                << 100 * ms(iterated - start) / total << "% of " << total
+                << "ms" << std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(CanonicalTXSet_timing, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
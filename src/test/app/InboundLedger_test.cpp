@@ -0,0 +1,192 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/InboundLedger.h>
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/shamap/SHAMap.h>
+#include <test/jtx.h>
+#include <test/shamap/common.h>
+#include <test/unit_test/SuiteJournal.h>
+
+namespace ripple {
+namespace test {
+
+class InboundLedger_test : public beast::unit_test::suite
+{
+    // Build a reply holding the nodes a peer would send for these requests
+    static protocol::TMLedgerData
+    makeReply(
+        SHAMap const& source,
+        std::vector<SHAMapNodeID> const& requests,
+        int depth)
+    {
+        protocol::TMLedgerData packet;
+        packet.set_ledgerhash(
+            source.getHash().as_uint256().data(), uint256::bytes);
+        packet.set_ledgerseq(0);
+        packet.set_type(protocol::liAS_NODE);
+
+        for (auto const& nodeID : requests)
+        {
+            std::vector<std::pair<SHAMapNodeID, Blob>> nodes;
+            if (!source.getNodeFat(nodeID, nodes, false, depth))
+                return {};
+
+            for (auto const& [id, data] : nodes)
+            {
+                auto node = packet.add_nodes();
+                node->set_nodeid(id.getRawString());
+                node->set_nodedata(data.data(), data.size());
+            }
+        }
+        return packet;
+    }
+
+    void
+    testConcurrentNodes()
+    {
+        testcase("concurrent nodes");
+
+        using namespace jtx;
+        Env env{*this};
+        SuiteJournal journal("InboundLedger_test", *this);
+
+        beast::xor_shift_engine rng(7);
+        tests::TestNodeFamily sourceFamily(journal);
+        SHAMap source(SHAMapType::FREE, sourceFamily);
+        for (int i = 0; i < 4000; ++i)
+        {
+            Serializer s;
+            for (int j = 0; j < 3; ++j)
+                s.add32(rand_int<std::uint32_t>(rng));
+            source.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                make_shamapitem(s.getSHA512Half(), s.slice()));
+        }
+        source.setImmutable();
+
+        // The same replies are added on the calling thread to one map,
+        // and concurrently to the other
+        tests::TestNodeFamily serialFamily(journal);
+        tests::TestNodeFamily parallelFamily(journal);
+        SHAMap serial(SHAMapType::FREE, serialFamily);
+        SHAMap parallel(SHAMapType::FREE, parallelFamily);
+        serial.setSynching();
+        parallel.setSynching();
+
+        auto add = [&](protocol::TMLedgerData const& packet) {
+            auto const s = addLedgerNodes(
+                serial, source.getHash(), packet, nullptr, nullptr, journal);
+            auto const p = addLedgerNodes(
+                parallel,
+                source.getHash(),
+                packet,
+                nullptr,
+                &env.app().getJobQueue(),
+                journal);
+            BEAST_EXPECT(s.get() == p.get());
+            return s.isGood() && p.isGood();
+        };
+
+        BEAST_EXPECT(add(makeReply(source, {SHAMapNodeID()}, 0)));
+
+        // Each reply spans every branch of the root, and is large enough
+        // to be added concurrently
+        std::size_t replies = 0;
+        while (serial.isSynching())
+        {
+            auto const missing = serial.getMissingNodes(256, nullptr);
+            if (missing.empty())
+                break;
+
+            std::vector<SHAMapNodeID> requests;
+            for (auto const& [nodeID, hash] : missing)
+                requests.push_back(nodeID);
+
+            auto const packet = makeReply(source, requests, 2);
+            if (replies == 0)
+                BEAST_EXPECT(packet.nodes_size() >= 256);
+
+            if (!add(packet) || ++replies > 100)
+            {
+                fail("unable to sync");
+                break;
+            }
+            BEAST_EXPECT(
+                parallel.getMissingNodes(256, nullptr).size() ==
+                serial.getMissingNodes(256, nullptr).size());
+        }
+
+        serial.clearSynching();
+        parallel.clearSynching();
+        BEAST_EXPECT(source.deepCompare(serial));
+        BEAST_EXPECT(source.deepCompare(parallel));
+        BEAST_EXPECT(parallel.isValid());
+        parallel.invariants();
+
+        // Nodes that do not match the hashes in their parents are rejected
+        // when added concurrently
+        tests::TestNodeFamily badFamily(journal);
+        SHAMap bad(SHAMapType::FREE, badFamily);
+        bad.setSynching();
+        BEAST_EXPECT(addLedgerNodes(
+                         bad,
+                         source.getHash(),
+                         makeReply(source, {SHAMapNodeID()}, 0),
+                         nullptr,
+                         nullptr,
+                         journal)
+                         .isGood());
+
+        std::vector<SHAMapNodeID> children;
+        for (int branch = 0; branch < SHAMap::branchFactor; ++branch)
+            children.push_back(SHAMapNodeID().getChildNodeID(branch));
+        auto packet = makeReply(source, children, 1);
+        BEAST_EXPECT(packet.nodes_size() >= 64);
+        for (auto& node : *packet.mutable_nodes())
+        {
+            auto& data = *node.mutable_nodedata();
+            data[data.size() / 2] ^= 1;
+        }
+        BEAST_EXPECT(!addLedgerNodes(
+                         bad,
+                         source.getHash(),
+                         packet,
+                         nullptr,
+                         &env.app().getJobQueue(),
+                         journal)
+                         .isGood());
+        BEAST_EXPECT(bad.getMissingNodes(256, nullptr).size() == 16);
+    }
+
+public:
+    void
+    run() override
+    {
+        testConcurrentNodes();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(InboundLedger, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -864,6 +864,7 @@ struct NetworkOfTwo
  * -- process a bad skip list
  * -- process a bad ledger delta
  * -- replay ledger ranges with different overlaps
+ * -- catch up across more ledgers than one task replays
  *
  * LedgerReplayerTimeout_test:
  * -- timeouts of SkipListAcquire
@@ -1437,6 +1438,68 @@ struct LedgerReplayer_test : public beast::unit_test::suite
         BEAST_EXPECT(net.client.countsAsExpected(0, 0, 0));
     }
 
+    void
+    testCatchUp()
+    {
+        testcase("catch up");
+        using namespace LedgerReplayParameters;
+
+        // InboundLedgers drops every request, so every ledger after the
+        // one the client has must be replayed, by two tasks.
+        int const totalReplay = MAX_TASK_SIZE + 50;
+        NetworkOfTwo net(
+            *this,
+            {totalReplay + 1, 10, 1'000'000, 1},
+            PeerSetBehavior::Good,
+            InboundLedgersBehavior::DropAll,
+            PeerFeature::LedgerReplayEnabled);
+
+        auto l = net.server.ledgerMaster.getClosedLedger();
+        uint256 const finalHash = l->info().hash;
+        std::uint32_t const finalSeq = l->seq();
+        for (int i = 0; i < totalReplay - 1; ++i)
+            l = net.server.ledgerMaster.getLedgerByHash(l->info().parentHash);
+        net.client.ledgerMaster.storeLedger(l);
+
+        // Not ahead of the local ledger, or too far ahead
+        BEAST_EXPECT(!net.client.replayer.catchUp(l, l->info().hash, l->seq()));
+        BEAST_EXPECT(!net.client.replayer.catchUp(
+            l, finalHash, l->seq() + MAX_CATCH_UP_LEDGERS + 1));
+
+        BEAST_EXPECT(net.client.replayer.catchUp(l, finalHash, finalSeq));
+        BEAST_EXPECT(net.client.replayer.catchUp(l, finalHash, finalSeq));
+        BEAST_EXPECT(net.client.waitForLedgers(finalHash, totalReplay));
+        BEAST_EXPECT(net.client.waitForDone());
+        BEAST_EXPECT(!net.client.replayer.catchingUp());
+
+        // The task for the last ledgers was created first, and the task
+        // for the ledgers before it when its skip list arrived.
+        auto const tasks = net.client.getTasks();
+        BEAST_EXPECT(tasks.size() == 2);
+        BEAST_EXPECT(net.client.checkStatus(
+            finalHash,
+            MAX_TASK_SIZE,
+            TaskStatus::Completed,
+            TaskStatus::Completed,
+            std::vector<TaskStatus>(
+                MAX_TASK_SIZE - 1, TaskStatus::Completed)));
+        if (tasks.size() == 2)
+        {
+            auto const& first = tasks[1]->getTaskParameter();
+            BEAST_EXPECT(first.startHash_ == l->info().hash);
+            BEAST_EXPECT(
+                first.totalLedgers_ == totalReplay - MAX_TASK_SIZE + 1);
+            BEAST_EXPECT(
+                first.finishHash_ == tasks[0]->getTaskParameter().startHash_);
+            BEAST_EXPECT(
+                net.client.taskStatus(tasks[1]) == TaskStatus::Completed);
+        }
+
+        // sweep
+        net.client.replayer.sweep();
+        BEAST_EXPECT(net.client.countsAsExpected(0, 0, 0));
+    }
+
     void
     run() override
     {
@@ -1457,6 +1520,7 @@ struct LedgerReplayer_test : public beast::unit_test::suite
         testSkipListBadReply();
         testLedgerDeltaBadReply();
         testLedgerReplayOverlap();
+        testCatchUp();
     }
 };
 
@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/impl/RequestWindow.h>
+#include <ripple/beast/unit_test.h>
+
+namespace ripple {
+namespace test {
+
+class RequestWindow_test : public beast::unit_test::suite
+{
+    using time_point = RequestWindow::clock_type::time_point;
+    using ms = std::chrono::milliseconds;
+
+    // Send as many requests as the window allows, and reply to all of them
+    // after `rtt`
+    static void
+    roundTrip(RequestWindow& w, time_point& now, ms rtt, bool useful = true)
+    {
+        auto const n = w.available();
+        for (std::size_t i = 0; i < n; ++i)
+            w.onSend(now);
+        now += rtt;
+        for (std::size_t i = 0; i < n; ++i)
+            w.onReply(now, useful);
+    }
+
+    void
+    testGrowth()
+    {
+        testcase("growth");
+
+        RequestWindow w;
+        time_point now;
+
+        BEAST_EXPECT(w.window() == RequestWindow::initialWindow);
+        BEAST_EXPECT(w.available() == RequestWindow::initialWindow);
+        BEAST_EXPECT(w.rtt() == ms{0});
+
+        w.onSend(now);
+        BEAST_EXPECT(w.outstanding() == 1);
+        BEAST_EXPECT(w.available() == RequestWindow::initialWindow - 1);
+
+        now += ms{100};
+        w.onReply(now, true);
+        BEAST_EXPECT(w.outstanding() == 0);
+        BEAST_EXPECT(w.rtt() == ms{100});
+        BEAST_EXPECT(w.window() == RequestWindow::initialWindow + 1);
+
+        // A steady round trip time opens the window up to its maximum
+        for (int i = 0; i < 10; ++i)
+            roundTrip(w, now, ms{100});
+        BEAST_EXPECT(w.window() == RequestWindow::maximumWindow);
+        BEAST_EXPECT(w.available() == RequestWindow::maximumWindow);
+    }
+
+    void
+    testCongestion()
+    {
+        testcase("congestion");
+
+        RequestWindow w;
+        time_point now;
+        for (int i = 0; i < 10; ++i)
+            roundTrip(w, now, ms{50});
+        BEAST_EXPECT(w.window() == RequestWindow::maximumWindow);
+
+        // Round trips growing well past the fastest one close the window
+        for (int i = 0; i < 20; ++i)
+            roundTrip(w, now, ms{400});
+        BEAST_EXPECT(w.rtt() > ms{100});
+        BEAST_EXPECT(w.window() < RequestWindow::maximumWindow);
+
+        // Useless replies halve the window, down to the minimum
+        RequestWindow u;
+        for (int i = 0; i < 10; ++i)
+            roundTrip(u, now, ms{50});
+        auto const before = u.window();
+        u.onSend(now);
+        u.onReply(now + ms{50}, false);
+        BEAST_EXPECT(u.window() == before / 2);
+        for (int i = 0; i < 10; ++i)
+            roundTrip(u, now, ms{50}, false);
+        BEAST_EXPECT(u.window() == RequestWindow::minimumWindow);
+        BEAST_EXPECT(u.available() == RequestWindow::minimumWindow);
+    }
+
+    void
+    testExpire()
+    {
+        testcase("expire");
+
+        RequestWindow w;
+        time_point now;
+        for (int i = 0; i < 10; ++i)
+            roundTrip(w, now, ms{50});
+        BEAST_EXPECT(w.window() == RequestWindow::maximumWindow);
+
+        w.onSend(now);
+        w.onSend(now + ms{10});
+        w.onSend(now + ms{2000});
+        BEAST_EXPECT(w.outstanding() == 3);
+
+        // Nothing sent before the cutoff
+        BEAST_EXPECT(w.expire(now) == 0);
+        BEAST_EXPECT(w.window() == RequestWindow::maximumWindow);
+
+        BEAST_EXPECT(w.expire(now + ms{1000}) == 2);
+        BEAST_EXPECT(w.outstanding() == 1);
+        BEAST_EXPECT(w.window() == RequestWindow::maximumWindow / 2);
+
+        // A reply with nothing outstanding is ignored
+        RequestWindow v;
+        v.onReply(now, false);
+        BEAST_EXPECT(v.window() == RequestWindow::initialWindow);
+        BEAST_EXPECT(v.rtt() == ms{0});
+    }
+
+public:
+    void
+    run() override
+    {
+        testGrowth();
+        testCongestion();
+        testExpire();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RequestWindow, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,447 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/ConcurrentKeyCache.h>
+#include <ripple/basics/KeyCache.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/digest.h>
+#include <test/unit_test/SuiteJournal.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class ConcurrentKeyCache_test : public beast::unit_test::suite
+{
+    static uint256
+    key(std::uint64_t n)
+    {
+        return sha512Half(n);
+    }
+
+    void
+    testExpiration()
+    {
+        testcase("expiration");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal j("ConcurrentKeyCache_test", *this);
+        TestStopwatch clock;
+
+        // Insert a key, find it, and age it so it gets evicted
+        {
+            ConcurrentKeyCache c("test", 1, 2s, clock, j);
+
+            BEAST_EXPECT(c.size() == 0);
+            BEAST_EXPECT(c.insert(key(1)));
+            BEAST_EXPECT(!c.insert(key(1)));
+            BEAST_EXPECT(c.size() == 1);
+            BEAST_EXPECT(c.touch_if_exists(key(1)));
+            ++clock;
+            c.sweep();
+            BEAST_EXPECT(c.size() == 1);
+            ++clock;
+            c.sweep();
+            BEAST_EXPECT(c.size() == 0);
+            BEAST_EXPECT(!c.touch_if_exists(key(1)));
+        }
+
+        // Insert two keys, have the one that is not used expire
+        {
+            ConcurrentKeyCache c("test", 2, 2s, clock, j);
+
+            BEAST_EXPECT(c.insert(key(1)));
+            BEAST_EXPECT(c.insert(key(2)));
+            BEAST_EXPECT(c.size() == 2);
+            ++clock;
+            c.sweep();
+            BEAST_EXPECT(c.size() == 2);
+            BEAST_EXPECT(c.touch_if_exists(key(2)));
+            ++clock;
+            c.sweep();
+            BEAST_EXPECT(c.size() == 1);
+            BEAST_EXPECT(!c.touch_if_exists(key(1)));
+            BEAST_EXPECT(c.touch_if_exists(key(2)));
+        }
+
+        // Insert three keys, one over the target, and sweep
+        {
+            ConcurrentKeyCache c("test", 2, 3s, clock, j);
+
+            BEAST_EXPECT(c.insert(key(1)));
+            ++clock;
+            BEAST_EXPECT(c.insert(key(2)));
+            ++clock;
+            BEAST_EXPECT(c.insert(key(3)));
+            ++clock;
+            BEAST_EXPECT(c.size() == 3);
+            c.sweep();
+            BEAST_EXPECT(c.size() < 3);
+            BEAST_EXPECT(c.touch_if_exists(key(3)));
+
+            auto const [hits, misses] = c.getHitsAndMisses();
+            BEAST_EXPECT(hits == 1);
+            BEAST_EXPECT(misses == 0);
+
+            c.clear();
+            BEAST_EXPECT(c.size() == 0);
+            BEAST_EXPECT(!c.touch_if_exists(key(3)));
+        }
+    }
+
+    void
+    testCapacity()
+    {
+        testcase("capacity");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal j("ConcurrentKeyCache_test", *this);
+        TestStopwatch clock;
+
+        // A target size of one set has a single set of slots
+        ConcurrentKeyCache c("test", ConcurrentKeyCache::ways, 60s, clock, j);
+        BEAST_EXPECT(c.capacity() == ConcurrentKeyCache::ways);
+
+        for (std::uint64_t i = 0; i < ConcurrentKeyCache::ways; ++i)
+        {
+            BEAST_EXPECT(c.insert(key(i)));
+            ++clock;
+        }
+        BEAST_EXPECT(c.size() == ConcurrentKeyCache::ways);
+
+        // Once full, the key used least recently makes room
+        BEAST_EXPECT(c.touch_if_exists(key(0)));
+        BEAST_EXPECT(c.insert(key(100)));
+        BEAST_EXPECT(c.size() == ConcurrentKeyCache::ways);
+        BEAST_EXPECT(c.touch_if_exists(key(0)));
+        BEAST_EXPECT(!c.touch_if_exists(key(1)));
+        BEAST_EXPECT(c.touch_if_exists(key(100)));
+
+        // A later target size can lower the number of keys kept
+        c.setTargetSize(2);
+        BEAST_EXPECT(c.getTargetSize() == 2);
+        c.setTargetAge(10s);
+        BEAST_EXPECT(c.getTargetAge() == 10s);
+        ++clock;
+        c.sweep();
+        BEAST_EXPECT(c.size() == 2);
+
+        // A large or missing target size does not make the table large yet
+        ConcurrentKeyCache d("test", 0, 60s, clock, j);
+        BEAST_EXPECT(d.capacity() == ConcurrentKeyCache::initialCapacity);
+        ConcurrentKeyCache e("test", 1000000, 60s, clock, j);
+        BEAST_EXPECT(e.capacity() == ConcurrentKeyCache::initialCapacity);
+    }
+
+    void
+    testResize()
+    {
+        testcase("resize");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal j("ConcurrentKeyCache_test", *this);
+        TestStopwatch clock;
+
+        auto const most = ConcurrentKeyCache::defaultCapacity;
+        ConcurrentKeyCache c("test", 0, 60s, clock, j);
+
+        // Insert keys, the last hundred a second after the others, so that
+        // no key inserted before them is used more recently
+        std::uint64_t n = 0;
+        auto const insert = [&](std::uint64_t count) {
+            while (n < count - 100)
+                c.insert(key(n++));
+            ++clock;
+            while (n < count)
+                c.insert(key(n++));
+        };
+
+        // The table grows as keys are inserted, up to the room the target
+        // size calls for
+        insert(4 * most);
+        BEAST_EXPECT(c.capacity() == most);
+        BEAST_EXPECT(c.size() > most / 2);
+        BEAST_EXPECT(c.size() <= most);
+
+        // A lower target size shrinks the table at the next sweep, keeping
+        // the keys used most recently
+        ++clock;
+        for (std::uint64_t i = n - 100; i < n; ++i)
+            BEAST_EXPECT(c.touch_if_exists(key(i)));
+        c.setTargetSize(1024);
+        c.sweep();
+        BEAST_EXPECT(c.capacity() == 1024);
+        BEAST_EXPECT(c.size() <= 1024);
+        for (std::uint64_t i = n - 100; i < n; ++i)
+            BEAST_EXPECT(c.touch_if_exists(key(i)));
+
+        // A higher one lets it grow again
+        c.setTargetSize(2 * most);
+        c.sweep();
+        BEAST_EXPECT(c.capacity() == 2048);
+        insert(12 * most);
+        BEAST_EXPECT(c.capacity() == 2 * most);
+        for (std::uint64_t i = n - 100; i < n; ++i)
+            BEAST_EXPECT(c.touch_if_exists(key(i)));
+    }
+
+    void
+    testConcurrency()
+    {
+        testcase("concurrency");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal j("ConcurrentKeyCache_test", *this);
+
+        std::size_t const threads = 4;
+        std::uint64_t const perThread = 5000;
+
+        // Plenty of room, so that no set of slots overflows
+        ConcurrentKeyCache c(
+            "test", 16 * threads * perThread, 60s, stopwatch(), j);
+
+        // Grow the table first, since a key inserted while the table is
+        // being resized may be lost
+        for (std::uint64_t i = 0; c.capacity() < 16 * threads * perThread;
+             ++i)
+            c.insert(key(1000000 + i));
+        c.clear();
+
+        // Each thread inserts its own keys while looking up everyone's
+        std::vector<std::thread> workers;
+        std::atomic<std::size_t> lost{0};
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t] {
+                for (std::uint64_t i = 0; i < perThread; ++i)
+                {
+                    auto const k = key(t * perThread + i);
+                    c.insert(k);
+                    if (!c.touch_if_exists(k))
+                        ++lost;
+                    auto const other = (t + 1) % threads;
+                    c.touch_if_exists(key(other * perThread + i));
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        // With room to spare, no key is evicted and none is torn
+        BEAST_EXPECT(lost == 0);
+        BEAST_EXPECT(c.size() == threads * perThread);
+        for (std::uint64_t i = 0; i < threads * perThread; ++i)
+        {
+            if (!c.touch_if_exists(key(i)))
+                ++lost;
+        }
+        BEAST_EXPECT(lost == 0);
+        BEAST_EXPECT(!c.touch_if_exists(key(threads * perThread)));
+    }
+
+    void
+    testConcurrentResize()
+    {
+        testcase("concurrent resize");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal j("ConcurrentKeyCache_test", *this);
+
+        std::size_t const threads = 4;
+        std::uint64_t const perThread = 50000;
+
+        ConcurrentKeyCache c("test", 0, 60s, stopwatch(), j);
+
+        // Threads insert and look up keys while the table grows, and while
+        // sweeps shrink it and let it grow again
+        std::atomic<bool> done{false};
+        std::thread sweeper([&] {
+            int const sizes[] = {1024, 0, 8192};
+            for (std::size_t i = 0; !done; ++i)
+            {
+                c.setTargetSize(sizes[i % 3]);
+                c.sweep();
+                std::this_thread::yield();
+            }
+        });
+
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t] {
+                for (std::uint64_t i = 0; i < perThread; ++i)
+                {
+                    c.insert(key(t * perThread + i));
+                    c.touch_if_exists(key(t * perThread + i / 2));
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        done = true;
+        sweeper.join();
+
+        BEAST_EXPECT(c.size() <= c.capacity());
+        c.clear();
+        BEAST_EXPECT(c.size() == 0);
+    }
+
+    void
+    testReadersDuringResize()
+    {
+        testcase("readers during resize");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal j("ConcurrentKeyCache_test", *this);
+
+        ConcurrentKeyCache c("test", 0, 60s, stopwatch(), j);
+        for (std::uint64_t i = 0; i < 1000; ++i)
+            c.insert(key(i));
+
+        // Threads only look keys up, while another thread shrinks the
+        // table with sweeps and grows it again with inserts, so that
+        // lookups keep starting just as a table is replaced
+        std::atomic<bool> done{false};
+        std::atomic<std::uint64_t> lookups{0};
+        std::vector<std::thread> readers;
+        for (std::size_t t = 0; t < 4; ++t)
+        {
+            readers.emplace_back([&] {
+                std::uint64_t count = 0;
+                while (!done)
+                {
+                    for (std::uint64_t i = 0; i < 1000; ++i)
+                        c.touch_if_exists(key(i));
+                    count += 1000;
+                }
+                lookups += count;
+            });
+        }
+
+        std::size_t resizes = 0;
+        auto capacity = c.capacity();
+        auto const resized = [&] {
+            if (c.capacity() != capacity)
+            {
+                capacity = c.capacity();
+                ++resizes;
+            }
+        };
+        for (std::uint64_t round = 0; round < 100; ++round)
+        {
+            c.setTargetSize(256);
+            c.sweep();
+            resized();
+            c.setTargetSize(0);
+            for (std::uint64_t i = 0; i < 4000; ++i)
+                c.insert(key(1000 + round * 4000 + i));
+            resized();
+        }
+        done = true;
+        for (auto& reader : readers)
+            reader.join();
+
+        BEAST_EXPECT(resizes >= 100);
+        auto const [hits, misses] = c.getHitsAndMisses();
+        BEAST_EXPECT(hits + misses == lookups);
+        BEAST_EXPECT(c.size() <= c.capacity());
+    }
+
+public:
+    void
+    run() override
+    {
+        testExpiration();
+        testCapacity();
+        testResize();
+        testConcurrency();
+        testConcurrentResize();
+        testReadersDuringResize();
+    }
+};
+
+// Compares lookups from several threads against KeyCache
+class ConcurrentKeyCache_timing_test : public beast::unit_test::suite
+{
+    template <class Cache>
+    std::chrono::milliseconds
+    lookups(
+        Cache& cache,
+        std::vector<uint256> const& keys,
+        std::size_t threads)
+    {
+        for (auto const& k : keys)
+            cache.insert(k);
+
+        auto const start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&] {
+                for (int pass = 0; pass < 10; ++pass)
+                {
+                    for (auto const& k : keys)
+                        cache.touch_if_exists(k);
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono_literals;
+        test::SuiteJournal j("ConcurrentKeyCache_timing_test", *this);
+
+        std::vector<uint256> keys;
+        for (std::uint64_t i = 0; i < 500000; ++i)
+            keys.push_back(sha512Half(i));
+
+        for (std::size_t threads : {1, 2, 4, 8})
+        {
+            KeyCache locked("locked", keys.size(), 60s, stopwatch(), j);
+            ConcurrentKeyCache concurrent(
+                "concurrent", keys.size(), 60s, stopwatch(), j);
+
+            auto const a = lookups(locked, keys, threads);
+            auto const b = lookups(concurrent, keys, threads);
+            log << threads << " threads: KeyCache " << a.count()
+                << "ms, ConcurrentKeyCache " << b.count() << "ms"
+                << std::endl;
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ConcurrentKeyCache, ripple_basics, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(
+    ConcurrentKeyCache_timing,
+    ripple_basics,
+    ripple);
+
+}  // namespace ripple
@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Tracer.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/jss.h>
+
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace perf {
+
+class Tracer_test : public beast::unit_test::suite
+{
+    // The number of spans of each name in a trace
+    static std::map<std::string, std::size_t>
+    count(Json::Value const& trace)
+    {
+        std::map<std::string, std::size_t> result;
+        for (auto const& event : trace[jss::traceEvents])
+        {
+            if (event[jss::ph] == "X")
+                ++result[event[jss::name].asString()];
+        }
+        return result;
+    }
+
+    void
+    testRecord()
+    {
+        testcase("record");
+
+        auto& tracer = Tracer::instance();
+        tracer.clear();
+        tracer.enable(true);
+        BEAST_EXPECT(tracer.enabled());
+
+        std::size_t const perThread = 1000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t] {
+                beast::setCurrentThreadName("tracer " + std::to_string(t));
+                for (std::size_t i = 0; i < perThread; ++i)
+                {
+                    auto const start = Tracer::now();
+                    tracer.record(t % 2 ? "odd" : "even", start, Tracer::now());
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        auto const trace = tracer.getJson();
+        auto const counts = count(trace);
+        BEAST_EXPECT(counts.size() == 2);
+        BEAST_EXPECT(counts.at("even") == 2 * perThread);
+        BEAST_EXPECT(counts.at("odd") == 2 * perThread);
+
+        // Every event has a time and a thread with a name
+        std::map<std::uint32_t, std::string> names;
+        for (auto const& event : trace[jss::traceEvents])
+        {
+            if (event[jss::ph] == "M")
+                names[event[jss::tid].asUInt()] =
+                    event[jss::args][jss::name].asString();
+        }
+        for (auto const& event : trace[jss::traceEvents])
+        {
+            if (event[jss::ph] != "X")
+                continue;
+            BEAST_EXPECT(event[jss::ts].asDouble() >= 0);
+            BEAST_EXPECT(event[jss::dur].asDouble() >= 0);
+            BEAST_EXPECT(
+                names[event[jss::tid].asUInt()].compare(0, 7, "tracer ") ==
+                0);
+        }
+
+        // The threads exited, so new threads reuse their buffers
+        std::thread([&] {
+            auto const start = Tracer::now();
+            tracer.record("again", start, Tracer::now());
+        }).join();
+        BEAST_EXPECT(count(tracer.getJson())["again"] == 1);
+
+        tracer.enable(false);
+        tracer.clear();
+        BEAST_EXPECT(count(tracer.getJson()).empty());
+    }
+
+    void
+    testWrap()
+    {
+        testcase("wrap");
+
+        auto& tracer = Tracer::instance();
+        tracer.clear();
+
+        // Only the most recent spans are kept. The oldest of them may be
+        // being overwritten, so it is left out too.
+        auto const total = Tracer::bufferSize + 100;
+        for (std::size_t i = 0; i < total; ++i)
+        {
+            auto const start = Tracer::now();
+            tracer.record(i < 100 ? "old" : "new", start, start + i);
+        }
+        auto const counts = count(tracer.getJson());
+        BEAST_EXPECT(counts.count("old") == 0);
+        BEAST_EXPECT(counts.at("new") == Tracer::bufferSize - 1);
+
+        tracer.clear();
+        auto const start = Tracer::now();
+        tracer.record("after", start, Tracer::now());
+        auto const after = count(tracer.getJson());
+        BEAST_EXPECT(after.size() == 1 && after.at("after") == 1);
+    }
+
+    void
+    testSpan()
+    {
+        testcase("span");
+
+        auto& tracer = Tracer::instance();
+        tracer.enable(false);
+        tracer.clear();
+        {
+            Span const span("Tracer_test::disabled");
+        }
+        BEAST_EXPECT(
+            count(tracer.getJson()).count("Tracer_test::disabled") == 0);
+
+        tracer.enable(true);
+        {
+            Span const outer("Tracer_test::outer");
+            Span const inner("Tracer_test::inner");
+        }
+        tracer.enable(false);
+        auto const counts = count(tracer.getJson());
+        BEAST_EXPECT(counts.at("Tracer_test::outer") == 1);
+        BEAST_EXPECT(counts.at("Tracer_test::inner") == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testRecord();
+        testWrap();
+        testSpan();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Tracer, basics, ripple);
+
+}  // namespace perf
+}  // namespace ripple
@@ -21,10 +21,21 @@
 #include <ripple/basics/base_uint.h>
 #include <ripple/basics/hardened_hash.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <boost/algorithm/hex.hpp>
 #include <boost/endian/conversion.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <complex>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <string>
 
 #include <type_traits>
+#include <unordered_set>
+#include <vector>
 
 namespace ripple {
 namespace test {
@@ -54,6 +65,15 @@ struct nonhash
     }
 };
 
+static uint256
+randomKey(beast::xor_shift_engine& rng)
+{
+    uint256 key;
+    for (auto& b : key)
+        b = static_cast<std::uint8_t>(rng());
+    return key;
+}
+
 struct base_uint_test : beast::unit_test::suite
 {
     using test96 = base_uint<96>;
@@ -128,9 +148,101 @@ struct base_uint_test : beast::unit_test::suite
         }
     }
 
+    // Check the vectorized comparison and hex conversion against plain
+    // implementations, for sizes which use whole and partial blocks.
+    template <std::size_t Bits>
+    void
+    testKernels(beast::xor_shift_engine& rng)
+    {
+        using T = base_uint<Bits>;
+
+        auto random = [&] {
+            T t;
+            for (auto& b : t)
+                b = static_cast<std::uint8_t>(rng());
+            return t;
+        };
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            T const a = random();
+            T b = a;
+            // Differ in a single byte, or not at all
+            if (i % 10 != 0)
+                b.data()[rng() % T::bytes] ^= 1 + rng() % 255;
+
+            // memcmp compares bytes as unsigned, like base_uint does
+            auto const expected =
+                std::memcmp(a.data(), b.data(), T::bytes) <=> 0;
+            BEAST_EXPECT((a <=> b) == expected);
+            BEAST_EXPECT((a == b) == (expected == 0));
+
+            std::string expectedHex;
+            boost::algorithm::hex(
+                a.cbegin(), a.cend(), std::back_inserter(expectedHex));
+            auto const hex = to_string(a);
+            BEAST_EXPECT(hex == expectedHex);
+
+            T parsed;
+            BEAST_EXPECT(parsed.parseHex(hex) && parsed == a);
+            std::string lower = hex;
+            std::transform(
+                lower.begin(), lower.end(), lower.begin(), [](char c) {
+                    return static_cast<char>(std::tolower(c));
+                });
+            BEAST_EXPECT(parsed.parseHex(lower) && parsed == a);
+
+            // A bad character anywhere is caught
+            std::string bad = hex;
+            bad[rng() % bad.size()] = "gG/:@`\x80\xff "[rng() % 9];
+            BEAST_EXPECT(!parsed.parseHex(bad));
+        }
+    }
+
+    void
+    testDigestHash()
+    {
+        testcase("digest_hash");
+
+        digest_hash const h1;
+        digest_hash const h2;
+        uint256 const a{1};
+        uint256 const b{2};
+        BEAST_EXPECT(h1(a) == h1(a));
+        BEAST_EXPECT(h1(a) != h1(b));
+        // Each instance has its own seed
+        BEAST_EXPECT(h1(a) != h2(a) || h1(b) != h2(b));
+
+        beast::xor_shift_engine rng(2);
+        std::vector<uint256> keys;
+        std::unordered_set<uint256, digest_hash> set;
+        for (int i = 0; i < 1000; ++i)
+        {
+            keys.push_back(randomKey(rng));
+            set.insert(keys.back());
+        }
+        BEAST_EXPECT(set.size() == keys.size());
+        for (auto const& key : keys)
+            BEAST_EXPECT(set.count(key) == 1);
+        BEAST_EXPECT(set.count(uint256{}) == 0);
+    }
+
     void
     run() override
     {
+        {
+            testcase("base_uint: vectorized kernels");
+            beast::xor_shift_engine rng(1);
+            testKernels<64>(rng);
+            testKernels<96>(rng);
+            testKernels<128>(rng);
+            testKernels<160>(rng);
+            testKernels<256>(rng);
+            testKernels<384>(rng);
+        }
+
+        testDigestHash();
+
         testcase("base_uint: general purpose tests");
 
         static_assert(
@@ -366,5 +478,88 @@ struct base_uint_test : beast::unit_test::suite
 
 BEAST_DEFINE_TESTSUITE(base_uint, ripple_basics, ripple);
 
+//------------------------------------------------------------------------------
+
+// Measures comparing, hashing and converting uint256 to and from hex
+class base_uint_timing_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template <class F>
+    void
+    time(char const* what, std::size_t count, F&& f)
+    {
+        auto const start = clock_type::now();
+        f();
+        auto const elapsed = clock_type::now() - start;
+        log << what << ": " << std::fixed << std::setprecision(1)
+            << std::chrono::duration<double, std::nano>(elapsed).count() /
+                count
+            << " ns" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        std::size_t const count = 1 << 20;
+        std::size_t const rounds = 8;
+
+        beast::xor_shift_engine rng(3);
+        std::vector<uint256> keys;
+        keys.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            keys.push_back(randomKey(rng));
+
+        std::size_t sum = 0;
+        time("compare", count * rounds, [&] {
+            for (std::size_t r = 0; r < rounds; ++r)
+                for (std::size_t i = 1; i < count; ++i)
+                    sum += keys[i - 1] < keys[i];
+        });
+        time("equal", count * rounds, [&] {
+            for (std::size_t r = 0; r < rounds; ++r)
+                for (std::size_t i = 1; i < count; ++i)
+                    sum += keys[i - 1] == keys[i];
+        });
+
+        time("std::map insert", count, [&] {
+            std::map<uint256, int> m;
+            for (auto const& key : keys)
+                m.emplace(key, 0);
+            sum += m.size();
+        });
+
+        time("hardened_hash", count * rounds, [&] {
+            hardened_hash<> const h;
+            for (std::size_t r = 0; r < rounds; ++r)
+                for (auto const& key : keys)
+                    sum += h(key);
+        });
+        time("digest_hash", count * rounds, [&] {
+            digest_hash const h;
+            for (std::size_t r = 0; r < rounds; ++r)
+                for (auto const& key : keys)
+                    sum += h(key);
+        });
+
+        std::vector<std::string> hex;
+        hex.reserve(count);
+        time("to_string", count, [&] {
+            for (auto const& key : keys)
+                hex.push_back(to_string(key));
+        });
+        time("parseHex", count, [&] {
+            uint256 u;
+            for (auto const& s : hex)
+                sum += u.parseHex(s);
+        });
+
+        BEAST_EXPECT(sum != 0);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(base_uint_timing, ripple_basics, ripple);
+
 }  // namespace test
 }  // namespace ripple
@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/insight/StatsDCollector.h>
+#include <ripple/beast/unit_test.h>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace beast {
+namespace insight {
+
+class StatsDCollector_test : public unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono_literals;
+
+        boost::asio::io_service ios;
+        boost::asio::ip::udp::socket server(
+            ios,
+            boost::asio::ip::udp::endpoint(
+                boost::asio::ip::address_v4::loopback(), 0));
+        server.non_blocking(true);
+        IP::Endpoint const address(
+            server.local_endpoint().address(), server.local_endpoint().port());
+
+        auto const collector = StatsDCollector::New(
+            address, "test", Journal{Journal::getNullSink()});
+
+        // Many metrics, so they do not all fit in one packet
+        std::vector<Counter> counters;
+        for (int i = 0; i < 100; ++i)
+            counters.push_back(collector->make_counter(
+                "a_counter_with_a_long_name_" + std::to_string(i)));
+
+        auto hits = collector->make_counter("hits");
+        auto latency = collector->make_event("latency");
+        auto level = collector->make_gauge("level");
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&] {
+                for (int i = 0; i < 10000; ++i)
+                    ++hits;
+                for (int i = 0; i < 100; ++i)
+                    latency.notify(std::chrono::milliseconds(i % 2 ? 3 : 40));
+                for (auto& counter : counters)
+                    counter.increment(2);
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        latency.notify(std::chrono::minutes(5));
+        level = 7;
+
+        // Collect what arrives, summed by metric name and type
+        std::map<std::string, double> received;
+        std::size_t packets = 0;
+        bool sizesOk = true;
+        auto const deadline = std::chrono::steady_clock::now() + 5s;
+        while ((received["hits|c"] < 40000 || received["level|g"] != 7 ||
+                received["latency|count"] < 400.5) &&
+               std::chrono::steady_clock::now() < deadline)
+        {
+            char buf[65536];
+            boost::system::error_code ec;
+            auto const n = server.receive(boost::asio::buffer(buf), 0, ec);
+            if (ec)
+            {
+                std::this_thread::sleep_for(10ms);
+                continue;
+            }
+            ++packets;
+            sizesOk = sizesOk && n <= 1472;
+
+            std::string const data(buf, n);
+            std::size_t pos = 0;
+            while (pos < data.size())
+            {
+                auto const end = data.find('\n', pos);
+                std::string const line = data.substr(pos, end - pos);
+                pos = end == std::string::npos ? data.size() : end + 1;
+
+                // test.name:value|type[|@rate]
+                auto const colon = line.find(':');
+                auto const bar = line.find('|', colon);
+                auto const rate = line.find("|@", bar);
+                if (line.compare(0, 5, "test.") != 0 ||
+                    colon == std::string::npos || bar == std::string::npos)
+                {
+                    fail("malformed line: " + line);
+                    continue;
+                }
+                auto const name = line.substr(5, colon - 5);
+                auto const value =
+                    std::stod(line.substr(colon + 1, bar - colon - 1));
+                auto const type = line.substr(
+                    bar + 1,
+                    rate == std::string::npos ? rate : rate - bar - 1);
+                double const count = rate == std::string::npos
+                    ? 1
+                    : 1 / std::stod(line.substr(rate + 2));
+                if (type == "ms")
+                {
+                    received[name + "|count"] += count;
+                    received[name + "|ms"] += value * count;
+                }
+                else
+                {
+                    received[name + "|" + type] += value;
+                }
+            }
+        }
+
+        BEAST_EXPECT(received["hits|c"] == 40000);
+        BEAST_EXPECT(received["a_counter_with_a_long_name_99|c"] == 8);
+        BEAST_EXPECT(received["level|g"] == 7);
+        BEAST_EXPECT(std::abs(received["latency|count"] - 401) < 0.01);
+        BEAST_EXPECT(
+            std::abs(received["latency|ms"] - (200 * 3 + 200 * 40 + 300000)) <
+            1);
+        BEAST_EXPECT(packets > 1);
+        BEAST_EXPECT(sizesOk);
+
+        auto const text = collector->prometheus();
+        auto contains = [&](std::string const& s) {
+            return text.find(s) != std::string::npos;
+        };
+        BEAST_EXPECT(contains("# TYPE test_hits counter\ntest_hits 40000\n"));
+        BEAST_EXPECT(contains("test_level 7\n"));
+        BEAST_EXPECT(contains("# TYPE test_latency histogram\n"));
+        BEAST_EXPECT(contains("test_latency_bucket{le=\"5\"} 200\n"));
+        BEAST_EXPECT(contains("test_latency_bucket{le=\"50\"} 400\n"));
+        BEAST_EXPECT(contains("test_latency_bucket{le=\"+Inf\"} 401\n"));
+        BEAST_EXPECT(contains("test_latency_count 401\n"));
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(StatsDCollector, insight, beast);
+
+}  // namespace insight
+}  // namespace beast
@@ -0,0 +1,408 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_value.h>
+#include <ripple/json/json_writer.h>
+#include <test/csf.h>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Measures how consensus performs under configurable network conditions.
+
+    Each scenario simulates a network of validators with the csf framework
+    and reports percentiles of the consensus round time, the time for a
+    validation to reach other peers and the time for a ledger to be fully
+    validated, along with how often peers agreed on close times.
+
+    Scenarios are configured with `key=value` pairs passed as the suite
+    argument. A comma separated list of values runs every combination:
+
+        --unittest=ConsensusBenchmark
+        --unittest-arg="peers=10,20,40 latency=uniform delay=250 json=out.json"
+
+    Keys:
+        peers       Number of validators (20)
+        unl         Size of each validator's UNL; defaults to every peer
+        latency     Distribution of link delays: fixed, uniform or lognormal
+        delay       Mean link delay in milliseconds (200)
+        jitter      Spread of link delays in milliseconds (50)
+        txrate      Transactions submitted per second (100)
+        churn       Validators taken offline per minute (0)
+        downtime    Seconds a validator stays offline (30)
+        duration    Simulated seconds to run after the first round (300)
+        seed        Seed of the simulation's random numbers (1)
+        json        File to append the results to, one object per line
+
+    Any of the timing parameters in ConsensusParms, such as
+    `ledgerMIN_CONSENSUS=1500`, can be set in milliseconds, and any of the
+    percentages, such as `minCONSENSUS_PCT=75`, as a whole number.
+
+    Simulations are deterministic: the same arguments always give the same
+    results.
+*/
+class ConsensusBenchmark_test : public beast::unit_test::suite
+{
+    using Args = std::map<std::string, std::string>;
+
+    template <class T>
+    using ParmsTable = std::map<std::string, T ConsensusParms::*>;
+
+    static ParmsTable<std::chrono::milliseconds> const&
+    durationParms()
+    {
+        static ParmsTable<std::chrono::milliseconds> const parms{
+                {"ledgerIDLE_INTERVAL", &ConsensusParms::ledgerIDLE_INTERVAL},
+                {"ledgerMIN_CONSENSUS", &ConsensusParms::ledgerMIN_CONSENSUS},
+                {"ledgerMAX_CONSENSUS", &ConsensusParms::ledgerMAX_CONSENSUS},
+                {"ledgerMIN_CLOSE", &ConsensusParms::ledgerMIN_CLOSE},
+                {"ledgerGRANULARITY", &ConsensusParms::ledgerGRANULARITY},
+                {"avMIN_CONSENSUS_TIME",
+                 &ConsensusParms::avMIN_CONSENSUS_TIME}};
+        return parms;
+    }
+
+    static ParmsTable<std::size_t> const&
+    countParms()
+    {
+        static ParmsTable<std::size_t> const parms{
+                {"minCONSENSUS_PCT", &ConsensusParms::minCONSENSUS_PCT},
+                {"avINIT_CONSENSUS_PCT", &ConsensusParms::avINIT_CONSENSUS_PCT},
+                {"avMID_CONSENSUS_TIME", &ConsensusParms::avMID_CONSENSUS_TIME},
+                {"avMID_CONSENSUS_PCT", &ConsensusParms::avMID_CONSENSUS_PCT},
+                {"avLATE_CONSENSUS_TIME",
+                 &ConsensusParms::avLATE_CONSENSUS_TIME},
+                {"avLATE_CONSENSUS_PCT", &ConsensusParms::avLATE_CONSENSUS_PCT},
+                {"avSTUCK_CONSENSUS_TIME",
+                 &ConsensusParms::avSTUCK_CONSENSUS_TIME},
+                {"avSTUCK_CONSENSUS_PCT",
+                 &ConsensusParms::avSTUCK_CONSENSUS_PCT},
+                {"avCT_CONSENSUS_PCT", &ConsensusParms::avCT_CONSENSUS_PCT}};
+        return parms;
+    }
+
+    static std::size_t
+    get(Args const& args, std::string const& key, std::size_t dflt)
+    {
+        auto const it = args.find(key);
+        if (it == args.end())
+            return dflt;
+        return std::stoul(it->second);
+    }
+
+    // Summarize a histogram of durations in milliseconds
+    static Json::Value
+    summarize(csf::Histogram<csf::SimDuration> const& hist)
+    {
+        auto const ms = [](csf::SimDuration d) {
+            return std::chrono::duration<double, std::milli>(d).count();
+        };
+
+        Json::Value res{Json::objectValue};
+        res["count"] = static_cast<Json::UInt>(hist.size());
+        res["min"] = ms(hist.minValue());
+        res["mean"] = ms(hist.avg());
+        res["p50"] = ms(hist.percentile(0.50f));
+        res["p90"] = ms(hist.percentile(0.90f));
+        res["p99"] = ms(hist.percentile(0.99f));
+        res["max"] = ms(hist.maxValue());
+        return res;
+    }
+
+    Json::Value
+    runScenario(Args const& args)
+    {
+        using namespace csf;
+        using namespace std::chrono;
+
+        std::size_t const numPeers = get(args, "peers", 20);
+        std::size_t const unlSize =
+            std::min(get(args, "unl", numPeers), numPeers);
+        milliseconds const delay{get(args, "delay", 200)};
+        milliseconds const jitter{
+            std::min(get(args, "jitter", 50), std::size_t(delay.count()))};
+        std::size_t const txRate = get(args, "txrate", 100);
+        std::size_t const churn = get(args, "churn", 0);
+        seconds const downtime{get(args, "downtime", 30)};
+        seconds const duration{get(args, "duration", 300)};
+        std::string const latency =
+            args.count("latency") ? args.at("latency") : "fixed";
+
+        ConsensusParms parms;
+        for (auto const& [key, value] : args)
+        {
+            if (auto const it = durationParms().find(key);
+                it != durationParms().end())
+                parms.*(it->second) = milliseconds{std::stoul(value)};
+            else if (auto const it = countParms().find(key);
+                     it != countParms().end())
+                parms.*(it->second) = std::stoul(value);
+        }
+
+        Sim sim;
+        sim.rng.seed(get(args, "seed", 1));
+        PeerGroup network = sim.createGroup(numPeers);
+        for (Peer* peer : network)
+            peer->consensusParms = parms;
+
+        // Each validator trusts itself and the validators that follow it,
+        // so neighbouring UNLs overlap the most.
+        for (std::size_t i = 0; i < numPeers; ++i)
+        {
+            for (std::size_t j = 0; j < unlSize; ++j)
+                network[i]->trust(*network[(i + j) % numPeers]);
+        }
+
+        // Every validator is connected to every other, and each link has
+        // its own delay.
+        std::function<milliseconds()> linkDelay;
+        BEAST_EXPECT(
+            latency == "fixed" || latency == "uniform" ||
+            latency == "lognormal");
+        if (latency == "uniform" && jitter.count() != 0)
+        {
+            std::uniform_int_distribution<std::int64_t> dist{
+                (delay - jitter).count(), (delay + jitter).count()};
+            linkDelay = [&sim, dist]() mutable {
+                return milliseconds{dist(sim.rng)};
+            };
+        }
+        else if (latency == "lognormal" && jitter.count() != 0)
+        {
+            // Choose the parameters so the mean is `delay` and the standard
+            // deviation is `jitter`, giving the long tail of real links.
+            double const m = delay.count();
+            double const v = jitter.count() * jitter.count();
+            double const sigma2 = std::log(1 + v / (m * m));
+            std::lognormal_distribution<> dist{
+                std::log(m) - sigma2 / 2, std::sqrt(sigma2)};
+            linkDelay = [&sim, dist]() mutable {
+                return milliseconds{std::llround(dist(sim.rng))};
+            };
+        }
+        else
+        {
+            // Without jitter, every distribution is a fixed delay
+            linkDelay = [delay] { return delay; };
+        }
+
+        std::map<std::pair<Peer*, Peer*>, milliseconds> links;
+        for (std::size_t i = 0; i < numPeers; ++i)
+        {
+            for (std::size_t j = i + 1; j < numPeers; ++j)
+            {
+                auto const d = linkDelay();
+                network[i]->connect(*network[j], d);
+                links[{network[i], network[j]}] = d;
+            }
+        }
+
+        TxCollector txCollector;
+        LedgerCollector ledgerCollector;
+        RoundCollector roundCollector;
+        auto colls =
+            makeCollectors(txCollector, ledgerCollector, roundCollector);
+        sim.collectors.add(colls);
+
+        // Initial round to set prior state
+        sim.run(1);
+
+        SimTime const start = sim.scheduler.now();
+
+        // Submit transactions as a Poisson process
+        auto peerSelector = makeSelector(
+            network.begin(),
+            network.end(),
+            std::vector<double>(numPeers, 1.),
+            sim.rng);
+        std::optional<Submitter<
+            std::exponential_distribution<>,
+            std::mt19937_64,
+            decltype(peerSelector)>>
+            txSubmitter;
+        if (txRate != 0)
+            txSubmitter.emplace(
+                std::exponential_distribution<>{1 / Rate{txRate, 1s}.inv()},
+                start,
+                start + duration,
+                peerSelector,
+                sim.scheduler,
+                sim.rng);
+
+        // Take randomly chosen validators offline, then bring them back
+        // with the links they had before. A validator chosen again while
+        // offline stays offline until its last outage ends.
+        std::size_t outages = 0;
+        std::map<Peer*, std::size_t> offline;
+        if (churn != 0)
+        {
+            std::uniform_int_distribution<std::size_t> pick{0, numPeers - 1};
+            SimDuration const interval = SimDuration{minutes{1}} / churn;
+            for (SimTime when = start + interval; when < start + duration;
+                 when += interval)
+            {
+                Peer* const peer = network[pick(sim.rng)];
+                sim.scheduler.at(when, [&, peer] {
+                    ++outages;
+                    ++offline[peer];
+                    for (Peer* other : network)
+                        peer->disconnect(*other);
+                });
+                sim.scheduler.at(when + downtime, [&, peer] {
+                    if (--offline[peer] != 0)
+                        return;
+                    for (auto const& [link, d] : links)
+                    {
+                        if ((link.first == peer && !offline[link.second]) ||
+                            (link.second == peer && !offline[link.first]))
+                            link.first->connect(*link.second, d);
+                    }
+                });
+            }
+        }
+
+        auto const realStart = RealClock::now();
+        sim.run(duration);
+        auto const elapsed = RealClock::now() - realStart;
+
+        Json::Value res{Json::objectValue};
+        Json::Value& scenario = (res["scenario"] = Json::objectValue);
+        for (auto const& [key, value] : args)
+            scenario[key] = value;
+
+        res["branches"] = static_cast<Json::UInt>(sim.branches());
+        res["synchronized"] = sim.synchronized();
+        res["outages"] = static_cast<Json::UInt>(outages);
+        res["ledgers_accepted"] =
+            static_cast<Json::UInt>(ledgerCollector.accepted);
+        res["ledgers_validated"] =
+            static_cast<Json::UInt>(ledgerCollector.fullyValidated);
+        res["txs_submitted"] = static_cast<Json::UInt>(txCollector.submitted);
+        res["txs_validated"] = static_cast<Json::UInt>(txCollector.validated);
+        res["close_time_agree"] =
+            static_cast<Json::UInt>(roundCollector.closeAgree);
+        res["close_time_disagree"] =
+            static_cast<Json::UInt>(roundCollector.closeDisagree);
+        res["round_ms"] = summarize(roundCollector.roundTime);
+        res["validation_latency_ms"] =
+            summarize(roundCollector.validationLatency);
+        res["accept_to_validate_ms"] =
+            summarize(ledgerCollector.acceptToFullyValid);
+        res["submit_to_validate_ms"] =
+            summarize(txCollector.submitToValidate);
+        res["real_ms"] = static_cast<Json::UInt>(
+            duration_cast<milliseconds>(elapsed).count());
+        return res;
+    }
+
+    // Call f with every combination of the comma separated values
+    void
+    forEachScenario(
+        std::map<std::string, std::vector<std::string>> const& sweep,
+        std::function<void(Args const&)> const& f)
+    {
+        Args args;
+        std::function<void(decltype(sweep.begin()))> next = [&](auto it) {
+            if (it == sweep.end())
+                return f(args);
+            for (auto const& value : it->second)
+            {
+                args[it->first] = value;
+                next(std::next(it));
+            }
+        };
+        next(sweep.begin());
+    }
+
+public:
+    void
+    run() override
+    {
+        std::map<std::string, std::vector<std::string>> sweep;
+        std::string json;
+
+        std::istringstream argStream(arg());
+        std::string token;
+        while (argStream >> token)
+        {
+            auto const eq = token.find('=');
+            if (eq == std::string::npos)
+            {
+                fail("Expected key=value: " + token);
+                return;
+            }
+            auto const key = token.substr(0, eq);
+            if (key == "json")
+            {
+                json = token.substr(eq + 1);
+                continue;
+            }
+            auto& values = sweep[key];
+            boost::split(
+                values, token.substr(eq + 1), boost::algorithm::is_any_of(","));
+        }
+
+        std::ofstream out;
+        if (!json.empty())
+            out.open(json, std::ofstream::app);
+
+        forEachScenario(sweep, [&](Args const& args) {
+            Json::Value const res = runScenario(args);
+
+            auto const& round = res["round_ms"];
+            auto const& val = res["validation_latency_ms"];
+            log << "| Round p50/p90/p99 ms: " << round["p50"].asDouble()
+                << "/" << round["p90"].asDouble() << "/"
+                << round["p99"].asDouble()
+                << " | Validation p50/p99 ms: " << val["p50"].asDouble()
+                << "/" << val["p99"].asDouble()
+                << " | Close agree: " << res["close_time_agree"].asUInt()
+                << "/"
+                << res["close_time_agree"].asUInt() +
+                    res["close_time_disagree"].asUInt()
+                << " | Branches: " << res["branches"].asUInt() << " |"
+                << std::endl;
+
+            auto const line = Json::FastWriter().write(res);
+            log << line << std::endl;
+            if (out.is_open())
+                out << line << std::endl;
+
+            BEAST_EXPECT(res["ledgers_accepted"].asUInt() != 0);
+        });
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ConsensusBenchmark, consensus, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -18,6 +18,7 @@
 //==============================================================================
 #include <ripple/beast/unit_test.h>
 #include <ripple/consensus/LedgerTrie.h>
+#include <map>
 #include <random>
 #include <test/csf/ledgers.h>
 #include <unordered_map>
@@ -589,6 +590,132 @@ class LedgerTrie_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testPreferredOrdering()
+    {
+        using namespace csf;
+        using Seq = Ledger::Seq;
+        // The children of each node are kept ordered as their support changes,
+        // so check getPreferred as support moves between siblings and nodes
+        // are merged
+        {
+            LedgerTrie<Ledger> t;
+            LedgerHistoryHelper h;
+            auto preferred = [&]() { return t.getPreferred(Seq{1})->id; };
+
+            t.insert(h["ab"], 3);
+            t.insert(h["ac"], 2);
+            t.insert(h["ad"]);
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(preferred() == h["ab"].id());
+
+            // The last child takes the lead
+            t.insert(h["ad"], 3);
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(preferred() == h["ad"].id());
+
+            // And loses it again
+            BEAST_EXPECT(t.remove(h["ad"], 2));
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(preferred() == h["ab"].id());
+
+            // A tie goes to the larger starting ID
+            t.insert(h["ac"]);
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(
+                preferred() == std::max(h["ab"].id(), h["ac"].id()));
+            t.insert(h["ac"]);
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(preferred() == h["ac"].id());
+
+            // Removing the other children merges ac with its parent
+            BEAST_EXPECT(t.remove(h["ab"], 3));
+            BEAST_EXPECT(t.remove(h["ad"], 2));
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(t.branchSupport(h["a"]) == 4);
+            BEAST_EXPECT(preferred() == h["ac"].id());
+
+            // A child of the merged node needs more support than its parent
+            // to be preferred
+            t.insert(h["ace"], 4);
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(preferred() == h["ac"].id());
+            t.insert(h["ace"]);
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(preferred() == h["ace"].id());
+
+            // Moving all support to new children of the merged node splits
+            // them off, ordered by their own support
+            BEAST_EXPECT(t.remove(h["ace"], 5));
+            BEAST_EXPECT(t.remove(h["ac"], 4));
+            t.insert(h["acf"], 2);
+            t.insert(h["acg"], 3);
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(preferred() == h["acg"].id());
+            t.insert(h["acf"], 2);
+            BEAST_EXPECT(t.checkInvariants());
+            BEAST_EXPECT(preferred() == h["acf"].id());
+        }
+
+        // A trie changed by any sequence of inserts and removes prefers the
+        // same ledger as one built directly from the resulting support
+        {
+            LedgerTrie<Ledger> t;
+            LedgerHistoryHelper h;
+            std::map<std::string, std::uint32_t> support;
+
+            std::uint32_t const depthConst = 4;
+            std::uint32_t const width = 4;
+            std::mt19937 gen{7};
+            std::uniform_int_distribution<> depthDist(0, depthConst - 1);
+            std::uniform_int_distribution<> widthDist(0, width - 1);
+            std::uniform_int_distribution<> flip(0, 2);
+            for (std::uint32_t i = 0; i < 2000; ++i)
+            {
+                std::string curr = "";
+                char depth = depthDist(gen);
+                char offset = 0;
+                for (char d = 0; d < depth; ++d)
+                {
+                    char a = offset + widthDist(gen);
+                    curr += a;
+                    offset = (a + 1) * width;
+                }
+
+                // Favor inserts so the trie keeps some depth
+                if (flip(gen) != 0)
+                {
+                    t.insert(h[curr]);
+                    ++support[curr];
+                }
+                else if (t.remove(h[curr]))
+                {
+                    if (--support[curr] == 0)
+                        support.erase(curr);
+                }
+                if (!BEAST_EXPECT(t.checkInvariants()))
+                    return;
+
+                if (i % 50 != 0)
+                    continue;
+
+                LedgerTrie<Ledger> fresh;
+                for (auto const& [name, count] : support)
+                    fresh.insert(h[name], count);
+                for (Seq seq{0}; seq <= Seq{depthConst}; ++seq)
+                {
+                    auto const expected = fresh.getPreferred(seq);
+                    auto const actual = t.getPreferred(seq);
+                    if (!BEAST_EXPECT(
+                            expected.has_value() == actual.has_value()))
+                        return;
+                    if (expected && !BEAST_EXPECT(expected->id == actual->id))
+                        return;
+                }
+            }
+        }
+    }
+
     void
     testRootRelated()
     {
@@ -672,6 +799,7 @@ class LedgerTrie_test : public beast::unit_test::suite
         testEmpty();
         testSupport();
         testGetPreferred();
+        testPreferredOrdering();
         testRootRelated();
         testStress();
     }
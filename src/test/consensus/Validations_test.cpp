@@ -171,6 +171,7 @@ class Validations_test : public beast::unit_test::suite
     {
         clock_type& c_;
         LedgerOracle& oracle_;
+        NetClock::duration const& skew_;
 
     public:
         // Non-locking mutex to avoid locks in generic Validations
@@ -190,14 +191,15 @@ class Validations_test : public beast::unit_test::suite
         using Validation = csf::Validation;
         using Ledger = csf::Ledger;
 
-        Adaptor(clock_type& c, LedgerOracle& o) : c_{c}, oracle_{o}
+        Adaptor(clock_type& c, LedgerOracle& o, NetClock::duration const& skew)
+            : c_{c}, oracle_{o}, skew_{skew}
         {
         }
 
         NetClock::time_point
         now() const
         {
-            return toNetClock(c_);
+            return toNetClock(c_) + skew_;
         }
 
         std::optional<Ledger>
@@ -216,11 +218,13 @@ class Validations_test : public beast::unit_test::suite
     {
         ValidationParms p_;
         beast::manual_clock<std::chrono::steady_clock> clock_;
+        NetClock::duration skew_{0};
         TestValidations tv_;
         PeerID nextNodeId_{0};
 
     public:
-        explicit TestHarness(LedgerOracle& o) : tv_(p_, clock_, clock_, o)
+        explicit TestHarness(LedgerOracle& o)
+            : tv_(p_, clock_, clock_, o, skew_)
         {
         }
 
@@ -253,6 +257,14 @@ class Validations_test : public beast::unit_test::suite
         {
             return clock_;
         }
+
+        // Offset the network time seen by the validations from the time
+        // the nodes sign with, as when the local clock is stepped
+        void
+        skew(NetClock::duration d)
+        {
+            skew_ = d;
+        }
     };
 
     Ledger const genesisLedger{Ledger::MakeGenesis{}};
@@ -448,6 +460,93 @@ class Validations_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testStaleWindow()
+    {
+        using namespace std::chrono_literals;
+        testcase("Stale window");
+
+        LedgerHistoryHelper h;
+        Ledger ledgerA = h["a"];
+        Ledger ledgerAB = h["ab"];
+        Ledger ledgerAC = h["ac"];
+
+        TestHarness harness(h.oracle);
+        Node a = harness.makeNode(), b = harness.makeNode();
+        auto const early = harness.parms().validationCURRENT_EARLY;
+
+        // b signs one second after a
+        BEAST_EXPECT(ValStatus::current == harness.add(a.validate(ledgerAB)));
+        harness.clock().advance(1s);
+        BEAST_EXPECT(ValStatus::current == harness.add(b.validate(ledgerAC)));
+
+        // Just inside the window of a, both are current
+        harness.clock().advance(early - 2s);
+        BEAST_EXPECT(harness.vals().getNodesAfter(ledgerA, ledgerA.id()) == 2);
+
+        // At the end of the window of a, only a has gone stale
+        harness.clock().advance(1s);
+        BEAST_EXPECT(harness.vals().getNodesAfter(ledgerA, ledgerA.id()) == 1);
+        BEAST_EXPECT(
+            harness.vals().getPreferred(genesisLedger) ==
+            std::make_pair(ledgerAC.seq(), ledgerAC.id()));
+        BEAST_EXPECT(harness.vals().getCurrentNodeIDs().size() == 1);
+
+        // And then b
+        harness.clock().advance(1s);
+        BEAST_EXPECT(harness.vals().getNodesAfter(ledgerA, ledgerA.id()) == 0);
+        BEAST_EXPECT(
+            harness.vals().getPreferred(genesisLedger) == std::nullopt);
+        BEAST_EXPECT(harness.vals().getCurrentNodeIDs().empty());
+    }
+
+    void
+    testClockBackwards()
+    {
+        using namespace std::chrono_literals;
+        testcase("Clock goes backwards");
+
+        LedgerHistoryHelper h;
+        Ledger ledgerA = h["a"];
+        Ledger ledgerAB = h["ab"];
+        Ledger ledgerAC = h["ac"];
+        Ledger ledgerACD = h["acd"];
+
+        TestHarness harness(h.oracle);
+        Node a = harness.makeNode(), b = harness.makeNode();
+        auto const wall = harness.parms().validationCURRENT_WALL;
+        auto const local = harness.parms().validationCURRENT_LOCAL;
+
+        // a signed earlier, so its validation is the first to be looked at
+        // when flushing stale ones. It was seen early enough to stay current
+        // after the clock is stepped back.
+        BEAST_EXPECT(
+            ValStatus::current ==
+            harness.add(a.validate(ledgerAB, -10s, -local + 30s)));
+        BEAST_EXPECT(ValStatus::current == harness.add(b.validate(ledgerAC)));
+        BEAST_EXPECT(harness.vals().getNodesAfter(ledgerA, ledgerA.id()) == 2);
+
+        // Stepping the clock back puts the validation of b too far in the
+        // future. It is no longer current, so it is flushed rather than kept
+        // until the clock catches up.
+        harness.skew(-wall);
+        BEAST_EXPECT(harness.vals().getNodesAfter(ledgerA, ledgerA.id()) == 1);
+        BEAST_EXPECT(
+            harness.vals().getPreferred(genesisLedger) ==
+            std::make_pair(ledgerAB.seq(), ledgerAB.id()));
+
+        // Once the clock is back, b is not restored, but can validate again
+        harness.skew(0s);
+        BEAST_EXPECT(harness.vals().getNodesAfter(ledgerA, ledgerA.id()) == 1);
+        harness.clock().advance(1s);
+        BEAST_EXPECT(ValStatus::current == harness.add(b.validate(ledgerACD)));
+        BEAST_EXPECT(harness.vals().getNodesAfter(ledgerA, ledgerA.id()) == 2);
+
+        // A validation seen too far in the future is flushed too
+        harness.skew(-local);
+        BEAST_EXPECT(harness.vals().getNodesAfter(ledgerA, ledgerA.id()) == 1);
+    }
+
     void
     testGetNodesAfter()
     {
@@ -1130,6 +1229,8 @@ class Validations_test : public beast::unit_test::suite
     {
         testAddValidation();
         testOnStale();
+        testStaleWindow();
+        testClockBackwards();
         testGetNodesAfter();
         testCurrentTrusted();
         testGetCurrentPublicKeys();
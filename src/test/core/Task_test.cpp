@@ -0,0 +1,416 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/core/JobQueue.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class Task_test : public beast::unit_test::suite
+{
+public:
+    class gate
+    {
+    private:
+        std::condition_variable cv_;
+        std::mutex mutex_;
+        bool signaled_ = false;
+
+    public:
+        // Thread safe, blocks until signaled or period expires.
+        // Returns `true` if signaled.
+        template <class Rep, class Period>
+        bool
+        wait_for(std::chrono::duration<Rep, Period> const& rel_time)
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            auto b = cv_.wait_for(lk, rel_time, [this] { return signaled_; });
+            signaled_ = false;
+            return b;
+        }
+
+        void
+        signal()
+        {
+            std::lock_guard lk(mutex_);
+            signaled_ = true;
+            cv_.notify_all();
+        }
+    };
+
+    static std::unique_ptr<Config>
+    multiThreaded(std::unique_ptr<Config> cfg)
+    {
+        cfg->FORCE_MULTI_THREAD = true;
+        return cfg;
+    }
+
+private:
+    static Task<int>
+    add(int a, int b)
+    {
+        co_return a + b;
+    }
+
+    static Task<int>
+    throws()
+    {
+        Throw<std::runtime_error>("throws");
+        co_return 0;
+    }
+
+    Task<>
+    nested(gate& g)
+    {
+        BEAST_EXPECT(co_await add(1, 2) == 3);
+        BEAST_EXPECT(co_await add(co_await add(1, 2), 4) == 7);
+        try
+        {
+            co_await throws();
+            fail("no exception");
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(e.what() == std::string("throws"));
+        }
+        g.signal();
+    }
+
+    void
+    testNested()
+    {
+        using namespace std::chrono_literals;
+        testcase("nested");
+
+        jtx::Env env(*this, jtx::envconfig(multiThreaded));
+
+        gate g;
+        BEAST_EXPECT(
+            env.app().getJobQueue().postTask(jtCLIENT, "Task-Test", nested(g)));
+        BEAST_EXPECT(g.wait_for(5s));
+    }
+
+    Task<>
+    hops(JobQueue& jq, int n, gate& g)
+    {
+        int count = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            if (co_await jq.schedule(jtCLIENT, "Task-Test"))
+                ++count;
+        }
+        BEAST_EXPECT(count == n);
+        g.signal();
+    }
+
+    void
+    testSchedule()
+    {
+        using namespace std::chrono_literals;
+        testcase("schedule");
+
+        jtx::Env env(*this, jtx::envconfig(multiThreaded));
+        auto& jq = env.app().getJobQueue();
+
+        gate g;
+        BEAST_EXPECT(jq.postTask(jtCLIENT, "Task-Test", hops(jq, 100, g)));
+        BEAST_EXPECT(g.wait_for(5s));
+    }
+
+    Task<>
+    waits(JobQueue& jq, std::function<void()>& resume, gate& g)
+    {
+        co_await jq.suspend(jtCLIENT, "Task-Test", [&](auto r) {
+            resume = std::move(r);
+            g.signal();
+        });
+        g.signal();
+    }
+
+    void
+    testSuspend()
+    {
+        using namespace std::chrono_literals;
+        testcase("suspend");
+
+        jtx::Env env(*this, jtx::envconfig(multiThreaded));
+        auto& jq = env.app().getJobQueue();
+
+        gate g;
+        std::function<void()> resume;
+        BEAST_EXPECT(jq.postTask(jtCLIENT, "Task-Test", waits(jq, resume, g)));
+        BEAST_EXPECT(g.wait_for(5s));
+
+        // The Task stays suspended until it is resumed
+        BEAST_EXPECT(!g.wait_for(50ms));
+        resume();
+        BEAST_EXPECT(g.wait_for(5s));
+    }
+
+    Task<>
+    yields(JobQueue& jq, std::shared_ptr<JobQueue::Coro>& coro, gate& g)
+    {
+        bool const ran = co_await jq.awaitCoro(
+            jtCLIENT,
+            "Task-Test",
+            [&](std::shared_ptr<JobQueue::Coro> const& c) {
+                coro = c;
+                g.signal();
+                c->yield();
+            });
+        BEAST_EXPECT(ran);
+        g.signal();
+    }
+
+    void
+    testAwaitCoro()
+    {
+        using namespace std::chrono_literals;
+        testcase("await coro");
+
+        jtx::Env env(*this, jtx::envconfig(multiThreaded));
+        auto& jq = env.app().getJobQueue();
+
+        gate g;
+        std::shared_ptr<JobQueue::Coro> coro;
+        BEAST_EXPECT(jq.postTask(jtCLIENT, "Task-Test", yields(jq, coro, g)));
+        BEAST_EXPECT(g.wait_for(5s));
+        coro->join();
+        BEAST_EXPECT(!g.wait_for(50ms));
+        coro->post();
+        BEAST_EXPECT(g.wait_for(5s));
+    }
+
+    static Task<int>
+    get(LocalValue<int>& lv)
+    {
+        co_return *lv;
+    }
+
+    Task<>
+    local(JobQueue& jq, LocalValue<int>& lv, int id, gate& g)
+    {
+        BEAST_EXPECT(*lv == -1);
+        *lv = id;
+
+        co_await jq.suspend(jtCLIENT, "Task-Test", [&jq](auto resume) {
+            jq.addJob(jtCLIENT, "Task-Test", std::move(resume));
+        });
+        BEAST_EXPECT(*lv == id);
+        co_await jq.schedule(jtCLIENT, "Task-Test");
+        BEAST_EXPECT(co_await get(lv) == id);
+        g.signal();
+    }
+
+    void
+    testLocalValues()
+    {
+        using namespace std::chrono_literals;
+        testcase("local values");
+
+        jtx::Env env(*this, jtx::envconfig(multiThreaded));
+        auto& jq = env.app().getJobQueue();
+
+        LocalValue<int> lv(-1);
+        gate g;
+        for (int id = 0; id < 4; ++id)
+        {
+            BEAST_EXPECT(
+                jq.postTask(jtCLIENT, "Task-Test", local(jq, lv, id, g)));
+            BEAST_EXPECT(g.wait_for(5s));
+        }
+        BEAST_EXPECT(*lv == -1);
+
+        jq.addJob(jtCLIENT, "LocalValue-Test", [&]() {
+            this->BEAST_EXPECT(*lv == -1);
+            g.signal();
+        });
+        BEAST_EXPECT(g.wait_for(5s));
+    }
+
+public:
+    void
+    run() override
+    {
+        testNested();
+        testSchedule();
+        testSuspend();
+        testAwaitCoro();
+        testLocalValues();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Task, core, ripple);
+
+//------------------------------------------------------------------------------
+
+// Compares the memory and throughput of sessions run as JobQueue::Coro and
+// as Task. Each session suspends until all of them have, then finishes.
+// The argument is the number of sessions, 10000 by default.
+class Task_timing_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct Counters
+    {
+        std::size_t const n;
+        std::atomic<std::size_t> suspended{0};
+        std::atomic<std::size_t> finished{0};
+        Task_test::gate g;
+
+        explicit Counters(std::size_t n_) : n(n_)
+        {
+        }
+
+        void
+        suspend()
+        {
+            if (++suspended == n)
+                g.signal();
+        }
+
+        void
+        finish()
+        {
+            if (++finished == n)
+                g.signal();
+        }
+    };
+
+    // Returns the virtual and resident size of the process, in kilobytes,
+    // where the platform reports them.
+    static std::pair<std::size_t, std::size_t>
+    memory()
+    {
+        std::size_t vm = 0;
+        std::size_t rss = 0;
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.rfind("VmSize:", 0) == 0)
+                vm = std::stoul(line.substr(7));
+            else if (line.rfind("VmRSS:", 0) == 0)
+                rss = std::stoul(line.substr(6));
+        }
+        return {vm, rss};
+    }
+
+    void
+    report(
+        char const* what,
+        std::size_t n,
+        std::pair<std::size_t, std::size_t> const& before,
+        std::pair<std::size_t, std::size_t> const& during,
+        clock_type::duration elapsed)
+    {
+        auto const seconds = std::chrono::duration<double>(elapsed).count();
+        log << what << ": " << n << " sessions, "
+            << (during.first - before.first) / 1024 << " MB virtual, "
+            << (during.second - before.second) / 1024 << " MB resident, "
+            << std::fixed << n / seconds << " sessions per second"
+            << std::endl;
+    }
+
+    void
+    timeCoro(JobQueue& jq, std::size_t n)
+    {
+        using namespace std::chrono_literals;
+
+        Counters c(n);
+        std::vector<std::shared_ptr<JobQueue::Coro>> coros(n);
+        auto const before = memory();
+        auto const start = clock_type::now();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            jq.postCoro(jtCLIENT, "Task-Timing", [&, i](auto const& coro) {
+                coros[i] = coro;
+                c.suspend();
+                coro->yield();
+                c.finish();
+            });
+        }
+        BEAST_EXPECT(c.g.wait_for(60s));
+        auto const during = memory();
+        for (auto const& coro : coros)
+        {
+            coro->join();
+            coro->post();
+        }
+        BEAST_EXPECT(c.g.wait_for(60s));
+        report("coro", n, before, during, clock_type::now() - start);
+    }
+
+    static Task<>
+    session(JobQueue& jq, std::function<void()>& resume, Counters& c)
+    {
+        co_await jq.suspend(jtCLIENT, "Task-Timing", [&](auto r) {
+            resume = std::move(r);
+            c.suspend();
+        });
+        c.finish();
+    }
+
+    void
+    timeTask(JobQueue& jq, std::size_t n)
+    {
+        using namespace std::chrono_literals;
+
+        Counters c(n);
+        std::vector<std::function<void()>> resumes(n);
+        auto const before = memory();
+        auto const start = clock_type::now();
+        for (std::size_t i = 0; i < n; ++i)
+            jq.postTask(jtCLIENT, "Task-Timing", session(jq, resumes[i], c));
+        BEAST_EXPECT(c.g.wait_for(60s));
+        auto const during = memory();
+        for (auto& resume : resumes)
+            resume();
+        BEAST_EXPECT(c.g.wait_for(60s));
+        report("task", n, before, during, clock_type::now() - start);
+    }
+
+public:
+    void
+    run() override
+    {
+        std::size_t const n = arg().empty() ? 10000 : std::stoul(arg());
+
+        jtx::Env env(*this, jtx::envconfig(Task_test::multiThreaded));
+        auto& jq = env.app().getJobQueue();
+
+        timeTask(jq, n);
+        timeCoro(jq, n);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Task_timing, core, ripple);
+
+}  // namespace test
+}  // namespace ripple
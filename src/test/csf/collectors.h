@@ -25,8 +25,10 @@
 #include <test/csf/events.h>
 
 #include <chrono>
+#include <map>
 #include <optional>
 #include <ostream>
+#include <set>
 #include <tuple>
 
 namespace ripple {
@@ -675,6 +677,78 @@ struct LedgerCollector
     }
 };
 
+/** Tracks the consensus rounds of every peer.
+
+    This collector measures how long each peer takes from starting a round
+    to accepting its ledger, how often peers agree on the close time of the
+    ledgers they accept, and how long each validation takes to first reach
+    each other peer.
+*/
+struct RoundCollector
+{
+    std::size_t closeAgree{0};
+    std::size_t closeDisagree{0};
+
+    // When each peer started its current round
+    hash_map<PeerID, SimTime> roundStart;
+
+    // When each validation was shared, by validator and ledger
+    std::map<std::pair<PeerID, Ledger::ID>, SimTime> shared;
+
+    // The validations each peer has received, by validator and ledger
+    std::set<std::tuple<PeerID, PeerID, Ledger::ID>> received;
+
+    using Hist = Histogram<SimTime::duration>;
+    Hist roundTime;
+    Hist validationLatency;
+
+    // Ignore most events by default
+    template <class E>
+    void
+    on(PeerID, SimTime, E const& e)
+    {
+    }
+
+    void
+    on(PeerID who, SimTime when, StartRound const& e)
+    {
+        roundStart[who] = when;
+    }
+
+    void
+    on(PeerID who, SimTime when, AcceptLedger const& e)
+    {
+        auto const it = roundStart.find(who);
+        if (it != roundStart.end())
+        {
+            roundTime.insert(when - it->second);
+            roundStart.erase(it);
+        }
+
+        if (e.ledger.closeAgree())
+            ++closeAgree;
+        else
+            ++closeDisagree;
+    }
+
+    void
+    on(PeerID who, SimTime when, Share<Validation> const& e)
+    {
+        shared.emplace(std::make_pair(e.val.nodeID(), e.val.ledgerID()), when);
+    }
+
+    void
+    on(PeerID who, SimTime when, Receive<Validation> const& e)
+    {
+        auto const it =
+            shared.find(std::make_pair(e.val.nodeID(), e.val.ledgerID()));
+        // Only the first copy a peer receives counts
+        if (it != shared.end() &&
+            received.emplace(who, e.val.nodeID(), e.val.ledgerID()).second)
+            validationLatency.insert(when - it->second);
+    }
+};
+
 /** Write out stream of ledger activity
 
     Writes information about every accepted and fully-validated ledger to a
@@ -106,6 +106,7 @@ public:
         std::uint64_t const seedValue = 50;
 
         testBackend("nudb", seedValue);
+        testBackend("segment", seedValue);
 
 #if RIPPLE_ROCKSDB_AVAILABLE
         testBackend("rocksdb", seedValue);
@@ -0,0 +1,303 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/BatchWriter.h>
+#include <ripple/protocol/jss.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace ripple {
+namespace NodeStore {
+
+class BatchWriter_test : public TestBase
+{
+    // Runs tasks on a pool of threads, as the job queue does
+    class ThreadScheduler : public Scheduler
+    {
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        std::deque<Task*> tasks_;
+        bool stop_ = false;
+        std::vector<std::thread> threads_;
+
+    public:
+        explicit ThreadScheduler(std::size_t threads)
+        {
+            for (std::size_t i = 0; i < threads; ++i)
+            {
+                threads_.emplace_back([this] {
+                    std::unique_lock lock(mutex_);
+                    for (;;)
+                    {
+                        cond_.wait(
+                            lock, [this] { return stop_ || !tasks_.empty(); });
+                        if (tasks_.empty())
+                            return;
+                        auto const task = tasks_.front();
+                        tasks_.pop_front();
+                        lock.unlock();
+                        task->performScheduledTask();
+                        lock.lock();
+                    }
+                });
+            }
+        }
+
+        ~ThreadScheduler() override
+        {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            cond_.notify_all();
+            for (auto& thread : threads_)
+                thread.join();
+        }
+
+        void
+        scheduleTask(Task& task) override
+        {
+            {
+                std::lock_guard lock(mutex_);
+                tasks_.push_back(&task);
+            }
+            cond_.notify_one();
+        }
+
+        void
+        onFetch(FetchReport const&) override
+        {
+        }
+
+        void
+        onBatchWrite(BatchWriteReport const&) override
+        {
+        }
+    };
+
+    // Writes batches to a backend, or nowhere, taking a while for each
+    class Writer : public BatchWriter::Callback
+    {
+    public:
+        Backend* backend = nullptr;
+        std::chrono::microseconds perBatch{0};
+        std::chrono::microseconds perObject{0};
+
+        std::atomic<std::size_t> batches{0};
+        std::atomic<std::size_t> objects{0};
+        std::atomic<int> writing{0};
+        std::atomic<int> mostWriting{0};
+
+        void
+        writeBatch(Batch const& batch) override
+        {
+            auto const now = ++writing;
+            auto most = mostWriting.load();
+            while (now > most && !mostWriting.compare_exchange_weak(most, now))
+                ;
+
+            if (backend)
+                backend->storeBatch(batch);
+            std::this_thread::sleep_for(perBatch + perObject * batch.size());
+
+            ++batches;
+            objects += batch.size();
+            --writing;
+        }
+    };
+
+    // Store batches from several threads at once
+    static void
+    produce(BatchWriter& writer, std::vector<Batch> const& batches)
+    {
+        std::vector<std::thread> producers;
+        for (auto const& batch : batches)
+        {
+            producers.emplace_back([&writer, &batch] {
+                for (auto const& object : batch)
+                    writer.store(object);
+            });
+        }
+        for (auto& producer : producers)
+            producer.join();
+    }
+
+    // Wait until every object stored has been written
+    static void
+    drain(BatchWriter& writer)
+    {
+        while (writer.getWriteLoad() != 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    static std::uint64_t
+    total(Json::Value const& histogram)
+    {
+        std::uint64_t result = 0;
+        for (auto const& count : histogram)
+            result += std::stoull(count.asString());
+        return result;
+    }
+
+    void
+    testBackpressure()
+    {
+        testcase("backpressure");
+
+        using namespace std::chrono_literals;
+        ThreadScheduler scheduler(8);
+        Writer writer;
+        writer.perBatch = 2ms;
+
+        std::vector<Batch> batches;
+        for (std::uint64_t i = 1; i <= 4; ++i)
+            batches.push_back(createPredictableBatch(numObjectsToTest, i));
+
+        Json::Value counts(Json::objectValue);
+        {
+            BatchWriter::Setup setup;
+            setup.maxInFlight = 3;
+            setup.queueLimit = 500;
+            BatchWriter batchWriter(writer, scheduler, setup);
+            produce(batchWriter, batches);
+            drain(batchWriter);
+            batchWriter.getCountsJson(counts);
+        }
+
+        // Everything is written, by no more writers than allowed
+        BEAST_EXPECT(writer.objects == 4 * numObjectsToTest);
+        BEAST_EXPECT(writer.mostWriting <= 3);
+
+        // Producers were held back, and the queue did not grow past
+        // its limit
+        BEAST_EXPECT(
+            std::stoull(counts[jss::node_write_stalls].asString()) > 0);
+        BEAST_EXPECT(
+            std::stoull(counts[jss::node_write_stall_duration_us].asString()) >
+            0);
+        for (auto const& bucket : counts[jss::node_write_queue_depth]
+                                      .getMemberNames())
+            BEAST_EXPECT(std::stoull(bucket) <= 500);
+
+        // Every batch is in the histograms
+        BEAST_EXPECT(
+            total(counts[jss::node_write_latency_us]) == writer.batches);
+        BEAST_EXPECT(
+            total(counts[jss::node_write_queue_depth]) == writer.batches);
+        BEAST_EXPECT(counts[jss::node_write_queue].asUInt() == 0);
+    }
+
+    void
+    testAdaptation()
+    {
+        testcase("adaptation");
+
+        using namespace std::chrono_literals;
+        ThreadScheduler scheduler(4);
+        Writer writer;
+        writer.perObject = 5us;
+
+        Json::Value counts(Json::objectValue);
+        {
+            BatchWriter::Setup setup;
+            setup.maxInFlight = 1;
+            setup.targetLatency = 2ms;
+            BatchWriter batchWriter(writer, scheduler, setup);
+
+            // A batch takes longer than the target until it holds fewer
+            // than 400 objects
+            produce(
+                batchWriter,
+                {createPredictableBatch(8 * numObjectsToTest, 1),
+                 createPredictableBatch(8 * numObjectsToTest, 2)});
+            drain(batchWriter);
+            batchWriter.getCountsJson(counts);
+        }
+
+        BEAST_EXPECT(writer.objects == 16 * numObjectsToTest);
+        auto const limit = counts[jss::node_write_batch_limit].asUInt();
+        log << "batch limit: " << limit << std::endl;
+        BEAST_EXPECT(limit < batchWriteLimitSize / 16);
+        BEAST_EXPECT(limit >= batchWritePreallocationSize);
+    }
+
+    void
+    testBackend(std::string const& type)
+    {
+        testcase("backend type=" + type);
+
+        ThreadScheduler scheduler(8);
+        test::SuiteJournal journal("BatchWriter_test", *this);
+
+        beast::temp_dir tempDir;
+        Section params;
+        params.set("type", type);
+        params.set("path", tempDir.path());
+
+        std::vector<Batch> batches;
+        for (std::uint64_t i = 1; i <= 8; ++i)
+            batches.push_back(createPredictableBatch(numObjectsToTest, i));
+
+        auto backend = Manager::instance().make_Backend(
+            params, megabytes(4), scheduler, journal);
+        backend->open();
+
+        Writer writer;
+        writer.backend = backend.get();
+        {
+            BatchWriter::Setup setup;
+            setup.queueLimit = 1000;
+            BatchWriter batchWriter(writer, scheduler, setup);
+            produce(batchWriter, batches);
+        }
+
+        for (auto const& batch : batches)
+        {
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testBackpressure();
+        testAdaptation();
+        testBackend("nudb");
+#if RIPPLE_ROCKSDB_AVAILABLE
+        testBackend("rocksdb");
+#endif
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BatchWriter, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -21,11 +21,14 @@
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DatabaseTieredImp.h>
+#include <ripple/protocol/jss.h>
 #include <test/jtx.h>
 #include <test/jtx/CheckMessageLogs.h>
 #include <test/jtx/envconfig.h>
 #include <test/nodestore/TestBase.h>
 #include <test/unit_test/SuiteJournal.h>
+#include <boost/filesystem/fstream.hpp>
 
 namespace ripple {
 
@@ -652,6 +655,156 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void
+    testTiered(std::string const& hotType, std::int64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        testcase("tiered NodeStore with '" + hotType + "' hot tier");
+
+        beast::temp_dir cold_db;
+        Section coldParams;
+        coldParams.set("type", "memory");
+        coldParams.set("path", cold_db.path());
+
+        beast::temp_dir hot_db;
+        Section hotParams;
+        hotParams.set("type", hotType);
+        hotParams.set("path", hot_db.path());
+        hotParams.set("hot_ledgers", "256");
+
+        // A hot backend left behind by an unclean shutdown
+        auto const stale =
+            boost::filesystem::path(hot_db.path()) / "hot.stale";
+        boost::filesystem::create_directory(stale);
+        boost::filesystem::ofstream(stale / "nudb.dat") << "stale";
+
+        auto coldBackend = Manager::instance().make_Backend(
+            coldParams, megabytes(4), scheduler, journal_);
+        coldBackend->open();
+
+        DatabaseTieredImp db(
+            scheduler,
+            2,
+            std::move(coldBackend),
+            hotParams,
+            megabytes(4),
+            coldParams,
+            journal_);
+
+        // Stale hot backends are removed when the database opens
+        BEAST_EXPECT(!boost::filesystem::exists(stale));
+
+        auto counter = [&db](Json::StaticString const& name) {
+            Json::Value obj(Json::objectValue);
+            db.getCountsJson(obj);
+            return std::stoull(obj[name].asString());
+        };
+
+        auto storeAt = [&db](Batch const& batch, std::uint32_t seq) {
+            for (auto const& object : batch)
+            {
+                Blob data(object->getData());
+                db.store(
+                    object->getType(),
+                    std::move(data),
+                    object->getHash(),
+                    seq);
+            }
+        };
+
+        auto const seq = db.earliestLedgerSeq();
+        auto const batch = createPredictableBatch(numObjectsToTest, seedValue);
+
+        // New objects are served from the hot tier
+        storeAt(batch, seq);
+        db.sweep();
+        {
+            Batch copy;
+            fetchCopyOfBatch(db, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(counter(jss::node_hot_reads_hit) == batch.size());
+            BEAST_EXPECT(counter(jss::node_cold_reads_total) == 0);
+        }
+
+        // Two rotations demote the first batch out of the hot tier
+        auto const batch2 =
+            createPredictableBatch(numObjectsToTest, seedValue + 1);
+        storeAt(batch2, seq + 256);
+        db.sweep();
+        BEAST_EXPECT(counter(jss::node_hot_rotations) == 1);
+
+        // Nothing new was stored, so no rotation
+        db.sweep();
+        BEAST_EXPECT(counter(jss::node_hot_rotations) == 1);
+
+        storeAt(
+            createPredictableBatch(numObjectsToTest, seedValue + 2),
+            seq + 512);
+        db.sweep();
+        BEAST_EXPECT(counter(jss::node_hot_rotations) == 2);
+
+        // The demoted batch is read from the cold tier and promoted
+        {
+            Batch copy;
+            fetchCopyOfBatch(db, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(counter(jss::node_cold_reads_hit) == batch.size());
+            BEAST_EXPECT(counter(jss::node_hot_promotions) == batch.size());
+        }
+
+        // Promoted objects are served from the hot tier again
+        {
+            Batch copy;
+            fetchCopyOfBatch(db, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(counter(jss::node_cold_reads_total) == batch.size());
+            BEAST_EXPECT(
+                counter(jss::node_hot_reads_hit) == 2 * batch.size());
+        }
+
+        // Objects that were never stored miss in both tiers
+        auto const missing =
+            createPredictableBatch(numObjectsToTest, seedValue + 3);
+        {
+            Batch copy;
+            fetchCopyOfBatch(db, &copy, missing);
+            BEAST_EXPECT(copy.empty());
+            BEAST_EXPECT(
+                counter(jss::node_cold_reads_total) == 2 * batch.size());
+            BEAST_EXPECT(counter(jss::node_cold_reads_hit) == batch.size());
+        }
+
+        // Invalid hot tier configurations
+        auto const badConfig = [&](std::string const& key,
+                                   std::string const& value,
+                                   std::string const& error) {
+            Section params{hotParams};
+            params.set(key, value);
+            try
+            {
+                DatabaseTieredImp bad(
+                    scheduler,
+                    2,
+                    Manager::instance().make_Backend(
+                        coldParams, megabytes(4), scheduler, journal_),
+                    params,
+                    megabytes(4),
+                    coldParams,
+                    journal_);
+                fail();
+            }
+            catch (std::runtime_error const& e)
+            {
+                BEAST_EXPECT(e.what() == error);
+            }
+        };
+        badConfig("hot_ledgers", "255", "hot_ledgers must be at least 256");
+        badConfig("path", "", "Missing path in [node_db_hot]");
+    }
+
+    //--------------------------------------------------------------------------
+
     void
     run() override
     {
@@ -670,6 +823,12 @@ public:
 #endif
         }
 
+        // Tiered tests
+        {
+            testTiered("memory", seedValue);
+            testTiered("nudb", seedValue);
+        }
+
         // Import tests
         {
             testImport("nudb", "nudb", seedValue);
@@ -0,0 +1,321 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/Dictionaries.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+
+namespace ripple {
+namespace NodeStore {
+
+class Dictionaries_test : public TestBase
+{
+    // A buffer factory for the codec
+    struct Buffer
+    {
+        Blob data;
+
+        void*
+        operator()(std::size_t n)
+        {
+            data.resize(n);
+            return data.data();
+        }
+    };
+
+    // Objects that look like serialized trust lines: the same fields in
+    // the same order, with amounts and transaction ids that differ, and
+    // issues that come from a small set shared by every object.
+    static Batch
+    makeObjects(NodeObjectType type, int numObjects, std::uint64_t seed)
+    {
+        std::vector<Blob> issues(8, Blob(40));
+        beast::xor_shift_engine rng(1);
+        for (auto& issue : issues)
+            beast::rngfill(issue.data(), issue.size(), rng);
+
+        rng.seed(seed + 1);
+        Batch batch;
+        batch.reserve(numObjects);
+        for (int i = 0; i < numObjects; ++i)
+        {
+            Blob data{0x4D, 0x4C, 0x4E, 0x00, 0x11, 0x00, 0x72, 0x22};
+            auto append = [&](std::size_t random, Blob const& fixed) {
+                auto const at = data.size();
+                data.resize(at + random);
+                beast::rngfill(data.data() + at, random, rng);
+                data.insert(data.end(), fixed.begin(), fixed.end());
+            };
+            auto const& issue = issues[rand_int(rng, issues.size() - 1)];
+            append(0, {0x00, 0x02, 0x00, 0x00, 0x25});
+            append(4, {0x37, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+            append(0, {0x00, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+            append(0, {0x00, 0x00, 0x55});
+            append(32, {0x61, 0xD4});
+            append(7, issue);
+            append(0, {0x66, 0xD5});
+            append(7, issue);
+            append(0, {0x67, 0x80});
+            append(7, issue);
+            if (type == hotTRANSACTION_NODE)
+                append(16, issues[0]);
+
+            uint256 hash;
+            beast::rngfill(hash.begin(), hash.size(), rng);
+            batch.push_back(
+                NodeObject::createObject(type, std::move(data), hash));
+        }
+        return batch;
+    }
+
+    static Dictionaries
+    train(Dictionaries const& dictionaries, Batch const& batch)
+    {
+        DictionaryTrainer trainer(4096, 100 * 1024);
+        for (auto const& object : batch)
+        {
+            EncodedBlob e(object);
+            if (auto samples = trainer.sample(e.getData(), e.getSize()))
+            {
+                return dictionaries.add(std::make_shared<Dictionary const>(
+                    dictionaries.nextId(),
+                    samples->first,
+                    trainer.train(samples->second)));
+            }
+        }
+        return dictionaries;
+    }
+
+    static std::size_t
+    compressedSize(Batch const& batch, Dictionaries const* dictionaries)
+    {
+        std::size_t size = 0;
+        for (auto const& object : batch)
+        {
+            EncodedBlob e(object);
+            Buffer bf;
+            size += nodeobject_compress(
+                        e.getData(), e.getSize(), bf, dictionaries)
+                        .second;
+        }
+        return size;
+    }
+
+    bool
+    roundTrip(
+        std::shared_ptr<NodeObject> const& object,
+        Dictionaries const* compress,
+        Dictionaries const* decompress)
+    {
+        EncodedBlob e(object);
+        Buffer in;
+        auto const compressed =
+            nodeobject_compress(e.getData(), e.getSize(), in, compress);
+        Buffer out;
+        auto const result = nodeobject_decompress(
+            compressed.first, compressed.second, out, decompress);
+        DecodedBlob decoded(e.getKey(), result.first, result.second);
+        return decoded.wasOk() && isSame(object, decoded.createObject());
+    }
+
+    void
+    testCodec()
+    {
+        testcase("codec");
+
+        auto const samples = makeObjects(hotACCOUNT_NODE, 2000, 1);
+        auto const dictionaries = train(Dictionaries{}, samples);
+        BEAST_EXPECT(dictionaries.size() == 1);
+        auto const dictionary = dictionaries.compressor(hotACCOUNT_NODE);
+        if (!BEAST_EXPECT(dictionary))
+            return;
+        BEAST_EXPECT(dictionary->id() == 1);
+        BEAST_EXPECT(dictionaries.find(1) == dictionary);
+        BEAST_EXPECT(!dictionaries.compressor(hotTRANSACTION_NODE));
+
+        // Objects the dictionary was not trained on compress better than
+        // with lz4 alone
+        auto const objects = makeObjects(hotACCOUNT_NODE, 1000, 2);
+        auto const lz4 = compressedSize(objects, nullptr);
+        auto const zstd = compressedSize(objects, &dictionaries);
+        log << "lz4: " << lz4 << " bytes, zstd with a dictionary: " << zstd
+            << " bytes" << std::endl;
+        BEAST_EXPECT(zstd < lz4 * 3 / 4);
+
+        for (auto const& object : objects)
+            BEAST_EXPECT(roundTrip(object, &dictionaries, &dictionaries));
+
+        // Other types of objects are compressed as before
+        for (auto const& object : makeObjects(hotTRANSACTION_NODE, 10, 3))
+            BEAST_EXPECT(roundTrip(object, &dictionaries, nullptr));
+
+        // An object can't be read without its dictionary
+        try
+        {
+            roundTrip(objects.front(), &dictionaries, nullptr);
+            fail();
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(
+                std::string(e.what()) ==
+                "zstd_decompress: unknown dictionary 1");
+        }
+    }
+
+    void
+    testVersions()
+    {
+        testcase("versions");
+
+        auto const first =
+            train(Dictionaries{}, makeObjects(hotACCOUNT_NODE, 2000, 1));
+        auto const second =
+            train(first, makeObjects(hotACCOUNT_NODE, 2000, 4));
+        if (!BEAST_EXPECT(second.size() == 2))
+            return;
+        BEAST_EXPECT(first.size() == 1);
+        BEAST_EXPECT(second.compressor(hotACCOUNT_NODE) == second.find(2));
+        BEAST_EXPECT(first.compressor(hotACCOUNT_NODE) == first.find(1));
+        BEAST_EXPECT(second.find(1) == first.find(1));
+        BEAST_EXPECT(!second.find(3));
+        BEAST_EXPECT(!second.find(0));
+
+        // Objects written with an older dictionary stay readable
+        for (auto const& object : makeObjects(hotACCOUNT_NODE, 100, 5))
+        {
+            BEAST_EXPECT(roundTrip(object, &first, &second));
+            BEAST_EXPECT(roundTrip(object, &second, &second));
+        }
+
+        // Ids are given out in order
+        try
+        {
+            first.add(std::make_shared<Dictionary const>(
+                3, hotACCOUNT_NODE, second.find(2)->data()));
+            fail();
+        }
+        catch (std::logic_error const&)
+        {
+            pass();
+        }
+    }
+
+    void
+    testSerialization()
+    {
+        testcase("serialization");
+
+        auto const dictionaries =
+            train(Dictionaries{}, makeObjects(hotTRANSACTION_NODE, 2000, 6));
+        auto const dictionary = dictionaries.find(1);
+        if (!BEAST_EXPECT(dictionary))
+            return;
+        BEAST_EXPECT(dictionary->type() == hotTRANSACTION_NODE);
+
+        auto blob = dictionary->serialize();
+        auto const parsed = Dictionary::parse(makeSlice(blob));
+        BEAST_EXPECT(parsed->id() == dictionary->id());
+        BEAST_EXPECT(parsed->type() == dictionary->type());
+        BEAST_EXPECT(parsed->data() == dictionary->data());
+
+        BEAST_EXPECT(Dictionary::key(1) == Dictionary::key(1));
+        BEAST_EXPECT(Dictionary::key(1) != Dictionary::key(2));
+
+        // An unknown version is rejected
+        blob[0] = 2;
+        try
+        {
+            Dictionary::parse(makeSlice(blob));
+            fail();
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+    }
+
+    void
+    testBackend()
+    {
+        testcase("backend");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("Dictionaries_test", *this);
+
+        beast::temp_dir tempDir;
+        Section params;
+        params.set("type", "nudb");
+        params.set("path", tempDir.path());
+        params.set("compression_dictionaries", "1");
+
+        // Enough objects to train a dictionary with the default sizes
+        auto const batch = makeObjects(hotACCOUNT_NODE, 30000, 7);
+
+        auto check = [&](Backend& backend) {
+            Batch copy;
+            fetchCopyOfBatch(backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+
+            // The dictionary is not one of the objects
+            std::size_t count = 0;
+            backend.for_each([&](std::shared_ptr<NodeObject>) { ++count; });
+            BEAST_EXPECT(count == batch.size());
+        };
+
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+            check(*backend);
+        }
+
+        // Objects written with the dictionary are readable after the
+        // database is reopened, even with training disabled
+        params.set("compression_dictionaries", "0");
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            check(*backend);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testCodec();
+        testVersions();
+        testSerialization();
+        testBackend();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Dictionaries, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
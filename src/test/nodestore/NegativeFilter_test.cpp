@@ -0,0 +1,340 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/json/json_value.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/NegativeFilter.h>
+#include <ripple/protocol/jss.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <fstream>
+
+namespace ripple {
+namespace NodeStore {
+
+class NegativeFilter_test : public TestBase
+{
+    static std::vector<uint256>
+    makeKeys(std::size_t n, std::uint64_t seed)
+    {
+        beast::xor_shift_engine rng(seed);
+        std::vector<uint256> keys(n);
+        for (auto& key : keys)
+            beast::rngfill(key.begin(), key.size(), rng);
+        return keys;
+    }
+
+    void
+    testFilter()
+    {
+        testcase("filter");
+
+        std::size_t const n = 100000;
+        NegativeFilter filter(n, 10);
+        BEAST_EXPECT(filter.capacity() == n);
+
+        auto const present = makeKeys(n, 1);
+        for (auto const& key : present)
+            filter.insert(key);
+        BEAST_EXPECT(filter.inserted() == n);
+
+        // There are no false negatives
+        bool all = true;
+        for (auto const& key : present)
+            all = all && filter.mayContain(key);
+        BEAST_EXPECT(all);
+
+        // With 10 bits per key, about 1% of absent keys are reported as
+        // possibly present
+        std::size_t falsePositives = 0;
+        for (auto const& key : makeKeys(n, 2))
+            falsePositives += filter.mayContain(key);
+        log << "false positive rate: "
+            << static_cast<double>(falsePositives) / n << std::endl;
+        BEAST_EXPECT(falsePositives < n / 40);
+    }
+
+    void
+    testPersistence()
+    {
+        testcase("persistence");
+
+        beast::temp_dir dir;
+        auto const file = boost::filesystem::path(dir.path()) / "filter";
+
+        auto const keys = makeKeys(10000, 3);
+        {
+            NegativeFilter filter(keys.size(), 12);
+            for (auto const& key : keys)
+                filter.insert(key);
+            BEAST_EXPECT(filter.save(file));
+        }
+
+        {
+            NegativeFilter filter(keys.size(), 12);
+            BEAST_EXPECT(filter.load(file));
+            BEAST_EXPECT(filter.inserted() == keys.size());
+
+            bool all = true;
+            for (auto const& key : keys)
+                all = all && filter.mayContain(key);
+            BEAST_EXPECT(all);
+        }
+
+        // A filter with a different geometry does not load the file
+        {
+            NegativeFilter filter(2 * keys.size(), 12);
+            BEAST_EXPECT(!filter.load(file));
+        }
+        {
+            NegativeFilter filter(keys.size(), 6);
+            BEAST_EXPECT(!filter.load(file));
+        }
+
+        // A corrupt file does not load and leaves the filter empty
+        {
+            std::fstream f(
+                file.string(), std::ios::in | std::ios::out | std::ios::binary);
+            f.seekp(100);
+            f.put('\xff');
+            f.seekp(101);
+            f.put('\x00');
+        }
+        {
+            NegativeFilter filter(keys.size(), 12);
+            BEAST_EXPECT(!filter.load(file));
+            BEAST_EXPECT(filter.inserted() == 0);
+
+            std::size_t contained = 0;
+            for (auto const& key : keys)
+                contained += filter.mayContain(key);
+            BEAST_EXPECT(contained == 0);
+        }
+
+        // A missing file does not load
+        {
+            NegativeFilter filter(keys.size(), 12);
+            BEAST_EXPECT(!filter.load(file.string() + ".missing"));
+        }
+    }
+
+    void
+    testBackend(std::string const& type, std::uint64_t const seedValue)
+    {
+        testcase("Backend type=" + type);
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("NegativeFilter_test", *this);
+
+        beast::temp_dir tempDir;
+        Section params;
+        params.set("type", type);
+        params.set("path", tempDir.path());
+        params.set("negative_filter_keys", std::to_string(numObjectsToTest));
+
+        auto const batch = createPredictableBatch(numObjectsToTest, seedValue);
+        auto const missing =
+            createPredictableBatch(numObjectsToTest, seedValue + 1);
+
+        auto counter = [](Backend const& backend,
+                          Json::StaticString const& name) {
+            Json::Value obj(Json::objectValue);
+            backend.getCountsJson(obj);
+            return std::stoull(obj[name].asString());
+        };
+
+        auto check = [&](Backend& backend) {
+            Batch copy;
+            fetchCopyOfBatch(backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+
+            // Almost every absent object is answered by the filter
+            fetchMissing(backend, missing);
+            BEAST_EXPECT(
+                counter(backend, jss::node_filter_checks) == 2 * batch.size());
+            auto const hits = counter(backend, jss::node_filter_hits);
+            auto const falsePositives =
+                counter(backend, jss::node_filter_false_positives);
+            BEAST_EXPECT(hits + falsePositives == missing.size());
+            BEAST_EXPECT(falsePositives < missing.size() / 40);
+        };
+
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+            check(*backend);
+        }
+
+        if (type == "memory")
+            return;
+
+        // The filter is saved on close, and loaded on open
+        auto const file =
+            boost::filesystem::path(tempDir.path()) / "negative.filter";
+        BEAST_EXPECT(boost::filesystem::exists(file));
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            BEAST_EXPECT(
+                counter(*backend, jss::node_filter_keys) == batch.size());
+            check(*backend);
+        }
+
+        // Without a saved filter, it is rebuilt from the backend and saved
+        boost::filesystem::remove(file);
+        {
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            BEAST_EXPECT(boost::filesystem::exists(file));
+            BEAST_EXPECT(
+                counter(*backend, jss::node_filter_keys) == batch.size());
+            check(*backend);
+        }
+
+        // Invalid configuration
+        try
+        {
+            params.set("negative_filter_bits", "0");
+            Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            fail();
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(
+                std::string(e.what()) ==
+                "negative_filter_bits must be between 1 and 64");
+        }
+    }
+
+    void
+    testRecovery(std::uint64_t const seedValue)
+    {
+        testcase("recovery");
+
+        namespace fs = boost::filesystem;
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("NegativeFilter_test", *this);
+
+        // Memory backends keep their objects when closed and reopened
+        beast::temp_dir tempDir;
+        Section params;
+        params.set("type", "memory");
+        params.set("path", tempDir.path());
+        Section filtered{params};
+        filtered.set("negative_filter_keys", std::to_string(numObjectsToTest));
+
+        auto const file = fs::path(tempDir.path()) / "negative.filter";
+        auto const log = fs::path(tempDir.path()) / "negative.filter.log";
+
+        auto const batch = createPredictableBatch(numObjectsToTest, seedValue);
+        auto const batch2 =
+            createPredictableBatch(numObjectsToTest, seedValue + 1);
+        auto const missing =
+            createPredictableBatch(numObjectsToTest, seedValue + 2);
+
+        auto open = [&](Section const& section) {
+            auto backend = Manager::instance().make_Backend(
+                section, megabytes(4), scheduler, journal);
+            backend->open();
+            return backend;
+        };
+
+        auto keys = [](Backend const& backend) {
+            Json::Value obj(Json::objectValue);
+            backend.getCountsJson(obj);
+            return std::stoull(obj[jss::node_filter_keys].asString());
+        };
+
+        {
+            auto backend = open(filtered);
+            storeBatch(*backend, batch);
+        }
+        BEAST_EXPECT(fs::exists(file));
+        BEAST_EXPECT(!fs::exists(log));
+
+        // Keys stored while open are logged, in blocks or at the latest
+        // on a sync. Keep the files as a crash would leave them, before
+        // the filter is saved on close.
+        {
+            auto backend = open(filtered);
+            storeBatch(*backend, batch2);
+            BEAST_EXPECT(fs::file_size(log) < batch2.size() * 32);
+            backend->sync();
+            BEAST_EXPECT(fs::file_size(log) == batch2.size() * 32);
+
+            fs::copy_file(file, file.string() + ".crash");
+            fs::copy_file(log, log.string() + ".crash");
+        }
+        fs::rename(file.string() + ".crash", file);
+        fs::rename(log.string() + ".crash", log);
+
+        // A key cut short by the crash is ignored
+        std::ofstream(log.string(), std::ios::binary | std::ios::app)
+            << "short";
+
+        // An object stored around the filter shows whether it was rebuilt
+        {
+            auto backend = open(params);
+            storeBatch(*backend, createPredictableBatch(1, seedValue + 3));
+        }
+
+        // The saved filter is brought up to date from the log
+        {
+            auto backend = open(filtered);
+            BEAST_EXPECT(keys(*backend) == batch.size() + batch2.size());
+            BEAST_EXPECT(!fs::exists(log) || fs::file_size(log) == 0);
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            fetchCopyOfBatch(*backend, &copy, batch2);
+            BEAST_EXPECT(areBatchesEqual(batch2, copy));
+            fetchMissing(*backend, missing);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        std::uint64_t const seedValue = 50;
+
+        testFilter();
+        testPersistence();
+        testBackend("memory", seedValue);
+        testBackend("nudb", seedValue);
+        testRecovery(seedValue);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(NegativeFilter, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,311 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <fstream>
+
+namespace ripple {
+namespace NodeStore {
+
+class Segment_test : public TestBase
+{
+    static Section
+    parameters(std::string const& path, std::size_t segmentObjects)
+    {
+        Section params;
+        params.set("type", "Segment");
+        params.set("path", path);
+        params.set("segment_objects", std::to_string(segmentObjects));
+        return params;
+    }
+
+    // The number of files in a directory with an extension
+    static std::size_t
+    files(std::string const& path, std::string const& extension)
+    {
+        std::size_t count = 0;
+        for (auto const& entry :
+             boost::filesystem::directory_iterator(path))
+            count += entry.path().extension() == extension;
+        return count;
+    }
+
+    std::unique_ptr<Backend>
+    make(Section const& params, Scheduler& scheduler, beast::Journal journal)
+    {
+        auto backend = Manager::instance().make_Backend(
+            params, megabytes(4), scheduler, journal);
+        backend->open();
+        return backend;
+    }
+
+    std::size_t
+    count(Backend& backend)
+    {
+        std::size_t objects = 0;
+        backend.for_each([&objects](std::shared_ptr<NodeObject>) {
+            ++objects;
+        });
+        return objects;
+    }
+
+    void
+    testSegments()
+    {
+        testcase("segments");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("Segment_test", *this);
+        beast::temp_dir tempDir;
+        auto const params = parameters(tempDir.path(), 100);
+
+        auto const batch = createPredictableBatch(450, 1);
+        auto const missing = createPredictableBatch(100, 2);
+        {
+            auto backend = make(params, scheduler, journal);
+            storeBatch(*backend, batch);
+
+            // Every hundred objects are sealed into a segment
+            BEAST_EXPECT(files(tempDir.path(), ".seg") == 4);
+            BEAST_EXPECT(files(tempDir.path(), ".log") == 1);
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            fetchMissing(*backend, missing);
+        }
+
+        // Closing seals the rest, and leaves no log
+        BEAST_EXPECT(files(tempDir.path(), ".seg") == 5);
+        BEAST_EXPECT(files(tempDir.path(), ".log") == 0);
+
+        {
+            auto backend = make(params, scheduler, journal);
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            fetchMissing(*backend, missing);
+            BEAST_EXPECT(count(*backend) == batch.size());
+        }
+    }
+
+    void
+    testMerge()
+    {
+        testcase("merge");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("Segment_test", *this);
+        beast::temp_dir tempDir;
+        auto const params = parameters(tempDir.path(), 10);
+
+        // Eight segments of ten objects are merged into one, which joins
+        // the next tier
+        auto const batch = createPredictableBatch(100, 3);
+        auto backend = make(params, scheduler, journal);
+        storeBatch(*backend, batch);
+        BEAST_EXPECT(files(tempDir.path(), ".seg") == 3);
+
+        Batch copy;
+        fetchCopyOfBatch(*backend, &copy, batch);
+        BEAST_EXPECT(areBatchesEqual(batch, copy));
+        fetchMissing(*backend, createPredictableBatch(100, 4));
+
+        // Merged segments are merged again, and an object that was stored
+        // twice is kept once
+        auto const more = createPredictableBatch(700, 5);
+        storeBatch(*backend, batch);
+        storeBatch(*backend, more);
+        BEAST_EXPECT(files(tempDir.path(), ".seg") == 6);
+        BEAST_EXPECT(count(*backend) == batch.size() + more.size());
+        fetchCopyOfBatch(*backend, &copy, more);
+        BEAST_EXPECT(areBatchesEqual(more, copy));
+        fetchCopyOfBatch(*backend, &copy, batch);
+        BEAST_EXPECT(areBatchesEqual(batch, copy));
+    }
+
+    void
+    testLog()
+    {
+        testcase("log");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("Segment_test", *this);
+        beast::temp_dir tempDir;
+        beast::temp_dir crashDir;
+
+        auto const batch = createPredictableBatch(300, 6);
+        auto backend =
+            make(parameters(tempDir.path(), 1000), scheduler, journal);
+        storeBatch(*backend, batch);
+        backend->sync();
+        BEAST_EXPECT(files(tempDir.path(), ".seg") == 0);
+
+        // Copy the files as they would be if the server stopped now, with
+        // a record only partly written.
+        for (auto const& entry :
+             boost::filesystem::directory_iterator(tempDir.path()))
+        {
+            auto const to = boost::filesystem::path(crashDir.path()) /
+                entry.path().filename();
+            boost::filesystem::copy_file(entry.path(), to);
+            if (to.extension() == ".log")
+            {
+                std::ofstream log(
+                    to.string(), std::ios::binary | std::ios::app);
+                log << std::string(40, 'x');
+            }
+        }
+
+        // The objects are replayed from the log
+        auto recovered =
+            make(parameters(crashDir.path(), 1000), scheduler, journal);
+        Batch copy;
+        fetchCopyOfBatch(*recovered, &copy, batch);
+        BEAST_EXPECT(areBatchesEqual(batch, copy));
+        BEAST_EXPECT(count(*recovered) == batch.size());
+        BEAST_EXPECT(files(crashDir.path(), ".log") == 0);
+    }
+
+    void
+    testFiles()
+    {
+        testcase("files");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("Segment_test", *this);
+        beast::temp_dir tempDir;
+        auto const params = parameters(tempDir.path(), 100);
+        auto const segment = [&](std::string const& name) {
+            return (boost::filesystem::path(tempDir.path()) / name).string();
+        };
+
+        auto const batch = createPredictableBatch(100, 7);
+        make(params, scheduler, journal)->storeBatch(batch);
+        BEAST_EXPECT(files(tempDir.path(), ".seg") == 1);
+
+        // A segment that was being written when the server stopped is
+        // removed
+        std::ofstream(segment("000000000002.tmp")) << "partial";
+        {
+            auto backend = make(params, scheduler, journal);
+            BEAST_EXPECT(files(tempDir.path(), ".tmp") == 0);
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+
+        // A file that is not a segment is rejected
+        std::ofstream(segment("000000000002.seg")) << std::string(100, 'x');
+        try
+        {
+            make(params, scheduler, journal);
+            fail("not a segment");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+
+        // So is a segment whose header does not match its size
+        boost::filesystem::copy_file(
+            segment("000000000001.seg"),
+            segment("000000000002.seg"),
+            boost::filesystem::copy_option::overwrite_if_exists);
+        {
+            std::ofstream corrupt(
+                segment("000000000002.seg"),
+                std::ios::binary | std::ios::app);
+            corrupt << "extra";
+        }
+        try
+        {
+            make(params, scheduler, journal);
+            fail("corrupt segment");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+    }
+
+    void
+    testSealFailure()
+    {
+        testcase("seal failure");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("Segment_test", *this);
+        beast::temp_dir tempDir;
+
+        auto const batch = createPredictableBatch(50, 8);
+        auto backend =
+            make(parameters(tempDir.path(), 1000), scheduler, journal);
+        storeBatch(*backend, batch);
+
+        // A directory in the way of the temporary file makes sealing fail
+        auto const blocker =
+            boost::filesystem::path(tempDir.path()) / "000000000001.tmp";
+        boost::filesystem::create_directories(blocker / "busy");
+        try
+        {
+            count(*backend);
+            fail("sealing should fail");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+
+        // The objects are still waiting, and in their log
+        Batch copy;
+        fetchCopyOfBatch(*backend, &copy, batch);
+        BEAST_EXPECT(areBatchesEqual(batch, copy));
+        BEAST_EXPECT(files(tempDir.path(), ".seg") == 0);
+        BEAST_EXPECT(files(tempDir.path(), ".log") == 1);
+
+        boost::filesystem::remove_all(blocker);
+        BEAST_EXPECT(count(*backend) == batch.size());
+        BEAST_EXPECT(files(tempDir.path(), ".seg") == 1);
+        BEAST_EXPECT(files(tempDir.path(), ".log") == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testSegments();
+        testMerge();
+        testLog();
+        testFiles();
+        testSealFailure();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Segment, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/impl/BatchVerifier.h>
+#include <test/jtx.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+
+namespace ripple {
+namespace test {
+
+class BatchVerifier_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        testcase("batch");
+
+        using namespace jtx;
+        Env env(*this);
+        auto& jobQueue = env.app().getJobQueue();
+        BatchVerifier verifier(jobQueue, env.journal);
+
+        // Jobs of this type run one at a time, so while this job waits
+        // every message submitted joins the same batch.
+        JobType const type = jtUPDATE_PF;
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        BEAST_EXPECT(jobQueue.addJob(type, "block", [released]() {
+            released.wait();
+        }));
+
+        std::size_t const unique = 100;
+        std::size_t const copies = 3;
+
+        std::atomic<std::size_t> verified{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t done = 0;
+        std::size_t good = 0;
+        std::size_t unchecked = 0;
+
+        auto finish = [&](bool result) {
+            std::lock_guard lock(mutex);
+            ++done;
+            good += result;
+            cv.notify_all();
+        };
+
+        for (std::size_t c = 0; c < copies; ++c)
+        {
+            for (std::size_t i = 0; i < unique; ++i)
+            {
+                // Odd messages have bad signatures
+                verifier.submit(
+                    type,
+                    "check",
+                    uint256{i},
+                    [&verified, i]() {
+                        ++verified;
+                        return i % 2 == 0;
+                    },
+                    finish);
+            }
+        }
+
+        // A message that needs no check, with the suppression hash of one
+        // with a bad signature.
+        verifier.submit(type, "check", uint256{1}, {}, [&](bool result) {
+            std::lock_guard lock(mutex);
+            ++unchecked;
+            cv.notify_all();
+            BEAST_EXPECT(result);
+        });
+
+        BEAST_EXPECT(verifier.size() == unique * copies + 1);
+        release.set_value();
+
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&]() {
+                return done == unique * copies && unchecked == 1;
+            });
+        }
+
+        // Each signature was verified once, and every copy has the result
+        BEAST_EXPECT(verified == unique);
+        BEAST_EXPECT(good == unique * copies / 2);
+        BEAST_EXPECT(verifier.size() == 0);
+
+        // A check that throws fails every message with its suppression hash
+        std::size_t failed = 0;
+        for (std::size_t c = 0; c < copies; ++c)
+        {
+            verifier.submit(
+                type,
+                "check",
+                uint256{unique},
+                []() -> bool { throw std::runtime_error("bad"); },
+                [&](bool result) {
+                    std::lock_guard lock(mutex);
+                    failed += !result;
+                    ++done;
+                    cv.notify_all();
+                });
+        }
+
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&]() { return done == (unique + 1) * copies; });
+        }
+        BEAST_EXPECT(failed == copies);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BatchVerifier, overlay, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,244 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/peerfinder/impl/Handouts.h>
+#include <ripple/peerfinder/impl/Livecache.h>
+#include <test/unit_test/SuiteJournal.h>
+
+#include <chrono>
+#include <set>
+
+namespace ripple {
+namespace PeerFinder {
+
+namespace {
+
+// A distinct address for every n
+beast::IP::Endpoint
+makeEndpoint(std::uint32_t n)
+{
+    return beast::IP::Endpoint(beast::IP::AddressV4(0x0A000000 + n), 51235);
+}
+
+std::vector<SlotHandouts>
+makeTargets(std::size_t count, clock_type& clock)
+{
+    std::vector<SlotHandouts> targets;
+    targets.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i)
+        targets.emplace_back(std::make_shared<SlotImp>(
+            makeEndpoint(0x00100000 + i), false, clock));
+    return targets;
+}
+
+}  // namespace
+
+class Handouts_test : public beast::unit_test::suite
+{
+    TestStopwatch clock_;
+    test::SuiteJournal journal_;
+
+public:
+    Handouts_test() : journal_("Handouts_test", *this)
+    {
+    }
+
+    void
+    testDraw()
+    {
+        testcase("draw");
+
+        using namespace std::chrono_literals;
+        Livecache<> c(clock_, journal_);
+        for (std::uint32_t i = 0; i < 100; ++i)
+            c.insert(Endpoint{makeEndpoint(i), 1 + i % 3});
+
+        // Drawing every position visits every endpoint once
+        for (auto hop : c.hops)
+        {
+            std::set<beast::IP::Endpoint> const all = [&] {
+                std::set<beast::IP::Endpoint> s;
+                for (auto const& ep : hop)
+                    s.insert(ep.address);
+                return s;
+            }();
+            std::set<beast::IP::Endpoint> drawn;
+            for (std::size_t i = 0; i < hop.size(); ++i)
+                BEAST_EXPECT(drawn.insert(hop.draw(i).address).second);
+            BEAST_EXPECT(drawn == all);
+        }
+
+        // Moving and removing endpoints still finds them after draws
+        for (std::uint32_t i = 0; i < 50; ++i)
+            c.insert(Endpoint{makeEndpoint(i), 0});
+        BEAST_EXPECT(c.size() == 100);
+        BEAST_EXPECT(c.hops.begin()->size() == 50);
+
+        clock_.advance(Tuning::liveCacheSecondsToLive - 1s);
+        for (std::uint32_t i = 50; i < 60; ++i)
+            c.insert(Endpoint{makeEndpoint(i), 1});
+        clock_.advance(1s);
+        c.expire();
+        BEAST_EXPECT(c.size() == 10);
+        BEAST_EXPECT((c.hops.begin() + 1)->size() == 10);
+        BEAST_EXPECT(c.hops.histogram() == "0, 10, 0, 0, 0, 0, 0, 0");
+    }
+
+    void
+    testSlotHandouts()
+    {
+        testcase("slot handouts");
+
+        Livecache<> c(clock_, journal_);
+        std::uint32_t const cached = 200;
+        for (std::uint32_t i = 0; i < cached; ++i)
+            c.insert(Endpoint{makeEndpoint(i), 1 + i % (Tuning::maxHops + 1)});
+        auto const histogram = c.hops.histogram();
+
+        auto targets = makeTargets(50, clock_);
+        handout(targets.begin(), targets.end(), c.hops.begin(), c.hops.end());
+
+        std::set<beast::IP::Endpoint> handedOut;
+        for (auto const& t : targets)
+        {
+            BEAST_EXPECT(t.full());
+            std::set<beast::IP::Address> addresses;
+            for (auto const& ep : t.list())
+            {
+                BEAST_EXPECT(ep.hops <= Tuning::maxHops);
+                BEAST_EXPECT(addresses.insert(ep.address.address()).second);
+                handedOut.insert(ep.address);
+            }
+        }
+
+        // Targets are not all given the same endpoints
+        BEAST_EXPECT(handedOut.size() > 2 * Tuning::numberOfEndpoints);
+        BEAST_EXPECT(c.size() == cached);
+        BEAST_EXPECT(c.hops.histogram() == histogram);
+
+        // Endpoints sent to a slot are not sent again
+        std::set<beast::IP::Endpoint> first;
+        for (auto const& ep : targets.front().list())
+            first.insert(ep.address);
+        SlotHandouts again(targets.front().slot());
+        handout(&again, &again + 1, c.hops.begin(), c.hops.end());
+        for (auto const& ep : again.list())
+            BEAST_EXPECT(first.count(ep.address) == 0);
+    }
+
+    void
+    testRedirectHandouts()
+    {
+        testcase("redirect handouts");
+
+        Livecache<> c(clock_, journal_);
+        for (std::uint32_t i = 0; i < 20; ++i)
+            c.insert(Endpoint{makeEndpoint(i), 0});
+        for (std::uint32_t i = 20; i < 40; ++i)
+            c.insert(Endpoint{makeEndpoint(i), Tuning::maxHops + 1});
+        for (std::uint32_t i = 40; i < 45; ++i)
+            c.insert(Endpoint{makeEndpoint(i), 2});
+
+        // Only the endpoints at hops 2 may be given out, and not the
+        // address of the slot being redirected.
+        RedirectHandouts h(
+            std::make_shared<SlotImp>(makeEndpoint(40), false, clock_));
+        handout(&h, &h + 1, c.hops.begin(), c.hops.end());
+        BEAST_EXPECT(h.list().size() == 4);
+        for (auto const& ep : h.list())
+        {
+            BEAST_EXPECT(ep.hops == 2);
+            BEAST_EXPECT(ep.address != makeEndpoint(40));
+        }
+    }
+
+    void
+    run() override
+    {
+        testDraw();
+        testSlotHandouts();
+        testRedirectHandouts();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Handouts, peerfinder, ripple);
+
+//------------------------------------------------------------------------------
+
+// Measures how long it takes to build the periodic endpoint messages for
+// every active peer, as Logic::buildEndpointsForPeers does.
+class Handouts_timing_test : public beast::unit_test::suite
+{
+    TestStopwatch clock_;
+    test::SuiteJournal journal_;
+
+public:
+    Handouts_timing_test() : journal_("Handouts_timing_test", *this)
+    {
+    }
+
+    void
+    run() override
+    {
+        using namespace std::chrono;
+
+        for (std::uint32_t const cached : {1000, 10000, 50000})
+        {
+            Livecache<> c(clock_, journal_);
+            for (std::uint32_t i = 0; i < cached; ++i)
+                c.insert(Endpoint{makeEndpoint(i), 1 + i % Tuning::maxHops});
+
+            for (std::size_t const peers : {100, 500, 2000})
+            {
+                std::size_t const rounds = 20;
+                std::size_t handedOut = 0;
+                steady_clock::duration elapsed{};
+                for (std::size_t i = 0; i < rounds; ++i)
+                {
+                    auto targets = makeTargets(peers, clock_);
+
+                    auto const start = steady_clock::now();
+                    handout(
+                        targets.begin(),
+                        targets.end(),
+                        c.hops.begin(),
+                        c.hops.end());
+                    elapsed += steady_clock::now() - start;
+
+                    for (auto const& t : targets)
+                        handedOut += t.list().size();
+                }
+                BEAST_EXPECT(
+                    handedOut == rounds * peers * Tuning::numberOfEndpoints);
+
+                auto const us = duration_cast<microseconds>(elapsed).count();
+                log << cached << " endpoints, " << peers
+                    << " peers: " << us / rounds << "us per round"
+                    << std::endl;
+            }
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Handouts_timing, peerfinder, ripple);
+
+}  // namespace PeerFinder
+}  // namespace ripple
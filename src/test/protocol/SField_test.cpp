@@ -0,0 +1,169 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/SField.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <test/jtx.h>
+
+#include <chrono>
+
+namespace ripple {
+namespace test {
+
+class SField_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        testcase("getField");
+
+        // Fields found in serialized objects
+        std::initializer_list<SField const*> const serialized{
+            &sfLedgerEntryType,
+            &sfFlags,
+            &sfAccount,
+            &sfBalance,
+            &sfPreviousTxnID,
+            &sfMemos,
+            &sfTickSize,
+            &sfIndexes};
+        for (auto const field : serialized)
+        {
+            BEAST_EXPECT(
+                &SField::getField(field->fieldType, field->fieldValue) ==
+                field);
+            BEAST_EXPECT(&SField::getField(field->fieldCode) == field);
+            BEAST_EXPECT(&SField::getField(field->fieldName) == field);
+        }
+
+        // Fields that are never serialized
+        BEAST_EXPECT(SField::getField(STI_UINT256, 257).getName() == "hash");
+        BEAST_EXPECT(SField::getField(STI_UINT256, 258).getName() == "index");
+        BEAST_EXPECT(
+            &SField::getField(STI_TRANSACTION, 257) == &sfTransaction);
+        BEAST_EXPECT(&SField::getField(0) == &sfGeneric);
+        BEAST_EXPECT(SField::getField(-1).isInvalid());
+
+        // Unknown fields
+        BEAST_EXPECT(SField::getField(STI_UINT32, 255).isInvalid());
+        BEAST_EXPECT(SField::getField(STI_UINT64, 0).isInvalid());
+        BEAST_EXPECT(SField::getField(200, 1).isInvalid());
+        BEAST_EXPECT(SField::getField(STI_ACCOUNT, 1000).isInvalid());
+        BEAST_EXPECT(SField::getField(-5, 1).isInvalid());
+        BEAST_EXPECT(SField::getField("NoSuchField").isInvalid());
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SField, protocol, ripple);
+
+//------------------------------------------------------------------------------
+
+// Measures how fast ledger entries and transaction metadata deserialize.
+// Field lookup runs once for every field of every object.
+class SField_timing_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+
+        Env env(*this, envconfig(), nullptr, beast::severities::kError);
+
+        // Build a ledger with a mix of account roots, trust lines, offers
+        // and directories.
+        Account const gw("gateway");
+        auto const USD = gw["USD"];
+        env.fund(XRP(1000000), gw);
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 200; ++i)
+            accounts.emplace_back("acct" + std::to_string(i));
+        for (auto const& account : accounts)
+            env.fund(XRP(10000), account);
+        env.close();
+
+        for (auto const& account : accounts)
+            env(trust(account, USD(10000)));
+        env.close();
+
+        for (auto const& account : accounts)
+            env(pay(gw, account, USD(1000)));
+        env.close();
+
+        for (std::size_t i = 0; i < accounts.size(); ++i)
+            env(offer(accounts[i], XRP(10 + i), USD(10)));
+        env.close();
+
+        std::vector<std::pair<uint256, Blob>> entries;
+        for (auto const& sle : env.closed()->sles)
+            entries.emplace_back(sle->key(), sle->getSerializer().peekData());
+
+        std::vector<Blob> metadata;
+        for (auto const& [tx, meta] : env.closed()->txs)
+        {
+            (void)tx;
+            if (meta)
+                metadata.push_back(meta->getSerializer().peekData());
+        }
+
+        log << entries.size() << " ledger entries, " << metadata.size()
+            << " metadata objects" << std::endl;
+
+        auto time = [&](char const* what, std::size_t count, auto&& f) {
+            std::size_t const rounds = 200;
+            auto const start = clock_type::now();
+            for (std::size_t i = 0; i < rounds; ++i)
+                f();
+            auto const elapsed =
+                std::chrono::duration<double>(clock_type::now() - start);
+            log << what << ": " << std::fixed
+                << rounds * count / elapsed.count() << " per second"
+                << std::endl;
+        };
+
+        std::size_t fields = 0;
+        time("ledger entries", entries.size(), [&] {
+            for (auto const& [key, blob] : entries)
+            {
+                STLedgerEntry const sle(
+                    SerialIter{blob.data(), blob.size()}, key);
+                fields += sle.getCount();
+            }
+        });
+        time("metadata", metadata.size(), [&] {
+            for (auto const& blob : metadata)
+            {
+                STObject const meta(
+                    SerialIter{blob.data(), blob.size()}, sfMetadata);
+                fields += meta.getCount();
+            }
+        });
+        BEAST_EXPECT(fields != 0);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SField_timing, protocol, ripple);
+
+}  // namespace test
+}  // namespace ripple
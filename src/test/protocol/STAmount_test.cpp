@@ -21,9 +21,377 @@
 #include <ripple/basics/random.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/protocol/STAmount.h>
+#include <test/jtx.h>
+
+#include <boost/multiprecision/cpp_int.hpp>
+
+#include <chrono>
 
 namespace ripple {
 
+// The IOU arithmetic as it was before it had a fast path, to check that
+// the fast path gives the same results.
+namespace reference {
+
+std::uint64_t const tenTo14 = 100000000000000ull;
+std::uint64_t const tenTo14m1 = tenTo14 - 1;
+std::uint64_t const tenTo17 = tenTo14 * 1000;
+
+std::int64_t
+getSNValue(STAmount const& amount)
+{
+    auto ret = static_cast<std::int64_t>(amount.mantissa());
+    return amount.negative() ? -ret : ret;
+}
+
+// Calculate (a * b) / c when all three values are 64-bit
+// without loss of precision:
+std::uint64_t
+muldiv(
+    std::uint64_t multiplier,
+    std::uint64_t multiplicand,
+    std::uint64_t divisor)
+{
+    boost::multiprecision::uint128_t ret;
+
+    boost::multiprecision::multiply(ret, multiplier, multiplicand);
+    ret /= divisor;
+
+    if (ret > std::numeric_limits<std::uint64_t>::max())
+    {
+        Throw<std::overflow_error>(
+            "overflow: (" + std::to_string(multiplier) + " * " +
+            std::to_string(multiplicand) + ") / " + std::to_string(divisor));
+    }
+
+    return static_cast<uint64_t>(ret);
+}
+
+std::uint64_t
+muldiv_round(
+    std::uint64_t multiplier,
+    std::uint64_t multiplicand,
+    std::uint64_t divisor,
+    std::uint64_t rounding)
+{
+    boost::multiprecision::uint128_t ret;
+
+    boost::multiprecision::multiply(ret, multiplier, multiplicand);
+    ret += rounding;
+    ret /= divisor;
+
+    if (ret > std::numeric_limits<std::uint64_t>::max())
+    {
+        Throw<std::overflow_error>(
+            "overflow: ((" + std::to_string(multiplier) + " * " +
+            std::to_string(multiplicand) + ") + " + std::to_string(rounding) +
+            ") / " + std::to_string(divisor));
+    }
+
+    return static_cast<uint64_t>(ret);
+}
+
+STAmount
+divide(STAmount const& num, STAmount const& den, Issue const& issue)
+{
+    if (den == beast::zero)
+        Throw<std::runtime_error>("division by zero");
+
+    if (num == beast::zero)
+        return {issue};
+
+    std::uint64_t numVal = num.mantissa();
+    std::uint64_t denVal = den.mantissa();
+    int numOffset = num.exponent();
+    int denOffset = den.exponent();
+
+    if (num.native())
+    {
+        while (numVal < STAmount::cMinValue)
+        {
+            // Need to bring into range
+            numVal *= 10;
+            --numOffset;
+        }
+    }
+
+    if (den.native())
+    {
+        while (denVal < STAmount::cMinValue)
+        {
+            denVal *= 10;
+            --denOffset;
+        }
+    }
+
+    // We divide the two mantissas (each is between 10^15
+    // and 10^16). To maintain precision, we multiply the
+    // numerator by 10^17 (the product is in the range of
+    // 10^32 to 10^33) followed by a division, so the result
+    // is in the range of 10^16 to 10^15.
+    return STAmount(
+        issue,
+        muldiv(numVal, tenTo17, denVal) + 5,
+        numOffset - denOffset - 17,
+        num.negative() != den.negative());
+}
+
+STAmount
+multiply(STAmount const& v1, STAmount const& v2, Issue const& issue)
+{
+    if (v1 == beast::zero || v2 == beast::zero)
+        return STAmount(issue);
+
+    if (v1.native() && v2.native() && isXRP(issue))
+    {
+        std::uint64_t const minV =
+            getSNValue(v1) < getSNValue(v2) ? getSNValue(v1) : getSNValue(v2);
+        std::uint64_t const maxV =
+            getSNValue(v1) < getSNValue(v2) ? getSNValue(v2) : getSNValue(v1);
+
+        if (minV > 3000000000ull)  // sqrt(cMaxNative)
+            Throw<std::runtime_error>("Native value overflow");
+
+        if (((maxV >> 32) * minV) > 2095475792ull)  // cMaxNative / 2^32
+            Throw<std::runtime_error>("Native value overflow");
+
+        return STAmount(v1.getFName(), minV * maxV);
+    }
+
+    if (getSTNumberSwitchover())
+        return {IOUAmount{Number{v1} * Number{v2}}, issue};
+
+    std::uint64_t value1 = v1.mantissa();
+    std::uint64_t value2 = v2.mantissa();
+    int offset1 = v1.exponent();
+    int offset2 = v2.exponent();
+
+    if (v1.native())
+    {
+        while (value1 < STAmount::cMinValue)
+        {
+            value1 *= 10;
+            --offset1;
+        }
+    }
+
+    if (v2.native())
+    {
+        while (value2 < STAmount::cMinValue)
+        {
+            value2 *= 10;
+            --offset2;
+        }
+    }
+
+    // We multiply the two mantissas (each is between 10^15
+    // and 10^16), so their product is in the 10^30 to 10^32
+    // range. Dividing their product by 10^14 maintains the
+    // precision, by scaling the result to 10^16 to 10^18.
+    return STAmount(
+        issue,
+        muldiv(value1, value2, tenTo14) + 7,
+        offset1 + offset2 + 14,
+        v1.negative() != v2.negative());
+}
+
+void
+canonicalizeRound(bool native, std::uint64_t& value, int& offset)
+{
+    if (native)
+    {
+        if (offset < 0)
+        {
+            int loops = 0;
+
+            while (offset < -1)
+            {
+                value /= 10;
+                ++offset;
+                ++loops;
+            }
+
+            value += (loops >= 2) ? 9 : 10;  // add before last divide
+            value /= 10;
+            ++offset;
+        }
+    }
+    else if (value > STAmount::cMaxValue)
+    {
+        while (value > (10 * STAmount::cMaxValue))
+        {
+            value /= 10;
+            ++offset;
+        }
+
+        value += 9;  // add before last divide
+        value /= 10;
+        ++offset;
+    }
+}
+
+STAmount
+mulRound(
+    STAmount const& v1,
+    STAmount const& v2,
+    Issue const& issue,
+    bool roundUp)
+{
+    if (v1 == beast::zero || v2 == beast::zero)
+        return {issue};
+
+    bool const xrp = isXRP(issue);
+
+    if (v1.native() && v2.native() && xrp)
+    {
+        std::uint64_t minV =
+            (getSNValue(v1) < getSNValue(v2)) ? getSNValue(v1) : getSNValue(v2);
+        std::uint64_t maxV =
+            (getSNValue(v1) < getSNValue(v2)) ? getSNValue(v2) : getSNValue(v1);
+
+        if (minV > 3000000000ull)  // sqrt(cMaxNative)
+            Throw<std::runtime_error>("Native value overflow");
+
+        if (((maxV >> 32) * minV) > 2095475792ull)  // cMaxNative / 2^32
+            Throw<std::runtime_error>("Native value overflow");
+
+        return STAmount(v1.getFName(), minV * maxV);
+    }
+
+    std::uint64_t value1 = v1.mantissa(), value2 = v2.mantissa();
+    int offset1 = v1.exponent(), offset2 = v2.exponent();
+
+    if (v1.native())
+    {
+        while (value1 < STAmount::cMinValue)
+        {
+            value1 *= 10;
+            --offset1;
+        }
+    }
+
+    if (v2.native())
+    {
+        while (value2 < STAmount::cMinValue)
+        {
+            value2 *= 10;
+            --offset2;
+        }
+    }
+
+    bool const resultNegative = v1.negative() != v2.negative();
+
+    // We multiply the two mantissas (each is between 10^15
+    // and 10^16), so their product is in the 10^30 to 10^32
+    // range. Dividing their product by 10^14 maintains the
+    // precision, by scaling the result to 10^16 to 10^18.
+    //
+    // If the we're rounding up, we want to round up away
+    // from zero, and if we're rounding down, truncation
+    // is implicit.
+    std::uint64_t amount = muldiv_round(
+        value1, value2, tenTo14, (resultNegative != roundUp) ? tenTo14m1 : 0);
+
+    int offset = offset1 + offset2 + 14;
+    if (resultNegative != roundUp)
+        canonicalizeRound(xrp, amount, offset);
+    STAmount result(issue, amount, offset, resultNegative);
+
+    if (roundUp && !resultNegative && !result)
+    {
+        if (xrp)
+        {
+            // return the smallest value above zero
+            amount = 1;
+            offset = 0;
+        }
+        else
+        {
+            // return the smallest value above zero
+            amount = STAmount::cMinValue;
+            offset = STAmount::cMinOffset;
+        }
+        return STAmount(issue, amount, offset, resultNegative);
+    }
+    return result;
+}
+
+STAmount
+divRound(
+    STAmount const& num,
+    STAmount const& den,
+    Issue const& issue,
+    bool roundUp)
+{
+    if (den == beast::zero)
+        Throw<std::runtime_error>("division by zero");
+
+    if (num == beast::zero)
+        return {issue};
+
+    std::uint64_t numVal = num.mantissa(), denVal = den.mantissa();
+    int numOffset = num.exponent(), denOffset = den.exponent();
+
+    if (num.native())
+    {
+        while (numVal < STAmount::cMinValue)
+        {
+            numVal *= 10;
+            --numOffset;
+        }
+    }
+
+    if (den.native())
+    {
+        while (denVal < STAmount::cMinValue)
+        {
+            denVal *= 10;
+            --denOffset;
+        }
+    }
+
+    bool const resultNegative = (num.negative() != den.negative());
+
+    // We divide the two mantissas (each is between 10^15
+    // and 10^16). To maintain precision, we multiply the
+    // numerator by 10^17 (the product is in the range of
+    // 10^32 to 10^33) followed by a division, so the result
+    // is in the range of 10^16 to 10^15.
+    //
+    // We round away from zero if we're rounding up or
+    // truncate if we're rounding down.
+    std::uint64_t amount = muldiv_round(
+        numVal, tenTo17, denVal, (resultNegative != roundUp) ? denVal - 1 : 0);
+
+    int offset = numOffset - denOffset - 17;
+
+    if (resultNegative != roundUp)
+        canonicalizeRound(isXRP(issue), amount, offset);
+
+    STAmount result(issue, amount, offset, resultNegative);
+    if (roundUp && !resultNegative && !result)
+    {
+        if (isXRP(issue))
+        {
+            // return the smallest value above zero
+            amount = 1;
+            offset = 0;
+        }
+        else
+        {
+            // return the smallest value above zero
+            amount = STAmount::cMinValue;
+            offset = STAmount::cMinOffset;
+        }
+        return STAmount(issue, amount, offset, resultNegative);
+    }
+    return result;
+}
+
+
+}  // namespace reference
+
+
 class STAmount_test : public beast::unit_test::suite
 {
 public:
@@ -673,6 +1041,135 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void
+    testArithmeticReference()
+    {
+        testcase("arithmetic matches reference");
+
+        beast::xor_shift_engine engine(35);
+        Issue const usd{Currency(0x5553440000000000), AccountID(0x4985601)};
+
+        // Mantissas at the ends of the range are the most likely to differ
+        std::uint64_t const edges[] = {
+            STAmount::cMinValue,
+            STAmount::cMinValue + 1,
+            STAmount::cMinValue * 3 - 1,
+            STAmount::cMinValue * 5,
+            STAmount::cMaxValue / 3,
+            STAmount::cMaxValue - 1,
+            STAmount::cMaxValue};
+
+        auto iou = [&](int minOffset, int maxOffset) {
+            auto const mantissa = rand_int(engine, 7) == 0
+                ? edges[rand_int(engine, 6)]
+                : rand_int(engine, STAmount::cMinValue, STAmount::cMaxValue);
+            return STAmount(
+                usd,
+                mantissa,
+                rand_int(engine, minOffset, maxOffset),
+                rand_int(engine, 1) == 0);
+        };
+
+        auto xrp = [&]() {
+            // Every number of digits, up to the most drops there are
+            std::uint64_t limit = 10;
+            for (auto digits = rand_int(engine, 1, 17); digits > 1; --digits)
+                limit *= 10;
+            return STAmount(
+                rand_int(engine, limit / 10, limit - 1),
+                rand_int(engine, 1) == 0);
+        };
+
+        auto amount = [&]() {
+            switch (rand_int(engine, 3))
+            {
+                case 0:
+                    return xrp();
+                case 1:
+                    // Large enough to overflow or small enough to underflow
+                    return iou(STAmount::cMinOffset, STAmount::cMaxOffset);
+                default:
+                    return iou(-20, 20);
+            }
+        };
+
+        // Both give the same amount, or both throw
+        std::size_t mismatches = 0;
+        auto same = [&](auto&& actual, auto&& expected) {
+            std::optional<STAmount> a, e;
+            try
+            {
+                a = actual();
+            }
+            catch (std::exception const&)
+            {
+            }
+            try
+            {
+                e = expected();
+            }
+            catch (std::exception const&)
+            {
+            }
+
+            if (a.has_value() != e.has_value() ||
+                (a &&
+                 (a->mantissa() != e->mantissa() ||
+                  a->exponent() != e->exponent() ||
+                  a->negative() != e->negative() ||
+                  a->native() != e->native())))
+            {
+                if (++mismatches <= 10)
+                    log << "mismatch: " << (a ? a->getFullText() : "throws")
+                        << " != " << (e ? e->getFullText() : "throws")
+                        << std::endl;
+            }
+        };
+
+        // With Number switched on, amounts are rounded in each of its modes
+        std::vector<std::pair<bool, Number::rounding_mode>> const modes{
+            {false, Number::to_nearest},
+            {true, Number::to_nearest},
+            {true, Number::towards_zero},
+            {true, Number::downward},
+            {true, Number::upward}};
+
+        for (auto const& [switchover, mode] : modes)
+        {
+            NumberSO stNumberSO{switchover};
+            saveNumberRoundMode const saved{Number::setround(mode)};
+
+            for (int i = 0; i < 100000; ++i)
+            {
+                auto const v1 = amount();
+                auto const v2 = amount();
+                auto const& issue = rand_int(engine, 3) == 0 ? xrpIssue() : usd;
+                bool const roundUp = rand_int(engine, 1) == 0;
+
+                same(
+                    [&] { return multiply(v1, v2, issue); },
+                    [&] { return reference::multiply(v1, v2, issue); });
+                same(
+                    [&] { return divide(v1, v2, issue); },
+                    [&] { return reference::divide(v1, v2, issue); });
+                same(
+                    [&] { return mulRound(v1, v2, issue, roundUp); },
+                    [&] {
+                        return reference::mulRound(v1, v2, issue, roundUp);
+                    });
+                same(
+                    [&] { return divRound(v1, v2, issue, roundUp); },
+                    [&] {
+                        return reference::divRound(v1, v2, issue, roundUp);
+                    });
+            }
+        }
+
+        BEAST_EXPECT(mismatches == 0);
+    }
+
+    //--------------------------------------------------------------------------
+
     void
     run() override
     {
@@ -680,6 +1177,7 @@ public:
         testNativeCurrency();
         testCustomCurrency();
         testArithmetic();
+        testArithmeticReference();
         testUnderflow();
         testRounding();
         testConvertXRP();
@@ -689,4 +1187,121 @@ public:
 
 BEAST_DEFINE_TESTSUITE(STAmount, ripple_data, ripple);
 
+//------------------------------------------------------------------------------
+
+// Measures how fast IOU amounts are multiplied and divided, and how fast
+// offers cross, which is where most of that arithmetic happens.
+class STAmount_timing_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    static double
+    seconds(clock_type::duration d)
+    {
+        return std::chrono::duration<double>(d).count();
+    }
+
+    void
+    timeArithmetic()
+    {
+        beast::xor_shift_engine engine(1);
+        Issue const usd{Currency(0x5553440000000000), AccountID(0x4985601)};
+
+        std::vector<STAmount> amounts;
+        for (int i = 0; i < 1024; ++i)
+            amounts.emplace_back(
+                usd,
+                rand_int(engine, STAmount::cMinValue, STAmount::cMaxValue),
+                rand_int(engine, -10, 10),
+                rand_int(engine, 1) == 0);
+
+        auto time = [&](char const* what, auto&& f) {
+            std::size_t const rounds = 2000000;
+            std::size_t nonzero = 0;
+            auto const start = clock_type::now();
+            for (std::size_t i = 0; i < rounds; ++i)
+                nonzero += f(amounts[i % 1024], amounts[(i * 7 + 3) % 1024]) !=
+                    beast::zero;
+            auto const elapsed = seconds(clock_type::now() - start);
+            BEAST_EXPECT(nonzero == rounds);
+            log << what << ": " << std::fixed << rounds / elapsed
+                << " per second" << std::endl;
+        };
+
+        time("multiply", [&](auto const& a, auto const& b) {
+            return multiply(a, b, usd);
+        });
+        time("divide", [&](auto const& a, auto const& b) {
+            return divide(a, b, usd);
+        });
+        time("mulRound", [&](auto const& a, auto const& b) {
+            return mulRound(a, b, usd, true);
+        });
+        time("divRound", [&](auto const& a, auto const& b) {
+            return divRound(a, b, usd, false);
+        });
+    }
+
+    void
+    timeOfferCrossing()
+    {
+        using namespace test::jtx;
+
+        Env env(*this, envconfig(), nullptr, beast::severities::kError);
+
+        Account const gw("gateway");
+        Account const maker("maker");
+        Account const taker("taker");
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+
+        env.fund(XRP(10000000), gw, maker, taker);
+        env.close();
+        env(trust(maker, USD(100000000)));
+        env(trust(maker, EUR(100000000)));
+        env(trust(taker, USD(100000000)));
+        env(trust(taker, EUR(100000000)));
+        env.close();
+        env(pay(gw, maker, EUR(10000000)));
+        env(pay(gw, taker, USD(10000000)));
+        env.close();
+
+        int const offers = 400;
+        std::size_t crossed = 0;
+        clock_type::duration elapsed{};
+
+        for (int round = 0; round < 5; ++round)
+        {
+            // Offers at many qualities, with amounts that are not round
+            for (int i = 0; i < offers; ++i)
+                env(offer(maker, USD(10.987654321), EUR(10.123 + i * 0.0137)));
+            env.close();
+
+            // One offer crossing all of them
+            auto const start = clock_type::now();
+            env(offer(taker, EUR(1), USD(11 * offers)),
+                txflags(tfSell | tfImmediateOrCancel));
+            elapsed += clock_type::now() - start;
+            crossed += offers;
+            env.close();
+
+            // Only the maker's trust lines are left
+            BEAST_EXPECT(env.le(maker)->getFieldU32(sfOwnerCount) == 2);
+        }
+
+        log << "offer crossing: " << std::fixed << crossed / seconds(elapsed)
+            << " offers per second" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        timeArithmetic();
+        timeOfferCrossing();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(STAmount_timing, ripple_data, ripple);
+
 }  // namespace ripple
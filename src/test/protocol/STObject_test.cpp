@@ -389,6 +389,71 @@ public:
     }
 
     // Exercise field accessors
+    void
+    testHashing()
+    {
+        testcase("hashing");
+
+        // Data added to an SHA512HalfSerializer is hashed, not stored
+        auto check = [this](std::size_t blobSize) {
+            Blob const blob(blobSize, 0x5a);
+
+            Serializer s;
+            SHA512HalfSerializer h;
+            for (Serializer* p : {&s, static_cast<Serializer*>(&h)})
+            {
+                BEAST_EXPECT(p->add8(1) == 0);
+                BEAST_EXPECT(p->add16(2) == 1);
+                BEAST_EXPECT(p->add32(HashPrefix::txSign) == 3);
+                BEAST_EXPECT(p->add64(4) == 7);
+                BEAST_EXPECT(p->addFieldID(STI_UINT32, 2) == 15);
+                BEAST_EXPECT(p->addFieldID(STI_UINT8, 16) == 16);
+                BEAST_EXPECT(p->addVL(blob) == 19);
+                p->addBitString(uint256{7});
+            }
+
+            BEAST_EXPECT(h.hashed() == s.size());
+            BEAST_EXPECT(h.size() == 0);
+            BEAST_EXPECT(h.getSHA512Half() == s.getSHA512Half());
+            BEAST_EXPECT(h.getSHA512Half() == sha512Half(s.slice()));
+        };
+        check(0);
+        check(100);
+        check(300);
+        check(20000);
+
+        // Copies of a hashing serializer are ordinary, empty serializers
+        SHA512HalfSerializer h;
+        h.add32(1);
+        Serializer copy(h);
+        copy.add32(2);
+        BEAST_EXPECT(copy.size() == 4);
+        BEAST_EXPECT(h.hashed() == 4);
+
+        // Object hashes match the hash of the serialized object
+        STObject object(sfGeneric);
+        object.setFieldU32(sfFlags, 3);
+        object.setAccountID(sfAccount, AccountID(5));
+        object.setFieldVL(sfSigningPubKey, Blob(33, 2));
+        object.setFieldVL(sfTxnSignature, Blob(70, 1));
+        object.setFieldVL(sfMemoData, Blob(1000, 9));
+        object.setFieldH256(sfPreviousTxnID, uint256{9});
+
+        Serializer all;
+        all.add32(HashPrefix::transactionID);
+        object.add(all);
+        BEAST_EXPECT(
+            object.getHash(HashPrefix::transactionID) == all.getSHA512Half());
+
+        Serializer signing;
+        signing.add32(HashPrefix::txSign);
+        object.addWithoutSigningFields(signing);
+        BEAST_EXPECT(signing.size() < all.size());
+        BEAST_EXPECT(
+            object.getSigningHash(HashPrefix::txSign) ==
+            signing.getSHA512Half());
+    }
+
     void
     testFields()
     {
@@ -712,6 +777,7 @@ run() override
 
     testFields();
     testSerialization();
+    testHashing();
     testParseJSONArray();
     testParseJSONArrayWithInvalidChildrenObjects();
     testParseJSONEdgeCases();
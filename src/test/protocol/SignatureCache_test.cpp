@@ -0,0 +1,170 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/SignatureCache.h>
+
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class SignatureCache_test : public beast::unit_test::suite
+{
+    static uint256
+    key(std::uint64_t n)
+    {
+        return SignatureCache::makeKey(uint256{n}, Slice{}, Slice{}, false);
+    }
+
+    void
+    testKeys()
+    {
+        testcase("keys");
+
+        std::uint8_t const bytes[] = {1, 2, 3, 4};
+        Slice const ab(bytes, 2);
+        Slice const cd(bytes + 2, 2);
+        Slice const abc(bytes, 3);
+        Slice const d(bytes + 3, 1);
+
+        auto const k = SignatureCache::makeKey(uint256{1}, ab, cd, false);
+        BEAST_EXPECT(k == SignatureCache::makeKey(uint256{1}, ab, cd, false));
+
+        // Every part of what decides the signature is good is in the key
+        BEAST_EXPECT(k != SignatureCache::makeKey(uint256{2}, ab, cd, false));
+        BEAST_EXPECT(k != SignatureCache::makeKey(uint256{1}, cd, cd, false));
+        BEAST_EXPECT(k != SignatureCache::makeKey(uint256{1}, ab, ab, false));
+        BEAST_EXPECT(k != SignatureCache::makeKey(uint256{1}, ab, cd, true));
+
+        // The key and signature do not run together
+        BEAST_EXPECT(k != SignatureCache::makeKey(uint256{1}, abc, d, false));
+    }
+
+    void
+    testExpiration()
+    {
+        testcase("expiration");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        SignatureCache cache(1024, 60s, clock);
+
+        BEAST_EXPECT(!cache.contains(key(1)));
+        cache.insert(key(1));
+        BEAST_EXPECT(cache.contains(key(1)));
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.hits() == 1);
+        BEAST_EXPECT(cache.misses() == 1);
+
+        clock.advance(30s);
+        cache.insert(key(2));
+        BEAST_EXPECT(cache.contains(key(1)));
+        BEAST_EXPECT(cache.contains(key(2)));
+
+        // The first signature expires first
+        clock.advance(31s);
+        BEAST_EXPECT(!cache.contains(key(1)));
+        BEAST_EXPECT(cache.contains(key(2)));
+        BEAST_EXPECT(cache.size() == 1);
+
+        // Inserting again starts a new lifetime
+        cache.insert(key(1));
+        clock.advance(45s);
+        BEAST_EXPECT(cache.contains(key(1)));
+        BEAST_EXPECT(!cache.contains(key(2)));
+
+        cache.clear();
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(!cache.contains(key(1)));
+    }
+
+    void
+    testCapacity()
+    {
+        testcase("capacity");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        std::size_t const size = 1024;
+        SignatureCache cache(size, 60s, clock);
+
+        for (std::uint64_t i = 0; i < 10 * size; ++i)
+            cache.insert(key(i));
+        BEAST_EXPECT(cache.size() <= size);
+        BEAST_EXPECT(cache.size() > size / 2);
+
+        // The newest signatures are kept
+        std::size_t recent = 0;
+        for (std::uint64_t i = 9 * size; i < 10 * size; ++i)
+            recent += cache.contains(key(i));
+        BEAST_EXPECT(recent > size / 2);
+        BEAST_EXPECT(!cache.contains(key(0)));
+
+        // Expired signatures are not found, and are dropped
+        clock.advance(61s);
+        auto const before = cache.size();
+        for (std::uint64_t i = 9 * size; i < 10 * size; ++i)
+            BEAST_EXPECT(!cache.contains(key(i)));
+        BEAST_EXPECT(cache.size() == before - recent);
+    }
+
+    void
+    testConcurrency()
+    {
+        testcase("concurrency");
+
+        using namespace std::chrono_literals;
+        SignatureCache cache(1 << 16, 600s);
+
+        std::size_t const threads = 4;
+        std::size_t const perThread = 5000;
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t] {
+                for (std::uint64_t i = 0; i < perThread; ++i)
+                {
+                    auto const k = key(t * perThread + i);
+                    if (!cache.contains(k))
+                        cache.insert(k);
+                }
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        BEAST_EXPECT(cache.size() == threads * perThread);
+        BEAST_EXPECT(cache.misses() == threads * perThread);
+    }
+
+public:
+    void
+    run() override
+    {
+        testKeys();
+        testExpiration();
+        testCapacity();
+        testConcurrency();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SignatureCache, protocol, ripple);
+
+}  // namespace ripple
@@ -27,6 +27,7 @@
 
 #include <boost/utility/base_from_member.hpp>
 #include <functional>
+#include <thread>
 
 namespace ripple {
 namespace Resource {
@@ -275,6 +276,113 @@ public:
         pass();
     }
 
+    void
+    testDecay()
+    {
+        testcase("Decay");
+
+        using namespace std::chrono_literals;
+
+        // The atomic sample decays exactly like the plain one
+        TestStopwatch clock;
+        DecayingSample<decayWindowSeconds, TestStopwatch> plain(clock.now());
+        AtomicDecayingSample<decayWindowSeconds, TestStopwatch> atomic(
+            clock.now());
+
+        bool same = true;
+        for (int i = 0; i < 500; ++i)
+        {
+            if (i % 3 == 0)
+            {
+                auto const cost = 100 + rand_int(5000);
+                same = same &&
+                    plain.add(cost, clock.now()) ==
+                        atomic.add(cost, clock.now());
+            }
+            same = same &&
+                plain.value(clock.now()) == atomic.value(clock.now());
+            clock.advance(std::chrono::seconds(rand_int(3)));
+        }
+        BEAST_EXPECT(same);
+
+        // Long idle periods reset the value
+        atomic.clear();
+        atomic.add(1000 * decayWindowSeconds, clock.now());
+        BEAST_EXPECT(atomic.value(clock.now()) == 1000);
+        clock.advance(std::chrono::seconds(4 * decayWindowSeconds + 1));
+        BEAST_EXPECT(atomic.value(clock.now()) == 0);
+
+        // Times older than the last update don't decay the value
+        atomic.add(1000 * decayWindowSeconds, clock.now());
+        auto const then = clock.now();
+        clock.advance(10s);
+        auto const later = atomic.value(clock.now());
+        BEAST_EXPECT(later < 1000);
+        atomic.add(0, clock.now());
+        BEAST_EXPECT(atomic.add(0, then) == later);
+
+        // The value saturates instead of wrapping around
+        atomic.add(std::numeric_limits<std::int32_t>::max(), clock.now());
+        atomic.add(std::numeric_limits<std::int32_t>::max(), clock.now());
+        atomic.add(std::numeric_limits<std::int32_t>::max(), clock.now());
+        BEAST_EXPECT(
+            atomic.value(clock.now()) ==
+            std::numeric_limits<std::uint32_t>::max() / decayWindowSeconds);
+
+        atomic.clear();
+        BEAST_EXPECT(atomic.value(clock.now()) == 0);
+    }
+
+    void
+    testConcurrency(beast::Journal j)
+    {
+        testcase("Concurrency");
+
+        TestLogic logic(j);
+
+        int const threads = 4;
+        int const charges = 10000;
+        Charge const fee(10);
+
+        beast::IP::Endpoint const addr(
+            beast::IP::Endpoint::from_string("192.0.2.3"));
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]() {
+                // Half the threads create a consumer for every charge
+                Consumer held(logic.newInboundEndpoint(addr));
+                for (int i = 0; i < charges; ++i)
+                {
+                    if (t % 2 == 0)
+                    {
+                        Consumer c(logic.newInboundEndpoint(addr));
+                        Consumer copy(c);
+                        copy.charge(fee);
+                    }
+                    else
+                    {
+                        held.charge(fee);
+                    }
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        // The clock did not move, so nothing decayed
+        Consumer c(logic.newInboundEndpoint(addr));
+        BEAST_EXPECT(c.entry().refcount == 1);
+        BEAST_EXPECT(
+            c.balance() == threads * charges * fee.cost() / decayWindowSeconds);
+
+        auto const json = logic.getJson(0);
+        BEAST_EXPECT(json.size() == 1);
+        BEAST_EXPECT(json.isMember(c.to_string()));
+    }
+
     void
     run() override
     {
@@ -286,6 +394,8 @@ public:
         testCharges(journal);
         testImports(journal);
         testImport(journal);
+        testDecay();
+        testConcurrency(journal);
     }
 };
 
@@ -0,0 +1,212 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+
+namespace ripple {
+
+class LedgerExport_test : public beast::unit_test::suite
+{
+    static Json::Value
+    exportLedger(test::jtx::Env& env, Json::Value const& params)
+    {
+        return env.rpc("json", "ledger_export", to_string(params))
+            [jss::result];
+    }
+
+    // Allow exports to a directory
+    static std::unique_ptr<Config>
+    exportTo(std::unique_ptr<Config> cfg, std::string const& directory)
+    {
+        cfg->legacy(SECTION_LEDGER_EXPORT, directory);
+        return cfg;
+    }
+
+    void
+    testExport(std::size_t partitions)
+    {
+        testcase("export " + std::to_string(partitions));
+
+        using namespace test::jtx;
+        beast::temp_dir td;
+        Env env{*this, envconfig(exportTo, td.path())};
+
+        Account const gw{"gateway"};
+        auto const USD = gw["USD"];
+        env.fund(XRP(100000), gw);
+        std::vector<Account> accounts;
+        for (int i = 0; i < 100; ++i)
+            accounts.emplace_back("bob" + std::to_string(i));
+        for (auto const& account : accounts)
+            env.fund(XRP(1000), account);
+        env.close();
+        for (auto const& account : accounts)
+            env(trust(account, USD(100)));
+        env.close();
+
+        auto const ledger = env.closed();
+        std::map<uint256, Blob> expected;
+        for (auto const& sle : ledger->sles)
+            expected.emplace(sle->key(), sle->getSerializer().peekData());
+
+        // The defaults are the validated ledger and 16 partitions
+        Json::Value params;
+        params[jss::path] = "export";
+        if (partitions != 16)
+        {
+            params[jss::ledger_index] = "closed";
+            params[jss::partitions] = static_cast<unsigned>(partitions);
+        }
+        auto const result = exportLedger(env, params);
+
+        BEAST_EXPECT(result[jss::status] == "success");
+        BEAST_EXPECT(result[jss::ledger_index] == ledger->info().seq);
+        BEAST_EXPECT(
+            result[jss::entries] == std::to_string(expected.size()));
+        if (!BEAST_EXPECT(result[jss::files].size() == partitions))
+            return;
+
+        std::map<uint256, Blob> found;
+        std::uint64_t bytes = 0;
+        for (std::size_t partition = 0; partition < partitions; ++partition)
+        {
+            std::ifstream in(
+                td.file("export/" + result[jss::files][partition].asString()),
+                std::ios::binary);
+            Blob const data{
+                std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>()};
+            bytes += data.size();
+
+            SerialIter sit(makeSlice(data));
+            BEAST_EXPECT(sit.getSlice(8) == makeSlice(std::string("XRPLSTAT")));
+            BEAST_EXPECT(sit.get32() == 1);
+            BEAST_EXPECT(sit.get32() == ledger->info().seq);
+            BEAST_EXPECT(sit.get256() == ledger->info().hash);
+            BEAST_EXPECT(sit.get256() == ledger->info().accountHash);
+            BEAST_EXPECT(sit.get16() == partition);
+            BEAST_EXPECT(sit.get16() == partitions);
+
+            std::optional<uint256> previous;
+            while (!sit.empty())
+            {
+                auto const key = sit.get256();
+                auto const shift = partitions == 16 ? 4 : 0;
+                BEAST_EXPECT((key.data()[0] >> shift) == partition);
+                BEAST_EXPECT(!previous || *previous < key);
+                previous = key;
+                found.emplace(key, sit.getVL());
+            }
+        }
+
+        BEAST_EXPECT(found == expected);
+        BEAST_EXPECT(result[jss::bytes] == std::to_string(bytes));
+    }
+
+    void
+    testErrors()
+    {
+        testcase("errors");
+
+        using namespace test::jtx;
+        beast::temp_dir td;
+        Env env{*this, envconfig(exportTo, td.path())};
+        env.close();
+
+        {
+            Json::Value params;
+            params[jss::ledger_index] = "closed";
+            auto const result = exportLedger(env, params);
+            BEAST_EXPECT(result[jss::error] == "invalidParams");
+            BEAST_EXPECT(result[jss::error_message] == "Missing field 'path'.");
+        }
+
+        // Only the configured directory can be written to
+        for (auto const& path :
+             {td.path(), std::string("../export"), std::string("a/../../b")})
+        {
+            Json::Value params;
+            params[jss::path] = path;
+            params[jss::ledger_index] = "closed";
+            auto const result = exportLedger(env, params);
+            BEAST_EXPECT(result[jss::error] == "invalidParams");
+            BEAST_EXPECT(
+                result[jss::error_message] == "Invalid field 'path'.");
+        }
+
+        {
+            Env env{*this};
+            Json::Value params;
+            params[jss::path] = "export";
+            params[jss::ledger_index] = "closed";
+            auto const result = exportLedger(env, params);
+            BEAST_EXPECT(result[jss::error] == "notEnabled");
+        }
+
+        {
+            Json::Value params;
+            params[jss::path] = "export";
+            params[jss::ledger_index] = "closed";
+            params[jss::partitions] = 17;
+            auto const result = exportLedger(env, params);
+            BEAST_EXPECT(result[jss::error] == "invalidParams");
+            BEAST_EXPECT(
+                result[jss::error_message] == "Invalid field 'partitions'.");
+        }
+
+        {
+            // The open ledger has no state map of its own to walk
+            Json::Value params;
+            params[jss::path] = "export";
+            params[jss::ledger_index] = "current";
+            auto const result = exportLedger(env, params);
+            BEAST_EXPECT(result[jss::error] == "invalidParams");
+        }
+
+        {
+            Env env{*this, envconfig(no_admin)};
+            Json::Value params;
+            params[jss::path] = "export";
+            auto const result = exportLedger(env, params);
+            BEAST_EXPECT(result[jss::error] == "noPermission");
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testExport(16);
+        testExport(256);
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerExport, rpc, ripple);
+
+}  // namespace ripple
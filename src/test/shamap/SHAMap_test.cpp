@@ -21,10 +21,14 @@
 #include <ripple/basics/Buffer.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/shamap/SHAMap.h>
 #include <test/shamap/common.h>
 #include <test/unit_test/SuiteJournal.h>
 
+#include <chrono>
+#include <thread>
+
 namespace ripple {
 namespace tests {
 
@@ -122,6 +126,7 @@ public:
 
         run(true, journal);
         run(false, journal);
+        testReadAhead(journal);
     }
 
     void
@@ -326,6 +331,167 @@ public:
             }
         }
     }
+
+    void
+    testReadAhead(beast::Journal const& journal)
+    {
+        testcase("read ahead");
+
+        tests::TestNodeFamily tf{journal};
+
+        std::vector<uint256> keys;
+        SHAMapHash hash;
+        {
+            SHAMap map{SHAMapType::FREE, tf};
+            for (int i = 0; i < 5000; ++i)
+            {
+                keys.push_back(sha512Half(i));
+                map.addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    make_shamapitem(keys.back(), IntToVUC(i)));
+            }
+            map.flushDirty(hotACCOUNT_NODE);
+            hash = map.getHash();
+        }
+        std::sort(keys.begin(), keys.end());
+
+        // Each scan starts with nothing in memory but the root, and a
+        // window small enough to fill up
+        auto load = [&] {
+            tf.reset();
+            auto map = std::make_unique<SHAMap>(
+                SHAMapType::FREE, hash.as_uint256(), tf);
+            BEAST_EXPECT(map->fetchRoot(hash, nullptr));
+            map->setImmutable();
+            return map;
+        };
+
+        {
+            auto const map = load();
+            std::vector<uint256> found;
+            for (auto it = map->begin(16); it != map->end(); ++it)
+                found.push_back(it->key());
+            BEAST_EXPECT(found == keys);
+        }
+
+        {
+            auto const map = load();
+            auto const start = keys.begin() + keys.size() / 3;
+            std::vector<uint256> found;
+            for (auto it = map->upper_bound(*start, 16); it != map->end();
+                 ++it)
+                found.push_back(it->key());
+            BEAST_EXPECT(
+                found == std::vector<uint256>(std::next(start), keys.end()));
+        }
+
+        {
+            auto const map = load();
+            std::vector<uint256> found;
+            map->visitLeaves(
+                [&](boost::intrusive_ptr<SHAMapItem const> const& item) {
+                    found.push_back(item->key());
+                },
+                16);
+            BEAST_EXPECT(found == keys);
+        }
+
+        {
+            // Starting a scan of a map whose nodes are all cached visits
+            // a window's worth of them, not the rest of the map
+            auto const map = load();
+            std::vector<std::shared_ptr<SHAMapTreeNode>> cached;
+            std::vector<std::shared_ptr<SHAMapInnerNode>> inners{
+                std::static_pointer_cast<SHAMapInnerNode>(map->root_)};
+            while (!inners.empty())
+            {
+                auto const inner = inners.back();
+                inners.pop_back();
+                for (int branch = 0; branch < 16; ++branch)
+                {
+                    if (inner->isEmptyBranch(branch))
+                        continue;
+                    auto node = map->fetchNodeNT(inner->getChildHash(branch));
+                    if (node->isInner())
+                        inners.push_back(
+                            std::static_pointer_cast<SHAMapInnerNode>(node));
+                    cached.push_back(std::move(node));
+                }
+            }
+            BEAST_EXPECT(cached.size() > 5000);
+
+            auto const cache = tf.getTreeNodeCache(0);
+            auto const lookups = [&cache] {
+                auto const [hits, misses] = cache->getHitsAndMisses();
+                return hits + misses;
+            };
+
+            auto const before = lookups();
+            auto const ra = map->makeReadAhead(SHAMap::defaultReadAhead);
+            map->advanceReadAhead(*ra, uint256{});
+            auto const visited = lookups() - before;
+            BEAST_EXPECT(visited > 0);
+            BEAST_EXPECT(visited <= SHAMap::defaultReadAhead + 16);
+
+            // Each step of the scan visits a few more
+            map->advanceReadAhead(*ra, keys[1]);
+            BEAST_EXPECT(
+                lookups() - before - visited <=
+                SHAMap::ReadAhead::stepVisits + 16);
+        }
+
+        {
+            // The scan reaches hooked nodes itself, so a map that is in
+            // memory isn't explored at all
+            SHAMap map{SHAMapType::FREE, tf};
+            for (int i = 0; i < 5000; ++i)
+                map.addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    make_shamapitem(keys[i], IntToVUC(i)));
+            map.flushDirty(hotACCOUNT_NODE);
+
+            auto const ra = map.makeReadAhead(SHAMap::defaultReadAhead);
+            map.advanceReadAhead(*ra, uint256{});
+            BEAST_EXPECT(ra->unexplored_.empty());
+            BEAST_EXPECT(ra->ahead_.empty());
+            BEAST_EXPECT(ra->pending_ == 0);
+            BEAST_EXPECT(ra->visits_ == SHAMap::defaultReadAhead - 16);
+        }
+
+        {
+            // A read ahead given the last key of a scan reads nothing
+            // past it
+            auto const map = load();
+            uint256 last = ~uint256{};
+            last.data()[0] = 0x0F;
+            auto const ra = map->makeReadAhead(SHAMap::defaultReadAhead, last);
+            for (int i = 0; i < 1000; ++i)
+            {
+                map->advanceReadAhead(*ra, uint256{});
+                if (ra->pending_ == 0 && ra->unexplored_.empty())
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            BEAST_EXPECT(ra->pending_ == 0);
+            BEAST_EXPECT(ra->ahead_.size() > 100);
+            for (auto const& node : ra->ahead_)
+                BEAST_EXPECT(node.first.getNodeID() <= last);
+        }
+
+        {
+            // A map that is not backed has nothing to read
+            SHAMap map{SHAMapType::FREE, tf};
+            map.setUnbacked();
+            for (int i = 0; i < 100; ++i)
+                map.addItem(
+                    SHAMapNodeType::tnACCOUNT_STATE,
+                    make_shamapitem(keys[i], IntToVUC(i)));
+            std::size_t count = 0;
+            for (auto it = map.begin(16); it != map.end(); ++it)
+                ++count;
+            BEAST_EXPECT(count == 100);
+        }
+    }
 };
 
 class SHAMapPathProof_test : public beast::unit_test::suite